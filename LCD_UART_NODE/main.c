@@ -4,6 +4,10 @@
  * Desc: The goal of this project is to write messages received through CAN
  *       to the LCD display
  *
+ * Notes: UART runs at 921600(picked by UART1BaudBest) with the
+ *        FIFOs on, received bytes are queued by the UART ISR(see
+ *        InitUART1FIFO) and written to the LCD from main
+ *
  * Hardware Notes: system employs UART1 on port B
  */
 
@@ -29,8 +33,6 @@
 
 /************************FLAGS******************************/
 
-uint8_t rx_flag = 0x00;
-
 //0 if on line 1, not 0 if on line 2
 uint8_t line_flag = 0;
 
@@ -45,11 +47,6 @@ void SwapLines(void);
 
 void ArbSoftDelay(void);
 
-/*********************************************ISR PROTOTYPES**********************************/
-
-//interrupt configured for RX interrupt
-void UART_RX_Handler(void);
-
 /*********************************************MAIN**********************************/
 
 int main(void){
@@ -78,7 +75,18 @@ int main(void){
 
     LCDWriteCString(string);
 
-    InitUART1(&UART_RX_Handler);
+    /*
+     * fastest standard rate the clock makes within tolerance,
+     * capped at what the FTDI cable takes(921600 at 16MHz, +0.64%)
+     */
+    tUARTBaud baud;
+    UART1BaudBest(SysCtlClockGet(), 921600, UART1_BAUD_MAX_ERROR_PPM, &baud);
+
+    /*
+     * 16 byte FIFOs, interrupt at half full
+     * stragglers come in on the receive timeout
+     */
+    InitUART1FIFO(baud.baud, UART_FIFO_TX4_8, UART_FIFO_RX4_8);
 
     IntMasterEnable();
 
@@ -97,14 +105,12 @@ int main(void){
 
     while(1){
 
-      if(rx_flag){
-
-          data = UARTCharGet(UART1_BASE);
+      //one byte per pass so the line check below keeps up
+      //UART1RxStatsGet shows interrupts per byte
+      if(UART1RxGet(&data)){
 
           LCDWriteASCII(data,pcounter);
 
-          rx_flag = 0;
-
       }
 
       //LCD is a 2x16
@@ -157,19 +163,3 @@ void ArbSoftDelay(void){
     for(uint16_t idx = 0; idx < 5000; idx++);
 
 }
-
-/************************ISR******************************/
-void UART_RX_Handler(void){
-
-   UARTIntClear(UART1_BASE, UART_INT_RX); //clear the asserted interrupts
-
-   rx_flag = 1;
-
-}
-
-
-
-
-
-
-
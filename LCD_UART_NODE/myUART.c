@@ -16,18 +16,102 @@
 #include "inc/hw_can.h"
 #include "inc/hw_ints.h"
 #include "inc/hw_memmap.h"
+#include "inc/hw_timer.h"
 #include "inc/hw_types.h"
 #include "driverlib/can.h"
 #include "driverlib/gpio.h"
 #include "driverlib/interrupt.h"
 #include "driverlib/pin_map.h"
 #include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
 #include "driverlib/uart.h"
 #include "utils/uartstdio.h"
 
 //my includes
 #include "myUART.h"
 
+/*******************************GLOBALS******************************/
+
+#define RX_RING_MASK (UART1_RX_RING_SIZE - 1)
+
+/*
+ * RX ring for InitUART1FIFO
+ * the ISR only writes g_ui32RxHead and the reader
+ * only writes g_ui32RxTail so neither has to mask
+ * interrupts, both are free running
+ */
+static volatile uint8_t g_pui8RxRing[UART1_RX_RING_SIZE];
+static volatile uint32_t g_ui32RxHead = 0;
+static volatile uint32_t g_ui32RxTail = 0;
+
+static volatile tUARTRxStats g_sRxStats;
+
+#define TX_RING_MASK (UART1_TX_RING_SIZE - 1)
+#define ECHO_RING_MASK (UART1_ECHO_RING_SIZE - 1)
+
+/*
+ * TX ring for UART1Write
+ * UART1Write only writes g_ui32TxHead and the ISR only
+ * writes g_ui32TxTail, the ISR is the only one that
+ * touches the TX FIFO
+ */
+static volatile uint8_t g_pui8TxRing[UART1_TX_RING_SIZE];
+static volatile uint32_t g_ui32TxHead = 0;
+static volatile uint32_t g_ui32TxTail = 0;
+
+/*
+ * echo from the line assembler, filled and drained by the ISR
+ * only so the TX ring keeps a single producer
+ */
+static uint8_t g_pui8EchoRing[UART1_ECHO_RING_SIZE];
+static uint32_t g_ui32EchoHead = 0;
+static uint32_t g_ui32EchoTail = 0;
+
+//line assembler fed by the ISR, 0 when not started
+static tUARTLine * volatile g_psLine = 0;
+
+/*
+ * standard rates, fastest first, for UART1BaudBest
+ * and UART1AutoBaud
+ */
+static const uint32_t g_pui32StdBaud[] = {
+    4000000, 3000000, 2000000, 1500000, 1000000, 921600, 500000,
+    460800, 250000, 230400, 115200, 57600, 38400, 19200, 9600
+};
+
+#define STD_BAUD_COUNT (sizeof(g_pui32StdBaud) / sizeof(g_pui32StdBaud[0]))
+
+//Timer2 capture counts are 24 bits with the prescaler
+#define CAPTURE_MASK 0x00FFFFFF
+
+/******************************ISR PROTO******************************/
+
+/*
+ * Desc: RX/RT ISR used by InitUART1FIFO
+ */
+static void UART1FIFOISR(void);
+
+/*
+ * Desc: runs one received byte through the line assembler
+ */
+static void LineFeed(tUARTLine *line, uint8_t data);
+
+/*
+ * Desc: queues echo output, drops what doesn't fit
+ */
+static void EchoPut(tUARTLine *line, const uint8_t *data, uint32_t len);
+
+/*
+ * Desc: moves echo then TX ring bytes into the TX FIFO
+ */
+static void TxPrime(void);
+
+/*
+ * Desc: works out a rate from captured edge times
+ */
+static uint32_t AutoBaudRate(const uint32_t *edges, uint32_t count,
+                             uint32_t clock);
+
 /*
  * Desc: Initializes UART
  *       Baud Rate:115.2k
@@ -98,53 +182,686 @@ void InitUART1(void (*isr_fxn)(void)){
 }
 
 /*
- * Desc: Receives a string from UART,
- *       function will stop once it detects
- *       a user input termination value
+ * Desc: Initializes UART1 with the 16 byte FIFOs enabled
+ *       Length: 8 bits
+ *       Parity: None
+ *       Stop bits: 1
+ *
+ * Parameters:
+ * baud - baud rate, 921600 works from a 16MHz clock
+ * tx_level - UART_FIFO_TXn_8
+ * rx_level - UART_FIFO_RXn_8
+ *
+ * Hardware Notes: UART1 on Port B used
+ *       UART RX: PB0
+ *       UART TX: PB1
+ */
+void InitUART1FIFO(uint32_t baud, uint32_t tx_level, uint32_t rx_level){
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART1);
+
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UART1));
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOB));
+
+    //Pin configuarations
+    GPIOPinConfigure(GPIO_PB0_U1RX);
+    GPIOPinConfigure(GPIO_PB1_U1TX);
+
+    GPIOPinTypeUART(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+
+    //8N1 at the requested rate
+    UARTConfigSetExpClk(UART1_BASE, SysCtlClockGet(), baud,
+                        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+                            UART_CONFIG_PAR_NONE));
+
+    /*
+     * FIFO interrupts fire at the trigger levels instead of
+     * on every byte, RT catches the bytes left below the RX
+     * level after 32 bit times of silence
+     */
+    UARTFIFOLevelSet(UART1_BASE, tx_level, rx_level);
+    UARTFIFOEnable(UART1_BASE);
+
+    g_ui32RxHead = 0;
+    g_ui32RxTail = 0;
+    g_sRxStats.interrupts = 0;
+    g_sRxStats.bytes = 0;
+    g_sRxStats.overruns = 0;
+    g_sRxStats.dropped = 0;
+    g_ui32TxHead = 0;
+    g_ui32TxTail = 0;
+    g_ui32EchoHead = 0;
+    g_ui32EchoTail = 0;
+    g_psLine = 0;
+
+    /*INTERRUPTS*/
+    UARTIntClear(UART1_BASE, UART_INT_RX | UART_INT_RT);
+    UARTIntEnable(UART1_BASE, UART_INT_RX | UART_INT_RT);
+    UARTIntRegister(UART1_BASE, &UART1FIFOISR);
+
+    //CPU interrupt enbales
+    IntEnable(INT_UART1);
+
+    UARTEnable(UART1_BASE);
+
+}
+
+/*
+ * Desc: gets one byte from the InitUART1FIFO ring
  *
  * Paramters:
- *       string: pointer to output string
- *       term: specified termiation character
+ *       data: where to put the byte
  *
- * Notes: WILL TERMINATE THE FINAL STRING WITH A
- *        NULL CHARACTER
+ * Returns: true if a byte was available
+ */
+bool UART1RxGet(uint8_t *data){
+
+    uint32_t tail = g_ui32RxTail;
+
+    if(tail == g_ui32RxHead){
+        return false;
+    }
+
+    *data = g_pui8RxRing[tail & RX_RING_MASK];
+
+    //hand the slot back after the byte is read
+    g_ui32RxTail = tail + 1;
+
+    return true;
+
+}
+
+/*
+ * Desc: returns the number of bytes waiting in the ring
+ */
+uint32_t UART1RxAvail(void){
+
+    uint32_t head = g_ui32RxHead;
+
+    return head - g_ui32RxTail;
+
+}
+
+/*
+ * Desc: copies the receive counters
+ */
+void UART1RxStatsGet(tUARTRxStats *stats){
+
+    bool masked = IntMasterDisable();
+
+    stats->interrupts = g_sRxStats.interrupts;
+    stats->bytes = g_sRxStats.bytes;
+    stats->overruns = g_sRxStats.overruns;
+    stats->dropped = g_sRxStats.dropped;
+
+    if(!masked){
+        IntMasterEnable();
+    }
+
+}
+
+/*
+ * Desc: queues bytes for transmission on UART1, never blocks
+ *
+ * Paramters:
+ *       data: bytes to send
+ *       len: number of bytes
  *
- *        function will not preserve received terminator
+ * Returns: bytes queued, less than len if the TX ring filled up
+ */
+uint32_t UART1Write(const uint8_t *data, uint32_t len){
+
+    uint32_t head = g_ui32TxHead;
+    uint32_t limit = g_ui32TxTail + UART1_TX_RING_SIZE;
+    uint32_t count = 0;
+
+    while((count < len) && (head != limit)){
+
+        g_pui8TxRing[head & TX_RING_MASK] = data[count];
+        head++;
+        count++;
+
+    }
+
+    //publish once, then let the ISR start the FIFO
+    g_ui32TxHead = head;
+
+    if(count){
+        IntPendSet(INT_UART1);
+    }
+
+    return count;
+
+}
+
+/*
+ * Desc: returns the free space in the TX ring
+ */
+uint32_t UART1TxFree(void){
+
+    uint32_t tail = g_ui32TxTail;
+
+    return UART1_TX_RING_SIZE - (g_ui32TxHead - tail);
+
+}
+
+/*
+ * Desc: starts assembling lines from UART1 in the ISR
+ *
+ * Paramters:
+ *       line: assembler state, must stay valid while started
+ *       buf: line buffer
+ *       size: size of buf including the null, 2 to UART1_LINE_MAX_SIZE
+ *       echo: echo characters and edits through the TX path
+ *       on_line: optional line callback, 0 to poll ready
+ *
+ * Returns: false if buf or size is unusable, nothing is started
+ */
+bool UART1LineStart(tUARTLine *line, uint8_t *buf, uint32_t size,
+                    bool echo, void (*on_line)(uint8_t *line, uint32_t len)){
+
+    //room for one character and the null, a size past the
+    //limit is taken to be garbage rather than a real buffer
+    if(!line || !buf || (size < 2) || (size > UART1_LINE_MAX_SIZE)){
+        return false;
+    }
+
+    line->buf = buf;
+    line->size = size;
+    line->len = 0;
+    line->echo = echo;
+    line->last_cr = false;
+    line->ready = false;
+    line->overflows = 0;
+    line->on_line = on_line;
+
+    //the ISR picks it up from here, including bytes already waiting
+    g_psLine = line;
+    IntPendSet(INT_UART1);
+
+    return true;
+
+}
+
+/*
+ * Desc: returns true if a finished line is waiting in line->buf
+ */
+bool UART1LineReady(tUARTLine *line){
+
+    return line->ready;
+
+}
+
+/*
+ * Desc: hands the line buffer back to the assembler for the
+ *       next line
+ */
+void UART1LineRelease(tUARTLine *line){
+
+    line->len = 0;
+    line->ready = false;
+
+    //characters that came in meanwhile are waiting in the RX ring
+    IntPendSet(INT_UART1);
+
+}
+
+/*
+ * Desc: stops the line assembler, received bytes go back to
+ *       the RX ring for UART1RxGet
+ */
+void UART1LineStop(void){
+
+    g_psLine = 0;
+
+}
+
+/*
+ * Desc: works out the divisor UARTConfigSetExpClk will use for
+ *       a rate and how far off the result is
  *
+ * Notes: same arithmetic as UARTConfigSetExpClk so the error
+ *        reported is the error the UART really has
  */
-void UART1InString(uint8_t *string,uint8_t term){
+bool UART1BaudCalc(uint32_t clock, uint32_t baud, tUARTBaud *result){
 
-    uint8_t temp = UARTCharGet(UART1_BASE);
+    uint32_t div_baud = baud;
+    uint32_t div;
 
-    //while received character isn't the termination char
-    while(temp != term){
+    //fastest the UART goes is clock/8 with HSE
+    if((baud == 0) || (baud > (clock / 8))){
+        return false;
+    }
+
+    result->baud = baud;
+    result->hse = (baud * 16) > clock;
 
-        //echo input to terminal
-        UARTCharPut(UART1_BASE,temp);
+    //HSE halves the oversampling, same as halving the rate
+    if(result->hse){
+        div_baud /= 2;
+    }
 
-        //if backspace received decrement string and remove char
-        if(temp == BS){
+    //divisor in 1/64ths rounded to nearest
+    div = (((clock * 8) / div_baud) + 1) / 2;
+
+    //IBRD is 16 bits and can't be 0
+    if((div < 64) || (div >= (65536 * 64))){
+        return false;
+    }
 
-            string = string - 1;
-            *string = 0;
+    result->divisor = div;
+    result->actual = (uint32_t)((((uint64_t)clock * (result->hse ? 8 : 4)) +
+                                 (div / 2)) / div);
+    result->error_ppm = (int32_t)((((int64_t)result->actual - baud) *
+                                   1000000) / baud);
 
+    return true;
+
+}
+
+/*
+ * Desc: picks the fastest standard rate the clock can make
+ *       within max_ppm
+ */
+uint32_t UART1BaudBest(uint32_t clock, uint32_t max_baud, uint32_t max_ppm,
+                       tUARTBaud *result){
+
+    int32_t error;
+
+    for(uint32_t idx = 0; idx < STD_BAUD_COUNT; idx++){
+
+        if(max_baud && (g_pui32StdBaud[idx] > max_baud)){
+            continue;
+        }
+
+        if(!UART1BaudCalc(clock, g_pui32StdBaud[idx], result)){
+            continue;
+        }
+
+        error = (result->error_ppm < 0) ? -result->error_ppm :
+                                          result->error_ppm;
+
+        if((uint32_t)error <= max_ppm){
+            return result->baud;
+        }
+
+    }
+
+    return 0;
+
+}
+
+/*
+ * Desc: changes the rate of the running UART1
+ */
+void UART1BaudSet(uint32_t clock, uint32_t baud){
+
+    //disables the UART, sets the divisor and HSE, enables it again
+    UARTConfigSetExpClk(UART1_BASE, clock, baud,
+                        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+                            UART_CONFIG_PAR_NONE));
+
+}
+
+/*
+ * Desc: measures the rate of the first character received and
+ *       switches UART1 to it
+ *
+ * Notes: the timer runs from the system clock, which is also
+ *        the UART clock, so no conversion is needed
+ */
+uint32_t UART1AutoBaud(uint32_t clock, uint32_t timeout_ms,
+                       tUARTBaud *result){
+
+    uint32_t edges[UART1_AUTOBAUD_EDGES];
+    uint32_t count = 0;
+    uint32_t shortest = CAPTURE_MASK;
+    //64 bit, clock/1000 * timeout_ms passes 32 bits after
+    //268ms at 16MHz and the running count after 268s
+    uint64_t limit = (uint64_t)(clock / 1000) * timeout_ms;
+    uint64_t elapsed = 0;
+    uint32_t last, now, gap;
+    uint32_t baud;
+
+    //hand PB0 from the UART to the timer
+    UARTDisable(UART1_BASE);
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER2);
+
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER2));
+
+    GPIOPinConfigure(GPIO_PB0_T2CCP0);
+    GPIOPinTypeTimer(GPIO_PORTB_BASE, GPIO_PIN_0);
+
+    /*
+     * Timer2A counts up through all 24 bits(prescaler included)
+     * and latches the count on both edges
+     */
+    TimerConfigure(TIMER2_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_CAP_TIME_UP);
+    TimerControlEvent(TIMER2_BASE, TIMER_A, TIMER_EVENT_BOTH_EDGES);
+    TimerLoadSet(TIMER2_BASE, TIMER_A, 0xFFFF);
+    TimerPrescaleSet(TIMER2_BASE, TIMER_A, 0xFF);
+    TimerIntClear(TIMER2_BASE, TIMER_CAPA_EVENT);
+    TimerEnable(TIMER2_BASE, TIMER_A);
+
+    last = HWREG(TIMER2_BASE + TIMER_O_TAV) & CAPTURE_MASK;
+
+    while(count < UART1_AUTOBAUD_EDGES){
+
+        //free running count, summed so the timeout survives wraps
+        now = HWREG(TIMER2_BASE + TIMER_O_TAV) & CAPTURE_MASK;
+        elapsed += (now - last) & CAPTURE_MASK;
+        last = now;
+
+        if(TimerIntStatus(TIMER2_BASE, false) & TIMER_CAPA_EVENT){
+
+            TimerIntClear(TIMER2_BASE, TIMER_CAPA_EVENT);
+            edges[count] = TimerValueGet(TIMER2_BASE, TIMER_A) & CAPTURE_MASK;
+
+            if(count){
+                gap = (edges[count] - edges[count - 1]) & CAPTURE_MASK;
+                if(gap < shortest){
+                    shortest = gap;
+                }
+            }
+
+            count++;
+            continue;
+
+        }
+
+        //a frame(10 bits) of idle line ends the character
+        if((count >= 2) &&
+           (((now - edges[count - 1]) & CAPTURE_MASK) > (shortest * 10))){
+            break;
+        }
+
+        if(limit && (elapsed > limit)){
+            break;
+        }
+
+    }
+
+    //give PB0 back to the UART
+    TimerDisable(TIMER2_BASE, TIMER_A);
+    GPIOPinConfigure(GPIO_PB0_U1RX);
+    GPIOPinTypeUART(GPIO_PORTB_BASE, GPIO_PIN_0);
+
+    baud = AutoBaudRate(edges, count, clock);
+
+    if(!baud || !UART1BaudCalc(clock, baud, result)){
+        UARTEnable(UART1_BASE);
+        return 0;
+    }
+
+    UART1BaudSet(clock, baud);
+
+    return baud;
+
+}
+
+/*
+ * Desc: runs one received byte through the line assembler
+ *
+ * Notes: BS/DEL edit, CR, LF and CR/LF end the line,
+ *        characters past the buffer are counted and dropped
+ *
+ * Assumes: called from the ISR with line->ready clear
+ */
+static void LineFeed(tUARTLine *line, uint8_t data){
+
+    //backspace removes the last character, never past the start
+    if((data == BS) || (data == DEL)){
+
+        line->last_cr = false;
+
+        if(line->len){
+            line->len--;
+            EchoPut(line, (const uint8_t *)"\b \b", 3);
+        }
+
+        return;
+
+    }
+
+    //LF right after a CR ends the same line
+    if((data == LF) && line->last_cr){
+
+        line->last_cr = false;
+
+        return;
+
+    }
+
+    if((data == CR) || (data == LF)){
+
+        line->last_cr = (data == CR);
+        line->buf[line->len] = 0;
+
+        EchoPut(line, (const uint8_t *)"\r\n", 2);
+
+        if(line->on_line){
+            line->on_line(line->buf, line->len);
+            line->len = 0;
         }
         else{
-            //set string equal to received character
-            *string = temp;
+            line->ready = true;
+        }
+
+        return;
+
+    }
+
+    line->last_cr = false;
+
+    //keep room for the null
+    if(line->len < (line->size - 1)){
+        line->buf[line->len] = data;
+        line->len++;
+        EchoPut(line, &data, 1);
+    }
+    else{
+        line->overflows++;
+    }
 
-            // increment string
-            string++;
+}
+
+/*
+ * Desc: queues echo output, drops what doesn't fit
+ *
+ * Assumes: called from the ISR
+ */
+static void EchoPut(tUARTLine *line, const uint8_t *data, uint32_t len){
+
+    if(!line->echo){
+        return;
+    }
+
+    while(len-- && ((g_ui32EchoHead - g_ui32EchoTail) < UART1_ECHO_RING_SIZE)){
+        g_pui8EchoRing[g_ui32EchoHead & ECHO_RING_MASK] = *data++;
+        g_ui32EchoHead++;
+    }
+
+}
+
+/*
+ * Desc: moves echo then TX ring bytes into the TX FIFO
+ *
+ * Notes: the TX interrupt stays on while anything is left
+ *
+ * Assumes: called from the ISR
+ */
+static void TxPrime(void){
+
+    uint32_t head = g_ui32TxHead;
+    uint32_t tail = g_ui32TxTail;
+
+    //echo first so typing stays responsive behind long output
+    while((g_ui32EchoTail != g_ui32EchoHead) && UARTSpaceAvail(UART1_BASE)){
+        UARTCharPutNonBlocking(UART1_BASE,
+                               g_pui8EchoRing[g_ui32EchoTail & ECHO_RING_MASK]);
+        g_ui32EchoTail++;
+    }
+
+    while((tail != head) && UARTSpaceAvail(UART1_BASE)){
+        UARTCharPutNonBlocking(UART1_BASE, g_pui8TxRing[tail & TX_RING_MASK]);
+        tail++;
+    }
+
+    //hand the slots back to UART1Write
+    g_ui32TxTail = tail;
+
+    if((tail != head) || (g_ui32EchoTail != g_ui32EchoHead)){
+        UARTIntEnable(UART1_BASE, UART_INT_TX);
+    }
+    else{
+        UARTIntDisable(UART1_BASE, UART_INT_TX);
+    }
+
+}
+
+/*
+ * Desc: works out a rate from captured edge times
+ *
+ * Returns: the rate, rounded to a standard rate when one is
+ *          within UART1_AUTOBAUD_SNAP_PPM, 0 if the edges don't
+ *          make sense
+ *
+ * Notes: every edge of a character falls on a bit boundary.
+ *        Gaps under 1.5 times the shortest are single bits and
+ *        their average is the bit time, less sensitive to a
+ *        tick of capture jitter than the shortest gap alone.
+ *        The span from the start bit to the last edge holds a
+ *        whole number of bits(at most 9), dividing it by that
+ *        number keeps the error to a tick over the whole frame
+ */
+static uint32_t AutoBaudRate(const uint32_t *edges, uint32_t count,
+                             uint32_t clock){
+
+    uint32_t shortest = CAPTURE_MASK;
+    uint32_t sum = 0;
+    uint32_t singles = 0;
+    uint32_t span, bits, baud, gap, diff;
+    uint32_t idx;
+
+    if(count < 2){
+        return 0;
+    }
+
+    for(idx = 1; idx < count; idx++){
+        gap = (edges[idx] - edges[idx - 1]) & CAPTURE_MASK;
+        if(gap < shortest){
+            shortest = gap;
+        }
+    }
+
+    for(idx = 1; idx < count; idx++){
+        gap = (edges[idx] - edges[idx - 1]) & CAPTURE_MASK;
+        if((gap * 2) < (shortest * 3)){
+            sum += gap;
+            singles++;
         }
-        temp = UARTCharGet(UART1_BASE);
+    }
+
+    span = (edges[count - 1] - edges[0]) & CAPTURE_MASK;
+
+    if(sum == 0){
+        return 0;
+    }
+
+    //span over the average single bit, rounded
+    bits = (uint32_t)((((uint64_t)span * singles) + (sum / 2)) / sum);
+
+    if((bits == 0) || (bits > 9)){
+        return 0;
+    }
+
+    baud = (uint32_t)((((uint64_t)clock * bits) + (span / 2)) / span);
+
+    for(idx = 0; idx < STD_BAUD_COUNT; idx++){
+
+        diff = (baud > g_pui32StdBaud[idx]) ? (baud - g_pui32StdBaud[idx]) :
+                                              (g_pui32StdBaud[idx] - baud);
 
+        if(((uint64_t)diff * 1000000) <=
+           ((uint64_t)g_pui32StdBaud[idx] * UART1_AUTOBAUD_SNAP_PPM)){
+            return g_pui32StdBaud[idx];
+        }
 
     }
 
-    //terminate string with null
-    string++;
-    *string = 0x00;
+    return baud;
 
 }
 
+/**************************************ISR********************************************/
+
+/*
+ * Desc: RX/RT/TX ISR used by InitUART1FIFO
+ *
+ * Notes: drains everything in the FIFO per entry, at the
+ *        RX4_8 level that is at least 8 bytes per interrupt
+ *        while data is streaming
+ *
+ *        also entered by IntPendSet from UART1Write and the
+ *        line functions with no UART status set
+ */
+static void UART1FIFOISR(void){
+
+    uint32_t head = g_ui32RxHead;
+    uint32_t tail = g_ui32RxTail;
+    uint32_t status = UARTIntStatus(UART1_BASE, true);
+    tUARTLine *line = g_psLine;
+
+    UARTIntClear(UART1_BASE, status);
+
+    if(status & (UART_INT_RX | UART_INT_RT)){
+        g_sRxStats.interrupts++;
+    }
 
+    while(UARTCharsAvail(UART1_BASE)){
+
+        uint8_t data = UARTCharGetNonBlocking(UART1_BASE);
+
+        if((head - tail) < UART1_RX_RING_SIZE){
+            g_pui8RxRing[head & RX_RING_MASK] = data;
+            head++;
+            g_sRxStats.bytes++;
+        }
+        else{
+            g_sRxStats.dropped++;
+        }
+
+    }
+
+    //overrun means the FIFO filled before we got here
+    if(UARTRxErrorGet(UART1_BASE) & UART_RXERROR_OVERRUN){
+        g_sRxStats.overruns++;
+        UARTRxErrorClear(UART1_BASE);
+    }
+
+    /*
+     * with a line assembler started the ISR is the ring's reader,
+     * it stops while a finished line waits for UART1LineRelease
+     * and leaves the rest in the ring until then
+     */
+    if(line){
+
+        while(!line->ready && (tail != head)){
+            LineFeed(line, g_pui8RxRing[tail & RX_RING_MASK]);
+            tail++;
+        }
+
+        g_ui32RxTail = tail;
+
+    }
+
+    //publish once, after the bytes are stored
+    g_ui32RxHead = head;
+
+    TxPrime();
+
+}
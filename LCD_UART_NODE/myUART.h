@@ -22,6 +22,91 @@
 #define LF 0x0A //line feed
 #define BS 0x08 //backspace
 
+#define DEL 0x7F //delete, sent by some terminals for backspace
+
+//RX ring used by InitUART1FIFO, power of two
+#ifndef UART1_RX_RING_SIZE
+#define UART1_RX_RING_SIZE 256
+#endif
+
+//TX ring used by UART1Write, power of two
+#ifndef UART1_TX_RING_SIZE
+#define UART1_TX_RING_SIZE 128
+#endif
+
+//echo ring filled by the line assembler, power of two
+#ifndef UART1_ECHO_RING_SIZE
+#define UART1_ECHO_RING_SIZE 32
+#endif
+
+/*
+ * baud error UART1BaudBest accepts, parts per million
+ * 8N1 tolerates a few percent between both ends combined
+ * so each end should stay well under half of that
+ */
+#ifndef UART1_BAUD_MAX_ERROR_PPM
+#define UART1_BAUD_MAX_ERROR_PPM 15000
+#endif
+
+//how close a measured rate must be to a standard rate
+//for UART1AutoBaud to use the standard rate, ppm
+#ifndef UART1_AUTOBAUD_SNAP_PPM
+#define UART1_AUTOBAUD_SNAP_PPM 40000
+#endif
+
+//edges UART1AutoBaud captures at most, 10 covers a whole 'U'
+#define UART1_AUTOBAUD_EDGES 10
+
+//largest line buffer UART1LineStart accepts
+#ifndef UART1_LINE_MAX_SIZE
+#define UART1_LINE_MAX_SIZE 256
+#endif
+
+/*
+ * Desc: receive counters for InitUART1FIFO
+ *
+ * Notes: interrupts/bytes is the interrupts per byte figure,
+ *        1.0 means every byte cost a full interrupt entry
+ */
+typedef struct {
+    uint32_t interrupts;    //ISR entries
+    uint32_t bytes;         //bytes moved into the ring
+    uint32_t overruns;      //hardware FIFO overruns
+    uint32_t dropped;       //bytes lost because the ring was full
+} tUARTRxStats;
+
+/*
+ * Desc: line assembler state, see UART1LineStart
+ *
+ * Notes: owned by the UART1 ISR while a line is being typed,
+ *        the buffer belongs to the caller once ready is set
+ *        until UART1LineRelease is called
+ */
+typedef struct {
+    uint8_t *buf;           //caller's line buffer
+    uint32_t size;          //size of buf, including the null
+    uint32_t len;           //characters in the line so far
+    bool echo;              //echo typed characters back
+    bool last_cr;           //swallow the LF of a CR/LF pair
+    volatile bool ready;    //a full line is waiting in buf
+    uint32_t overflows;     //characters dropped because buf was full
+    void (*on_line)(uint8_t *line, uint32_t len);
+} tUARTLine;
+
+/*
+ * Desc: baud rate divisor for a clock, see UART1BaudCalc
+ *
+ * Notes: the UART divides the clock by 16(or 8 with HSE) times
+ *        divisor/64, so only some rates come out exact
+ */
+typedef struct {
+    uint32_t baud;          //requested rate
+    uint32_t actual;        //rate the divisor really gives
+    int32_t error_ppm;      //actual vs requested, parts per million
+    uint32_t divisor;       //in 1/64ths, IBRD << 6 | FBRD
+    bool hse;               //8x oversampling instead of 16x
+} tUARTBaud;
+
 /*
  * Desc: Initializes UART
  *       Baud Rate:115.2k
@@ -40,20 +125,193 @@
 void InitUART1(void (*isr_fxn)(void));
 
 /*
- * Desc: Receives a string from UART,
- *       function will stop once it detects
- *       a user input termination value
+ * Desc: Initializes UART1 with the 16 byte FIFOs enabled
+ *       Length: 8 bits
+ *       Parity: None
+ *       Stop bits: 1
+ *
+ *       The RX interrupt fires at the RX trigger level and the
+ *       receive timeout(UART_INT_RT) picks up anything left below
+ *       it once the line goes quiet. The built in ISR drains every
+ *       available byte into a ring read with UART1RxGet
+ *
+ * Parameters:
+ * baud - baud rate, 921600 works from a 16MHz clock
+ * tx_level - UART_FIFO_TXn_8
+ * rx_level - UART_FIFO_RXn_8, higher means fewer interrupts
+ *            but more bytes waiting for the timeout
+ *
+ * Hardware Notes: UART1 on Port B used
+ *       UART RX: PB0
+ *       UART TX: PB1
+ */
+void InitUART1FIFO(uint32_t baud, uint32_t tx_level, uint32_t rx_level);
+
+/*
+ * Desc: gets one byte from the InitUART1FIFO ring
+ *
+ * Paramters:
+ *       data: where to put the byte
+ *
+ * Returns: true if a byte was available
+ */
+bool UART1RxGet(uint8_t *data);
+
+/*
+ * Desc: returns the number of bytes waiting in the ring
+ */
+uint32_t UART1RxAvail(void);
+
+/*
+ * Desc: copies the receive counters
+ */
+void UART1RxStatsGet(tUARTRxStats *stats);
+
+/*
+ * Desc: queues bytes for transmission on UART1, never blocks
+ *
+ * Paramters:
+ *       data: bytes to send
+ *       len: number of bytes
+ *
+ * Returns: bytes queued, less than len if the TX ring filled up
+ *
+ * Notes: requires InitUART1FIFO, the UART1 ISR feeds the FIFO
+ *        call from one context only(main loop)
+ */
+uint32_t UART1Write(const uint8_t *data, uint32_t len);
+
+/*
+ * Desc: returns the free space in the TX ring
+ */
+uint32_t UART1TxFree(void);
+
+/*
+ * Desc: starts assembling lines from UART1 in the ISR
+ *
+ *       Received characters are edited into buf as they arrive:
+ *       BS/DEL remove the last character, CR, LF or CR/LF end
+ *       the line and anything past size - 1 characters is dropped
+ *       (counted in overflows). A finished line is null terminated
+ *       without its terminator
+ *
+ *       If on_line is given it is called from the ISR with each
+ *       finished line and the assembler starts the next line once
+ *       it returns. Otherwise ready is set and the line stays put
+ *       until UART1LineRelease, characters received meanwhile wait
+ *       in the RX ring
  *
  * Paramters:
- *       string: pointer to output string
- *       term: specified termiation character
+ *       line: assembler state, must stay valid while started
+ *       buf: line buffer
+ *       size: size of buf including the null, 2 to UART1_LINE_MAX_SIZE
+ *       echo: echo characters and edits through the TX path
+ *       on_line: optional line callback, 0 to poll ready
  *
- * Notes: WILL TERMINATE THE FINAL STRING WITH A
- *        NULL CHARACTER
+ * Returns: false if buf is missing or size is out of range,
+ *          nothing is started then
+ *
+ * Notes: requires InitUART1FIFO, UART1RxGet must not be used
+ *        while a line assembler is started
+ *
+ *        use UART1LineStartArray for an array buffer so the
+ *        size can't disagree with it
+ */
+bool UART1LineStart(tUARTLine *line, uint8_t *buf, uint32_t size,
+                    bool echo, void (*on_line)(uint8_t *line, uint32_t len));
+
+/*
+ * Desc: UART1LineStart with the size taken from the array itself
+ *
+ * Notes: buf must be an array, not a pointer
+ */
+#define UART1LineStartArray(line, buf, echo, on_line)                  \
+    UART1LineStart((line), (buf), sizeof(buf), (echo), (on_line))
+
+/*
+ * Desc: returns true if a finished line is waiting in line->buf
+ */
+bool UART1LineReady(tUARTLine *line);
+
+/*
+ * Desc: hands the line buffer back to the assembler for the
+ *       next line
+ */
+void UART1LineRelease(tUARTLine *line);
+
+/*
+ * Desc: stops the line assembler, received bytes go back to
+ *       the RX ring for UART1RxGet
+ */
+void UART1LineStop(void);
+
+/*
+ * Desc: works out the divisor UARTConfigSetExpClk will use for
+ *       a rate and how far off the result is
+ *
+ *       Rates above clock/16 use HSE(8x oversampling), which
+ *       doubles the top rate to clock/8 at the cost of a
+ *       coarser divisor
+ *
+ * Paramters:
+ *       clock: UART clock, SysCtlClockGet()
+ *       baud: requested rate
+ *       result: divisor, actual rate and error
+ *
+ * Returns: false if the rate can't be reached from this clock
+ */
+bool UART1BaudCalc(uint32_t clock, uint32_t baud, tUARTBaud *result);
+
+/*
+ * Desc: picks the fastest standard rate(9600 up to 4M) the
+ *       clock can make within max_ppm
+ *
+ * Paramters:
+ *       clock: UART clock, SysCtlClockGet()
+ *       max_baud: fastest rate the other end takes, 0 for no limit
+ *       max_ppm: largest error allowed, UART1_BAUD_MAX_ERROR_PPM
+ *       result: settings for the chosen rate
+ *
+ * Returns: the chosen rate, 0 if none fits
+ *
+ * Notes: at 16MHz that is 2M exact with HSE, at 80MHz 4M
+ */
+uint32_t UART1BaudBest(uint32_t clock, uint32_t max_baud, uint32_t max_ppm,
+                       tUARTBaud *result);
+
+/*
+ * Desc: changes the rate of the running UART1
+ *
+ * Notes: waits for the character being sent to finish,
+ *        the FIFOs end up enabled
+ */
+void UART1BaudSet(uint32_t clock, uint32_t baud);
+
+/*
+ * Desc: measures the rate of the first character received and
+ *       switches UART1 to it
+ *
+ *       PB0 is handed to Timer2 capture(T2CCP0) which timestamps
+ *       both edges of the character. The shortest pulse is one
+ *       bit, the span from the start bit to the last edge gives
+ *       the rate to within a timer tick over the whole frame.
+ *       A rate within UART1_AUTOBAUD_SNAP_PPM of a standard one
+ *       is rounded to it
+ *
+ * Paramters:
+ *       clock: UART and timer clock, SysCtlClockGet()
+ *       timeout_ms: how long to wait, 0 waits forever
+ *       result: settings for the rate found
  *
- *        function will not preserve received terminator
+ * Returns: the rate UART1 now runs at, 0 on timeout or if the
+ *          character couldn't be measured(the old rate is kept)
  *
+ * Notes: blocks, requires InitUART1FIFO first. The character
+ *        measured is used up, so the other end should send
+ *        'U'(0x55, a pulse every bit) or CR which both have
+ *        single bit pulses. Uses Timer2
  */
-void UART1InString(uint8_t *string,uint8_t term);
+uint32_t UART1AutoBaud(uint32_t clock, uint32_t timeout_ms,
+                       tUARTBaud *result);
 
 #endif /* MYUART_H_ */
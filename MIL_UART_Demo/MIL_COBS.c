@@ -0,0 +1,484 @@
+/*
+ * Name: MIL_COBS.c
+ * Author: Marquez Jones
+ * Desc: Binary telemetry framing over uartstdio(see MIL_COBS.h)
+ *
+ * Notes: the encoder writes straight into the uartstdio TX ring and
+ *        the decoder runs from the UART ISR, neither keeps a copy
+ *        of the frame in between
+ *
+ *        the CRC, MIL_COBSEncode and the decoder build on their own,
+ *        everything that touches the UART needs UART_BUFFERED
+ */
+
+/* INCLUDES */
+//includes
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "utils/uartstdio.h"
+
+//MIL includes
+#include "MIL_COBS.h"
+
+/*
+ * DWT cycle counter registers(Cortex-M4 core)
+ */
+#define DWT_CTRL        0xE0001000
+#define DWT_CYCCNT      0xE0001004
+#define DEMCR           0xE000EDFC
+#define DEMCR_TRCENA    0x01000000
+#define DWT_CYCCNTENA   0x00000001
+
+/*
+ * The benchmark's text line as a precompiled format, the same
+ * as "T %u %d %d %d %u\n"
+ */
+#define TELEMETRY_LINE(F)           \
+    F##LIT("T ")                    \
+    F##UINT(tick, ' ', 0)           \
+    F##LIT(" ")                     \
+    F##INT(ax, ' ', 0)              \
+    F##LIT(" ")                     \
+    F##INT(ay, ' ', 0)              \
+    F##LIT(" ")                     \
+    F##INT(az, ' ', 0)              \
+    F##LIT(" ")                     \
+    F##UINT(vbat, ' ', 0)           \
+    F##LIT("\n")
+
+/*******************************GLOBALS******************************/
+
+/*
+ * CRC-16/CCITT-FALSE table, poly 0x1021, MSB first
+ */
+static const uint16_t g_pui16CRC16Table[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
+//one byte of CRC
+#define CRC16_STEP(crc, data)                                               \
+    ((uint16_t)(((crc) << 8) ^                                              \
+                g_pui16CRC16Table[(((crc) >> 8) ^ (data)) & 0xFF]))
+
+/*
+ * COBS encoder state
+ *
+ * code_pos is where the code byte of the current block goes,
+ * it is filled in once the block ends. Positions are masked so
+ * the output can wrap around a ring
+ */
+typedef struct {
+    uint8_t *buf;
+    uint32_t mask;
+    uint32_t pos;
+    uint32_t code_pos;
+    uint8_t code;
+} tCOBSEncoder;
+
+#ifdef UART_BUFFERED
+//TelemetryLine(), TelemetryLinePrint()
+UARTSTDIO_FMT_DEFINE(TelemetryLine, TELEMETRY_LINE)
+
+/******************************FXN PROTO******************************/
+
+/*
+ * Desc: RX hook used by MIL_COBSAttach
+ */
+static void DecodeHook(void *pvArg, unsigned char ucChar);
+#endif
+
+/******************************ENCODER******************************/
+
+/*
+ * Desc: starts a frame at start
+ */
+static inline void EncoderStart(tCOBSEncoder *enc, uint8_t *buf,
+                                uint32_t mask, uint32_t start){
+
+    enc->buf = buf;
+    enc->mask = mask;
+    enc->code_pos = start;
+    enc->pos = start + 1;
+    enc->code = 1;
+
+}
+
+/*
+ * Desc: encodes one byte
+ *
+ * Notes: a zero or a full block(254 data bytes) closes the
+ *        current block and opens the next
+ */
+static inline void EncoderPut(tCOBSEncoder *enc, uint8_t data){
+
+    if(data){
+        enc->buf[enc->pos & enc->mask] = data;
+        enc->pos++;
+        enc->code++;
+    }
+
+    if(!data || (enc->code == 0xFF)){
+        enc->buf[enc->code_pos & enc->mask] = enc->code;
+        enc->code_pos = enc->pos;
+        enc->pos++;
+        enc->code = 1;
+    }
+
+}
+
+/*
+ * Desc: closes the last block
+ */
+static inline void EncoderFinish(tCOBSEncoder *enc){
+
+    enc->buf[enc->code_pos & enc->mask] = enc->code;
+
+}
+
+/*
+ * Desc: CRC-16/CCITT-FALSE, table driven
+ *
+ * Inputs: running CRC(0xFFFF to start), data, length
+ */
+uint16_t MIL_CRC16(uint16_t crc, const uint8_t *data, uint32_t len){
+
+    while(len--){
+        crc = CRC16_STEP(crc, *data++);
+    }
+
+    return crc;
+
+}
+
+/*
+ * Desc: COBS encodes a buffer, no delimiter added
+ *
+ * Inputs: destination(at least MIL_COBS_ENCODED_MAX(len) - 1 bytes),
+ *         source, length
+ * Returns: encoded length
+ */
+uint32_t MIL_COBSEncode(uint8_t *dst, const uint8_t *src, uint32_t len){
+
+    tCOBSEncoder enc;
+
+    EncoderStart(&enc, dst, 0xFFFFFFFF, 0);
+
+    for(uint32_t idx = 0; idx < len; idx++){
+        EncoderPut(&enc, src[idx]);
+    }
+
+    EncoderFinish(&enc);
+
+    return enc.pos;
+
+}
+
+#ifdef UART_BUFFERED
+/*
+ * Desc: sends one frame
+ *
+ * Inputs: UART handle, message id, payload, payload length
+ * Returns: true if queued, false if the TX ring did not have room
+ *          for the whole frame(nothing is queued then)
+ *
+ * Notes: CRC and COBS are done in the same pass, straight into
+ *        the ring
+ */
+bool MIL_COBSSend(UARTStdioHandle psUART, uint8_t id, const void *payload,
+                  uint32_t len){
+
+    const uint8_t *src = payload;
+    tUARTStdioTxSpan sSpan;
+    tCOBSEncoder enc;
+    uint16_t crc;
+
+    if(len > MIL_COBS_MAX_PAYLOAD){
+        return false;
+    }
+
+    //reserve the worst case so the frame can't be cut short
+    if(UARTStdioTxReserve(psUART, &sSpan) <
+       MIL_COBS_ENCODED_MAX(len + MIL_COBS_FRAME_OVERHEAD)){
+        return false;
+    }
+
+    EncoderStart(&enc, sSpan.pcBuf, sSpan.ui32Mask, sSpan.ui32Start);
+
+    crc = CRC16_STEP(0xFFFF, id);
+    EncoderPut(&enc, id);
+
+    for(uint32_t idx = 0; idx < len; idx++){
+        crc = CRC16_STEP(crc, src[idx]);
+        EncoderPut(&enc, src[idx]);
+    }
+
+    //big endian so the CRC over the whole frame comes out 0
+    EncoderPut(&enc, (uint8_t)(crc >> 8));
+    EncoderPut(&enc, (uint8_t)crc);
+    EncoderFinish(&enc);
+
+    //delimiter
+    enc.buf[enc.pos & enc.mask] = 0;
+    enc.pos++;
+
+    UARTStdioTxCommit(psUART, enc.pos - sSpan.ui32Start);
+
+    return true;
+
+}
+#endif
+
+/******************************DECODER******************************/
+
+/*
+ * Desc: sets up a decoder
+ *
+ * Inputs: decoder, frame buffer(MIL_COBS_FRAME_OVERHEAD + the largest
+ *         payload expected), its size, frame callback
+ */
+void MIL_COBSDecoderInit(tCOBSDecoder *dec, uint8_t *buf, uint32_t size,
+                         tCOBSFrameFxn on_frame){
+
+    dec->buf = buf;
+    dec->size = size;
+    dec->len = 0;
+    dec->crc = 0xFFFF;
+    dec->remaining = 0;
+    dec->code = 0;
+    dec->discard = false;
+    dec->on_frame = on_frame;
+    dec->frames = 0;
+    dec->crc_errors = 0;
+    dec->framing_errors = 0;
+
+}
+
+/*
+ * Desc: stores one decoded byte
+ *
+ * Returns: false if the frame doesn't fit, the rest of it is skipped
+ */
+static inline bool DecoderAppend(tCOBSDecoder *dec, uint8_t data){
+
+    if(dec->len >= dec->size){
+        dec->discard = true;
+        dec->framing_errors++;
+        return false;
+    }
+
+    dec->buf[dec->len] = data;
+    dec->len++;
+    dec->crc = CRC16_STEP(dec->crc, data);
+
+    return true;
+
+}
+
+/*
+ * Desc: runs one received byte through the decoder
+ *
+ * Notes: the CRC is kept up to date byte by byte so the end of
+ *        a frame costs the same as any other byte
+ */
+void MIL_COBSDecodeByte(tCOBSDecoder *dec, uint8_t data){
+
+    //delimiter, the frame is complete
+    if(data == 0){
+
+        if(!dec->discard && dec->code){
+
+            if((dec->remaining != 0) || (dec->len < MIL_COBS_FRAME_OVERHEAD)){
+                dec->framing_errors++;
+            }
+            else if(dec->crc != 0){
+                dec->crc_errors++;
+            }
+            else{
+                dec->frames++;
+                dec->on_frame(dec->buf[0], &dec->buf[1],
+                              dec->len - MIL_COBS_FRAME_OVERHEAD);
+            }
+
+        }
+
+        //back to back delimiters are just idle
+        dec->len = 0;
+        dec->crc = 0xFFFF;
+        dec->remaining = 0;
+        dec->code = 0;
+        dec->discard = false;
+
+        return;
+
+    }
+
+    if(dec->discard){
+        return;
+    }
+
+    //code byte
+    if(dec->remaining == 0){
+
+        //every block but a full one was followed by a zero
+        if(dec->code && (dec->code != 0xFF)){
+            if(!DecoderAppend(dec, 0)){
+                return;
+            }
+        }
+
+        dec->code = data;
+        dec->remaining = data - 1;
+
+        return;
+
+    }
+
+    DecoderAppend(dec, data);
+    dec->remaining--;
+
+}
+
+#ifdef UART_BUFFERED
+/*
+ * Desc: feeds a UART's received bytes to a decoder from its ISR
+ *
+ * Notes: turns echo off, the UART's RX buffer is no longer used
+ */
+void MIL_COBSAttach(UARTStdioHandle psUART, tCOBSDecoder *dec){
+
+    UARTStdioEchoSet(psUART, false);
+    UARTStdioRxHookSet(psUART, DecodeHook, dec);
+
+}
+
+/*
+ * Desc: RX hook used by MIL_COBSAttach
+ */
+static void DecodeHook(void *pvArg, unsigned char ucChar){
+
+    MIL_COBSDecodeByte((tCOBSDecoder *)pvArg, ucChar);
+
+}
+#endif
+
+/******************************BENCHMARK***************************************/
+
+#ifdef UART_BUFFERED
+
+/*
+ * Desc: times MIL_COBSSend against UARTStdioPrintf, and against the
+ *       same line from a precompiled format(UARTSTDIO_FMT_DEFINE), for
+ *       the same telemetry record using the DWT cycle counter
+ *
+ * Inputs: UART handle, number of iterations, results
+ *
+ * Notes: interrupts are off while measuring so the UART ISR
+ *        doesn't land in the numbers, the TX ring is discarded
+ *        after each message
+ */
+void MIL_COBSBenchmark(UARTStdioHandle psUART, uint32_t iterations,
+                       tCOBSBench *result){
+
+    //a typical sensor record, 12 bytes with no padding
+    struct {
+        uint32_t tick;
+        int16_t accel[3];
+        uint16_t vbat;
+    } sRec = {0, {-123, 456, -7890}, 3300};
+
+    uint32_t start_cnt;
+    uint32_t free;
+    bool masked;
+
+    //enable the cycle counter
+    HWREG(DEMCR) |= DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CYCCNTENA;
+
+    result->cobs_cycles = 0;
+    result->cobs_bytes = 0;
+    result->printf_cycles = 0;
+    result->printf_bytes = 0;
+    result->fmt_cycles = 0;
+
+    if(iterations == 0){
+        return;
+    }
+
+    masked = IntMasterDisable();
+
+    UARTStdioFlushTx(psUART, true);
+
+    for(uint32_t idx = 0; idx < iterations; idx++){
+
+        sRec.tick = idx * 1000;
+
+        free = UARTStdioTxBytesFree(psUART);
+        start_cnt = HWREG(DWT_CYCCNT);
+        MIL_COBSSend(psUART, 0x10, &sRec, sizeof(sRec));
+        result->cobs_cycles += HWREG(DWT_CYCCNT) - start_cnt;
+        result->cobs_bytes += free - UARTStdioTxBytesFree(psUART);
+        UARTStdioFlushTx(psUART, true);
+
+        free = UARTStdioTxBytesFree(psUART);
+        start_cnt = HWREG(DWT_CYCCNT);
+        UARTStdioPrintf(psUART, "T %u %d %d %d %u\n", sRec.tick,
+                        sRec.accel[0], sRec.accel[1], sRec.accel[2],
+                        sRec.vbat);
+        result->printf_cycles += HWREG(DWT_CYCCNT) - start_cnt;
+        result->printf_bytes += free - UARTStdioTxBytesFree(psUART);
+        UARTStdioFlushTx(psUART, true);
+
+        start_cnt = HWREG(DWT_CYCCNT);
+        TelemetryLinePrint(psUART, sRec.tick, sRec.accel[0], sRec.accel[1],
+                           sRec.accel[2], sRec.vbat);
+        result->fmt_cycles += HWREG(DWT_CYCCNT) - start_cnt;
+        UARTStdioFlushTx(psUART, true);
+
+    }
+
+    if(!masked){
+        IntMasterEnable();
+    }
+
+    result->cobs_cycles /= iterations;
+    result->cobs_bytes /= iterations;
+    result->printf_cycles /= iterations;
+    result->printf_bytes /= iterations;
+    result->fmt_cycles /= iterations;
+
+}
+#endif
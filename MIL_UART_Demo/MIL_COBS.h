@@ -0,0 +1,170 @@
+/*
+ * Name: MIL_COBS.h
+ * Author: Marquez Jones
+ * Desc: Binary telemetry framing over uartstdio
+ *
+ * Frame format:
+ *       [id][payload 0-MIL_COBS_MAX_PAYLOAD bytes][CRC16 hi][CRC16 lo]
+ *
+ *       The whole frame is COBS(Consistent Overhead Byte Stuffing)
+ *       encoded so it never contains a 0x00, and a single 0x00 ends
+ *       it. A receiver that joins mid stream or loses a byte just
+ *       waits for the next 0x00 to resync. COBS costs one byte per
+ *       254 bytes of frame, plus the delimiter
+ *
+ *       The CRC is CRC-16/CCITT-FALSE(poly 0x1021, init 0xFFFF) over
+ *       the id and payload, sent big endian so that running the CRC
+ *       over the whole decoded frame gives 0
+ *
+ * Sending:
+ *       MIL_COBSSend encodes straight into the uartstdio TX ring
+ *       (UARTStdioTxReserve/UARTStdioTxCommit) in one pass that also
+ *       computes the CRC, so the payload is never copied or formatted
+ *       first. A frame is queued whole or not at all
+ *
+ * Receiving:
+ *       MIL_COBSAttach hooks a decoder to the UART's RX interrupt
+ *       (UARTStdioRxHookSet). Each byte moves the decoder one step and
+ *       a good frame is handed to the on_frame callback, still in the
+ *       ISR, as soon as its delimiter arrives
+ *
+ * Notes: message ids are up to the application, e.g. an enum shared
+ *        by both ends of the link. Payload structs should be packed
+ *        and use fixed width types
+ *
+ *        MIL_COBSSend, MIL_COBSAttach and MIL_COBSBenchmark require
+ *        UART_BUFFERED, the CRC, encoder and decoder don't
+ */
+
+#ifndef MIL_COBS_H_
+#define MIL_COBS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/uartstdio.h"
+
+/****************************CONFIG*************************************/
+
+//largest payload MIL_COBSSend accepts
+#ifndef MIL_COBS_MAX_PAYLOAD
+#define MIL_COBS_MAX_PAYLOAD    250
+#endif
+
+//id + CRC around the payload
+#define MIL_COBS_FRAME_OVERHEAD 3
+
+//worst case bytes on the wire for a frame of n bytes(id + payload + CRC),
+//code bytes plus the delimiter
+#define MIL_COBS_ENCODED_MAX(n) ((n) + ((n) / 254) + 2)
+
+/****************************TYPES**************************************/
+
+/*
+ * Desc: called with each good frame
+ *
+ * Notes: runs in the UART ISR, payload is only valid
+ *        during the call
+ */
+typedef void (*tCOBSFrameFxn)(uint8_t id, const uint8_t *payload,
+                              uint32_t len);
+
+/*
+ * Desc: incremental decoder state
+ */
+typedef struct {
+    uint8_t *buf;           //decoded frame(id + payload + CRC)
+    uint32_t size;          //size of buf
+    uint32_t len;           //bytes decoded so far
+    uint16_t crc;           //CRC of the bytes decoded so far
+    uint8_t remaining;      //data bytes left in the current COBS block
+    uint8_t code;           //code byte of the current block
+    bool discard;           //bad frame, skip to the next delimiter
+    tCOBSFrameFxn on_frame;
+    uint32_t frames;        //good frames
+    uint32_t crc_errors;    //frames with a bad CRC
+    uint32_t framing_errors;//short, truncated or oversized frames
+} tCOBSDecoder;
+
+/*
+ * Desc: benchmark results, see MIL_COBSBenchmark
+ */
+typedef struct {
+    uint32_t cobs_cycles;   //CPU cycles per MIL_COBSSend
+    uint32_t cobs_bytes;    //bytes on the wire per frame
+    uint32_t printf_cycles; //CPU cycles per UARTStdioPrintf
+    uint32_t printf_bytes;  //bytes on the wire per line
+    uint32_t fmt_cycles;    //CPU cycles per line with a precompiled format
+} tCOBSBench;
+
+/****************************FUNCTIONS**********************************/
+
+/*
+ * Desc: CRC-16/CCITT-FALSE, table driven
+ *
+ * Inputs: running CRC(0xFFFF to start), data, length
+ */
+uint16_t MIL_CRC16(uint16_t crc, const uint8_t *data, uint32_t len);
+
+/*
+ * Desc: COBS encodes a buffer, no delimiter added
+ *
+ * Inputs: destination(at least MIL_COBS_ENCODED_MAX(len) - 1 bytes),
+ *         source, length
+ * Returns: encoded length
+ */
+uint32_t MIL_COBSEncode(uint8_t *dst, const uint8_t *src, uint32_t len);
+
+#ifdef UART_BUFFERED
+/*
+ * Desc: sends one frame
+ *
+ * Inputs: UART handle, message id, payload, payload length
+ * Returns: true if queued, false if the TX ring did not have room
+ *          for the whole frame(nothing is queued then)
+ *
+ * Assumes: called from the same context as the other writers of
+ *          this UART
+ */
+bool MIL_COBSSend(UARTStdioHandle psUART, uint8_t id, const void *payload,
+                  uint32_t len);
+#endif
+
+/*
+ * Desc: sets up a decoder
+ *
+ * Inputs: decoder, frame buffer(MIL_COBS_FRAME_OVERHEAD + the largest
+ *         payload expected), its size, frame callback
+ */
+void MIL_COBSDecoderInit(tCOBSDecoder *dec, uint8_t *buf, uint32_t size,
+                         tCOBSFrameFxn on_frame);
+
+/*
+ * Desc: runs one received byte through the decoder
+ *
+ * Notes: calls on_frame when a delimiter ends a good frame
+ */
+void MIL_COBSDecodeByte(tCOBSDecoder *dec, uint8_t data);
+
+#ifdef UART_BUFFERED
+/*
+ * Desc: feeds a UART's received bytes to a decoder from its ISR
+ *
+ * Notes: turns echo off, the UART's RX buffer is no longer used
+ */
+void MIL_COBSAttach(UARTStdioHandle psUART, tCOBSDecoder *dec);
+
+/*
+ * Desc: times MIL_COBSSend against UARTStdioPrintf, and against the
+ *       same line from a precompiled format(UARTSTDIO_FMT_DEFINE), for
+ *       the same telemetry record using the DWT cycle counter
+ *
+ * Inputs: UART handle, number of iterations, results
+ *
+ * Notes: only CPU time is measured, the TX ring is discarded after
+ *        each message. Wire time is bytes * 10 bits / baud
+ */
+void MIL_COBSBenchmark(UARTStdioHandle psUART, uint32_t iterations,
+                       tCOBSBench *result);
+#endif
+
+#endif /* MIL_COBS_H_ */
@@ -0,0 +1,580 @@
+/*
+ * Name: MIL_Shell.c
+ * Author: Marquez Jones
+ * Desc: Command shell over uartstdio(see MIL_Shell.h)
+ *
+ * Notes: the command table is const and comes from Shell_Commands.h,
+ *        only the hash slots are built at run time
+ */
+
+/* INCLUDES */
+//includes
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/uartstdio.h"
+#include "utils/ustdlib.h"
+
+//MIL includes
+#include "MIL_Shell.h"
+
+/*
+ * FNV-1a constants
+ */
+#define SHELL_FNV_BASIS     0x811C9DC5
+#define SHELL_FNV_PRIME     0x01000193
+
+/*******************************GLOBALS******************************/
+
+//table entry
+#define MIL_SHELL_GEN_ENTRY(name, types, usage)                        \
+    {#name, types, usage, Cmd_##name},
+
+/*
+ * Command table, in the order of Shell_Commands.h
+ */
+static const tShellCmd g_psShellCmds[MIL_SHELL_NUM_CMDS] = {
+    SHELL_COMMANDS(MIL_SHELL_GEN_ENTRY)
+};
+
+//the slots hold an index in a byte and the table stops growing at 64
+//commands, more doesn't build(negative array size)
+typedef char tShellCmdsFit[(MIL_SHELL_NUM_CMDS <= 64) ? 1 : -1];
+
+/*
+ * Hash slots, command index + 1, 0 is empty
+ */
+static uint8_t g_pui8ShellSlots[MIL_SHELL_TABLE_SIZE];
+
+//seed the slots were built with
+static uint32_t g_ui32ShellSeed;
+
+//slots are built
+static bool g_bShellReady = false;
+
+/******************************FXN PROTO******************************/
+
+/*
+ * Desc: hash of a name, without regard to case
+ */
+static uint32_t ShellHash(const char *name, uint32_t len, uint32_t seed);
+
+/*
+ * Desc: builds the slots, see MIL_ShellInit
+ */
+static bool ShellBuild(void);
+
+/*
+ * Desc: reads an unsigned 32 bit value
+ */
+static bool ShellParseU32(const char *word, const char **end,
+                          uint32_t *value);
+
+/*
+ * Desc: converts one argument
+ */
+static bool ShellConvert(char type, const char *word, tShellArg *arg);
+
+/******************************LOOKUP******************************/
+
+/*
+ * Desc: hash of a name, without regard to case
+ *
+ * Inputs: name, length, seed
+ * Returns: slot index
+ *
+ * Notes: FNV-1a on the lower case characters, folded so the low bits
+ *        that pick the slot depend on all of the hash
+ */
+static uint32_t ShellHash(const char *name, uint32_t len, uint32_t seed){
+
+    uint32_t hash = SHELL_FNV_BASIS ^ seed;
+    char c;
+
+    for(uint32_t idx = 0; idx < len; idx++){
+        c = name[idx];
+        if((c >= 'A') && (c <= 'Z')){
+            c += 'a' - 'A';
+        }
+        hash = (hash ^ (uint8_t)c) * SHELL_FNV_PRIME;
+    }
+
+    hash ^= hash >> 16;
+
+    return hash & (MIL_SHELL_TABLE_SIZE - 1);
+
+}
+
+/*
+ * Desc: builds the slots
+ *
+ * Returns: false if no seed up to MIL_SHELL_SEED_TRIES puts every
+ *          command in its own slot
+ *
+ * Notes: the table is at least 8 times the commands so a seed is
+ *        usually found within a few tries
+ */
+static bool ShellBuild(void){
+
+    uint32_t slot;
+    uint32_t idx;
+
+    for(uint32_t seed = 0; seed < MIL_SHELL_SEED_TRIES; seed++){
+
+        for(slot = 0; slot < MIL_SHELL_TABLE_SIZE; slot++){
+            g_pui8ShellSlots[slot] = 0;
+        }
+
+        for(idx = 0; idx < MIL_SHELL_NUM_CMDS; idx++){
+            slot = ShellHash(g_psShellCmds[idx].name,
+                             ustrlen(g_psShellCmds[idx].name), seed);
+            if(g_pui8ShellSlots[slot]){
+                break;
+            }
+            g_pui8ShellSlots[slot] = idx + 1;
+        }
+
+        //every command placed
+        if(idx == MIL_SHELL_NUM_CMDS){
+            g_ui32ShellSeed = seed;
+            return true;
+        }
+
+    }
+
+    return false;
+
+}
+
+/*
+ * Desc: looks up a command
+ *
+ * Inputs: name(need not be 0 terminated), its length
+ * Returns: the command, or 0 if there is none
+ *
+ * Notes: one hash, one slot, one compare
+ */
+const tShellCmd *MIL_ShellFind(const char *name, uint32_t len){
+
+    const tShellCmd *cmd;
+    uint8_t entry;
+
+    if(!g_bShellReady){
+        return 0;
+    }
+
+    entry = g_pui8ShellSlots[ShellHash(name, len, g_ui32ShellSeed)];
+    if(!entry){
+        return 0;
+    }
+
+    cmd = &g_psShellCmds[entry - 1];
+    if(ustrncasecmp(cmd->name, name, len) || cmd->name[len]){
+        return 0;
+    }
+
+    return cmd;
+
+}
+
+/******************************EXECUTE******************************/
+
+/*
+ * Desc: reads an unsigned 32 bit value, 0x for hex and a leading 0 for
+ *       octal as with ustrtoul base 0, no sign
+ *
+ * Inputs: word, where the digits stopped, result
+ * Returns: false if there are no digits or the value is past 0xFFFFFFFF
+ *
+ * Notes: ustrtoul saturates to ULONG_MAX, on the target that is
+ *        0xFFFFFFFF itself and can't be told from an overflow, so the
+ *        digits are added up in 64 bits here instead
+ */
+static bool ShellParseU32(const char *word, const char **end,
+                          uint32_t *value){
+
+    uint64_t acc = 0;
+    uint32_t base = 10;
+    uint32_t digit;
+    bool valid = false;
+    char c;
+
+    if((word[0] == '0') && ((word[1] == 'x') || (word[1] == 'X'))){
+        base = 16;
+        word += 2;
+    }
+    else if(word[0] == '0'){
+        base = 8;
+    }
+
+    for(;; word++){
+
+        c = *word;
+        if((c >= '0') && (c <= '9')){
+            digit = c - '0';
+        }
+        else if((c >= 'a') && (c <= 'f')){
+            digit = c - 'a' + 10;
+        }
+        else if((c >= 'A') && (c <= 'F')){
+            digit = c - 'A' + 10;
+        }
+        else{
+            break;
+        }
+
+        if(digit >= base){
+            break;
+        }
+
+        //once past 32 bits it stays past, the rest are only consumed
+        if(acc <= 0xFFFFFFFFULL){
+            acc = (acc * base) + digit;
+        }
+        valid = true;
+
+    }
+
+    *end = word;
+    *value = (uint32_t)acc;
+
+    return valid && (acc <= 0xFFFFFFFFULL);
+
+}
+
+/*
+ * Desc: converts one argument
+ *
+ * Inputs: type character, word, result
+ * Returns: false if the whole word isn't a value of the type
+ */
+static bool ShellConvert(char type, const char *word, tShellArg *arg){
+
+    const char *end;
+    uint32_t mag;
+    bool neg;
+
+    switch(type){
+
+        case 'u':
+            if(*word == '+'){
+                word++;
+            }
+            if(!ShellParseU32(word, &end, &mag)){
+                return false;
+            }
+            arg->u = mag;
+            break;
+
+        case 'i':
+            //sign, then the magnitude, a second sign has no digits
+            neg = (*word == '-');
+            if(neg || (*word == '+')){
+                word++;
+            }
+            if(!ShellParseU32(word, &end, &mag)){
+                return false;
+            }
+            if(mag > (neg ? 0x80000000UL : 0x7FFFFFFFUL)){
+                return false;
+            }
+            arg->u = neg ? (0 - mag) : mag;
+            break;
+
+        case 'f':
+            arg->f = ustrtof(word, &end);
+            break;
+
+        case 's':
+            arg->s = word;
+            return true;
+
+        default:
+            return false;
+
+    }
+
+    return (end != word) && (*end == 0);
+
+}
+
+/*
+ * Desc: splits a line, converts its arguments and runs the command
+ *
+ * Inputs: UART for the handler and error messages, line(modified)
+ * Returns: see tShellStatus, errors are also printed
+ *
+ * Notes: words are separated by spaces or tabs and ended in place
+ */
+tShellStatus MIL_ShellExec(UARTStdioHandle psUART, char *line){
+
+    char *words[MIL_SHELL_MAX_ARGS + 1];
+    tShellArg args[MIL_SHELL_MAX_ARGS];
+    const tShellCmd *cmd;
+    const char *types;
+    uint32_t count = 0;
+    uint32_t len = 0;
+    bool required = true;
+    char type = 0;
+
+    //split
+    while(*line){
+
+        while((*line == ' ') || (*line == '\t')){
+            *line++ = 0;
+        }
+
+        if(!*line){
+            break;
+        }
+
+        if(count > MIL_SHELL_MAX_ARGS){
+            UARTStdioPrintf(psUART, "too many arguments\n");
+            return SHELL_ARG_COUNT;
+        }
+
+        words[count++] = line;
+        while(*line && (*line != ' ') && (*line != '\t')){
+            line++;
+        }
+
+        //length of the command name for the lookup
+        if(count == 1){
+            len = line - words[0];
+        }
+
+    }
+
+    if(count == 0){
+        return SHELL_EMPTY;
+    }
+
+    cmd = MIL_ShellFind(words[0], len);
+    if(!cmd){
+        UARTStdioPrintf(psUART, "unknown command: %s\n", words[0]);
+        return SHELL_UNKNOWN;
+    }
+
+    //convert, walking the types alongside the arguments
+    types = cmd->args;
+    for(uint32_t idx = 1; idx < count; idx++){
+
+        if(*types == '|'){
+            required = false;
+            types++;
+        }
+
+        if(*types && (*types != '*')){
+            type = *types++;
+        }
+        else if(*types != '*'){
+            UARTStdioPrintf(psUART, "usage: %s\n", cmd->usage);
+            return SHELL_ARG_COUNT;
+        }
+
+        if(!ShellConvert(type, words[idx], &args[idx - 1])){
+            UARTStdioPrintf(psUART, "bad argument %u: %s\nusage: %s\n", idx,
+                            words[idx], cmd->usage);
+            return SHELL_BAD_ARG;
+        }
+
+    }
+
+    //any type left before the '|' is a missing argument
+    if(required && *types && (*types != '|') && (*types != '*')){
+        UARTStdioPrintf(psUART, "usage: %s\n", cmd->usage);
+        return SHELL_ARG_COUNT;
+    }
+
+    cmd->handler(psUART, count - 1, args);
+
+    return SHELL_OK;
+
+}
+
+/*
+ * Desc: prints the usage line of every command
+ */
+void MIL_ShellHelp(UARTStdioHandle psUART){
+
+    for(uint32_t idx = 0; idx < MIL_SHELL_NUM_CMDS; idx++){
+        UARTStdioPrintf(psUART, "  %s\n", g_psShellCmds[idx].usage);
+    }
+
+}
+
+/******************************SETUP******************************/
+
+/*
+ * Desc: sets up a shell on a UART and prints the prompt
+ *
+ * Inputs: shell, UART handle, prompt
+ * Returns: false if no hash seed was found
+ */
+bool MIL_ShellInit(tShell *shell, UARTStdioHandle psUART,
+                   const char *prompt){
+
+    if(!g_bShellReady){
+        g_bShellReady = ShellBuild();
+        if(!g_bShellReady){
+            return false;
+        }
+    }
+
+    shell->uart = psUART;
+    shell->prompt = prompt;
+    shell->len = 0;
+    shell->last_cr = false;
+    shell->last_tab = false;
+
+#ifdef UART_BUFFERED
+    //the shell echoes, the UART holding lines back would hide tab
+    UARTStdioEchoSet(psUART, false);
+#endif
+
+    UARTStdioPrintf(psUART, "%s", prompt);
+
+    return true;
+
+}
+
+/******************************EDITING******************************/
+
+#ifdef UART_BUFFERED
+/*
+ * Desc: completes the command name being typed
+ *
+ * Notes: only the first word is completed. The matches are listed
+ *        by a second tab once they can't be taken any further
+ */
+static void ShellComplete(tShell *shell){
+
+    const tShellCmd *match = 0;
+    uint32_t matches = 0;
+    uint32_t common = 0;
+    uint32_t idx;
+    const char *name;
+
+    for(idx = 0; idx < shell->len; idx++){
+        if(shell->line[idx] == ' '){
+            return;
+        }
+    }
+
+    //count the matches and how far they agree
+    for(idx = 0; idx < MIL_SHELL_NUM_CMDS; idx++){
+
+        name = g_psShellCmds[idx].name;
+        if(ustrncasecmp(name, shell->line, shell->len)){
+            continue;
+        }
+
+        if(!matches){
+            match = &g_psShellCmds[idx];
+            common = ustrlen(name);
+        }
+        else{
+            uint32_t same = shell->len;
+            while((same < common) && name[same] &&
+                  (name[same] == match->name[same])){
+                same++;
+            }
+            common = same;
+        }
+        matches++;
+
+    }
+
+    if(!matches){
+        return;
+    }
+
+    //fill in as far as the matches agree, plus a space for one match
+    if(common > shell->len){
+        name = match->name;
+        while((shell->len < common) &&
+              (shell->len < (MIL_SHELL_LINE_SIZE - 2))){
+            shell->line[shell->len] = name[shell->len];
+            UARTStdioWrite(shell->uart, &name[shell->len], 1);
+            shell->len++;
+        }
+        if(matches == 1){
+            shell->line[shell->len++] = ' ';
+            UARTStdioWrite(shell->uart, " ", 1);
+        }
+        //the next tab lists what is left
+        shell->last_tab = (matches > 1);
+        return;
+    }
+
+    //list them and redraw the line
+    if(shell->last_tab){
+        UARTStdioWrite(shell->uart, "\n", 1);
+        for(idx = 0; idx < MIL_SHELL_NUM_CMDS; idx++){
+            name = g_psShellCmds[idx].name;
+            if(!ustrncasecmp(name, shell->line, shell->len)){
+                UARTStdioPrintf(shell->uart, "%s  ", name);
+            }
+        }
+        UARTStdioPrintf(shell->uart, "\n%s", shell->prompt);
+        UARTStdioWrite(shell->uart, shell->line, shell->len);
+    }
+    shell->last_tab = !shell->last_tab;
+
+}
+
+/*
+ * Desc: edits the line with the characters received so far and runs
+ *       it once enter is pressed
+ *
+ * Returns: true if a line was run
+ */
+bool MIL_ShellPoll(tShell *shell){
+
+    unsigned char c;
+
+    while(UARTStdioRxBytesAvail(shell->uart)){
+
+        c = UARTStdioGetc(shell->uart);
+
+        if(c != '\t'){
+            shell->last_tab = false;
+        }
+
+        //LF of a CRLF
+        if((c == '\n') && shell->last_cr){
+            shell->last_cr = false;
+            continue;
+        }
+        shell->last_cr = (c == '\r');
+
+        if((c == '\r') || (c == '\n')){
+            UARTStdioWrite(shell->uart, "\n", 1);
+            shell->line[shell->len] = 0;
+            MIL_ShellExec(shell->uart, shell->line);
+            shell->len = 0;
+            UARTStdioPrintf(shell->uart, "%s", shell->prompt);
+            return true;
+        }
+
+        if((c == '\b') || (c == 0x7F)){
+            if(shell->len){
+                shell->len--;
+                UARTStdioWrite(shell->uart, "\b \b", 3);
+            }
+        }
+        else if(c == '\t'){
+            ShellComplete(shell);
+        }
+        //printable, the rest of the line is dropped once it's full
+        else if((c >= ' ') && (c < 0x7F) &&
+                (shell->len < (MIL_SHELL_LINE_SIZE - 1))){
+            shell->line[shell->len++] = c;
+            UARTStdioWrite(shell->uart, (const char *)&c, 1);
+        }
+
+    }
+
+    return false;
+
+}
+#endif
@@ -0,0 +1,191 @@
+/*
+ * Name: MIL_Shell.h
+ * Author: Marquez Jones
+ * Desc: Command shell over uartstdio
+ *
+ *       Commands are listed once in Shell_Commands.h and this header
+ *       expands the list into the handler prototypes and the command
+ *       count. MIL_Shell.c builds the command table from the same list
+ *
+ * Lines:
+ *       A line is split into words in place, each word is ended with
+ *       a 0 and the arguments point into the line, nothing is copied.
+ *       The arguments are checked and converted against the types
+ *       given for the command before its handler is called
+ *
+ * Dispatch:
+ *       Names are looked up in a perfect hash table, one hash of the
+ *       typed word, one slot and one compare whatever the number of
+ *       commands. The preprocessor can't hash the names, so the table
+ *       is sized at compile time and MIL_ShellInit searches for a hash
+ *       seed that gives every command its own slot
+ *
+ * Editing:
+ *       MIL_ShellPoll does the line editing itself so that tab can
+ *       complete a command name: one match is filled in, several are
+ *       filled in as far as they agree and listed on a second tab.
+ *       Backspace(or DEL) rubs out. The UART's own echo is turned off
+ *
+ *       A line read some other way, e.g. with UARTgets, can be run
+ *       with MIL_ShellExec
+ *
+ * Notes: MIL_ShellPoll requires UART_BUFFERED
+ */
+
+#ifndef MIL_SHELL_H_
+#define MIL_SHELL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/uartstdio.h"
+#include "Shell_Commands.h"
+
+/****************************CONFIG*************************************/
+
+//longest line, including the 0
+#ifndef MIL_SHELL_LINE_SIZE
+#define MIL_SHELL_LINE_SIZE     80
+#endif
+
+//most arguments after the command name
+#ifndef MIL_SHELL_MAX_ARGS
+#define MIL_SHELL_MAX_ARGS      8
+#endif
+
+//hash seeds MIL_ShellInit tries before giving up
+#ifndef MIL_SHELL_SEED_TRIES
+#define MIL_SHELL_SEED_TRIES    65536
+#endif
+
+/****************************TYPES**************************************/
+
+/*
+ * Desc: one converted argument, the member used follows the type
+ *       given for it in Shell_Commands.h
+ */
+typedef union {
+    uint32_t u;
+    int32_t i;
+    float f;
+    const char *s;
+} tShellArg;
+
+/*
+ * Desc: command handler
+ *
+ * Inputs: UART the command came from, number of arguments given,
+ *         the arguments
+ *
+ * Notes: string arguments point into the line and are only valid
+ *        during the call
+ */
+typedef void (*tShellCmdFxn)(UARTStdioHandle psUART, uint32_t argc,
+                             const tShellArg *args);
+
+/*
+ * Desc: one entry of the command table
+ */
+typedef struct {
+    const char *name;
+    const char *args;       //argument types, see Shell_Commands.h
+    const char *usage;
+    tShellCmdFxn handler;
+} tShellCmd;
+
+/*
+ * Desc: result of MIL_ShellExec
+ */
+typedef enum {
+    SHELL_OK,               //the handler ran
+    SHELL_EMPTY,            //blank line
+    SHELL_UNKNOWN,          //no such command
+    SHELL_BAD_ARG,          //an argument didn't convert
+    SHELL_ARG_COUNT         //too few or too many arguments
+} tShellStatus;
+
+/*
+ * Desc: shell state, one per UART
+ */
+typedef struct {
+    UARTStdioHandle uart;
+    const char *prompt;
+    char line[MIL_SHELL_LINE_SIZE];
+    uint32_t len;           //characters in line
+    bool last_cr;           //swallow the LF of a CRLF
+    bool last_tab;          //a second tab lists the matches
+} tShell;
+
+/****************************GENERATORS*********************************/
+
+//handler prototype
+#define MIL_SHELL_GEN_PROTO(name, types, usage)                        \
+    void Cmd_##name(UARTStdioHandle psUART, uint32_t argc,             \
+                    const tShellArg *args);
+
+//command index
+#define MIL_SHELL_GEN_INDEX(name, types, usage)                        \
+    SHELL_CMD_##name,
+
+SHELL_COMMANDS(MIL_SHELL_GEN_PROTO)
+
+enum {
+    SHELL_COMMANDS(MIL_SHELL_GEN_INDEX)
+    MIL_SHELL_NUM_CMDS
+};
+
+//hash table slots, a power of two at least eight times the commands
+//so that a seed is found in a few dozen tries at most
+#define MIL_SHELL_TABLE_SIZE                                           \
+    ((MIL_SHELL_NUM_CMDS <= 4)  ? 32  :                                \
+     (MIL_SHELL_NUM_CMDS <= 8)  ? 64  :                                \
+     (MIL_SHELL_NUM_CMDS <= 16) ? 128 :                                \
+     (MIL_SHELL_NUM_CMDS <= 32) ? 256 : 512)
+
+/****************************FUNCTIONS**********************************/
+
+/*
+ * Desc: sets up a shell on a UART and prints the prompt
+ *
+ * Inputs: shell, UART handle, prompt
+ * Returns: false if no hash seed was found(two names that differ
+ *          only in case)
+ *
+ * Notes: the hash table is shared, it is built by the first call
+ */
+bool MIL_ShellInit(tShell *shell, UARTStdioHandle psUART,
+                   const char *prompt);
+
+/*
+ * Desc: looks up a command
+ *
+ * Inputs: name(need not be 0 terminated), its length
+ * Returns: the command, or 0 if there is none
+ */
+const tShellCmd *MIL_ShellFind(const char *name, uint32_t len);
+
+/*
+ * Desc: splits a line, converts its arguments and runs the command
+ *
+ * Inputs: UART for the handler and error messages, line(modified)
+ * Returns: see tShellStatus, errors are also printed
+ */
+tShellStatus MIL_ShellExec(UARTStdioHandle psUART, char *line);
+
+/*
+ * Desc: prints the usage line of every command
+ */
+void MIL_ShellHelp(UARTStdioHandle psUART);
+
+#ifdef UART_BUFFERED
+/*
+ * Desc: edits the line with the characters received so far and runs
+ *       it once enter is pressed
+ *
+ * Returns: true if a line was run
+ *
+ * Notes: doesn't block, call it from the main loop
+ */
+bool MIL_ShellPoll(tShell *shell);
+#endif
+
+#endif /* MIL_SHELL_H_ */
@@ -0,0 +1,516 @@
+/*
+ * Name: MIL_UARTBench.c
+ * Author: Marquez Jones
+ * Desc: Throughput and latency benchmark for the buffered uartstdio
+ *       path(see MIL_UARTBench.h)
+ *
+ * Notes: bytes are queued with UARTStdioTxReserve/UARTStdioTxCommit so
+ *        they go out raw(UARTStdioWrite would turn \n into \r\n) and
+ *        come back through the normal RX ring with echo off
+ *
+ *        everything here needs the buffered uartstdio, the file builds
+ *        empty without UART_BUFFERED
+ */
+
+/* INCLUDES */
+//includes
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "inc/hw_uart.h"
+#include "driverlib/uart.h"
+#include "utils/uartstdio.h"
+
+//MIL includes
+#include "MIL_UARTBench.h"
+
+#ifdef UART_BUFFERED
+
+/*
+ * DWT cycle counter registers(Cortex-M4 core)
+ */
+#define DWT_CTRL        0xE0001000
+#define DWT_CYCCNT      0xE0001004
+#define DEMCR           0xE000EDFC
+#define DEMCR_TRCENA    0x01000000
+#define DWT_CYCCNTENA   0x00000001
+
+//byte n of a burst
+#define PATTERN(n)      ((uint8_t)((n) ^ ((n) >> 8)))
+
+//bisection steps when looking for the overrun point
+#define OVERRUN_STEPS   10
+
+//a burst this many byte times quiet is over
+#define IDLE_BYTES      64
+
+/*******************************GLOBALS******************************/
+
+/*
+ * Sweep tables for MIL_UARTBenchSweep
+ */
+static const uint32_t g_pui32BenchBaud[] = {
+    115200, 230400, 460800, 921600, 1843200, 3000000
+};
+
+static const uint32_t g_pui32BenchSize[] = {
+    16, 64, 256, 1024
+};
+
+#define BENCH_BAUD_COUNT    (sizeof(g_pui32BenchBaud) / sizeof(g_pui32BenchBaud[0]))
+#define BENCH_SIZE_COUNT    (sizeof(g_pui32BenchSize) / sizeof(g_pui32BenchSize[0]))
+
+//port under test and its rings
+static tUARTStdio g_sBenchUART;
+static unsigned char g_pui8BenchTx[MIL_UARTBENCH_MAX_BUF];
+static unsigned char g_pui8BenchRx[MIL_UARTBENCH_MAX_BUF];
+
+//ISR time, kept by BenchIntHandler
+static volatile uint32_t g_ui32IsrCycles;
+static volatile uint32_t g_ui32IsrCalls;
+static volatile uint32_t g_ui32IsrMax;
+
+/******************************FXN PROTO******************************/
+
+/*
+ * Desc: vector for the port under test, times UARTStdioIntProcess
+ */
+static void BenchIntHandler(void);
+
+/*
+ * Desc: busy waits
+ */
+static void Spin(uint32_t cycles);
+
+/*
+ * Desc: sends a burst through the loopback and reads it back
+ */
+static uint32_t LoopBurst(UARTStdioHandle psUART, uint32_t bytes,
+                          uint32_t work, uint32_t idle, uint32_t *errors);
+
+/*
+ * Desc: one byte round trip
+ */
+static bool LoopOne(UARTStdioHandle psUART, uint8_t data, uint32_t timeout,
+                    uint32_t *cycles);
+
+/*
+ * Desc: throws away whatever is still queued or on the wire
+ */
+static void Drain(UARTStdioHandle psUART, uint32_t idle);
+
+/******************************HELPERS******************************/
+
+/*
+ * Desc: vector for the port under test, times UARTStdioIntProcess
+ *
+ * Notes: exception entry and exit(12 cycles each, more with FPU
+ *        stacking) are outside the measurement
+ */
+static void BenchIntHandler(void){
+
+    uint32_t start_cnt;
+    uint32_t cycles;
+
+    if(g_sBenchUART.ui32Base == 0){
+        return;
+    }
+
+    start_cnt = HWREG(DWT_CYCCNT);
+    UARTStdioIntProcess(&g_sBenchUART);
+    cycles = HWREG(DWT_CYCCNT) - start_cnt;
+
+    g_ui32IsrCycles += cycles;
+    g_ui32IsrCalls++;
+
+    if(cycles > g_ui32IsrMax){
+        g_ui32IsrMax = cycles;
+    }
+
+}
+
+/*
+ * Desc: busy waits
+ *
+ * Inputs: clocks to wait
+ */
+static void Spin(uint32_t cycles){
+
+    uint32_t start_cnt = HWREG(DWT_CYCCNT);
+
+    while((HWREG(DWT_CYCCNT) - start_cnt) < cycles);
+
+}
+
+/*
+ * Desc: sends a burst through the loopback and reads it back
+ *
+ * Inputs: UART handle, burst length, clocks of app work after each
+ *         byte read, clocks without a byte that end the burst, errors
+ * Returns: clocks from the first byte queued to the last byte read
+ *
+ * Notes: the TX ring is topped up between reads so the wire never
+ *        waits on the app. errors counts the bytes that didn't come
+ *        back in order, after a gap the sequence picks up again at
+ *        the byte that did arrive
+ */
+static uint32_t LoopBurst(UARTStdioHandle psUART, uint32_t bytes,
+                          uint32_t work, uint32_t idle, uint32_t *errors){
+
+    tUARTStdioTxSpan sSpan;
+    uint32_t sent = 0;
+    uint32_t pos = 0;
+    uint32_t good = 0;
+    uint32_t count;
+    uint32_t start_cnt;
+    uint32_t last_cnt;
+    uint8_t data;
+
+    start_cnt = HWREG(DWT_CYCCNT);
+    last_cnt = start_cnt;
+
+    while(pos < bytes){
+
+        //top up the TX ring
+        if(sent < bytes){
+
+            count = UARTStdioTxReserve(psUART, &sSpan);
+
+            if(count > (bytes - sent)){
+                count = bytes - sent;
+            }
+
+            for(uint32_t idx = 0; idx < count; idx++){
+                sSpan.pcBuf[(sSpan.ui32Start + idx) & sSpan.ui32Mask] =
+                    PATTERN(sent + idx);
+            }
+
+            if(count){
+                UARTStdioTxCommit(psUART, count);
+                sent += count;
+            }
+
+        }
+
+        if(UARTStdioRxBytesAvail(psUART)){
+
+            data = UARTStdioGetc(psUART);
+            last_cnt = HWREG(DWT_CYCCNT);
+
+            if(data == PATTERN(pos)){
+                good++;
+            }
+            else{
+                //skip the lost bytes, or the rest if it's garbage
+                while((pos < bytes) && (data != PATTERN(pos))){
+                    pos++;
+                }
+                if(pos < bytes){
+                    good++;
+                }
+            }
+            pos++;
+
+            if(work){
+                Spin(work);
+            }
+
+        }
+        else if((HWREG(DWT_CYCCNT) - last_cnt) > idle){
+            //the rest was lost
+            break;
+        }
+
+    }
+
+    *errors += bytes - good;
+
+    //hardware FIFO overrun or framing trouble on the loopback
+    if(UARTRxErrorGet(psUART->ui32Base)){
+        UARTRxErrorClear(psUART->ui32Base);
+        (*errors)++;
+    }
+
+    return last_cnt - start_cnt;
+
+}
+
+/*
+ * Desc: one byte round trip
+ *
+ * Inputs: UART handle, byte, clocks to wait for it, round trip time
+ * Returns: false if the byte didn't come back intact
+ */
+static bool LoopOne(UARTStdioHandle psUART, uint8_t data, uint32_t timeout,
+                    uint32_t *cycles){
+
+    tUARTStdioTxSpan sSpan;
+    uint32_t start_cnt;
+
+    if(UARTStdioTxReserve(psUART, &sSpan) == 0){
+        return false;
+    }
+
+    sSpan.pcBuf[sSpan.ui32Start & sSpan.ui32Mask] = data;
+
+    start_cnt = HWREG(DWT_CYCCNT);
+    UARTStdioTxCommit(psUART, 1);
+
+    while(!UARTStdioRxBytesAvail(psUART)){
+        if((HWREG(DWT_CYCCNT) - start_cnt) > timeout){
+            return false;
+        }
+    }
+
+    *cycles = HWREG(DWT_CYCCNT) - start_cnt;
+
+    return UARTStdioGetc(psUART) == data;
+
+}
+
+/*
+ * Desc: throws away whatever is still queued or on the wire
+ *
+ * Inputs: UART handle, clocks for the line to go quiet
+ */
+static void Drain(UARTStdioHandle psUART, uint32_t idle){
+
+    UARTStdioFlushTx(psUART, true);
+    Spin(idle);
+    UARTStdioFlushRx(psUART);
+    UARTRxErrorClear(psUART->ui32Base);
+
+}
+
+/******************************BENCHMARK******************************/
+
+/*
+ * Desc: runs the benchmark once on a port in internal loopback
+ *
+ * Inputs: UART port(0-2), CPU clock, baud rate, TX and RX ring sizes
+ *         (powers of two up to MIL_UARTBENCH_MAX_BUF), results
+ * Returns: false if the port couldn't be opened or the sizes are bad,
+ *          the results are not filled in then
+ *
+ * Notes: the overrun search runs bursts of 4 RX rings with more or
+ *        less app work per byte, it is capped at 2 byte times
+ */
+bool MIL_UARTBenchRun(uint32_t port, uint32_t clock, uint32_t baud,
+                      uint32_t tx_size, uint32_t rx_size,
+                      tUARTBenchResult *result){
+
+    UARTStdioHandle psUART;
+    uint32_t errors = 0;
+    uint32_t lost;
+    uint32_t cycles;
+    uint32_t idle;
+    uint32_t total = 0;
+    uint32_t samples = 0;
+    uint32_t lo;
+    uint32_t hi;
+    uint32_t mid;
+
+    if((tx_size == 0) || (tx_size > MIL_UARTBENCH_MAX_BUF) ||
+       (tx_size & (tx_size - 1)) ||
+       (rx_size == 0) || (rx_size > MIL_UARTBENCH_MAX_BUF) ||
+       (rx_size & (rx_size - 1))){
+        return false;
+    }
+
+    //the UART tops out at clock/8 in high speed mode
+    if((baud == 0) || (baud > (clock / 8))){
+        return false;
+    }
+
+    //enable the cycle counter
+    HWREG(DEMCR) |= DEMCR_TRCENA;
+    HWREG(DWT_CTRL) |= DWT_CYCCNTENA;
+
+    psUART = UARTStdioInit(&g_sBenchUART, port, baud, clock,
+                           g_pui8BenchTx, tx_size, g_pui8BenchRx, rx_size);
+
+    if(!psUART){
+        return false;
+    }
+
+    //raw bytes, TX wired to RX inside the UART
+    UARTStdioEchoSet(psUART, false);
+    UARTIntRegister(psUART->ui32Base, BenchIntHandler);
+    UARTLoopbackEnable(psUART->ui32Base);
+    UARTRxErrorClear(psUART->ui32Base);
+
+    result->clock = clock;
+    result->baud = baud;
+    result->tx_size = tx_size;
+    result->rx_size = rx_size;
+    result->byte_cycles = (uint32_t)(((uint64_t)clock * 10) / baud);
+    result->bytes = MIL_UARTBENCH_BYTES;
+
+    idle = result->byte_cycles * IDLE_BYTES;
+
+    //throughput and ISR cost
+    g_ui32IsrCycles = 0;
+    g_ui32IsrCalls = 0;
+    g_ui32IsrMax = 0;
+
+    cycles = LoopBurst(psUART, MIL_UARTBENCH_BYTES, 0, idle, &errors);
+
+    result->isr_cycles_per_byte = g_ui32IsrCycles / MIL_UARTBENCH_BYTES;
+    result->isr_calls = g_ui32IsrCalls;
+    result->isr_max_cycles = g_ui32IsrMax;
+
+    if(cycles){
+        result->bytes_per_sec = (uint32_t)(((uint64_t)MIL_UARTBENCH_BYTES *
+                                            clock) / cycles);
+    }
+    else{
+        result->bytes_per_sec = 0;
+    }
+
+    result->wire_permille = (uint32_t)(((uint64_t)result->bytes_per_sec *
+                                        10000) / baud);
+
+    Drain(psUART, idle);
+
+    //latency, one byte at a time on a quiet line
+    result->latency_min = 0xFFFFFFFF;
+    result->latency_max = 0;
+
+    for(uint32_t idx = 0; idx < MIL_UARTBENCH_LATENCY_SAMPLES; idx++){
+
+        if(!LoopOne(psUART, PATTERN(idx), idle, &cycles)){
+            errors++;
+            Drain(psUART, idle);
+            continue;
+        }
+
+        total += cycles;
+        samples++;
+
+        if(cycles < result->latency_min){
+            result->latency_min = cycles;
+        }
+        if(cycles > result->latency_max){
+            result->latency_max = cycles;
+        }
+
+    }
+
+    if(samples){
+        result->latency_avg = total / samples;
+    }
+    else{
+        result->latency_min = 0;
+        result->latency_avg = 0;
+    }
+
+    //overrun point, bisect the app work per byte read
+    lo = 0;
+    hi = result->byte_cycles * 2;
+
+    for(uint32_t step = 0; step < OVERRUN_STEPS; step++){
+
+        mid = lo + ((hi - lo) / 2);
+        lost = 0;
+
+        LoopBurst(psUART, rx_size * 4, mid, idle + mid, &lost);
+        Drain(psUART, idle);
+
+        if(lost){
+            hi = mid;
+        }
+        else{
+            lo = mid;
+        }
+
+    }
+
+    result->overrun_work = lo;
+    result->errors = errors;
+
+    //driverlib has no loopback disable
+    HWREG(psUART->ui32Base + UART_O_CTL) &= ~UART_CTL_LBE;
+    UARTStdioClose(psUART);
+
+    return true;
+
+}
+
+/*
+ * Desc: prints one run as a line of JSON
+ *
+ * Inputs: console to print on, results
+ */
+void MIL_UARTBenchReport(UARTStdioHandle out,
+                         const tUARTBenchResult *result){
+
+    UARTStdioPrintf(out, "{\"clock\":%u,\"baud\":%u,\"tx_buf\":%u,"
+                    "\"rx_buf\":%u,\"byte_cycles\":%u,",
+                    result->clock, result->baud, result->tx_size,
+                    result->rx_size, result->byte_cycles);
+
+    UARTStdioPrintf(out, "\"bytes\":%u,\"bytes_per_sec\":%u,"
+                    "\"wire_permille\":%u,\"isr_cycles_per_byte\":%u,"
+                    "\"isr_calls\":%u,\"isr_max_cycles\":%u,",
+                    result->bytes, result->bytes_per_sec,
+                    result->wire_permille, result->isr_cycles_per_byte,
+                    result->isr_calls, result->isr_max_cycles);
+
+    UARTStdioPrintf(out, "\"latency_min\":%u,\"latency_avg\":%u,"
+                    "\"latency_max\":%u,\"overrun_work\":%u,"
+                    "\"errors\":%u}\n",
+                    result->latency_min, result->latency_avg,
+                    result->latency_max, result->overrun_work,
+                    result->errors);
+
+}
+
+/*
+ * Desc: runs and reports every baud rate and buffer size in the
+ *       sweep tables
+ *
+ * Inputs: console to print on, UART port to test, CPU clock
+ *
+ * Notes: TX and RX rings are the same size in each run. A run that
+ *        can't start prints {"baud":..,"error":1}
+ */
+void MIL_UARTBenchSweep(UARTStdioHandle out, uint32_t port,
+                        uint32_t clock){
+
+    tUARTBenchResult sResult;
+
+    for(uint32_t size = 0; size < BENCH_SIZE_COUNT; size++){
+
+        if(g_pui32BenchSize[size] > MIL_UARTBENCH_MAX_BUF){
+            continue;
+        }
+
+        for(uint32_t rate = 0; rate < BENCH_BAUD_COUNT; rate++){
+
+            if(g_pui32BenchBaud[rate] > (clock / 8)){
+                continue;
+            }
+
+            if(MIL_UARTBenchRun(port, clock, g_pui32BenchBaud[rate],
+                                g_pui32BenchSize[size],
+                                g_pui32BenchSize[size], &sResult)){
+                MIL_UARTBenchReport(out, &sResult);
+            }
+            else{
+                UARTStdioPrintf(out, "{\"baud\":%u,\"tx_buf\":%u,"
+                                "\"rx_buf\":%u,\"error\":1}\n",
+                                g_pui32BenchBaud[rate],
+                                g_pui32BenchSize[size],
+                                g_pui32BenchSize[size]);
+            }
+
+            //let the report get out before the next run
+            UARTStdioFlushTx(out, false);
+
+        }
+
+    }
+
+}
+
+#endif
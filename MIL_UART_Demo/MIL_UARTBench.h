@@ -0,0 +1,127 @@
+/*
+ * Name: MIL_UARTBench.h
+ * Author: Marquez Jones
+ * Desc: Throughput and latency benchmark for the buffered uartstdio
+ *       path, run over the UART's internal loopback
+ *
+ * Measurements(one run = one baud rate and buffer size):
+ *       throughput - a burst is written through the TX ring and read
+ *                    back from the RX ring as fast as the app can,
+ *                    bytes/sec and the share of the wire rate(baud/10)
+ *       ISR cost   - DWT cycles spent in UARTStdioIntProcess per byte
+ *                    looped(the byte goes through the ISR on the TX
+ *                    and the RX side), calls and worst single call
+ *       latency    - cycles from committing one byte to the app seeing
+ *                    it in the RX ring, min/avg/max. Includes the 10
+ *                    bit times on the wire and, since one byte is below
+ *                    the RX FIFO trigger, the 32 bit receive timeout
+ *       overrun    - the most app work per byte read(busy cycles) that
+ *                    still loses nothing over a burst of 4 RX buffers,
+ *                    found by bisection. Past this point the RX ring
+ *                    fills and uartstdio starts dropping
+ *
+ * Report:
+ *       MIL_UARTBenchReport prints one JSON object per line so the
+ *       console log can be fed straight to a script, e.g.
+ *       {"baud":115200,"tx_buf":256,"rx_buf":256,...}
+ *       cycle counts are in CPU clocks, "clock" gives the rate
+ *
+ * Notes: requires UART_BUFFERED, without it only the result type is
+ *        declared and MIL_UARTBench.c builds empty. The port under
+ *        test is opened and closed by the benchmark and its interrupt
+ *        vector is taken over with UARTIntRegister, so use a UART the
+ *        application doesn't(never the console). No pins are needed, the port runs in
+ *        internal loopback
+ *
+ *        CYCCNT wraps after 2^32 clocks(86s at 50MHz), keep
+ *        MIL_UARTBENCH_BYTES small enough for the slowest baud rate
+ */
+
+#ifndef MIL_UARTBENCH_H_
+#define MIL_UARTBENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/uartstdio.h"
+
+/****************************CONFIG*************************************/
+
+//largest TX/RX ring the benchmark can run with, power of two
+#ifndef MIL_UARTBENCH_MAX_BUF
+#define MIL_UARTBENCH_MAX_BUF       1024
+#endif
+
+//bytes looped for the throughput run
+#ifndef MIL_UARTBENCH_BYTES
+#define MIL_UARTBENCH_BYTES         4096
+#endif
+
+//single byte round trips for the latency run
+#ifndef MIL_UARTBENCH_LATENCY_SAMPLES
+#define MIL_UARTBENCH_LATENCY_SAMPLES   32
+#endif
+
+/****************************TYPES**************************************/
+
+/*
+ * Desc: results of one run, see MIL_UARTBenchRun
+ */
+typedef struct {
+    uint32_t clock;             //CPU clock, Hz
+    uint32_t baud;
+    uint32_t tx_size;           //TX ring, bytes
+    uint32_t rx_size;           //RX ring, bytes
+    uint32_t byte_cycles;       //one byte on the wire(10 bits), clocks
+    uint32_t bytes;             //bytes in the throughput run
+    uint32_t bytes_per_sec;
+    uint32_t wire_permille;     //bytes_per_sec against baud/10, 1000 = full
+    uint32_t isr_cycles_per_byte;
+    uint32_t isr_calls;
+    uint32_t isr_max_cycles;    //longest single ISR
+    uint32_t latency_min;       //clocks, commit to byte in the RX ring
+    uint32_t latency_avg;
+    uint32_t latency_max;
+    uint32_t overrun_work;      //most app clocks per byte read without loss
+    uint32_t errors;            //lost or out of order bytes, 0 on a good run
+} tUARTBenchResult;
+
+/****************************FUNCTIONS**********************************/
+
+#ifdef UART_BUFFERED
+/*
+ * Desc: runs the benchmark once on a port in internal loopback
+ *
+ * Inputs: UART port(0-2), CPU clock, baud rate, TX and RX ring sizes
+ *         (powers of two up to MIL_UARTBENCH_MAX_BUF), results
+ * Returns: false if the port couldn't be opened or the sizes are bad,
+ *          the results are not filled in then
+ *
+ * Notes: blocks for the whole run, about
+ *        (MIL_UARTBENCH_BYTES + 40 * rx_size) byte times
+ */
+bool MIL_UARTBenchRun(uint32_t port, uint32_t clock, uint32_t baud,
+                      uint32_t tx_size, uint32_t rx_size,
+                      tUARTBenchResult *result);
+
+/*
+ * Desc: prints one run as a line of JSON
+ *
+ * Inputs: console to print on, results
+ */
+void MIL_UARTBenchReport(UARTStdioHandle out,
+                         const tUARTBenchResult *result);
+
+/*
+ * Desc: runs and reports every baud rate and buffer size in the
+ *       sweep tables(see MIL_UARTBench.c)
+ *
+ * Inputs: console to print on, UART port to test, CPU clock
+ *
+ * Notes: rates the UART can't reach at this clock(above clock/8)
+ *        are skipped
+ */
+void MIL_UARTBenchSweep(UARTStdioHandle out, uint32_t port,
+                        uint32_t clock);
+#endif
+
+#endif /* MIL_UARTBENCH_H_ */
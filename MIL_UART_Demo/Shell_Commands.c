@@ -0,0 +1,101 @@
+/*
+ * Name: Shell_Commands.c
+ * Author: Marquez Jones
+ * Desc: Handlers for the commands in Shell_Commands.h
+ *
+ * Usage: with uartstdio set up(UART_BUFFERED)
+ *
+ *       tShell shell;
+ *       MIL_ShellInit(&shell, psUART, "> ");
+ *       while(1){
+ *           MIL_ShellPoll(&shell);
+ *       }
+ */
+
+/* INCLUDES */
+//includes
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/uartstdio.h"
+
+//MIL includes
+#include "MIL_Shell.h"
+
+/******************************HANDLERS******************************/
+
+/*
+ * Desc: lists the commands
+ */
+void Cmd_help(UARTStdioHandle psUART, uint32_t argc, const tShellArg *args){
+
+    (void)argc;
+    (void)args;
+
+    MIL_ShellHelp(psUART);
+
+}
+
+/*
+ * Desc: prints the words back
+ */
+void Cmd_echo(UARTStdioHandle psUART, uint32_t argc, const tShellArg *args){
+
+    for(uint32_t idx = 0; idx < argc; idx++){
+        UARTStdioPrintf(psUART, idx ? " %s" : "%s", args[idx].s);
+    }
+
+    UARTStdioPrintf(psUART, "\n");
+
+}
+
+/*
+ * Desc: sums integers
+ *
+ * Notes: the sum is 64 bit, 32 bit arguments can't overflow it for any
+ *        line length. uvsnprintf has no %lld so the magnitude is
+ *        printed as two 9 digit halves
+ */
+void Cmd_add(UARTStdioHandle psUART, uint32_t argc, const tShellArg *args){
+
+    int64_t sum = 0;
+    uint64_t mag;
+
+    for(uint32_t idx = 0; idx < argc; idx++){
+        sum += args[idx].i;
+    }
+
+    mag = (sum < 0) ? (0 - (uint64_t)sum) : (uint64_t)sum;
+
+    if(mag >= 1000000000){
+        UARTStdioPrintf(psUART, "%s%u%09u\n", (sum < 0) ? "-" : "",
+                        (uint32_t)(mag / 1000000000),
+                        (uint32_t)(mag % 1000000000));
+    }
+    else{
+        UARTStdioPrintf(psUART, "%s%u\n", (sum < 0) ? "-" : "",
+                        (uint32_t)mag);
+    }
+
+}
+
+/*
+ * Desc: multiplies two floats
+ */
+void Cmd_scale(UARTStdioHandle psUART, uint32_t argc, const tShellArg *args){
+
+    (void)argc;
+
+    UARTStdioPrintf(psUART, "%g\n", (double)(args[0].f * args[1].f));
+
+}
+
+/*
+ * Desc: prints a number in hex
+ */
+void Cmd_hex(UARTStdioHandle psUART, uint32_t argc, const tShellArg *args){
+
+    (void)argc;
+
+    UARTStdioPrintf(psUART, "0x%08x\n", args[0].u);
+
+}
@@ -0,0 +1,43 @@
+/*
+ * Name: Shell_Commands.h
+ * Author: Marquez Jones
+ * Desc: Command list for the UART shell
+ *       This is the description that MIL_Shell.h turns into the
+ *       command table, the handlers live in Shell_Commands.c
+ *
+ * How to add a command:
+ *       1. add CMD(name, args, usage) to SHELL_COMMANDS
+ *            name  - what is typed, also names the handler Cmd_<name>
+ *            args  - argument types, one character each
+ *                      u - unsigned 32 bit(0x for hex, a leading
+ *                          0 for octal)
+ *                      i - signed 32 bit, the same with a sign
+ *                      f - float(ustrtof)
+ *                      s - string, points into the line
+ *                    arguments after a '|' are optional, a '*' after
+ *                    the last type repeats it for any more arguments
+ *            usage - one line shown by help
+ *       2. write void Cmd_<name>(UARTStdioHandle psUART, uint32_t argc,
+ *                                const tShellArg *args)
+ *
+ * Notes: names are matched without regard to case, so two names
+ *        may not differ only in case
+ *
+ *        at most 64 commands, MIL_Shell.c won't build with more
+ */
+
+#ifndef SHELL_COMMANDS_H_
+#define SHELL_COMMANDS_H_
+
+/*
+ * Command list
+ * CMD(name, args, usage)
+ */
+#define SHELL_COMMANDS(CMD)                                            \
+    CMD(help,  "",      "help             list the commands")          \
+    CMD(echo,  "|s*",   "echo [word...]   print the words")            \
+    CMD(add,   "i|i*",  "add n [n...]     sum of integers")            \
+    CMD(scale, "ff",    "scale x k        x times k")                  \
+    CMD(hex,   "u",     "hex n            n in hex")
+
+#endif /* SHELL_COMMANDS_H_ */
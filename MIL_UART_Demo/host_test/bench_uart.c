@@ -0,0 +1,136 @@
+/*
+ * Name: bench_uart.c
+ * Author: Marquez Jones
+ * Desc: Runs MIL_UARTBench on the simulated UART(sim_uart.c), with
+ *       uartstdio.c, ustdlib.c and MIL_UARTBench.c as built for the
+ *       target
+ *
+ * Usage: bench_uart [-q]
+ *
+ *        Prints MIL_UARTBenchSweep on port 1 as the target prints it on
+ *        its console, one JSON line per run, then one more run at
+ *        CHECK_BAUD with CHECK_SIZE rings that is checked against what
+ *        the model has to give. -q only does the checked run
+ *
+ * Checks: no errors, the wire kept busy, latency no shorter than the
+ *         10 bit times on the wire plus the 32 bit receive timeout and
+ *         not much longer, and the overrun point. Reading one byte per
+ *         work clocks while the wire brings one per byte time, the app
+ *         falls (1 - byte time / work) behind per byte, so a burst of 4
+ *         rings just fits the RX ring at work = 4/3 byte time, less what
+ *         the read itself and the ISR cost
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "utils/uartstdio.h"
+#include "MIL_UARTBench.h"
+#include "sim_uart.h"
+
+//TM4C123 at full speed
+#define SIM_CLOCK       80000000
+
+//console and port under test
+#define CONSOLE_PORT    0
+#define BENCH_PORT      1
+
+//the checked run
+#define CHECK_BAUD      115200
+#define CHECK_SIZE      256
+
+//console rings
+static tUARTStdio g_sConsole;
+static unsigned char g_pui8ConsoleTx[1024];
+static unsigned char g_pui8ConsoleRx[16];
+
+/*
+ * Desc: prints a failed check
+ *
+ * Returns: false
+ */
+static bool Fail(const char *what, uint32_t got, uint32_t lo, uint32_t hi){
+
+    fprintf(stderr, "bench_uart: %s %u, expected %u to %u\n", what,
+            (unsigned)got, (unsigned)lo, (unsigned)hi);
+
+    return false;
+
+}
+
+/*
+ * Desc: checks the run at CHECK_BAUD against the model
+ *
+ * Returns: true if every figure is where it has to be
+ */
+static bool Check(const tUARTBenchResult *result){
+
+    uint32_t bit = result->byte_cycles / 10;
+    uint32_t overrun = (result->byte_cycles * 4) / 3;
+    bool ok = true;
+
+    if(result->errors){
+        ok = Fail("errors", result->errors, 0, 0);
+    }
+
+    if(result->wire_permille < 990){
+        ok = Fail("wire_permille", result->wire_permille, 990, 1000);
+    }
+
+    if(result->latency_min < (bit * 42)){
+        ok = Fail("latency_min", result->latency_min, bit * 42, bit * 43);
+    }
+
+    if(result->latency_max > (bit * 43)){
+        ok = Fail("latency_max", result->latency_max, bit * 42, bit * 43);
+    }
+
+    //the per byte cost takes a couple of percent off
+    if((result->overrun_work < (overrun - (overrun / 50))) ||
+       (result->overrun_work > (overrun + (overrun / 100)))){
+        ok = Fail("overrun_work", result->overrun_work,
+                  overrun - (overrun / 50), overrun + (overrun / 100));
+    }
+
+    return ok;
+
+}
+
+int main(int argc, char **argv){
+
+    UARTStdioHandle console;
+    tUARTBenchResult sResult;
+    bool quick = (argc > 1) && !strcmp(argv[1], "-q");
+
+    SimConsole(CONSOLE_PORT);
+
+    console = UARTStdioInit(&g_sConsole, CONSOLE_PORT, 115200, SIM_CLOCK,
+                            g_pui8ConsoleTx, sizeof(g_pui8ConsoleTx),
+                            g_pui8ConsoleRx, sizeof(g_pui8ConsoleRx));
+
+    if(!quick){
+        MIL_UARTBenchSweep(console, BENCH_PORT, SIM_CLOCK);
+    }
+
+    if(!MIL_UARTBenchRun(BENCH_PORT, SIM_CLOCK, CHECK_BAUD, CHECK_SIZE,
+                         CHECK_SIZE, &sResult)){
+        fprintf(stderr, "bench_uart: the checked run didn't start\n");
+        return 1;
+    }
+
+    MIL_UARTBenchReport(console, &sResult);
+    UARTStdioFlushTx(console, false);
+    fflush(stdout);
+
+    if(!Check(&sResult)){
+        return 1;
+    }
+
+    fprintf(stderr, "%s: %llu simulated clocks, ok\n", argv[0],
+            (unsigned long long)SimCycles());
+
+    return 0;
+
+}
@@ -0,0 +1,413 @@
+/*
+ * Name: bench_ustdlib.c
+ * Author: Marquez Jones
+ * Desc: Microbenchmarks for ustdlib next to the C library
+ *
+ * Usage: bench_ustdlib [-q] [name ...]
+ *
+ *        Prints one line per case with the ns per call of the ustdlib
+ *        function and of its C library counterpart. Names pick cases
+ *        by prefix, -q runs each case once briefly(for the sanitizer
+ *        build, where only a clean run matters)
+ *
+ * Notes: each case is calibrated to run at least RUN_NS, then run
+ *        REPEATS more times and the fastest kept, which shrugs off
+ *        interrupts and frequency ramps. For steady numbers pin it to
+ *        one core(taskset -c 2) on an otherwise idle machine
+ *
+ *        Host numbers only compare versions of ustdlib against each
+ *        other, the target has no cache and a different core, so an
+ *        optimization still needs checking there
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include "utils/ustdlib.h"
+
+//shortest timed run and timed runs per case
+#define RUN_NS      20000000ULL
+#define REPEATS     7
+
+//keeps results live and inputs opaque to the optimizer
+#define KEEP(x)     (g_ui64Sink += (uint64_t)(x))
+#define OPAQUE(p)   __asm__ volatile("" : "+r"(p))
+
+/*
+ * Desc: one timed loop of a case
+ */
+typedef void (*tBenchFxn)(uint32_t count);
+
+/*
+ * Desc: one case, the ustdlib loop and the C library loop
+ */
+typedef struct {
+    const char *name;
+    tBenchFxn ufn;
+    tBenchFxn cfn;
+} tBenchCase;
+
+static volatile uint64_t g_ui64Sink;
+static char g_pcOut[128];
+
+//inputs
+static const char g_pcLong[] =
+    "The quick brown fox jumps over the lazy dog, then over the lazy cat";
+static const char g_pcLongCase[] =
+    "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG, THEN OVER THE LAZY CAT";
+static const char g_pcNeedle[] = "lazy cat";
+
+/*******************************CASES*******************************/
+
+static void UPrintInt(uint32_t count){
+    for(uint32_t idx = 0; idx < count; idx++){
+        KEEP(usnprintf(g_pcOut, sizeof(g_pcOut), "%d %u %08x %s",
+                       -(int)idx, idx, idx, "ok"));
+    }
+}
+
+static void CPrintInt(uint32_t count){
+    for(uint32_t idx = 0; idx < count; idx++){
+        KEEP(snprintf(g_pcOut, sizeof(g_pcOut), "%d %u %08x %s",
+                      -(int)idx, idx, idx, "ok"));
+    }
+}
+
+static void UPrintFloat(uint32_t count){
+    for(uint32_t idx = 0; idx < count; idx++){
+        KEEP(usnprintf(g_pcOut, sizeof(g_pcOut), "%.3f %e",
+                       idx * 0.001, idx * 1.5e-9));
+    }
+}
+
+static void CPrintFloat(uint32_t count){
+    for(uint32_t idx = 0; idx < count; idx++){
+        KEEP(snprintf(g_pcOut, sizeof(g_pcOut), "%.3f %e",
+                      idx * 0.001, idx * 1.5e-9));
+    }
+}
+
+static void UStrtoulDec(uint32_t count){
+    const char *str = "4294967295";
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(ustrtoul(str, 0, 10));
+    }
+}
+
+static void CStrtoulDec(uint32_t count){
+    const char *str = "4294967295";
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(strtoul(str, 0, 10));
+    }
+}
+
+static void UStrtoulHex(uint32_t count){
+    const char *str = "0xDEADBEEF";
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(ustrtoul(str, 0, 0));
+    }
+}
+
+static void CStrtoulHex(uint32_t count){
+    const char *str = "0xDEADBEEF";
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(strtoul(str, 0, 0));
+    }
+}
+
+static void UStrtof(uint32_t count){
+    const char *str = "3.14159";
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(ustrtof(str, 0) * 1000);
+    }
+}
+
+static void CStrtof(uint32_t count){
+    const char *str = "3.14159";
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(strtof(str, 0) * 1000);
+    }
+}
+
+static void UStrtofHard(uint32_t count){
+    const char *str = "1.17549435082228750797e-38";
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(ustrtof(str, 0) > 0);
+    }
+}
+
+static void CStrtofHard(uint32_t count){
+    const char *str = "1.17549435082228750797e-38";
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(strtof(str, 0) > 0);
+    }
+}
+
+static void UStrtod(uint32_t count){
+    const char *str = "2.718281828459045";
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(ustrtod(str, 0) * 1000);
+    }
+}
+
+static void CStrtod(uint32_t count){
+    const char *str = "2.718281828459045";
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(strtod(str, 0) * 1000);
+    }
+}
+
+static void UStrlen(uint32_t count){
+    const char *str = g_pcLong;
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(ustrlen(str));
+    }
+}
+
+static void CStrlen(uint32_t count){
+    const char *str = g_pcLong;
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(strlen(str));
+    }
+}
+
+static void UStrncmp(uint32_t count){
+    const char *str = g_pcLong;
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(ustrncmp(str, g_pcLong, sizeof(g_pcLong)));
+    }
+}
+
+static void CStrncmp(uint32_t count){
+    const char *str = g_pcLong;
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(strncmp(str, g_pcLong, sizeof(g_pcLong)));
+    }
+}
+
+static void UStrncasecmp(uint32_t count){
+    const char *str = g_pcLong;
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(ustrncasecmp(str, g_pcLongCase, sizeof(g_pcLong)));
+    }
+}
+
+static void CStrncasecmp(uint32_t count){
+    const char *str = g_pcLong;
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(strncasecmp(str, g_pcLongCase, sizeof(g_pcLong)));
+    }
+}
+
+static void UStrstr(uint32_t count){
+    const char *str = g_pcLong;
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(ustrstr(str, g_pcNeedle) - str);
+    }
+}
+
+static void CStrstr(uint32_t count){
+    const char *str = g_pcLong;
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        KEEP(strstr(str, g_pcNeedle) - str);
+    }
+}
+
+static void UStrncpy(uint32_t count){
+    const char *str = g_pcLong;
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        ustrncpy(g_pcOut, str, sizeof(g_pcOut));
+        KEEP(g_pcOut[idx & 63]);
+    }
+}
+
+static void CStrncpy(uint32_t count){
+    const char *str = g_pcLong;
+    for(uint32_t idx = 0; idx < count; idx++){
+        OPAQUE(str);
+        strncpy(g_pcOut, str, sizeof(g_pcOut));
+        KEEP(g_pcOut[idx & 63]);
+    }
+}
+
+static void ULocaltime(uint32_t count){
+    struct tm sTime;
+    for(uint32_t idx = 0; idx < count; idx++){
+        ulocaltime((time_t)(idx * 86413u), &sTime);
+        KEEP(sTime.tm_mday);
+    }
+}
+
+static void CLocaltime(uint32_t count){
+    struct tm sTime;
+    for(uint32_t idx = 0; idx < count; idx++){
+        time_t secs = (time_t)(idx * 86413u);
+        gmtime_r(&secs, &sTime);
+        KEEP(sTime.tm_mday);
+    }
+}
+
+static void UMktime(uint32_t count){
+    struct tm sTime;
+    memset(&sTime, 0, sizeof(sTime));
+    for(uint32_t idx = 0; idx < count; idx++){
+        sTime.tm_year = 70 + (idx & 63);
+        sTime.tm_mday = 1 + (idx & 15);
+        KEEP(umktime(&sTime));
+    }
+}
+
+static void CMktime(uint32_t count){
+    struct tm sTime;
+    memset(&sTime, 0, sizeof(sTime));
+    for(uint32_t idx = 0; idx < count; idx++){
+        sTime.tm_year = 70 + (idx & 63);
+        sTime.tm_mday = 1 + (idx & 15);
+        sTime.tm_mon = 0;
+        KEEP(timegm(&sTime));
+    }
+}
+
+static const tBenchCase g_psCases[] = {
+    { "printf_int",     UPrintInt,      CPrintInt },
+    { "printf_float",   UPrintFloat,    CPrintFloat },
+    { "strtoul_dec",    UStrtoulDec,    CStrtoulDec },
+    { "strtoul_hex",    UStrtoulHex,    CStrtoulHex },
+    { "strtof",         UStrtof,        CStrtof },
+    { "strtof_hard",    UStrtofHard,    CStrtofHard },
+    { "strtod",         UStrtod,        CStrtod },
+    { "strlen",         UStrlen,        CStrlen },
+    { "strncmp",        UStrncmp,       CStrncmp },
+    { "strncasecmp",    UStrncasecmp,   CStrncasecmp },
+    { "strstr",         UStrstr,        CStrstr },
+    { "strncpy",        UStrncpy,       CStrncpy },
+    { "localtime",      ULocaltime,     CLocaltime },
+    { "mktime",         UMktime,        CMktime },
+};
+
+#define CASE_COUNT  (sizeof(g_psCases) / sizeof(g_psCases[0]))
+
+/******************************TIMING******************************/
+
+/*
+ * Desc: monotonic time in ns
+ */
+static uint64_t Now(void){
+
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+
+    return ((uint64_t)sNow.tv_sec * 1000000000ULL) + sNow.tv_nsec;
+
+}
+
+/*
+ * Desc: ns for one call of fn, the fastest of the timed runs
+ *
+ * Inputs: loop, true for one short run
+ */
+static double Time(tBenchFxn fn, bool quick){
+
+    uint32_t count = 1;
+    uint64_t best = ~0ULL;
+    uint64_t elapsed;
+    uint64_t start;
+
+    //double the count until a run is long enough to time
+    do{
+        count *= 2;
+        start = Now();
+        fn(count);
+        elapsed = Now() - start;
+    }while(!quick && (elapsed < RUN_NS) && (count < (1U << 30)));
+
+    if(quick){
+        return (double)elapsed / count;
+    }
+
+    for(uint32_t rep = 0; rep < REPEATS; rep++){
+
+        start = Now();
+        fn(count);
+        elapsed = Now() - start;
+
+        if(elapsed < best){
+            best = elapsed;
+        }
+
+    }
+
+    return (double)best / count;
+
+}
+
+int main(int argc, char **argv){
+
+    bool quick = false;
+    int names = 0;
+
+    for(int arg = 1; arg < argc; arg++){
+        if(!strcmp(argv[arg], "-q")){
+            quick = true;
+        }
+        else{
+            names++;
+        }
+    }
+
+    printf("%-14s %12s %12s %8s\n", "case", "ustdlib ns", "libc ns",
+           "ratio");
+
+    for(uint32_t idx = 0; idx < CASE_COUNT; idx++){
+
+        double uns;
+        double cns;
+        bool run = !names;
+
+        for(int arg = 1; arg < argc; arg++){
+            if(strcmp(argv[arg], "-q") &&
+               !strncmp(g_psCases[idx].name, argv[arg], strlen(argv[arg]))){
+                run = true;
+            }
+        }
+
+        if(!run){
+            continue;
+        }
+
+        uns = Time(g_psCases[idx].ufn, quick);
+        cns = Time(g_psCases[idx].cfn, quick);
+
+        printf("%-14s %12.1f %12.1f %8.2f\n", g_psCases[idx].name, uns, cns,
+               uns / cns);
+
+    }
+
+    return 0;
+
+}
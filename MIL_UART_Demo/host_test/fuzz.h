@@ -0,0 +1,131 @@
+/*
+ * Name: fuzz.h
+ * Author: Marquez Jones
+ * Desc: Helpers shared by the ustdlib differential fuzz targets
+ *
+ * Notes: every target is a libFuzzer entry point,
+ *
+ *        int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+ *
+ *        built either against libFuzzer(make fuzz) or against
+ *        fuzz_main.c, which feeds it files or a fixed pseudo random
+ *        corpus(make check). The input bytes are read as a stream of
+ *        choices, running out just reads zeros, so every input is
+ *        valid and short inputs still reach the simple cases
+ */
+
+#ifndef FUZZ_H_
+#define FUZZ_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Desc: input being read
+ */
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+} tFuzzIn;
+
+/*
+ * Desc: starts reading an input
+ */
+static inline void FuzzStart(tFuzzIn *in, const uint8_t *data, size_t size){
+
+    in->data = data;
+    in->size = size;
+    in->pos = 0;
+
+}
+
+/*
+ * Desc: true while unread bytes are left
+ */
+static inline bool FuzzMore(const tFuzzIn *in){
+
+    return in->pos < in->size;
+
+}
+
+/*
+ * Desc: next byte, 0 once the input is used up
+ */
+static inline uint8_t FuzzByte(tFuzzIn *in){
+
+    return (in->pos < in->size) ? in->data[in->pos++] : 0;
+
+}
+
+/*
+ * Desc: next 32 bit value, little endian
+ */
+static inline uint32_t FuzzU32(tFuzzIn *in){
+
+    uint32_t value = 0;
+
+    for(uint32_t idx = 0; idx < 4; idx++){
+        value |= (uint32_t)FuzzByte(in) << (idx * 8);
+    }
+
+    return value;
+
+}
+
+/*
+ * Desc: next 64 bit value, little endian
+ */
+static inline uint64_t FuzzU64(tFuzzIn *in){
+
+    uint64_t value = FuzzU32(in);
+
+    return value | ((uint64_t)FuzzU32(in) << 32);
+
+}
+
+/*
+ * Desc: next value from 0 to count - 1
+ */
+static inline uint32_t FuzzPick(tFuzzIn *in, uint32_t count){
+
+    return FuzzByte(in) % count;
+
+}
+
+/*
+ * Desc: fills str with up to max - 1 characters drawn from alphabet
+ *       and terminates it
+ *
+ * Returns: length of the string
+ */
+static inline size_t FuzzString(tFuzzIn *in, char *str, size_t max,
+                                const char *alphabet, size_t letters){
+
+    size_t len = FuzzByte(in) % max;
+
+    for(size_t idx = 0; idx < len; idx++){
+        str[idx] = alphabet[FuzzByte(in) % letters];
+    }
+    str[len] = 0;
+
+    return len;
+
+}
+
+/*
+ * Desc: reports a mismatch with the C library and stops, so
+ *       libFuzzer keeps the input and make check fails
+ */
+#define FUZZ_FAIL(...)                                                  \
+    do{                                                                 \
+        fprintf(stderr, "%s:%d: ", __FILE__, __LINE__);                 \
+        fprintf(stderr, __VA_ARGS__);                                   \
+        fputc('\n', stderr);                                            \
+        abort();                                                        \
+    }while(0)
+
+#endif /* FUZZ_H_ */
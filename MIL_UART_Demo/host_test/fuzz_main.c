@@ -0,0 +1,116 @@
+/*
+ * Name: fuzz_main.c
+ * Author: Marquez Jones
+ * Desc: Stand alone driver for the fuzz targets when libFuzzer isn't
+ *       available(gcc builds, make check)
+ *
+ * Usage: fuzz_xxx [-runs=N] [-seed=S] [file ...]
+ *
+ *        With files, each one is run once as an input(a libFuzzer
+ *        crash or corpus file). Without, N pseudo random inputs are
+ *        made from seed S, so a run is repeatable and a failure
+ *        comes back with the same seed
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//longest generated input
+#define MAX_INPUT   512
+
+//defaults
+#define DEF_RUNS    200000
+#define DEF_SEED    1
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/*
+ * Desc: xorshift64*, plenty for making inputs
+ */
+static uint64_t Next(uint64_t *state){
+
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+
+    return *state * 0x2545F4914F6CDD1DULL;
+
+}
+
+/*
+ * Desc: runs one file as an input
+ *
+ * Returns: 0, or 1 if it couldn't be read
+ */
+static int RunFile(const char *path){
+
+    static uint8_t buf[1 << 20];
+    FILE *file = fopen(path, "rb");
+    size_t size;
+
+    if(!file){
+        perror(path);
+        return 1;
+    }
+
+    size = fread(buf, 1, sizeof(buf), file);
+    fclose(file);
+
+    LLVMFuzzerTestOneInput(buf, size);
+
+    return 0;
+
+}
+
+int main(int argc, char **argv){
+
+    uint8_t buf[MAX_INPUT];
+    unsigned long runs = DEF_RUNS;
+    uint64_t seed = DEF_SEED;
+    uint64_t state;
+    int files = 0;
+    int failed = 0;
+
+    for(int arg = 1; arg < argc; arg++){
+
+        if(!strncmp(argv[arg], "-runs=", 6)){
+            runs = strtoul(argv[arg] + 6, 0, 0);
+        }
+        else if(!strncmp(argv[arg], "-seed=", 6)){
+            seed = strtoull(argv[arg] + 6, 0, 0);
+        }
+        else{
+            failed |= RunFile(argv[arg]);
+            files++;
+        }
+
+    }
+
+    if(files){
+        return failed;
+    }
+
+    //xorshift must not start at 0
+    state = seed ? seed : DEF_SEED;
+
+    for(unsigned long run = 0; run < runs; run++){
+
+        //mostly short inputs, now and then a long one
+        size_t size = Next(&state) % ((run & 7) ? 64 : MAX_INPUT);
+
+        for(size_t idx = 0; idx < size; idx++){
+            buf[idx] = (uint8_t)(Next(&state) >> 56);
+        }
+
+        LLVMFuzzerTestOneInput(buf, size);
+
+    }
+
+    printf("%s: %lu runs, seed %llu, ok\n", argv[0], runs,
+           (unsigned long long)seed);
+
+    return 0;
+
+}
@@ -0,0 +1,440 @@
+/*
+ * Name: fuzz_printf.c
+ * Author: Marquez Jones
+ * Desc: Differential fuzz target for uvsnprintf and uvsinkprintf
+ *
+ * Notes: the input picks a format of up to MAX_PIECES literal runs and
+ *        conversions, their arguments and a buffer size. The format
+ *        goes through uvsnprintf and through uvsinkprintf into
+ *        usinkbuf, and both must match the C library's output built
+ *        piece by piece, truncation and return value included
+ *
+ *        The reference follows the documented ustdlib differences:
+ *        - %X prints lower case and %p is %x
+ *        - %s is padded on the right and never with zeros
+ *        - %c ignores the width
+ *        - precision is capped at UFMT_PREC_MAX and only used by
+ *          %e/%f/%g/%q
+ *        - %f of 2^32 - 1 or more prints as %e
+ *        - %q is the exact value of a Q format number
+ *        %e and %g are only checked where ufmtfloat promises exact
+ *        rounding(22 places of scaling or fewer)
+ *
+ *        Integer conversions read an unsigned long, as a 32 bit long
+ *        on the target, so the arguments are passed as longs here
+ */
+
+#include <math.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "fuzz.h"
+#include "utils/ustdlib.h"
+
+//pieces and arguments in one format
+#define MAX_PIECES      8
+#define MAX_ARGS        3
+
+//room for the output
+#define MAX_OUT         1024
+
+//argument classes, as read by va_arg
+#define ARG_LONG        1
+#define ARG_DOUBLE      2
+#define ARG_STR         3
+
+#define SIG1(a)         (a)
+#define SIG2(a, b)      ((a) | ((b) << 2))
+#define SIG3(a, b, c)   ((a) | ((b) << 2) | ((c) << 4))
+
+#define L(i)            args[i].l
+#define D(i)            args[i].d
+#define S(i)            args[i].s
+
+/*
+ * Desc: one argument
+ */
+typedef struct {
+    unsigned long l;
+    double d;
+    const char *s;
+} tArg;
+
+//a vsnprintf style formatter
+typedef int (*tFmtFxn)(char *s, size_t n, const char *fmt, va_list arg);
+
+//characters for literal runs and %s strings, no %
+static const char g_pcText[] = "abcXYZ 019-+.\t\n{}\":,";
+
+//strings for %s, kept until the formatters are done
+static char g_ppcStr[MAX_ARGS][32];
+
+/*
+ * Desc: uvsinkprintf into a buffer through usinkbuf, terminated the
+ *       way uvsnprintf terminates
+ */
+static int SinkFmt(char *s, size_t n, const char *fmt, va_list arg){
+
+    tUSinkBuf sBuf;
+    int count;
+
+    sBuf.pcBuf = s;
+    sBuf.ui32Left = n - 1;
+
+    count = uvsinkprintf(usinkbuf, &sBuf, fmt, arg);
+    *sBuf.pcBuf = 0;
+
+    return count;
+
+}
+
+/*
+ * Desc: runs a formatter on a variable argument list
+ */
+static int Call(tFmtFxn pfnFmt, char *s, size_t n, const char *fmt, ...){
+
+    va_list arg;
+    int count;
+
+    va_start(arg, fmt);
+    count = pfnFmt(s, n, fmt, arg);
+    va_end(arg);
+
+    return count;
+
+}
+
+/*
+ * Desc: runs a formatter with the arguments the format was built
+ *       with, every class combination needs its own call
+ */
+static int Run(tFmtFxn pfnFmt, char *s, size_t n, const char *fmt,
+               const tArg *args, uint32_t sig){
+
+    switch(sig){
+        case 0: return Call(pfnFmt, s, n, fmt);
+        case SIG1(1): return Call(pfnFmt, s, n, fmt, L(0));
+        case SIG1(2): return Call(pfnFmt, s, n, fmt, D(0));
+        case SIG1(3): return Call(pfnFmt, s, n, fmt, S(0));
+        case SIG2(1, 1): return Call(pfnFmt, s, n, fmt, L(0), L(1));
+        case SIG2(1, 2): return Call(pfnFmt, s, n, fmt, L(0), D(1));
+        case SIG2(1, 3): return Call(pfnFmt, s, n, fmt, L(0), S(1));
+        case SIG2(2, 1): return Call(pfnFmt, s, n, fmt, D(0), L(1));
+        case SIG2(2, 2): return Call(pfnFmt, s, n, fmt, D(0), D(1));
+        case SIG2(2, 3): return Call(pfnFmt, s, n, fmt, D(0), S(1));
+        case SIG2(3, 1): return Call(pfnFmt, s, n, fmt, S(0), L(1));
+        case SIG2(3, 2): return Call(pfnFmt, s, n, fmt, S(0), D(1));
+        case SIG2(3, 3): return Call(pfnFmt, s, n, fmt, S(0), S(1));
+        case SIG3(1, 1, 1): return Call(pfnFmt, s, n, fmt, L(0), L(1), L(2));
+        case SIG3(1, 1, 2): return Call(pfnFmt, s, n, fmt, L(0), L(1), D(2));
+        case SIG3(1, 1, 3): return Call(pfnFmt, s, n, fmt, L(0), L(1), S(2));
+        case SIG3(1, 2, 1): return Call(pfnFmt, s, n, fmt, L(0), D(1), L(2));
+        case SIG3(1, 2, 2): return Call(pfnFmt, s, n, fmt, L(0), D(1), D(2));
+        case SIG3(1, 2, 3): return Call(pfnFmt, s, n, fmt, L(0), D(1), S(2));
+        case SIG3(1, 3, 1): return Call(pfnFmt, s, n, fmt, L(0), S(1), L(2));
+        case SIG3(1, 3, 2): return Call(pfnFmt, s, n, fmt, L(0), S(1), D(2));
+        case SIG3(1, 3, 3): return Call(pfnFmt, s, n, fmt, L(0), S(1), S(2));
+        case SIG3(2, 1, 1): return Call(pfnFmt, s, n, fmt, D(0), L(1), L(2));
+        case SIG3(2, 1, 2): return Call(pfnFmt, s, n, fmt, D(0), L(1), D(2));
+        case SIG3(2, 1, 3): return Call(pfnFmt, s, n, fmt, D(0), L(1), S(2));
+        case SIG3(2, 2, 1): return Call(pfnFmt, s, n, fmt, D(0), D(1), L(2));
+        case SIG3(2, 2, 2): return Call(pfnFmt, s, n, fmt, D(0), D(1), D(2));
+        case SIG3(2, 2, 3): return Call(pfnFmt, s, n, fmt, D(0), D(1), S(2));
+        case SIG3(2, 3, 1): return Call(pfnFmt, s, n, fmt, D(0), S(1), L(2));
+        case SIG3(2, 3, 2): return Call(pfnFmt, s, n, fmt, D(0), S(1), D(2));
+        case SIG3(2, 3, 3): return Call(pfnFmt, s, n, fmt, D(0), S(1), S(2));
+        case SIG3(3, 1, 1): return Call(pfnFmt, s, n, fmt, S(0), L(1), L(2));
+        case SIG3(3, 1, 2): return Call(pfnFmt, s, n, fmt, S(0), L(1), D(2));
+        case SIG3(3, 1, 3): return Call(pfnFmt, s, n, fmt, S(0), L(1), S(2));
+        case SIG3(3, 2, 1): return Call(pfnFmt, s, n, fmt, S(0), D(1), L(2));
+        case SIG3(3, 2, 2): return Call(pfnFmt, s, n, fmt, S(0), D(1), D(2));
+        case SIG3(3, 2, 3): return Call(pfnFmt, s, n, fmt, S(0), D(1), S(2));
+        case SIG3(3, 3, 1): return Call(pfnFmt, s, n, fmt, S(0), S(1), L(2));
+        case SIG3(3, 3, 2): return Call(pfnFmt, s, n, fmt, S(0), S(1), D(2));
+        case SIG3(3, 3, 3): return Call(pfnFmt, s, n, fmt, S(0), S(1), S(2));
+        default: FUZZ_FAIL("bad signature %x", sig);
+    }
+
+}
+
+/*
+ * Desc: picks a double, mostly ones with short decimal forms and
+ *       halfway cases, sometimes any bit pattern
+ */
+static double PickDouble(tFuzzIn *in){
+
+    union {
+        double d;
+        uint64_t u;
+    } bits;
+
+    switch(FuzzPick(in, 4)){
+        case 0:
+            bits.u = FuzzU64(in);
+            return bits.d;
+        case 1:
+            return (double)(int32_t)FuzzU32(in) / 1000.0;
+        case 2:
+            //n + 1/2 at some power of two, ties for rounding
+            return ldexp((double)(int32_t)FuzzU32(in) + 0.5,
+                         (int)FuzzPick(in, 40) - 30);
+        default:
+            return (double)(int32_t)FuzzU32(in) * pow(10.0,
+                                                     (int)FuzzPick(in, 21) - 10);
+    }
+
+}
+
+/*
+ * Desc: true if %e/%g of value at prec is in ufmtfloat's exact range
+ */
+static bool ExactRange(double value, uint32_t prec){
+
+    int exp10;
+
+    if((value == 0.0) || !isfinite(value)){
+        return true;
+    }
+
+    exp10 = (int)floor(log10(fabs(value)));
+
+    return (uint32_t)abs(exp10) + prec + 1 <= 22;
+
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size){
+
+    static char fmt[MAX_PIECES * 24];
+    static char expect[MAX_PIECES * 96];
+    static char out[MAX_OUT];
+    static char sink[MAX_OUT];
+    tArg args[MAX_ARGS];
+    tFuzzIn in;
+    uint32_t nargs = 0;
+    uint32_t sig = 0;
+    size_t flen = 0;
+    size_t elen = 0;
+    size_t n;
+    int count;
+
+    FuzzStart(&in, data, size);
+
+    n = 1 + (FuzzU32(&in) % MAX_OUT);
+
+    for(uint32_t piece = 0; (piece < MAX_PIECES) && FuzzMore(&in); piece++){
+
+        uint32_t kind = FuzzPick(&in, 11);
+        bool zero = FuzzPick(&in, 3) == 0;
+        uint32_t width = FuzzPick(&in, 3) ? 0 : FuzzPick(&in, 40);
+        bool has_prec = FuzzPick(&in, 2);
+        uint32_t prec = FuzzPick(&in, 13);
+        uint32_t eprec;
+        char spec[16];
+        char conv;
+        size_t slen;
+
+        //the field part of the format, "%[0][width][.prec]"
+        slen = (size_t)sprintf(spec, "%%%s", zero ? "0" : "");
+        if(width){
+            slen += (size_t)sprintf(spec + slen, "%u", width);
+        }
+
+        eprec = has_prec ? prec : 6;
+        if(eprec > UFMT_PREC_MAX){
+            eprec = UFMT_PREC_MAX;
+        }
+
+        //conversions past the argument budget become literals
+        if((kind >= 1) && (kind <= 8) && (nargs + (kind == 8) >= MAX_ARGS)){
+            kind = 0;
+        }
+
+        switch(kind){
+
+            //literal run
+            case 0:
+            {
+                char lit[16];
+                size_t len = FuzzString(&in, lit, sizeof(lit), g_pcText,
+                                        sizeof(g_pcText) - 1);
+
+                memcpy(fmt + flen, lit, len);
+                flen += len;
+                memcpy(expect + elen, lit, len);
+                elen += len;
+                break;
+            }
+
+            //signed, unsigned and hex, read as longs
+            case 1:
+            case 2:
+            case 3:
+            {
+                uint32_t value = FuzzU32(&in);
+                const char *convs = (kind == 1) ? "di" :
+                                    (kind == 2) ? "uu" : "xX";
+
+                conv = (kind == 3) ? "xXp"[FuzzPick(&in, 3)] :
+                                     convs[FuzzPick(&in, 2)];
+
+                //a precision is ignored
+                if(has_prec){
+                    slen += (size_t)sprintf(spec + slen, ".%u", prec);
+                }
+
+                flen += (size_t)sprintf(fmt + flen, "%s%c", spec, conv);
+
+                if(kind == 1){
+                    args[nargs].l = (unsigned long)(long)(int32_t)value;
+                    elen += (size_t)sprintf(expect + elen,
+                                            zero ? "%0*d" : "%*d",
+                                            (int)width, (int32_t)value);
+                }
+                else{
+                    args[nargs].l = value;
+                    elen += (size_t)sprintf(expect + elen,
+                                            (kind == 2) ?
+                                            (zero ? "%0*u" : "%*u") :
+                                            (zero ? "%0*x" : "%*x"),
+                                            (int)width, value);
+                }
+
+                sig |= ARG_LONG << (nargs * 2);
+                nargs++;
+                break;
+            }
+
+            //string, padded on the right
+            case 4:
+            {
+                FuzzString(&in, g_ppcStr[nargs], sizeof(g_ppcStr[nargs]),
+                           g_pcText, sizeof(g_pcText) - 1);
+
+                //a precision is ignored, it doesn't truncate
+                if(has_prec){
+                    slen += (size_t)sprintf(spec + slen, ".%u", prec);
+                }
+
+                flen += (size_t)sprintf(fmt + flen, "%ss", spec);
+                elen += (size_t)sprintf(expect + elen, "%-*s", (int)width,
+                                        g_ppcStr[nargs]);
+
+                args[nargs].s = g_ppcStr[nargs];
+                sig |= ARG_STR << (nargs * 2);
+                nargs++;
+                break;
+            }
+
+            //character, any byte including 0, the width is ignored
+            case 5:
+            {
+                uint8_t value = FuzzByte(&in);
+
+                flen += (size_t)sprintf(fmt + flen, "%sc", spec);
+                expect[elen++] = (char)value;
+
+                args[nargs].l = value;
+                sig |= ARG_LONG << (nargs * 2);
+                nargs++;
+                break;
+            }
+
+            //%e, %f and %g
+            case 6:
+            case 7:
+            {
+                double value = PickDouble(&in);
+                char cfmt[24];
+
+                conv = "efg"[FuzzPick(&in, 3)];
+
+                //%f past 32 bits is %e, then the %e limits apply
+                if((conv == 'f') && !(fabs(value) < 4294967295.0) &&
+                   isfinite(value)){
+                    conv = 'F';
+                }
+                if((conv != 'f') && !ExactRange(value, eprec)){
+                    value = (double)(int32_t)FuzzU32(&in) / 1024.0;
+                    if(conv == 'F'){
+                        conv = 'f';
+                    }
+                }
+
+                if(has_prec){
+                    slen += (size_t)sprintf(spec + slen, ".%u", prec);
+                }
+
+                flen += (size_t)sprintf(fmt + flen, "%s%c", spec,
+                                        (conv == 'F') ? 'f' : conv);
+
+                sprintf(cfmt, "%%%s*.%u%c", zero ? "0" : "", eprec,
+                        (conv == 'F') ? 'e' : conv);
+                elen += (size_t)sprintf(expect + elen, cfmt, (int)width,
+                                        value);
+
+                args[nargs].d = value;
+                sig |= ARG_DOUBLE << (nargs * 2);
+                nargs++;
+                break;
+            }
+
+            //Q format, fraction bits then the value
+            case 8:
+            {
+                uint32_t bits = FuzzPick(&in, 32);
+                int32_t value = (int32_t)FuzzU32(&in);
+
+                if(has_prec){
+                    slen += (size_t)sprintf(spec + slen, ".%u", prec);
+                }
+
+                flen += (size_t)sprintf(fmt + flen, "%sq", spec);
+                elen += (size_t)sprintf(expect + elen,
+                                        zero ? "%0*.*f" : "%*.*f",
+                                        (int)width, (int)eprec,
+                                        ldexp((double)value, -(int)bits));
+
+                args[nargs].l = bits;
+                sig |= ARG_LONG << (nargs * 2);
+                nargs++;
+                args[nargs].l = (unsigned long)(long)value;
+                sig |= ARG_LONG << (nargs * 2);
+                nargs++;
+                break;
+            }
+
+            //percent
+            default:
+                flen += (size_t)sprintf(fmt + flen, "%%%%");
+                expect[elen++] = '%';
+                break;
+
+        }
+
+    }
+
+    fmt[flen] = 0;
+
+    //uvsnprintf, straight into the buffer
+    memset(out, 0x55, sizeof(out));
+    count = Run(uvsnprintf, out, n, fmt, args, sig);
+
+    if(((size_t)count != elen) || (out[(elen < n) ? elen : (n - 1)] != 0) ||
+       memcmp(out, expect, (elen < n) ? elen : (n - 1))){
+        expect[elen] = 0;
+        FUZZ_FAIL("uvsnprintf(%zu, \"%s\") gave %d \"%s\", expected %zu "
+                  "\"%s\"", n, fmt, count, out, elen, expect);
+    }
+
+    //uvsinkprintf through usinkbuf, in pieces
+    memset(sink, 0x55, sizeof(sink));
+    count = Run(SinkFmt, sink, n, fmt, args, sig);
+
+    if(((size_t)count != elen) || memcmp(out, sink, n)){
+        FUZZ_FAIL("uvsinkprintf(%zu, \"%s\") gave %d \"%s\", uvsnprintf "
+                  "gave \"%s\"", n, fmt, count, sink, out);
+    }
+
+    return 0;
+
+}
@@ -0,0 +1,142 @@
+/*
+ * Name: fuzz_strcmp.c
+ * Author: Marquez Jones
+ * Desc: Differential fuzz target for the ustdlib string functions,
+ *       ustrncasecmp, ustrcasecmp, ustrncmp, ustrcmp, ustrlen,
+ *       ustrncpy and ustrstr against the C library
+ *
+ * Notes: the strings come from a small alphabet, with case pairs and
+ *        bytes above 0x7F, so they often share long prefixes and the
+ *        needle is often found. Each string is copied to the end of
+ *        its own heap block at an offset picked by the input, so every
+ *        mix of alignments reaches the word at a time paths
+ *
+ *        Comparisons only have to agree in sign. Build with
+ *        -funsigned-char to compare bytes the way the target does
+ */
+
+#include <string.h>
+#include <strings.h>
+
+#include "fuzz.h"
+#include "utils/ustdlib.h"
+
+//longest string
+#define MAX_STR     80
+
+//longest ustrncpy destination
+#define MAX_COPY    96
+
+static const char g_pcText[] = "aAbBzZ09 \x7F\x80\xC1\xE1\xFF";
+
+/*
+ * Desc: sign of a comparison
+ */
+static int Sign(int value){
+
+    return (value > 0) - (value < 0);
+
+}
+
+/*
+ * Desc: copies str to the end of a new heap block, offset bytes in
+ */
+static char *Place(const char *str, size_t offset){
+
+    size_t len = strlen(str);
+    char *block = malloc(offset + len + 1);
+
+    memcpy(block + offset, str, len + 1);
+
+    return block;
+
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size){
+
+    char text1[MAX_STR];
+    char text2[MAX_STR];
+    char ucopy[MAX_COPY + 8];
+    char ccopy[MAX_COPY + 8];
+    tFuzzIn in;
+    size_t off1, off2, n;
+    char *block1, *block2;
+    char *s1, *s2;
+    char *found;
+
+    FuzzStart(&in, data, size);
+
+    off1 = FuzzPick(&in, 4);
+    off2 = FuzzPick(&in, 4);
+    n = FuzzPick(&in, 2) ? FuzzPick(&in, MAX_COPY) : (size_t)-1;
+
+    FuzzString(&in, text1, sizeof(text1), g_pcText, sizeof(g_pcText) - 1);
+
+    //the second string is often a piece of the first, maybe recased
+    if(FuzzPick(&in, 2) && text1[0]){
+        size_t len1 = strlen(text1);
+        size_t start = FuzzPick(&in, 255) % len1;
+        size_t len = FuzzPick(&in, 255) % (len1 - start + 1);
+
+        memcpy(text2, text1 + start, len);
+        text2[len] = 0;
+        if(FuzzPick(&in, 2) && len){
+            text2[FuzzPick(&in, 255) % len] ^= 0x20;
+        }
+    }
+    else{
+        FuzzString(&in, text2, sizeof(text2), g_pcText,
+                   sizeof(g_pcText) - 1);
+    }
+
+    block1 = Place(text1, off1);
+    block2 = Place(text2, off2);
+    s1 = block1 + off1;
+    s2 = block2 + off2;
+
+    if(Sign(ustrncasecmp(s1, s2, n)) != Sign(strncasecmp(s1, s2, n))){
+        FUZZ_FAIL("ustrncasecmp(\"%s\", \"%s\", %zu)", text1, text2, n);
+    }
+    if(Sign(ustrcasecmp(s1, s2)) != Sign(strcasecmp(s1, s2))){
+        FUZZ_FAIL("ustrcasecmp(\"%s\", \"%s\")", text1, text2);
+    }
+    if(Sign(ustrncmp(s1, s2, n)) != Sign(strncmp(s1, s2, n))){
+        FUZZ_FAIL("ustrncmp(\"%s\", \"%s\", %zu) at +%zu +%zu", text1, text2,
+                  n, off1, off2);
+    }
+    if(Sign(ustrcmp(s1, s2)) != Sign(strcmp(s1, s2))){
+        FUZZ_FAIL("ustrcmp(\"%s\", \"%s\") at +%zu +%zu", text1, text2,
+                  off1, off2);
+    }
+    if(ustrlen(s1) != strlen(s1)){
+        FUZZ_FAIL("ustrlen(\"%s\") at +%zu", text1, off1);
+    }
+
+    found = ustrstr(s1, s2);
+    if(found != strstr(s1, s2)){
+        FUZZ_FAIL("ustrstr(\"%s\", \"%s\") gave %td", text1, text2,
+                  found ? (found - s1) : -1);
+    }
+
+    //copy into a destination at the source's alignment or not
+    if(n <= MAX_COPY){
+        size_t doff = FuzzPick(&in, 4);
+
+        memset(ucopy, 0x55, sizeof(ucopy));
+        memset(ccopy, 0x55, sizeof(ccopy));
+
+        found = ustrncpy(ucopy + doff, s1, n);
+        strncpy(ccopy + doff, s1, n);
+
+        if((found != (ucopy + doff)) || memcmp(ucopy, ccopy, sizeof(ucopy))){
+            FUZZ_FAIL("ustrncpy(+%zu, \"%s\" at +%zu, %zu)", doff, text1,
+                      off1, n);
+        }
+    }
+
+    free(block1);
+    free(block2);
+
+    return 0;
+
+}
@@ -0,0 +1,182 @@
+/*
+ * Name: fuzz_strtof.c
+ * Author: Marquez Jones
+ * Desc: Differential fuzz target for ustrtof and ustrtod against
+ *       strtof and strtod
+ *
+ * Notes: both are correctly rounded, so the results must match bit
+ *        for bit(any NaN matches any NaN) along with the end pointer.
+ *        Besides free form strings the input can pick the exact
+ *        halfway point between two neighbouring floats or doubles,
+ *        printed in full and then nudged a digit either way, which
+ *        is where a conversion that isn't correctly rounded slips
+ *
+ *        The reference follows the documented ustdlib differences:
+ *        only spaces and tabs are skipped before the number, and
+ *        there are no hex floats or "nan(...)", which the alphabet
+ *        leaves out
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "fuzz.h"
+#include "utils/ustdlib.h"
+
+//longest string
+#define MAX_STR     800
+
+//characters numbers are made of, plus a few that end them
+static const char g_pcNum[] = "0123456789.eE+- \tinfatyINFATY0123456789\n";
+
+/*
+ * Desc: one free form number, [sign][digits][.digits][e[sign]digits]
+ */
+static void MakeNumber(tFuzzIn *in, char *str){
+
+    uint32_t count;
+
+    if(FuzzPick(in, 2)){
+        *str++ = FuzzPick(in, 2) ? '-' : '+';
+    }
+
+    for(count = FuzzPick(in, 40); count; count--){
+        *str++ = '0' + FuzzPick(in, 10);
+    }
+
+    if(FuzzPick(in, 2)){
+        *str++ = '.';
+        for(count = FuzzPick(in, 40); count; count--){
+            *str++ = '0' + FuzzPick(in, 10);
+        }
+    }
+
+    if(FuzzPick(in, 2)){
+        *str++ = FuzzPick(in, 2) ? 'e' : 'E';
+        if(FuzzPick(in, 2)){
+            *str++ = FuzzPick(in, 2) ? '-' : '+';
+        }
+        str += sprintf(str, "%u", FuzzPick(in, 2) ? FuzzPick(in, 50) :
+                                                    FuzzU32(in) % 400);
+    }
+
+    *str = 0;
+
+}
+
+/*
+ * Desc: the halfway point between a float or double and the next one
+ *       up, in full, with the last digit maybe moved
+ */
+static void MakeHalfway(tFuzzIn *in, char *str){
+
+    char *last;
+    double mid;
+
+    if(FuzzPick(in, 2)){
+        union { float f; uint32_t u; } bits;
+
+        bits.u = FuzzU32(in) & 0x7F7FFFFF;
+        mid = ((double)bits.f + (double)nextafterf(bits.f, INFINITY)) / 2;
+        sprintf(str, "%.120g", mid);
+    }
+    else{
+        union { double d; uint64_t u; } bits;
+        long double wide;
+
+        bits.u = FuzzU64(in) & 0x7FEFFFFFFFFFFFFFULL;
+        wide = ((long double)bits.d +
+                (long double)nextafter(bits.d, INFINITY)) / 2;
+        sprintf(str, "%.*Lg", 40 + (int)FuzzPick(in, 700), wide);
+    }
+
+    //nudge the last digit of the mantissa
+    last = strpbrk(str, "e");
+    last = last ? (last - 1) : (str + strlen(str) - 1);
+    switch(FuzzPick(in, 3)){
+        case 0:
+            if((*last >= '1') && (*last <= '9')){
+                (*last)--;
+            }
+            break;
+        case 1:
+            if((*last >= '0') && (*last <= '8')){
+                (*last)++;
+            }
+            break;
+        default:
+            break;
+    }
+
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size){
+
+    static char text[MAX_STR];
+    tFuzzIn in;
+    size_t len;
+
+    FuzzStart(&in, data, size);
+
+    switch(FuzzPick(&in, 3)){
+        case 0:
+            FuzzString(&in, text, 48, g_pcNum, sizeof(g_pcNum) - 1);
+            break;
+        case 1:
+            MakeNumber(&in, text);
+            break;
+        default:
+            MakeHalfway(&in, text);
+            break;
+    }
+
+    len = strlen(text);
+
+    for(size_t offset = 0; offset < 4; offset += 3){
+
+        char *str = malloc(offset + len + 1);
+        const char *uend;
+        char *cend;
+        union { float f; uint32_t u; } uf, cf;
+        union { double d; uint64_t u; } ud, cd;
+        bool skip;
+
+        memcpy(str + offset, text, len + 1);
+
+        //strtof and strtod would skip the newline too
+        skip = str[offset + strspn(text, " \t")] == '\n';
+
+        uf.f = ustrtof(str + offset, &uend);
+        cf.f = skip ? 0.0f : strtof(str + offset, &cend);
+        if(skip){
+            cend = str + offset;
+        }
+
+        if(((uf.u != cf.u) && !(isnan(uf.f) && isnan(cf.f))) ||
+           (uend != cend)){
+            FUZZ_FAIL("ustrtof(\"%s\") gave %a(%08x) end %td, expected "
+                      "%a(%08x) end %td", text, uf.f, uf.u,
+                      uend - (str + offset), cf.f, cf.u,
+                      cend - (str + offset));
+        }
+
+        ud.d = ustrtod(str + offset, &uend);
+        cd.d = skip ? 0.0 : strtod(str + offset, &cend);
+        if(skip){
+            cend = str + offset;
+        }
+
+        if(((ud.u != cd.u) && !(isnan(ud.d) && isnan(cd.d))) ||
+           (uend != cend)){
+            FUZZ_FAIL("ustrtod(\"%s\") gave %a end %td, expected %a end %td",
+                      text, ud.d, uend - (str + offset), cd.d,
+                      cend - (str + offset));
+        }
+
+        free(str);
+
+    }
+
+    return 0;
+
+}
@@ -0,0 +1,132 @@
+/*
+ * Name: fuzz_strtoul.c
+ * Author: Marquez Jones
+ * Desc: Differential fuzz target for ustrtoul against strtoul
+ *
+ * Notes: the string is placed at every alignment so the word at a
+ *        time paths start at each offset, and it ends the heap block
+ *        so a read past the word that holds its end is caught by ASan
+ *        in the byte build
+ *
+ *        The reference follows the documented ustdlib differences:
+ *        - only spaces and tabs are skipped before the number
+ *        - bases are 0 and 2 to 16
+ *        - a "0x" with no hex digit after it is not a number, the C
+ *          library takes the 0
+ *
+ *        unsigned long is 64 bits on the host, so overflow is checked
+ *        at 2^64 here rather than 2^32 as on the target
+ */
+
+#include <string.h>
+
+#include "fuzz.h"
+#include "utils/ustdlib.h"
+
+//longest string
+#define MAX_STR     48
+
+//characters numbers are made of, plus a few that end them
+static const char g_pcNum[] = "0123456789abcdefABCDEFxX+- \tgz.\n";
+
+/*
+ * Desc: true for a hex digit
+ */
+static bool IsHex(char ch){
+
+    return ((ch >= '0') && (ch <= '9')) || (((ch | 0x20) >= 'a') &&
+                                            ((ch | 0x20) <= 'f'));
+
+}
+
+/*
+ * Desc: strtoul with the ustdlib differences applied
+ */
+static unsigned long RefStrtoul(const char *str, const char **end, int base){
+
+    const char *ptr = str;
+    char *cend;
+    unsigned long value;
+
+    while((*ptr == ' ') || (*ptr == '\t')){
+        ptr++;
+    }
+
+    //strtoul would skip the newline too
+    if(*ptr == '\n'){
+        *end = str;
+        return 0;
+    }
+
+    if((*ptr == '+') || (*ptr == '-')){
+        ptr++;
+    }
+
+    //strtoul takes the 0 of a bare 0x
+    if(((base == 0) || (base == 16)) && (ptr[0] == '0') &&
+       ((ptr[1] | 0x20) == 'x') && !IsHex(ptr[2])){
+        *end = str;
+        return 0;
+    }
+
+    value = strtoul(str, &cend, base);
+    *end = cend;
+
+    return value;
+
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size){
+
+    static const int pi32Base[] = { 0, 2, 8, 10, 16, 3, 7, 13 };
+    char text[MAX_STR];
+    tFuzzIn in;
+    size_t len;
+    int base;
+
+    FuzzStart(&in, data, size);
+
+    base = pi32Base[FuzzPick(&in, 8)];
+
+    //mostly digits of the base so the fast paths get long runs
+    if(FuzzPick(&in, 2)){
+        len = FuzzString(&in, text, sizeof(text), g_pcNum,
+                         sizeof(g_pcNum) - 1);
+    }
+    else{
+        len = FuzzString(&in, text, sizeof(text), g_pcNum,
+                         (base == 16 || base == 0) ? 22 : 10);
+    }
+
+    for(size_t offset = 0; offset < 4; offset++){
+
+        char *str = malloc(offset + len + 1);
+        const char *uend;
+        const char *cend;
+        unsigned long uvalue;
+        unsigned long cvalue;
+
+        memcpy(str + offset, text, len + 1);
+
+        uvalue = ustrtoul(str + offset, &uend, base);
+        cvalue = RefStrtoul(str + offset, &cend, base);
+
+        if((uvalue != cvalue) || (uend != cend)){
+            FUZZ_FAIL("ustrtoul(\"%s\", %d) at +%zu gave %lu end %td, "
+                      "expected %lu end %td", text, base, offset, uvalue,
+                      uend - (str + offset), cvalue, cend - (str + offset));
+        }
+
+        //a null endptr is allowed
+        if(ustrtoul(str + offset, 0, base) != uvalue){
+            FUZZ_FAIL("ustrtoul(\"%s\", %d) changed without endptr", text,
+                      base);
+        }
+
+        free(str);
+
+    }
+
+    return 0;
+
+}
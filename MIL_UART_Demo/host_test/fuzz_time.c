@@ -0,0 +1,136 @@
+/*
+ * Name: fuzz_time.c
+ * Author: Marquez Jones
+ * Desc: Differential fuzz target for ulocaltime, ulocaltime64,
+ *       utimetick, umktime and umktime64 against gmtime_r and timegm
+ *
+ * Notes: times are mostly near the 32 bit range, where ulocaltime64
+ *        takes its 32 bit path, and otherwise up to a few million
+ *        years either side of 1970. umktime gets fields well outside
+ *        their usual ranges to check the carrying
+ *
+ *        time_t is 64 bits on the host, so umktime never returns its
+ *        (time_t)-1 for a time past 32 bits here, it is only checked
+ *        against umktime64
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "fuzz.h"
+#include "utils/ustdlib.h"
+
+//most seconds either side of 1970, about 3 million years
+#define MAX_SECS    100000000000000LL
+
+/*
+ * Desc: true if the fields ulocaltime fills in match
+ */
+static bool SameTime(const struct tm *a, const struct tm *b){
+
+    return (a->tm_sec == b->tm_sec) && (a->tm_min == b->tm_min) &&
+           (a->tm_hour == b->tm_hour) && (a->tm_mday == b->tm_mday) &&
+           (a->tm_mon == b->tm_mon) && (a->tm_year == b->tm_year) &&
+           (a->tm_wday == b->tm_wday) && (a->tm_yday == b->tm_yday);
+
+}
+
+/*
+ * Desc: picks a field, mostly in range and sometimes far out of it
+ */
+static int PickField(tFuzzIn *in, int range){
+
+    switch(FuzzPick(in, 4)){
+        case 0:
+            return (int)(FuzzU32(in) % 20001) - 10000;
+        case 1:
+            return (int)FuzzPick(in, 3) - 1 + (FuzzPick(in, 2) ? range : 0);
+        default:
+            return (int)(FuzzU32(in) % (uint32_t)range);
+    }
+
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size){
+
+    struct tm utm, ctm;
+    tFuzzIn in;
+    int64_t secs;
+    time_t ctime;
+
+    FuzzStart(&in, data, size);
+
+    //seconds to calendar
+    switch(FuzzPick(&in, 3)){
+        case 0:
+            secs = (int64_t)(int32_t)FuzzU32(&in);
+            break;
+        case 1:
+            secs = (int64_t)FuzzU32(&in) + (int64_t)FuzzPick(&in, 3) - 1;
+            break;
+        default:
+            secs = (int64_t)(FuzzU64(&in) % (2 * MAX_SECS)) - MAX_SECS;
+            break;
+    }
+
+    ctime = (time_t)secs;
+    gmtime_r(&ctime, &ctm);
+
+    memset(&utm, 0x55, sizeof(utm));
+    ulocaltime64(secs, &utm);
+    if(!SameTime(&utm, &ctm)){
+        FUZZ_FAIL("ulocaltime64(%lld) gave %d-%02d-%02d %02d:%02d:%02d "
+                  "wday %d yday %d", (long long)secs, utm.tm_year + 1900,
+                  utm.tm_mon + 1, utm.tm_mday, utm.tm_hour, utm.tm_min,
+                  utm.tm_sec, utm.tm_wday, utm.tm_yday);
+    }
+
+    memset(&utm, 0x55, sizeof(utm));
+    ulocaltime(ctime, &utm);
+    if(!SameTime(&utm, &ctm)){
+        FUZZ_FAIL("ulocaltime(%lld)", (long long)secs);
+    }
+
+    //and back
+    if(umktime64(&utm) != secs){
+        FUZZ_FAIL("umktime64 of ulocaltime64(%lld) gave %lld",
+                  (long long)secs, (long long)umktime64(&utm));
+    }
+
+    //one second on
+    ctime++;
+    gmtime_r(&ctime, &ctm);
+    utimetick(&utm);
+    if(!SameTime(&utm, &ctm)){
+        FUZZ_FAIL("utimetick after %lld", (long long)secs);
+    }
+
+    //calendar to seconds, fields out of range carry
+    memset(&utm, 0, sizeof(utm));
+    utm.tm_year = PickField(&in, 200);
+    utm.tm_mon = PickField(&in, 12);
+    utm.tm_mday = PickField(&in, 31) + 1;
+    utm.tm_hour = PickField(&in, 24);
+    utm.tm_min = PickField(&in, 60);
+    utm.tm_sec = PickField(&in, 60);
+    utm.tm_wday = PickField(&in, 7);
+    utm.tm_yday = PickField(&in, 366);
+    ctm = utm;
+
+    secs = umktime64(&utm);
+    ctime = timegm(&ctm);
+
+    if(secs != (int64_t)ctime){
+        FUZZ_FAIL("umktime64(year %d mon %d mday %d %d:%d:%d) gave %lld, "
+                  "expected %lld", utm.tm_year, utm.tm_mon, utm.tm_mday,
+                  utm.tm_hour, utm.tm_min, utm.tm_sec, (long long)secs,
+                  (long long)ctime);
+    }
+
+    if(umktime(&utm) != (time_t)secs){
+        FUZZ_FAIL("umktime and umktime64 differ");
+    }
+
+    return 0;
+
+}
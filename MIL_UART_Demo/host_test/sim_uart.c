@@ -0,0 +1,660 @@
+/*
+ * Name: sim_uart.c
+ * Author: Marquez Jones
+ * Desc: Cycle counted model of the TM4C123 UARTs, NVIC and DWT cycle
+ *       counter(see sim_uart.h)
+ *
+ * Notes: every driverlib call first moves the clock on, which runs the
+ *        shifters and timers up to then, and takes any interrupt that
+ *        is due. Calls that can make one due(a pend, an enable) look
+ *        again when they are done
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_uart.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/uart.h"
+#include "utils/uartstdio.h"
+
+#include "sim_uart.h"
+
+//core registers
+#define DWT_CTRL        0xE0001000
+#define DWT_CYCCNT      0xE0001004
+#define DEMCR           0xE000EDFC
+#define DEMCR_TRCENA    0x01000000
+#define DWT_CYCCNTENA   0x00000001
+
+#define FIFO_DEPTH      16
+#define NUM_PORTS       3
+
+/*
+ * Desc: one UART and its NVIC line
+ */
+typedef struct {
+    uint32_t base;
+    uint32_t irq;
+    void (*vector)(void);
+    bool console;               //writes to stdout, no wire
+    bool enabled;               //UARTEnable
+    bool irq_enabled;           //IntEnable
+    bool pend;                  //IntPendSet
+    uint32_t ctl;               //UARTCTL, only LBE does anything
+    uint32_t unit;              //parts of a clock the times below are in
+    uint32_t byte_time;         //10 bit times
+    uint32_t timeout_time;      //32 bit times
+    uint32_t shift_part;        //what the last byte left over of a clock
+    uint32_t tx_trigger;        //TX interrupt at or below, bytes
+    uint32_t rx_trigger;        //RX interrupt at or above, bytes
+    uint32_t im;
+    uint32_t ris;
+    uint32_t rsr;
+    uint8_t tx[FIFO_DEPTH];
+    uint32_t tx_read;
+    uint32_t tx_count;
+    uint8_t rx[FIFO_DEPTH];
+    uint32_t rx_read;
+    uint32_t rx_count;
+    bool shifting;
+    uint8_t shift;
+    uint64_t shift_done;
+    bool timeout_armed;
+    uint64_t timeout_at;
+} tSimUART;
+
+/*******************************GLOBALS******************************/
+
+static tSimUART g_psSimUART[NUM_PORTS] = {
+    { .base = UART0_BASE, .irq = INT_UART0, .vector = UARTStdio0IntHandler },
+    { .base = UART1_BASE, .irq = INT_UART1, .vector = UARTStdio1IntHandler },
+    { .base = UART2_BASE, .irq = INT_UART2, .vector = UARTStdio2IntHandler },
+};
+
+//CPU clocks since reset
+static uint64_t g_ui64Now;
+
+//PRIMASK, and true while a handler runs(no nesting)
+static bool g_bMasked;
+static bool g_bInHandler;
+
+//core registers HWREG can reach
+static volatile uint32_t g_ui32DWTCtrl;
+static volatile uint32_t g_ui32DWTCyccnt;
+static volatile uint32_t g_ui32DEMCR;
+
+/******************************HELPERS******************************/
+
+/*
+ * Desc: stops the run on something the model doesn't cover
+ */
+static void Unmodelled(const char *what, uint32_t value){
+
+    fprintf(stderr, "sim_uart: %s 0x%08x isn't modelled\n", what,
+            (unsigned)value);
+    abort();
+
+}
+
+/*
+ * Desc: UART at a base address
+ */
+static tSimUART *Port(uint32_t base){
+
+    for(uint32_t port = 0; port < NUM_PORTS; port++){
+        if(g_psSimUART[port].base == base){
+            return &g_psSimUART[port];
+        }
+    }
+
+    Unmodelled("UART base", base);
+
+    return 0;
+
+}
+
+/*
+ * Desc: UART on an interrupt number
+ */
+static tSimUART *Irq(uint32_t irq){
+
+    for(uint32_t port = 0; port < NUM_PORTS; port++){
+        if(g_psSimUART[port].irq == irq){
+            return &g_psSimUART[port];
+        }
+    }
+
+    Unmodelled("interrupt", irq);
+
+    return 0;
+
+}
+
+/*
+ * Desc: loads the shifter from the TX FIFO if it is idle
+ *
+ * Inputs: UART, time the shifter is free from
+ */
+static void TxStart(tSimUART *uart, uint64_t when){
+
+    uint32_t before = uart->tx_count;
+
+    if(uart->shifting || !uart->enabled || (uart->tx_count == 0)){
+        return;
+    }
+
+    uart->shift = uart->tx[uart->tx_read];
+    uart->tx_read = (uart->tx_read + 1) % FIFO_DEPTH;
+    uart->tx_count--;
+    uart->shifting = true;
+
+    //a byte time isn't a whole number of clocks, carry the part over
+    uart->shift_part += uart->byte_time;
+    uart->shift_done = when + (uart->shift_part / uart->unit);
+    uart->shift_part %= uart->unit;
+
+    //the trigger fires on the way down through the level
+    if((before > uart->tx_trigger) && (uart->tx_count <= uart->tx_trigger)){
+        uart->ris |= UART_INT_TX;
+    }
+
+}
+
+/*
+ * Desc: a byte arriving from the wire
+ *
+ * Inputs: UART, byte, time its stop bit ended
+ */
+static void RxPush(tSimUART *uart, uint8_t data, uint64_t when){
+
+    if(uart->rx_count == FIFO_DEPTH){
+        uart->rsr |= UART_RXERROR_OVERRUN;
+        uart->ris |= UART_INT_OE;
+    }
+    else{
+        uart->rx[(uart->rx_read + uart->rx_count) % FIFO_DEPTH] = data;
+        uart->rx_count++;
+    }
+
+    if(uart->rx_count >= uart->rx_trigger){
+        uart->ris |= UART_INT_RX;
+    }
+
+    uart->timeout_armed = true;
+    uart->timeout_at = when + (uart->timeout_time / uart->unit);
+
+}
+
+/*
+ * Desc: runs a UART's shifter and receive timeout up to a time
+ */
+static void Run(tSimUART *uart, uint64_t until){
+
+    for(;;){
+
+        if(uart->shifting && (uart->shift_done <= until) &&
+           (!uart->timeout_armed || (uart->shift_done <= uart->timeout_at))){
+
+            uart->shifting = false;
+
+            if(uart->ctl & UART_CTL_LBE){
+                RxPush(uart, uart->shift, uart->shift_done);
+            }
+
+            TxStart(uart, uart->shift_done);
+
+        }
+        else if(uart->timeout_armed && (uart->timeout_at <= until)){
+
+            uart->timeout_armed = false;
+
+            if(uart->rx_count){
+                uart->ris |= UART_INT_RT;
+            }
+
+        }
+        else{
+            break;
+        }
+
+    }
+
+}
+
+/*
+ * Desc: moves the clock on, the UARTs follow
+ */
+static void Advance(uint32_t cycles){
+
+    g_ui64Now += cycles;
+
+    for(uint32_t port = 0; port < NUM_PORTS; port++){
+        Run(&g_psSimUART[port], g_ui64Now);
+    }
+
+}
+
+/*
+ * Desc: takes the interrupts that are due, lowest port first, until
+ *       none are
+ */
+static void Dispatch(void){
+
+    bool taken;
+
+    if(g_bInHandler){
+        return;
+    }
+
+    do{
+
+        taken = false;
+
+        for(uint32_t port = 0; port < NUM_PORTS; port++){
+
+            tSimUART *uart = &g_psSimUART[port];
+
+            if(g_bMasked || !uart->irq_enabled ||
+               !(uart->pend || (uart->ris & uart->im))){
+                continue;
+            }
+
+            if(!uart->vector){
+                Unmodelled("vector of interrupt", uart->irq);
+            }
+
+            uart->pend = false;
+            g_bInHandler = true;
+
+            Advance(SIM_IRQ_CYCLES);
+            uart->vector();
+            Advance(SIM_IRQ_CYCLES);
+
+            g_bInHandler = false;
+            taken = true;
+
+        }
+
+    }while(taken);
+
+}
+
+/*
+ * Desc: charges a hardware access and takes what is due
+ */
+static void Touch(uint32_t cycles){
+
+    Advance(cycles);
+    Dispatch();
+
+}
+
+/******************************HARNESS******************************/
+
+void SimConsole(uint32_t port){
+
+    if(port >= NUM_PORTS){
+        Unmodelled("UART port", port);
+    }
+
+    g_psSimUART[port].console = true;
+
+}
+
+uint64_t SimCycles(void){
+
+    return g_ui64Now;
+
+}
+
+/******************************REGISTERS******************************/
+
+volatile uint32_t *SimReg(uint32_t ui32Addr){
+
+    Touch(SIM_REG_CYCLES);
+
+    switch(ui32Addr){
+
+        case DWT_CYCCNT:
+            if((g_ui32DEMCR & DEMCR_TRCENA) &&
+               (g_ui32DWTCtrl & DWT_CYCCNTENA)){
+                g_ui32DWTCyccnt = (uint32_t)g_ui64Now;
+            }
+            return &g_ui32DWTCyccnt;
+
+        case DWT_CTRL:
+            return &g_ui32DWTCtrl;
+
+        case DEMCR:
+            return &g_ui32DEMCR;
+
+        default:
+            break;
+
+    }
+
+    for(uint32_t port = 0; port < NUM_PORTS; port++){
+        if(ui32Addr == (g_psSimUART[port].base + UART_O_CTL)){
+            return &g_psSimUART[port].ctl;
+        }
+    }
+
+    Unmodelled("register", ui32Addr);
+
+    return 0;
+
+}
+
+/******************************NVIC******************************/
+
+bool IntMasterEnable(void){
+
+    bool masked = g_bMasked;
+
+    Touch(SIM_CALL_CYCLES);
+    g_bMasked = false;
+    Dispatch();
+
+    return masked;
+
+}
+
+bool IntMasterDisable(void){
+
+    bool masked = g_bMasked;
+
+    Touch(SIM_CALL_CYCLES);
+    g_bMasked = true;
+
+    return masked;
+
+}
+
+void IntEnable(uint32_t ui32Interrupt){
+
+    Touch(SIM_CALL_CYCLES);
+    Irq(ui32Interrupt)->irq_enabled = true;
+    Dispatch();
+
+}
+
+void IntDisable(uint32_t ui32Interrupt){
+
+    Touch(SIM_CALL_CYCLES);
+    Irq(ui32Interrupt)->irq_enabled = false;
+
+}
+
+void IntPendSet(uint32_t ui32Interrupt){
+
+    Touch(SIM_CALL_CYCLES);
+    Irq(ui32Interrupt)->pend = true;
+    Dispatch();
+
+}
+
+/******************************SYSCTL******************************/
+
+bool SysCtlPeripheralPresent(uint32_t ui32Peripheral){
+
+    Touch(SIM_CALL_CYCLES);
+
+    return (ui32Peripheral == SYSCTL_PERIPH_UART0) ||
+           (ui32Peripheral == SYSCTL_PERIPH_UART1) ||
+           (ui32Peripheral == SYSCTL_PERIPH_UART2);
+
+}
+
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral){
+
+    (void)ui32Peripheral;
+
+    Touch(SIM_CALL_CYCLES);
+
+}
+
+/******************************UART******************************/
+
+void UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk,
+                         uint32_t ui32Baud, uint32_t ui32Config){
+
+    tSimUART *uart = Port(ui32Base);
+    uint32_t div;
+
+    //8N1 is all uartstdio asks for
+    (void)ui32Config;
+
+    Touch(SIM_CALL_CYCLES);
+
+    //bit time as the baud divisor gives it, in 64ths of 16 clocks or
+    //of 8 in high speed mode, like driverlib works it out
+    uart->unit = 4;
+
+    if((ui32Baud * 16) > ui32UARTClk){
+        ui32UARTClk /= 2;
+        uart->unit = 8;
+    }
+
+    div = (((ui32UARTClk * 8) / ui32Baud) + 1) / 2;
+
+    uart->byte_time = div * 10;
+    uart->timeout_time = div * 32;
+    uart->shift_part = 0;
+
+}
+
+void UARTFIFOLevelSet(uint32_t ui32Base, uint32_t ui32TxLevel,
+                      uint32_t ui32RxLevel){
+
+    static const uint32_t pui32Eighths[] = { 1, 2, 4, 6, 7 };
+    tSimUART *uart = Port(ui32Base);
+
+    Touch(SIM_CALL_CYCLES);
+
+    uart->tx_trigger = pui32Eighths[ui32TxLevel] * FIFO_DEPTH / 8;
+    uart->rx_trigger = pui32Eighths[ui32RxLevel >> 3] * FIFO_DEPTH / 8;
+
+}
+
+void UARTEnable(uint32_t ui32Base){
+
+    tSimUART *uart = Port(ui32Base);
+
+    Touch(SIM_CALL_CYCLES);
+
+    uart->enabled = true;
+    TxStart(uart, g_ui64Now);
+
+}
+
+void UARTDisable(uint32_t ui32Base){
+
+    tSimUART *uart = Port(ui32Base);
+
+    Touch(SIM_CALL_CYCLES);
+
+    //turning the FIFOs off empties them
+    uart->enabled = false;
+    uart->shifting = false;
+    uart->timeout_armed = false;
+    uart->tx_count = 0;
+    uart->rx_count = 0;
+    uart->ris = 0;
+
+}
+
+bool UARTCharsAvail(uint32_t ui32Base){
+
+    tSimUART *uart = Port(ui32Base);
+
+    Touch(SIM_CALL_CYCLES);
+
+    return uart->rx_count != 0;
+
+}
+
+bool UARTSpaceAvail(uint32_t ui32Base){
+
+    tSimUART *uart = Port(ui32Base);
+
+    Touch(SIM_CALL_CYCLES);
+
+    return uart->console || (uart->tx_count < FIFO_DEPTH);
+
+}
+
+int32_t UARTCharGetNonBlocking(uint32_t ui32Base){
+
+    tSimUART *uart = Port(ui32Base);
+    uint8_t data;
+
+    Touch(SIM_CALL_CYCLES);
+
+    if(uart->rx_count == 0){
+        return -1;
+    }
+
+    data = uart->rx[uart->rx_read];
+    uart->rx_read = (uart->rx_read + 1) % FIFO_DEPTH;
+    uart->rx_count--;
+
+    return data;
+
+}
+
+int32_t UARTCharGet(uint32_t ui32Base){
+
+    int32_t data;
+
+    //nothing ever arrives on a console
+    if(Port(ui32Base)->console){
+        Unmodelled("console input on UART", ui32Base);
+    }
+
+    while((data = UARTCharGetNonBlocking(ui32Base)) < 0);
+
+    return data;
+
+}
+
+bool UARTCharPutNonBlocking(uint32_t ui32Base, unsigned char ucData){
+
+    tSimUART *uart = Port(ui32Base);
+
+    Touch(SIM_CALL_CYCLES);
+
+    if(uart->console){
+        if(ucData != '\r'){
+            putchar(ucData);
+        }
+        return true;
+    }
+
+    if(uart->tx_count == FIFO_DEPTH){
+        return false;
+    }
+
+    uart->tx[(uart->tx_read + uart->tx_count) % FIFO_DEPTH] = ucData;
+    uart->tx_count++;
+    TxStart(uart, g_ui64Now);
+
+    return true;
+
+}
+
+void UARTCharPut(uint32_t ui32Base, unsigned char ucData){
+
+    while(!UARTCharPutNonBlocking(ui32Base, ucData));
+
+}
+
+void UARTIntRegister(uint32_t ui32Base, void (*pfnHandler)(void)){
+
+    tSimUART *uart = Port(ui32Base);
+
+    Touch(SIM_CALL_CYCLES);
+
+    //driverlib enables the interrupt along with the handler
+    uart->vector = pfnHandler;
+    uart->irq_enabled = true;
+    Dispatch();
+
+}
+
+void UARTIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags){
+
+    tSimUART *uart = Port(ui32Base);
+
+    Touch(SIM_CALL_CYCLES);
+
+    uart->im |= ui32IntFlags;
+    Dispatch();
+
+}
+
+void UARTIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags){
+
+    tSimUART *uart = Port(ui32Base);
+
+    Touch(SIM_CALL_CYCLES);
+
+    uart->im &= ~ui32IntFlags;
+
+}
+
+uint32_t UARTIntStatus(uint32_t ui32Base, bool bMasked){
+
+    tSimUART *uart = Port(ui32Base);
+
+    Touch(SIM_CALL_CYCLES);
+
+    return bMasked ? (uart->ris & uart->im) : uart->ris;
+
+}
+
+void UARTIntClear(uint32_t ui32Base, uint32_t ui32IntFlags){
+
+    tSimUART *uart = Port(ui32Base);
+
+    Touch(SIM_CALL_CYCLES);
+
+    uart->ris &= ~ui32IntFlags;
+
+}
+
+uint32_t UARTRxErrorGet(uint32_t ui32Base){
+
+    tSimUART *uart = Port(ui32Base);
+
+    Touch(SIM_CALL_CYCLES);
+
+    return uart->rsr;
+
+}
+
+void UARTRxErrorClear(uint32_t ui32Base){
+
+    tSimUART *uart = Port(ui32Base);
+
+    Touch(SIM_CALL_CYCLES);
+
+    uart->rsr = 0;
+
+}
+
+void UARTLoopbackEnable(uint32_t ui32Base){
+
+    tSimUART *uart = Port(ui32Base);
+
+    Touch(SIM_CALL_CYCLES);
+
+    uart->ctl |= UART_CTL_LBE;
+
+}
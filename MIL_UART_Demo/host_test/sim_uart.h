@@ -0,0 +1,63 @@
+/*
+ * Name: sim_uart.h
+ * Author: Marquez Jones
+ * Desc: Cycle counted model of the TM4C123 UARTs, NVIC and DWT cycle
+ *       counter, enough to run uartstdio.c(UART_BUFFERED) and
+ *       MIL_UARTBench.c on the host
+ *
+ * Model: time is a count of CPU clocks that only moves when the code
+ *        touches the hardware,
+ *        - a driverlib call(stubs/driverlib) costs SIM_CALL_CYCLES
+ *        - an HWREG access(stubs/inc/hw_types.h) costs SIM_REG_CYCLES,
+ *          a read of DWT_CYCCNT returns the clock
+ *        - interrupt entry and exit cost SIM_IRQ_CYCLES each
+ *        C code between those is free, so cycle counts, the ISR ones
+ *        most of all, are an estimate. Anything timed against the wire
+ *        (throughput, latency, the overrun point) is exact to a few
+ *        accesses, since the app polls the clock while it waits
+ *
+ *        Each UART has 16 byte TX and RX FIFOs, a shifter that takes
+ *        10 bit times(8N1) per byte at the rate the baud divisor
+ *        really gives(3000000 at 80MHz is 0.3% slow), and internal
+ *        loopback through the LBE bit of UARTCTL. Interrupts,
+ *        - TX when a byte leaves the TX FIFO and takes it from above
+ *          to at or below the trigger level
+ *        - RX when a byte arrives and the RX FIFO is at or above the
+ *          trigger level
+ *        - RT 32 bit times after the last byte arrived, if the RX
+ *          FIFO isn't empty by then
+ *        - a byte arriving at a full RX FIFO is lost and sets the
+ *          overrun error
+ *        The NVIC takes an interrupt whenever the core touches the
+ *        hardware with interrupts unmasked, one at a time, for a
+ *        pend(IntPendSet) or as long as the UART's masked status is
+ *        set. The vectors start out as UARTStdio0-2IntHandler and
+ *        UARTIntRegister replaces them
+ *
+ * Notes: a console port(SimConsole) has no wire, what is written to
+ *        it goes straight to stdout without the CRs
+ */
+
+#ifndef SIM_UART_H_
+#define SIM_UART_H_
+
+#include <stdint.h>
+
+//clocks charged per hardware access
+#define SIM_CALL_CYCLES     10
+#define SIM_REG_CYCLES      4
+#define SIM_IRQ_CYCLES      12
+
+/*
+ * Desc: makes a UART write to stdout
+ *
+ * Inputs: UART port(0-2)
+ */
+void SimConsole(uint32_t port);
+
+/*
+ * Desc: CPU clocks so far
+ */
+uint64_t SimCycles(void);
+
+#endif /* SIM_UART_H_ */
@@ -0,0 +1,25 @@
+/*
+ * Name: debug.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare driverlib/debug.h
+ *
+ * Notes: ASSERT is always checked here and aborts, so a fuzz input
+ *        that breaks an argument contract shows up as a crash
+ */
+
+#ifndef __DRIVERLIB_DEBUG_H__
+#define __DRIVERLIB_DEBUG_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ASSERT(expr)                                                    \
+    do{                                                                 \
+        if(!(expr)){                                                    \
+            fprintf(stderr, "%s:%d: ASSERT(%s)\n", __FILE__, __LINE__,  \
+                    #expr);                                             \
+            abort();                                                    \
+        }                                                               \
+    }while(0)
+
+#endif // __DRIVERLIB_DEBUG_H__
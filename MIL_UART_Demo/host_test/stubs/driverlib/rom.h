@@ -0,0 +1,11 @@
+/*
+ * Name: rom.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare driverlib/rom.h, there is no ROM
+ *       on the host so nothing is defined and MAP_ goes to the calls
+ */
+
+#ifndef __DRIVERLIB_ROM_H__
+#define __DRIVERLIB_ROM_H__
+
+#endif // __DRIVERLIB_ROM_H__
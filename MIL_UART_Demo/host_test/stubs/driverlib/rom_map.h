@@ -0,0 +1,33 @@
+/*
+ * Name: rom_map.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare driverlib/rom_map.h, every MAP_
+ *       call uartstdio.c makes goes to the model in sim_uart.c
+ */
+
+#ifndef __DRIVERLIB_ROM_MAP_H__
+#define __DRIVERLIB_ROM_MAP_H__
+
+#define MAP_IntMasterEnable             IntMasterEnable
+#define MAP_IntMasterDisable            IntMasterDisable
+#define MAP_IntEnable                   IntEnable
+#define MAP_IntDisable                  IntDisable
+#define MAP_IntPendSet                  IntPendSet
+#define MAP_SysCtlPeripheralPresent     SysCtlPeripheralPresent
+#define MAP_SysCtlPeripheralEnable      SysCtlPeripheralEnable
+#define MAP_UARTConfigSetExpClk         UARTConfigSetExpClk
+#define MAP_UARTFIFOLevelSet            UARTFIFOLevelSet
+#define MAP_UARTEnable                  UARTEnable
+#define MAP_UARTDisable                 UARTDisable
+#define MAP_UARTCharsAvail              UARTCharsAvail
+#define MAP_UARTSpaceAvail              UARTSpaceAvail
+#define MAP_UARTCharGetNonBlocking      UARTCharGetNonBlocking
+#define MAP_UARTCharGet                 UARTCharGet
+#define MAP_UARTCharPutNonBlocking      UARTCharPutNonBlocking
+#define MAP_UARTCharPut                 UARTCharPut
+#define MAP_UARTIntEnable               UARTIntEnable
+#define MAP_UARTIntDisable              UARTIntDisable
+#define MAP_UARTIntStatus               UARTIntStatus
+#define MAP_UARTIntClear                UARTIntClear
+
+#endif // __DRIVERLIB_ROM_MAP_H__
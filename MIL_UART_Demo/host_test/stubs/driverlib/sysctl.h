@@ -0,0 +1,20 @@
+/*
+ * Name: sysctl.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare driverlib/sysctl.h, the UARTs only
+ */
+
+#ifndef __DRIVERLIB_SYSCTL_H__
+#define __DRIVERLIB_SYSCTL_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SYSCTL_PERIPH_UART0     0xf0001800
+#define SYSCTL_PERIPH_UART1     0xf0001801
+#define SYSCTL_PERIPH_UART2     0xf0001802
+
+extern bool SysCtlPeripheralPresent(uint32_t ui32Peripheral);
+extern void SysCtlPeripheralEnable(uint32_t ui32Peripheral);
+
+#endif // __DRIVERLIB_SYSCTL_H__
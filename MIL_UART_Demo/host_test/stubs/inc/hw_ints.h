@@ -0,0 +1,14 @@
+/*
+ * Name: hw_ints.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare inc/hw_ints.h, the UARTs only
+ */
+
+#ifndef __HW_INTS_H__
+#define __HW_INTS_H__
+
+#define INT_UART0               21
+#define INT_UART1               22
+#define INT_UART2               49
+
+#endif // __HW_INTS_H__
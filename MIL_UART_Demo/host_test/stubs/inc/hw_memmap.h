@@ -0,0 +1,14 @@
+/*
+ * Name: hw_memmap.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare inc/hw_memmap.h, the UARTs only
+ */
+
+#ifndef __HW_MEMMAP_H__
+#define __HW_MEMMAP_H__
+
+#define UART0_BASE              0x4000C000
+#define UART1_BASE              0x4000D000
+#define UART2_BASE              0x4000E000
+
+#endif // __HW_MEMMAP_H__
@@ -0,0 +1,21 @@
+/*
+ * Name: hw_types.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare inc/hw_types.h
+ *
+ * Notes: HWREG goes through SimReg(sim_uart.c), which charges the
+ *        access to the simulated clock and hands back the register,
+ *        so polling DWT_CYCCNT lets time and the UARTs move on
+ */
+
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+volatile uint32_t *SimReg(uint32_t ui32Addr);
+
+#define HWREG(x)                (*SimReg((uint32_t)(x)))
+
+#endif // __HW_TYPES_H__
@@ -0,0 +1,16 @@
+/*
+ * Name: hw_uart.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare inc/hw_uart.h, the registers the
+ *       demo touches directly
+ */
+
+#ifndef __HW_UART_H__
+#define __HW_UART_H__
+
+#define UART_O_DR               0x00000000
+#define UART_O_CTL              0x00000030
+
+#define UART_CTL_LBE            0x00000080
+
+#endif // __HW_UART_H__
@@ -0,0 +1,8 @@
+/*
+ * Name: uartstdio.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare utils/uartstdio.h, the demo's own
+ *       copy is the one under test
+ */
+
+#include "../../../uartstdio.h"
@@ -0,0 +1,8 @@
+/*
+ * Name: ustdlib.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare utils/ustdlib.h, the demo's own
+ *       copy is the one under test
+ */
+
+#include "../../../ustdlib.h"
@@ -0,0 +1,463 @@
+/*
+ * Name: test_cobs.c
+ * Author: Marquez Jones
+ * Desc: Round trip test of MIL_COBS.c's CRC, encoder and decoder, the
+ *       parts that build without UART_BUFFERED
+ *
+ * Checks: frames are built the way MIL_COBSSend builds them(id,
+ *         payload, CRC big endian), encoded with MIL_COBSEncode and
+ *         compared with a plain reference encoder, then fed through
+ *         MIL_COBSDecodeByte
+ *         - pseudo random payloads of every length, zero heavy
+ *         - frames around the 254 byte COBS block, where the encoded
+ *           length has to hit MIL_COBS_ENCODED_MAX exactly
+ *         - a corrupted frame counts a CRC error and isn't delivered
+ *         - after a dropped byte the decoder loses that frame, after
+ *           a dropped delimiter that frame and the next, and is back
+ *           in step from the following one
+ *         - frames too big for the buffer and too short for a CRC
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MIL_COBS.h"
+
+#define CHECK(cond)                                                    \
+    do{                                                                \
+        if(!(cond)){                                                   \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                   \
+        }                                                              \
+    }while(0)
+
+//largest frame tried, a few COBS blocks long
+#define FRAME_MAX       (3 * 254 + 8)
+
+//decoder buffer for the biggest payload MIL_COBSSend takes
+#define DECODE_SIZE     (MIL_COBS_MAX_PAYLOAD + MIL_COBS_FRAME_OVERHEAD)
+
+//last frame delivered by the decoder
+static uint8_t g_ui8GotId;
+static uint8_t g_pui8Got[FRAME_MAX];
+static uint32_t g_ui32GotLen;
+static uint32_t g_ui32Delivered;
+
+static uint32_t g_ui32Seed = 1;
+
+/**************************************HELPERS********************************************/
+
+/*
+ * Desc: xorshift32, the same sequence on every run
+ */
+static uint32_t Random(void){
+
+    g_ui32Seed ^= g_ui32Seed << 13;
+    g_ui32Seed ^= g_ui32Seed >> 17;
+    g_ui32Seed ^= g_ui32Seed << 5;
+
+    return g_ui32Seed;
+
+}
+
+/*
+ * Desc: decoder callback
+ */
+static void OnFrame(uint8_t id, const uint8_t *payload, uint32_t len){
+
+    CHECK(len <= sizeof(g_pui8Got));
+
+    g_ui8GotId = id;
+    memcpy(g_pui8Got, payload, len);
+    g_ui32GotLen = len;
+    g_ui32Delivered++;
+
+}
+
+/*
+ * Desc: builds a frame as MIL_COBSSend does
+ *
+ * Returns: frame length, payload length + MIL_COBS_FRAME_OVERHEAD
+ */
+static uint32_t BuildFrame(uint8_t *frame, uint8_t id, const uint8_t *payload,
+                           uint32_t len){
+
+    uint16_t crc;
+
+    frame[0] = id;
+    memcpy(&frame[1], payload, len);
+
+    crc = MIL_CRC16(0xFFFF, frame, len + 1);
+    frame[len + 1] = (uint8_t)(crc >> 8);
+    frame[len + 2] = (uint8_t)crc;
+
+    return len + MIL_COBS_FRAME_OVERHEAD;
+
+}
+
+/*
+ * Desc: textbook COBS, one pass per block
+ *
+ * Returns: encoded length
+ */
+static uint32_t RefEncode(uint8_t *dst, const uint8_t *src, uint32_t len){
+
+    uint32_t out = 0;
+    uint32_t idx = 0;
+
+    for(;;){
+
+        uint32_t run = 0;
+
+        while((idx + run < len) && src[idx + run] && (run < 254)){
+            run++;
+        }
+
+        dst[out++] = (uint8_t)(run + 1);
+        memcpy(&dst[out], &src[idx], run);
+        out += run;
+        idx += run;
+
+        //a full block is followed by another code byte, a short one
+        //stands for a zero unless it is the last
+        if(run == 254){
+            continue;
+        }
+
+        if(idx == len){
+            break;
+        }
+
+        idx++;
+
+    }
+
+    return out;
+
+}
+
+/*
+ * Desc: feeds bytes to the decoder
+ */
+static void Feed(tCOBSDecoder *dec, const uint8_t *data, uint32_t len){
+
+    for(uint32_t idx = 0; idx < len; idx++){
+        MIL_COBSDecodeByte(dec, data[idx]);
+    }
+
+}
+
+/*
+ * Desc: encodes a frame, checks it against the reference and the
+ *       bound, and decodes it again
+ */
+static void RoundTrip(tCOBSDecoder *dec, uint8_t id, const uint8_t *payload,
+                      uint32_t len){
+
+    uint8_t frame[FRAME_MAX + MIL_COBS_FRAME_OVERHEAD];
+    uint8_t enc[MIL_COBS_ENCODED_MAX(sizeof(frame))];
+    uint8_t ref[sizeof(enc)];
+    uint32_t frame_len = BuildFrame(frame, id, payload, len);
+    uint32_t enc_len = MIL_COBSEncode(enc, frame, frame_len);
+    uint32_t delivered = g_ui32Delivered;
+
+    CHECK(enc_len <= (MIL_COBS_ENCODED_MAX(frame_len) - 1));
+    CHECK(memchr(enc, 0, enc_len) == 0);
+    CHECK(RefEncode(ref, frame, frame_len) == enc_len);
+    CHECK(memcmp(ref, enc, enc_len) == 0);
+
+    enc[enc_len++] = 0;
+    Feed(dec, enc, enc_len);
+
+    CHECK(g_ui32Delivered == (delivered + 1));
+    CHECK(g_ui8GotId == id);
+    CHECK(g_ui32GotLen == len);
+    CHECK(memcmp(g_pui8Got, payload, len) == 0);
+
+}
+
+/*
+ * Desc: encodes a frame with its delimiter
+ *
+ * Returns: bytes on the wire
+ */
+static uint32_t Wire(uint8_t *wire, uint8_t id, const uint8_t *payload,
+                     uint32_t len){
+
+    uint8_t frame[FRAME_MAX + MIL_COBS_FRAME_OVERHEAD];
+    uint32_t frame_len = BuildFrame(frame, id, payload, len);
+    uint32_t wire_len = MIL_COBSEncode(wire, frame, frame_len);
+
+    wire[wire_len++] = 0;
+
+    return wire_len;
+
+}
+
+/*
+ * Desc: payload of len bytes, a quarter of them zero
+ */
+static void RandomPayload(uint8_t *payload, uint32_t len){
+
+    for(uint32_t idx = 0; idx < len; idx++){
+        payload[idx] = ((Random() & 3) == 0) ? 0 : (uint8_t)Random();
+    }
+
+}
+
+/**************************************CHECKS********************************************/
+
+static void CheckCRC(void){
+
+    static const uint8_t pui8Check[] = "123456789";
+    uint8_t frame[16];
+    uint32_t len = BuildFrame(frame, 0x42, pui8Check, 9);
+
+    //CRC-16/CCITT-FALSE check value
+    CHECK(MIL_CRC16(0xFFFF, pui8Check, 9) == 0x29B1);
+
+    //big endian, so the whole frame comes out 0
+    CHECK(MIL_CRC16(0xFFFF, frame, len) == 0);
+
+}
+
+static void CheckRandom(void){
+
+    tCOBSDecoder sDec;
+    uint8_t pui8Buf[DECODE_SIZE];
+    uint8_t payload[MIL_COBS_MAX_PAYLOAD];
+
+    MIL_COBSDecoderInit(&sDec, pui8Buf, sizeof(pui8Buf), OnFrame);
+
+    for(uint32_t pass = 0; pass < 20; pass++){
+        for(uint32_t len = 0; len <= MIL_COBS_MAX_PAYLOAD; len++){
+            RandomPayload(payload, len);
+            RoundTrip(&sDec, (uint8_t)Random(), payload, len);
+        }
+    }
+
+    //all zero, the id and CRC too
+    memset(payload, 0, sizeof(payload));
+    RoundTrip(&sDec, 0, payload, 0);
+    RoundTrip(&sDec, 0, payload, MIL_COBS_MAX_PAYLOAD);
+
+    CHECK(sDec.crc_errors == 0);
+    CHECK(sDec.framing_errors == 0);
+
+}
+
+static void CheckBlockBoundary(void){
+
+    tCOBSDecoder sDec;
+    uint8_t pui8Buf[FRAME_MAX + MIL_COBS_FRAME_OVERHEAD];
+    uint8_t payload[FRAME_MAX];
+    uint8_t frame[FRAME_MAX + MIL_COBS_FRAME_OVERHEAD];
+    uint8_t enc[MIL_COBS_ENCODED_MAX(sizeof(frame))];
+
+    MIL_COBSDecoderInit(&sDec, pui8Buf, sizeof(pui8Buf), OnFrame);
+
+    //frame lengths 250-260 and 504-514 cross the first and second
+    //254 byte block, every byte non zero is the worst case
+    for(uint32_t frame_len = 250; frame_len <= 514; frame_len++){
+
+        uint32_t len = frame_len - MIL_COBS_FRAME_OVERHEAD;
+
+        if((frame_len > 260) && (frame_len < 504)){
+            continue;
+        }
+
+        for(uint32_t idx = 0; idx < len; idx++){
+            payload[idx] = (uint8_t)(1 + (idx % 255));
+        }
+
+        //a CRC byte can still be zero, move the id until it isn't
+        for(uint8_t id = 1; ; id++){
+            BuildFrame(frame, id, payload, len);
+            if(frame[len + 1] && frame[len + 2]){
+                CHECK(MIL_COBSEncode(enc, frame, frame_len) ==
+                      (MIL_COBS_ENCODED_MAX(frame_len) - 1));
+                RoundTrip(&sDec, id, payload, len);
+                break;
+            }
+        }
+
+        //a zero as the last byte of the first block, then as the
+        //first byte after it(frame byte 254 is payload byte 253)
+        if(len > 254){
+            payload[253 - 1] = 0;
+            RoundTrip(&sDec, 0x55, payload, len);
+            payload[253 - 1] = 1;
+            payload[254 - 1] = 0;
+            RoundTrip(&sDec, 0x55, payload, len);
+        }
+
+    }
+
+    CHECK(sDec.crc_errors == 0);
+    CHECK(sDec.framing_errors == 0);
+
+}
+
+static void CheckCorrupt(void){
+
+    tCOBSDecoder sDec;
+    uint8_t pui8Buf[DECODE_SIZE];
+    uint8_t payload[32];
+    uint8_t wire[MIL_COBS_ENCODED_MAX(sizeof(payload) +
+                                      MIL_COBS_FRAME_OVERHEAD)];
+    uint32_t wire_len;
+
+    MIL_COBSDecoderInit(&sDec, pui8Buf, sizeof(pui8Buf), OnFrame);
+    RandomPayload(payload, sizeof(payload));
+
+    //flip one bit of every non code byte in turn, skipping a flip
+    //that would make a delimiter
+    wire_len = Wire(wire, 7, payload, sizeof(payload));
+
+    for(uint32_t pos = 1; pos < (wire_len - 1); pos++){
+
+        uint32_t delivered = g_ui32Delivered;
+        uint32_t errors = sDec.crc_errors + sDec.framing_errors;
+
+        if(wire[pos] == 0x01){
+            continue;
+        }
+
+        wire[pos] ^= 0x01;
+        Feed(&sDec, wire, wire_len);
+        wire[pos] ^= 0x01;
+
+        CHECK(g_ui32Delivered == delivered);
+        CHECK((sDec.crc_errors + sDec.framing_errors) == (errors + 1));
+
+    }
+
+    CHECK(sDec.crc_errors > 0);
+    CHECK(sDec.frames == 0);
+
+    //a flipped data byte is a CRC error, not a framing one
+    sDec.crc_errors = 0;
+    sDec.framing_errors = 0;
+    payload[0] = 0x11;
+    wire_len = Wire(wire, 7, payload, sizeof(payload));
+    CHECK(wire[2] == 0x11);
+    wire[2] = 0x12;
+    Feed(&sDec, wire, wire_len);
+    CHECK(sDec.crc_errors == 1);
+    CHECK(sDec.framing_errors == 0);
+
+}
+
+static void CheckResync(void){
+
+    tCOBSDecoder sDec;
+    uint8_t pui8Buf[DECODE_SIZE];
+    uint8_t pay_a[40];
+    uint8_t pay_b[24];
+    uint8_t wire_a[MIL_COBS_ENCODED_MAX(sizeof(pay_a) +
+                                        MIL_COBS_FRAME_OVERHEAD)];
+    uint8_t wire_b[MIL_COBS_ENCODED_MAX(sizeof(pay_b) +
+                                        MIL_COBS_FRAME_OVERHEAD)];
+    uint32_t len_a;
+    uint32_t len_b;
+
+    MIL_COBSDecoderInit(&sDec, pui8Buf, sizeof(pui8Buf), OnFrame);
+    RandomPayload(pay_a, sizeof(pay_a));
+    RandomPayload(pay_b, sizeof(pay_b));
+    len_a = Wire(wire_a, 1, pay_a, sizeof(pay_a));
+    len_b = Wire(wire_b, 2, pay_b, sizeof(pay_b));
+
+    //drop each byte of frame a in turn and send b twice behind it.
+    //Losing a data or code byte costs frame a, losing its delimiter
+    //merges it with the first b, either way one error and the
+    //decoder is back in step by the next delimiter
+    for(uint32_t drop = 0; drop < len_a; drop++){
+
+        uint32_t delivered = g_ui32Delivered;
+        uint32_t errors = sDec.crc_errors + sDec.framing_errors;
+        uint32_t expect = (drop == (len_a - 1)) ? 1 : 2;
+
+        Feed(&sDec, wire_a, drop);
+        Feed(&sDec, &wire_a[drop + 1], len_a - drop - 1);
+        Feed(&sDec, wire_b, len_b);
+        Feed(&sDec, wire_b, len_b);
+
+        CHECK(g_ui32Delivered == (delivered + expect));
+        CHECK((sDec.crc_errors + sDec.framing_errors) == (errors + 1));
+        CHECK(g_ui8GotId == 2);
+        CHECK(g_ui32GotLen == sizeof(pay_b));
+        CHECK(memcmp(g_pui8Got, pay_b, sizeof(pay_b)) == 0);
+
+    }
+
+    //joining mid frame is the same as losing its start
+    for(uint32_t join = 1; join < len_a; join++){
+
+        uint32_t delivered = g_ui32Delivered;
+
+        MIL_COBSDecoderInit(&sDec, pui8Buf, sizeof(pui8Buf), OnFrame);
+        Feed(&sDec, &wire_a[join], len_a - join);
+        Feed(&sDec, wire_b, len_b);
+
+        CHECK(g_ui32Delivered == (delivered + 1));
+        CHECK(g_ui8GotId == 2);
+
+    }
+
+}
+
+static void CheckFraming(void){
+
+    tCOBSDecoder sDec;
+    uint8_t pui8Buf[16];
+    uint8_t payload[64];
+    uint8_t wire[MIL_COBS_ENCODED_MAX(sizeof(payload) +
+                                      MIL_COBS_FRAME_OVERHEAD)];
+    uint32_t wire_len;
+    static const uint8_t pui8Short[] = {0x03, 0x11, 0x22, 0x00};
+    static const uint8_t pui8Idle[] = {0x00, 0x00, 0x00};
+
+    MIL_COBSDecoderInit(&sDec, pui8Buf, sizeof(pui8Buf), OnFrame);
+    RandomPayload(payload, sizeof(payload));
+
+    //one byte too big for the buffer
+    wire_len = Wire(wire, 3, payload, sizeof(pui8Buf) -
+                    MIL_COBS_FRAME_OVERHEAD + 1);
+    Feed(&sDec, wire, wire_len);
+    CHECK(sDec.framing_errors == 1);
+
+    //exactly fits
+    RoundTrip(&sDec, 3, payload, sizeof(pui8Buf) - MIL_COBS_FRAME_OVERHEAD);
+
+    //2 bytes can't hold an id and a CRC
+    Feed(&sDec, pui8Short, sizeof(pui8Short));
+    CHECK(sDec.framing_errors == 2);
+
+    //idle delimiters are no frames at all
+    Feed(&sDec, pui8Idle, sizeof(pui8Idle));
+    CHECK(sDec.framing_errors == 2);
+    CHECK(sDec.crc_errors == 0);
+    CHECK(sDec.frames == 1);
+
+}
+
+int main(int argc, char **argv){
+
+    (void)argc;
+
+    CheckCRC();
+    CheckRandom();
+    CheckBlockBoundary();
+    CheckCorrupt();
+    CheckResync();
+    CheckFraming();
+
+    fprintf(stderr, "%s: %u frames decoded, ok\n", argv[0],
+            (unsigned)g_ui32Delivered);
+
+    return 0;
+
+}
@@ -0,0 +1,278 @@
+/*
+ * Name: test_shell.c
+ * Author: Marquez Jones
+ * Desc: Runs lines through MIL_ShellExec with the commands of
+ *       Shell_Commands.h, on a simulated console(sim_uart.c) through
+ *       uartstdio.c(UART_BUFFERED) as built for the target
+ *
+ * Checks: the status of each line and what the command printed
+ *         - blank lines and unknown commands
+ *         - too few and too many arguments for each kind of type list,
+ *           and more words than MIL_SHELL_MAX_ARGS
+ *         - optional and repeated arguments(echo, add)
+ *         - names in any case, and MIL_ShellFind only taking len
+ *           characters of the name
+ *         - u and i at and one past the ends of their range, in
+ *           decimal, hex and octal, signs and junk after the digits
+ *
+ * Notes: the console writes to stdout, which is pointed at a temporary
+ *        file for each line and read back
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "utils/uartstdio.h"
+#include "MIL_Shell.h"
+#include "sim_uart.h"
+
+#define CHECK(cond)                                                    \
+    do{                                                                \
+        if(!(cond)){                                                   \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                   \
+        }                                                              \
+    }while(0)
+
+//TM4C123 at full speed
+#define SIM_CLOCK       80000000
+
+#define CONSOLE_PORT    0
+
+//console rings
+static tUARTStdio g_sConsole;
+static unsigned char g_pui8ConsoleTx[1024];
+static unsigned char g_pui8ConsoleRx[16];
+
+static UARTStdioHandle g_psConsole;
+
+//what the last line printed
+static char g_pcOut[1024];
+
+/**************************************HELPERS********************************************/
+
+/*
+ * Desc: runs a line and keeps what it printed in g_pcOut
+ *
+ * Returns: status of the line
+ */
+static tShellStatus Exec(const char *text){
+
+    char line[MIL_SHELL_LINE_SIZE];
+    tShellStatus status;
+    FILE *capture;
+    size_t got;
+    int saved;
+
+    CHECK(strlen(text) < sizeof(line));
+    strcpy(line, text);
+
+    fflush(stdout);
+    capture = tmpfile();
+    CHECK(capture);
+    saved = dup(STDOUT_FILENO);
+    CHECK(saved >= 0);
+    CHECK(dup2(fileno(capture), STDOUT_FILENO) >= 0);
+
+    status = MIL_ShellExec(g_psConsole, line);
+    UARTStdioFlushTx(g_psConsole, false);
+    fflush(stdout);
+
+    CHECK(dup2(saved, STDOUT_FILENO) >= 0);
+    close(saved);
+
+    rewind(capture);
+    got = fread(g_pcOut, 1, sizeof(g_pcOut) - 1, capture);
+    g_pcOut[got] = 0;
+    fclose(capture);
+
+    return status;
+
+}
+
+/*
+ * Desc: runs a line that has to give status and print out exactly
+ */
+static void Expect(const char *text, tShellStatus status, const char *out){
+
+    tShellStatus got = Exec(text);
+
+    if((got != status) || strcmp(g_pcOut, out)){
+        fprintf(stderr, "test_shell: \"%s\" gave %d \"%s\", expected %d "
+                "\"%s\"\n", text, (int)got, g_pcOut, (int)status, out);
+        exit(1);
+    }
+
+}
+
+/*
+ * Desc: runs a line that has to give status, whatever it prints
+ */
+static void ExpectStatus(const char *text, tShellStatus status){
+
+    tShellStatus got = Exec(text);
+
+    if(got != status){
+        fprintf(stderr, "test_shell: \"%s\" gave %d, expected %d\n", text,
+                (int)got, (int)status);
+        exit(1);
+    }
+
+}
+
+/**************************************TESTS********************************************/
+
+/*
+ * Desc: blank lines, unknown names and lookup
+ */
+static void TestLookup(void){
+
+    Expect("", SHELL_EMPTY, "");
+    Expect("  \t ", SHELL_EMPTY, "");
+    Expect("nope", SHELL_UNKNOWN, "unknown command: nope\n");
+    Expect("hexx 1", SHELL_UNKNOWN, "unknown command: hexx\n");
+    Expect("he 1", SHELL_UNKNOWN, "unknown command: he\n");
+
+    //any case, and words split on tabs too
+    Expect("HeX 255", SHELL_OK, "0x000000ff\n");
+    Expect("\tECHO\ta  b\t", SHELL_OK, "a b\n");
+
+    CHECK(MIL_ShellFind("help", 4) == MIL_ShellFind("HELP", 4));
+    CHECK(MIL_ShellFind("help", 4) != 0);
+    CHECK(!strcmp(MIL_ShellFind("hexx", 3)->name, "hex"));
+    CHECK(!strcmp(MIL_ShellFind("ScAlE", 5)->name, "scale"));
+    CHECK(MIL_ShellFind("hexx", 4) == 0);
+    CHECK(MIL_ShellFind("hex", 2) == 0);
+    CHECK(MIL_ShellFind("", 0) == 0);
+
+    //help lists every command
+    CHECK(Exec("help") == SHELL_OK);
+    CHECK(strstr(g_pcOut, "hex n"));
+    CHECK(strstr(g_pcOut, "scale x k"));
+
+}
+
+/*
+ * Desc: argument counts
+ */
+static void TestCounts(void){
+
+    //none allowed
+    Expect("help x", SHELL_ARG_COUNT,
+           "usage: help             list the commands\n");
+
+    //all required
+    Expect("scale 2", SHELL_ARG_COUNT,
+           "usage: scale x k        x times k\n");
+    Expect("scale", SHELL_ARG_COUNT,
+           "usage: scale x k        x times k\n");
+    Expect("scale 2 3 4", SHELL_ARG_COUNT,
+           "usage: scale x k        x times k\n");
+    Expect("hex", SHELL_ARG_COUNT, "usage: hex n            n in hex\n");
+    Expect("hex 1 2", SHELL_ARG_COUNT,
+           "usage: hex n            n in hex\n");
+
+    //one required then any number
+    Expect("add", SHELL_ARG_COUNT, "usage: add n [n...]     sum of integers\n");
+
+    //optional and repeated
+    Expect("echo", SHELL_OK, "\n");
+    Expect("echo one", SHELL_OK, "one\n");
+    Expect("echo 1 2 3 4 5 6 7 8", SHELL_OK, "1 2 3 4 5 6 7 8\n");
+    Expect("add 5", SHELL_OK, "5\n");
+    Expect("add 1 2 3 4 5 6 7 8", SHELL_OK, "36\n");
+
+    //MIL_SHELL_MAX_ARGS after the name
+    Expect("echo 1 2 3 4 5 6 7 8 9", SHELL_ARG_COUNT, "too many arguments\n");
+    Expect("nope 1 2 3 4 5 6 7 8 9", SHELL_ARG_COUNT, "too many arguments\n");
+
+}
+
+/*
+ * Desc: u and i ranges and syntax
+ */
+static void TestValues(void){
+
+    //u, the whole 32 bits and nothing past them
+    Expect("hex 0", SHELL_OK, "0x00000000\n");
+    Expect("hex 4294967295", SHELL_OK, "0xffffffff\n");
+    Expect("hex 0xFFFFFFFF", SHELL_OK, "0xffffffff\n");
+    Expect("hex 0x00000000FFFFFFFF", SHELL_OK, "0xffffffff\n");
+    Expect("hex 037777777777", SHELL_OK, "0xffffffff\n");
+    Expect("hex +10", SHELL_OK, "0x0000000a\n");
+    Expect("hex 017", SHELL_OK, "0x0000000f\n");
+    ExpectStatus("hex 4294967296", SHELL_BAD_ARG);
+    ExpectStatus("hex 0x100000000", SHELL_BAD_ARG);
+    ExpectStatus("hex 040000000000", SHELL_BAD_ARG);
+    ExpectStatus("hex 99999999999999999999999", SHELL_BAD_ARG);
+    Expect("hex -1", SHELL_BAD_ARG,
+           "bad argument 1: -1\nusage: hex n            n in hex\n");
+
+    //not a number, or not only one
+    ExpectStatus("hex 0x", SHELL_BAD_ARG);
+    ExpectStatus("hex 08", SHELL_BAD_ARG);
+    ExpectStatus("hex 12ab", SHELL_BAD_ARG);
+    ExpectStatus("hex ++1", SHELL_BAD_ARG);
+    ExpectStatus("hex x", SHELL_BAD_ARG);
+
+    //i, INT32_MIN to INT32_MAX
+    Expect("add 2147483647", SHELL_OK, "2147483647\n");
+    Expect("add -2147483648", SHELL_OK, "-2147483648\n");
+    Expect("add 0x7FFFFFFF -0x80000000", SHELL_OK, "-1\n");
+    Expect("add +7 -0", SHELL_OK, "7\n");
+    Expect("add -010", SHELL_OK, "-8\n");
+    ExpectStatus("add 2147483648", SHELL_BAD_ARG);
+    ExpectStatus("add -2147483649", SHELL_BAD_ARG);
+    ExpectStatus("add 0x80000000", SHELL_BAD_ARG);
+    ExpectStatus("add 4294967295", SHELL_BAD_ARG);
+    ExpectStatus("add 4294967296", SHELL_BAD_ARG);
+    ExpectStatus("add --1", SHELL_BAD_ARG);
+    ExpectStatus("add -+1", SHELL_BAD_ARG);
+    ExpectStatus("add -", SHELL_BAD_ARG);
+    Expect("add 1 2 x", SHELL_BAD_ARG,
+           "bad argument 3: x\nusage: add n [n...]     sum of integers\n");
+
+    //the sum is wider than the arguments
+    Expect("add 2147483647 2147483647 2147483647", SHELL_OK, "6442450941\n");
+    Expect("add -2147483648 -2147483648", SHELL_OK, "-4294967296\n");
+
+    //f
+    Expect("scale 1.5 4", SHELL_OK, "6\n");
+    ExpectStatus("scale 1.5x 4", SHELL_BAD_ARG);
+    ExpectStatus("scale 1.5 .", SHELL_BAD_ARG);
+
+}
+
+int main(int argc, char **argv){
+
+    tShell sShell;
+
+    (void)argc;
+
+    SimConsole(CONSOLE_PORT);
+
+    g_psConsole = UARTStdioInit(&g_sConsole, CONSOLE_PORT, 115200,
+                                SIM_CLOCK, g_pui8ConsoleTx,
+                                sizeof(g_pui8ConsoleTx), g_pui8ConsoleRx,
+                                sizeof(g_pui8ConsoleRx));
+
+    //nothing is found before the table is built
+    CHECK(MIL_ShellFind("help", 4) == 0);
+
+    CHECK(MIL_ShellInit(&sShell, g_psConsole, "> "));
+    UARTStdioFlushTx(g_psConsole, false);
+    fflush(stdout);
+
+    TestLookup();
+    TestCounts();
+    TestValues();
+
+    fprintf(stderr, "%s: ok\n", argv[0]);
+
+    return 0;
+
+}
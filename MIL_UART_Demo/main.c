@@ -13,6 +13,10 @@
  *       The launchpad has no usb access to the UART pins so you'll need a
  *       FTDI breakout board to use the putty terminal
  *
+ *       UART_FIFO_MODE picks between the original byte per interrupt
+ *       setup and the 16 byte FIFOs with trigger levels, the interrupt
+ *       and byte counters below show the difference(interrupts per byte)
+ *
  * Hardware Notes:
  * PB0 - UART RX
  * PB1 - UART TX
@@ -31,6 +35,17 @@
 #include "driverlib/sysctl.h"
 #include "driverlib/uart.h"
 #include "utils/uartstdio.h"
+/************************UART OPTIONS******************************/
+//1 = 16 byte FIFOs with the trigger levels below, 0 = interrupt per byte
+#define UART_FIFO_MODE  1
+#define UART_BAUD       115200
+#define UART_TX_LEVEL   UART_FIFO_TX4_8
+#define UART_RX_LEVEL   UART_FIFO_RX4_8
+
+//received bytes waiting to be echoed, power of two
+#define RX_RING_SIZE    64
+#define RX_RING_MASK    (RX_RING_SIZE - 1)
+
 /************************FLAGS******************************/
 //test flags for UART demo
 //Is used for tiva to continuously output 'U'
@@ -38,6 +53,17 @@ uint8_t tx_test_flag = 1;
 //Will be used to echo back received data
 uint8_t rx_test_flag = 0;
 
+/************************RX RING******************************/
+//ISR writes head, main writes tail, both free running
+volatile uint8_t rx_ring[RX_RING_SIZE];
+volatile uint32_t rx_head = 0;
+volatile uint32_t rx_tail = 0;
+
+//watch these in the debugger, rx_ints/rx_bytes = interrupts per byte
+volatile uint32_t rx_ints = 0;
+volatile uint32_t rx_bytes = 0;
+volatile uint32_t rx_overruns = 0;
+
 /************************FUNCTION PROTOTYPES******************************/
 //initialize UART
 void InitUART(void);
@@ -90,6 +116,12 @@ int main(void)
             UARTCharPut(UART1_BASE,0x55);
         }
 
+        //echo whatever the ISR queued
+        while(rx_tail != rx_head){
+            UARTCharPut(UART1_BASE, rx_ring[rx_tail & RX_RING_MASK]);
+            rx_tail++;
+        }
+
     }
 
 	//return 0;
@@ -121,18 +153,27 @@ void InitUART(void){
 
        /*
         * Configure UART
-        * -115.2kbp = baud rate
+        * -UART_BAUD = baud rate
         * -8 bit message length
         * -No Parity
         * -One stop bit
         */
-       UARTConfigSetExpClk(UART1_BASE, SysCtlClockGet(), 115200,
+       UARTConfigSetExpClk(UART1_BASE, SysCtlClockGet(), UART_BAUD,
                            (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
                                UART_CONFIG_PAR_NONE));
 
        /*INTERRUPTS*/
        //Peripheral Interrupt configs
+#if UART_FIFO_MODE
+       /*
+        * RX interrupt at the trigger level, the receive
+        * timeout(RT) picks up bytes left below it
+        */
+       UARTFIFOLevelSet(UART1_BASE, UART_TX_LEVEL, UART_RX_LEVEL);
+       UARTIntEnable(UART1_BASE, UART_INT_RX | UART_INT_RT);
+#else
        UARTIntEnable(UART1_BASE,UART_INT_RX);
+#endif
        UARTIntRegister(UART1_BASE, &UART_RX_Handler);
 
        //CPU interrupt enbales
@@ -146,11 +187,11 @@ void InitUART(void){
         * will be based on user defined level as opposed
         * to any data recevied/transmitted
         *
-        * in this I disabled FIFO
+        * UARTEnable turns the FIFOs on, byte mode turns them back off
         */
+#if !UART_FIFO_MODE
         UARTFIFODisable(UART1_BASE);
-
-
+#endif
 
 }
 
@@ -169,12 +210,37 @@ void InitGPIO(void){
 }
 
 /************************ISR******************************/
+/*
+ * Desc: drains every byte the UART has into rx_ring,
+ *       main does the echo
+ */
 void UART_RX_Handler(void){
+
+    uint32_t head = rx_head;
+
+    UARTIntClear(UART1_BASE, UARTIntStatus(UART1_BASE, true));
+
     tx_test_flag = 0;  // Stop transmitting
-   // rx_test_flag = 1;  // now echo
-    uint8_t rx_data = UARTCharGet(UART1_BASE);
+    rx_ints++;
 
-     //transmit data
-    UARTCharPut(UART1_BASE,rx_data);
-}
+    while(UARTCharsAvail(UART1_BASE)){
+
+        uint8_t rx_data = UARTCharGetNonBlocking(UART1_BASE);
+
+        //drop the byte if main hasn't caught up
+        if((head - rx_tail) < RX_RING_SIZE){
+            rx_ring[head & RX_RING_MASK] = rx_data;
+            head++;
+            rx_bytes++;
+        }
 
+    }
+
+    if(UARTRxErrorGet(UART1_BASE) & UART_RXERROR_OVERRUN){
+        rx_overruns++;
+        UARTRxErrorClear(UART1_BASE);
+    }
+
+    rx_head = head;
+
+}
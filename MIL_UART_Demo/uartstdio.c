@@ -35,7 +35,11 @@
 #include "driverlib/rom_map.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/uart.h"
+#ifdef UART_DMA
+#include "driverlib/udma.h"
+#endif
 #include "utils/uartstdio.h"
+#include "utils/ustdlib.h"
 
 //*****************************************************************************
 //
@@ -46,92 +50,146 @@
 
 //*****************************************************************************
 //
-// If buffered mode is defined, set aside RX and TX buffers and read/write
-// pointers to control them.
+// Every console lives in a tUARTStdio instance (see uartstdio.h).  The
+// original single console API (UARTStdioConfig(), UARTprintf() and so on)
+// works on a default instance kept here, with buffers of UART_TX_BUFFER_SIZE
+// and UART_RX_BUFFER_SIZE bytes.  Further consoles are opened with
+// UARTStdioInit() on instances and buffers supplied by the application, so
+// each UART gets buffers sized for its own traffic.
+//
+//*****************************************************************************
+static tUARTStdio g_sUARTStdio;
+
+//*****************************************************************************
+//
+// If buffered mode is defined, set aside RX and TX buffers for the default
+// instance.
 //
 //*****************************************************************************
 #ifdef UART_BUFFERED
 
 //*****************************************************************************
 //
-// This global controls whether or not we are echoing characters back to the
-// transmitter.  By default, echo is enabled but if using this module as a
-// convenient method of implementing a buffered serial interface over which
-// you will be running an application protocol, you are likely to want to
-// disable echo by calling UARTEchoSet(false).
+// The receive and transmit buffers are single producer, single consumer
+// rings.  Both indices are free running and only the low bits (the buffer
+// sizes must be powers of two) select a slot, so the number of bytes in a
+// ring is simply write - read and every slot is usable.  Each index has a
+// single writer:
+//
+// - TX: UARTStdioWrite() advances the write index, the interrupt handler
+//   advances the read index.  Only the interrupt handler feeds the UART FIFO.
+// - RX: the interrupt handler advances the write index, UARTStdioGets(),
+//   UARTStdioGetc() and UARTStdioFlushRx() advance the read index.
+//
+// A barrier orders the data accesses against the index that publishes them,
+// so neither side ever needs to mask interrupts.  This assumes UARTStdioWrite()
+// (and so UARTStdioPrintf()) is only called from one context per instance,
+// as before.
 //
 //*****************************************************************************
-static bool g_bDisableEcho;
+#if (UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) != 0
+#error "UART_TX_BUFFER_SIZE must be a power of two"
+#endif
+#if (UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) != 0
+#error "UART_RX_BUFFER_SIZE must be a power of two"
+#endif
+#if (UART_ECHO_BUFFER_SIZE & (UART_ECHO_BUFFER_SIZE - 1)) != 0
+#error "UART_ECHO_BUFFER_SIZE must be a power of two"
+#endif
+
+#if defined(ccs)
+#define RING_BARRIER()          __asm("    dmb")
+#elif defined(ewarm)
+#define RING_BARRIER()          __asm("DMB")
+#elif defined(rvmdk) || defined(__ARMCC_VERSION)
+#define RING_BARRIER()          __dmb(0xF)
+#else
+#define RING_BARRIER()          __sync_synchronize()
+#endif
 
 //*****************************************************************************
 //
-// Output ring buffer.  Buffer is full if g_ui32UARTTxReadIndex is one ahead of
-// g_ui32UARTTxWriteIndex.  Buffer is empty if the two indices are the same.
+// Output and input ring buffers of the default instance.
 //
 //*****************************************************************************
 static unsigned char g_pcUARTTxBuffer[UART_TX_BUFFER_SIZE];
-static volatile uint32_t g_ui32UARTTxWriteIndex = 0;
-static volatile uint32_t g_ui32UARTTxReadIndex = 0;
+static unsigned char g_pcUARTRxBuffer[UART_RX_BUFFER_SIZE];
 
 //*****************************************************************************
 //
-// Input ring buffer.  Buffer is full if g_ui32UARTTxReadIndex is one ahead of
-// g_ui32UARTTxWriteIndex.  Buffer is empty if the two indices are the same.
+// The instance open on each UART, used by the per-port interrupt handlers.
 //
 //*****************************************************************************
-static unsigned char g_pcUARTRxBuffer[UART_RX_BUFFER_SIZE];
-static volatile uint32_t g_ui32UARTRxWriteIndex = 0;
-static volatile uint32_t g_ui32UARTRxReadIndex = 0;
+static tUARTStdio *g_psUARTStdioPort[3];
 
 //*****************************************************************************
 //
-// Macros to determine number of free and used bytes in the transmit buffer.
+// The echo buffer is written and drained by the interrupt handler only and
+// goes out ahead of the transmit buffer, which keeps the transmit buffer to
+// a single producer.
 //
 //*****************************************************************************
-#define TX_BUFFER_USED          (GetBufferCount(&g_ui32UARTTxReadIndex,  \
-                                                &g_ui32UARTTxWriteIndex, \
-                                                UART_TX_BUFFER_SIZE))
-#define TX_BUFFER_FREE          (UART_TX_BUFFER_SIZE - TX_BUFFER_USED)
-#define TX_BUFFER_EMPTY         (IsBufferEmpty(&g_ui32UARTTxReadIndex,   \
-                                               &g_ui32UARTTxWriteIndex))
-#define TX_BUFFER_FULL          (IsBufferFull(&g_ui32UARTTxReadIndex,  \
-                                              &g_ui32UARTTxWriteIndex, \
-                                              UART_TX_BUFFER_SIZE))
-#define ADVANCE_TX_BUFFER_INDEX(Index) \
-                                (Index) = ((Index) + 1) % UART_TX_BUFFER_SIZE
+#define ECHO_BUFFER_MASK        (UART_ECHO_BUFFER_SIZE - 1)
 
+#ifdef UART_DMA
 //*****************************************************************************
 //
-// Macros to determine number of free and used bytes in the receive buffer.
+// uDMA mode.  The transmit buffer is handed to the UART TX channel one
+// contiguous segment at a time.  Received data lands in two blocks used in
+// ping-pong mode; the RX channel only answers burst requests, so the tail of
+// a message smaller than the FIFO trigger level stays in the FIFO and raises
+// the receive timeout, which flushes the partly filled block.
+//
+// On the TM4C123 a finished transfer raises the UART interrupt without a
+// status bit, so the interrupt handler checks the channels every time.
 //
 //*****************************************************************************
-#define RX_BUFFER_USED          (GetBufferCount(&g_ui32UARTRxReadIndex,  \
-                                                &g_ui32UARTRxWriteIndex, \
-                                                UART_RX_BUFFER_SIZE))
-#define RX_BUFFER_FREE          (UART_RX_BUFFER_SIZE - RX_BUFFER_USED)
-#define RX_BUFFER_EMPTY         (IsBufferEmpty(&g_ui32UARTRxReadIndex,   \
-                                               &g_ui32UARTRxWriteIndex))
-#define RX_BUFFER_FULL          (IsBufferFull(&g_ui32UARTRxReadIndex,  \
-                                              &g_ui32UARTRxWriteIndex, \
-                                              UART_RX_BUFFER_SIZE))
-#define ADVANCE_RX_BUFFER_INDEX(Index) \
-                                (Index) = ((Index) + 1) % UART_RX_BUFFER_SIZE
+static const uint32_t g_ui32UARTDMAAssign[3][2] =
+{
+    { UDMA_CH8_UART0RX, UDMA_CH9_UART0TX },
+    { UDMA_CH22_UART1RX, UDMA_CH23_UART1TX },
+    { UDMA_CH12_UART2RX, UDMA_CH13_UART2TX }
+};
+
+//
+// The channel number is the low byte of a channel assignment.
+//
+#define DMA_CHANNEL(ui32Assign) ((ui32Assign) & 0xFF)
+
+//
+// A single uDMA transfer moves at most 1024 items.
+//
+#define DMA_MAX_TRANSFER        1024
 #endif
 
 //*****************************************************************************
 //
-// The base address of the chosen UART.
+// Macros to determine number of free and used bytes in the transmit buffer
+// of an instance.
 //
 //*****************************************************************************
-static uint32_t g_ui32Base = 0;
+#define TX_BUFFER_SIZE(psUART)  ((psUART)->ui32TxMask + 1)
+#define TX_BUFFER_USED(psUART)  (GetBufferCount(&(psUART)->ui32TxReadIndex,  \
+                                                &(psUART)->ui32TxWriteIndex))
+#define TX_BUFFER_FREE(psUART)  (TX_BUFFER_SIZE(psUART) -                    \
+                                 TX_BUFFER_USED(psUART))
+#define TX_BUFFER_EMPTY(psUART) (IsBufferEmpty(&(psUART)->ui32TxReadIndex,   \
+                                               &(psUART)->ui32TxWriteIndex))
 
 //*****************************************************************************
 //
-// A mapping from an integer between 0 and 15 to its ASCII character
-// equivalent.
+// Macros to determine number of free and used bytes in the receive buffer
+// of an instance.
 //
 //*****************************************************************************
-static const char * const g_pcHex = "0123456789abcdef";
+#define RX_BUFFER_SIZE(psUART)  ((psUART)->ui32RxMask + 1)
+#define RX_BUFFER_USED(psUART)  (GetBufferCount(&(psUART)->ui32RxReadIndex,  \
+                                                &(psUART)->ui32RxWriteIndex))
+#define RX_BUFFER_FREE(psUART)  (RX_BUFFER_SIZE(psUART) -                    \
+                                 RX_BUFFER_USED(psUART))
+#define RX_BUFFER_EMPTY(psUART) (IsBufferEmpty(&(psUART)->ui32RxReadIndex,   \
+                                               &(psUART)->ui32RxWriteIndex))
+#endif
 
 //*****************************************************************************
 //
@@ -153,13 +211,6 @@ static const uint32_t g_ui32UARTInt[3] =
 {
     INT_UART0, INT_UART1, INT_UART2
 };
-
-//*****************************************************************************
-//
-// The port number in use.
-//
-//*****************************************************************************
-static uint32_t g_ui32PortNum;
 #endif
 
 //*****************************************************************************
@@ -174,25 +225,24 @@ static const uint32_t g_ui32UARTPeriph[3] =
 
 //*****************************************************************************
 //
-//! Determines whether the ring buffer whose pointers and size are provided
-//! is full or not.
+//! Determines whether the ring buffer whose pointers are provided is empty or
+//! not.
 //!
 //! \param pui32Read points to the read index for the buffer.
 //! \param pui32Write points to the write index for the buffer.
-//! \param ui32Size is the size of the buffer in bytes.
 //!
 //! This function is used to determine whether or not a given ring buffer is
-//! full.  The structure of the code is specifically to ensure that we do not
+//! empty.  The structure of the code is specifically to ensure that we do not
 //! see warnings from the compiler related to the order of volatile accesses
 //! being undefined.
 //!
-//! \return Returns \b true if the buffer is full or \b false otherwise.
+//! \return Returns \b true if the buffer is empty or \b false otherwise.
 //
 //*****************************************************************************
 #ifdef UART_BUFFERED
 static bool
-IsBufferFull(volatile uint32_t *pui32Read,
-             volatile uint32_t *pui32Write, uint32_t ui32Size)
+IsBufferEmpty(volatile uint32_t *pui32Read,
+              volatile uint32_t *pui32Write)
 {
     uint32_t ui32Write;
     uint32_t ui32Read;
@@ -200,30 +250,28 @@ IsBufferFull(volatile uint32_t *pui32Read,
     ui32Write = *pui32Write;
     ui32Read = *pui32Read;
 
-    return((((ui32Write + 1) % ui32Size) == ui32Read) ? true : false);
+    return((ui32Write == ui32Read) ? true : false);
 }
 #endif
 
 //*****************************************************************************
 //
-//! Determines whether the ring buffer whose pointers and size are provided
-//! is empty or not.
+//! Determines the number of bytes of data contained in a ring buffer.
 //!
 //! \param pui32Read points to the read index for the buffer.
 //! \param pui32Write points to the write index for the buffer.
 //!
-//! This function is used to determine whether or not a given ring buffer is
-//! empty.  The structure of the code is specifically to ensure that we do not
-//! see warnings from the compiler related to the order of volatile accesses
-//! being undefined.
+//! This function is used to determine how many bytes of data a given ring
+//! buffer currently contains.  The indices are free running so the count is
+//! their difference, modulo 2^32.
 //!
-//! \return Returns \b true if the buffer is empty or \b false otherwise.
+//! \return Returns the number of bytes of data currently in the buffer.
 //
 //*****************************************************************************
 #ifdef UART_BUFFERED
-static bool
-IsBufferEmpty(volatile uint32_t *pui32Read,
-              volatile uint32_t *pui32Write)
+static uint32_t
+GetBufferCount(volatile uint32_t *pui32Read,
+               volatile uint32_t *pui32Write)
 {
     uint32_t ui32Write;
     uint32_t ui32Read;
@@ -231,119 +279,540 @@ IsBufferEmpty(volatile uint32_t *pui32Read,
     ui32Write = *pui32Write;
     ui32Read = *pui32Read;
 
-    return((ui32Write == ui32Read) ? true : false);
+    return(ui32Write - ui32Read);
 }
 #endif
 
 //*****************************************************************************
 //
-//! Determines the number of bytes of data contained in a ring buffer.
-//!
-//! \param pui32Read points to the read index for the buffer.
-//! \param pui32Write points to the write index for the buffer.
-//! \param ui32Size is the size of the buffer in bytes.
-//!
-//! This function is used to determine how many bytes of data a given ring
-//! buffer currently contains.  The structure of the code is specifically to
-//! ensure that we do not see warnings from the compiler related to the order
-//! of volatile accesses being undefined.
-//!
-//! \return Returns the number of bytes of data currently in the buffer.
+// Removes one character from the receive buffer.  The caller must already
+// have seen that the buffer is not empty.  Only called by the reader.
 //
 //*****************************************************************************
 #ifdef UART_BUFFERED
-static uint32_t
-GetBufferCount(volatile uint32_t *pui32Read,
-               volatile uint32_t *pui32Write, uint32_t ui32Size)
+static unsigned char
+RxBufferGet(tUARTStdio *psUART)
 {
-    uint32_t ui32Write;
     uint32_t ui32Read;
+    unsigned char cChar;
 
-    ui32Write = *pui32Write;
-    ui32Read = *pui32Read;
+    ui32Read = psUART->ui32RxReadIndex;
 
-    return((ui32Write >= ui32Read) ? (ui32Write - ui32Read) :
-           (ui32Size - (ui32Read - ui32Write)));
+    //
+    // Read the slot only after the write index that published it, and
+    // release the slot only after it has been read.
+    //
+    RING_BARRIER();
+    cChar = psUART->pcRxBuffer[ui32Read & psUART->ui32RxMask];
+    RING_BARRIER();
+
+    psUART->ui32RxReadIndex = ui32Read + 1;
+
+    return(cChar);
 }
 #endif
 
 //*****************************************************************************
 //
-// Take as many bytes from the transmit buffer as we have space for and move
-// them into the UART transmit FIFO.
+// Queues a string for echo.  Called from the interrupt handler only.  If the
+// echo buffer is full the rest of the string is dropped.
 //
 //*****************************************************************************
 #ifdef UART_BUFFERED
 static void
-UARTPrimeTransmit(uint32_t ui32Base)
+EchoWrite(tUARTStdio *psUART, const char *pcBuf, uint32_t ui32Len)
+{
+    while(ui32Len-- &&
+          ((psUART->ui32EchoWriteIndex - psUART->ui32EchoReadIndex) <
+           UART_ECHO_BUFFER_SIZE))
+    {
+        psUART->pcEchoBuffer[psUART->ui32EchoWriteIndex & ECHO_BUFFER_MASK] =
+            *pcBuf++;
+        psUART->ui32EchoWriteIndex++;
+    }
+}
+#endif
+
+//*****************************************************************************
+//
+// Handles one received character: line editing and echo if enabled, then
+// storing it at the edit index.  Called from the interrupt handler only.
+//
+// Returns the new edit index.
+//
+//*****************************************************************************
+#ifdef UART_BUFFERED
+static uint32_t
+UARTRxChar(tUARTStdio *psUART, uint32_t ui32Edit, unsigned char ucChar)
 {
+    int8_t cChar;
+
+    cChar = (int8_t)ucChar;
+
+    //
+    // A receive hook takes the character as it is, the receive buffer is
+    // not used.
+    //
+    if(psUART->pfnRxHook)
+    {
+        psUART->pfnRxHook(psUART->pvRxHookArg, ucChar);
+        return(ui32Edit);
+    }
+
+    //
+    // If echo is disabled, we skip the various text filtering
+    // operations that would typically be required when supporting a
+    // command line.
+    //
+    if(!psUART->bDisableEcho)
+    {
+        //
+        // Handle backspace by erasing the last character in the
+        // buffer.
+        //
+        if(cChar == '\b')
+        {
+            //
+            // If there are any characters in the line being edited,
+            // then delete the last.  Characters already handed to the
+            // reader are left alone.
+            //
+            if(ui32Edit != psUART->ui32RxWriteIndex)
+            {
+                //
+                // Rub out the previous character on the users
+                // terminal.
+                //
+                EchoWrite(psUART, "\b \b", 3);
+
+                //
+                // Decrement the number of characters in the buffer.
+                //
+                ui32Edit--;
+            }
+
+            //
+            // Skip ahead to read the next character.
+            //
+            return(ui32Edit);
+        }
+
+        //
+        // If this character is LF and last was CR, then just gobble up
+        // the character since we already echoed the previous CR and we
+        // don't want to store 2 characters in the buffer if we don't
+        // need to.
+        //
+        if((cChar == '\n') && psUART->bLastWasCR)
+        {
+            psUART->bLastWasCR = false;
+            return(ui32Edit);
+        }
+
+        //
+        // See if a newline or escape character was received.
+        //
+        if((cChar == '\r') || (cChar == '\n') || (cChar == 0x1b))
+        {
+            //
+            // If the character is a CR, then it may be followed by an
+            // LF which should be paired with the CR.  So remember that
+            // a CR was received.
+            //
+            if(cChar == '\r')
+            {
+                psUART->bLastWasCR = true;
+            }
+
+            //
+            // Regardless of the line termination character received,
+            // put a CR in the receive buffer as a marker telling
+            // UARTStdioGets() where the line ends.  We also send an
+            // additional LF to ensure that the local terminal echo
+            // receives both CR and LF.
+            //
+            cChar = '\r';
+            EchoWrite(psUART, "\n", 1);
+        }
+    }
+
     //
-    // Do we have any data to transmit?
+    // If there is space in the receive buffer, put the character
+    // there, otherwise throw it away.
     //
-    if(!TX_BUFFER_EMPTY)
+    if((ui32Edit - psUART->ui32RxReadIndex) < RX_BUFFER_SIZE(psUART))
     {
         //
-        // Disable the UART interrupt.  If we don't do this there is a race
-        // condition which can cause the read index to be corrupted.
+        // Store the new character in the receive buffer
         //
-        MAP_IntDisable(g_ui32UARTInt[g_ui32PortNum]);
+        psUART->pcRxBuffer[ui32Edit & psUART->ui32RxMask] = ucChar;
+        ui32Edit++;
 
         //
-        // Yes - take some characters out of the transmit buffer and feed
-        // them to the UART transmit FIFO.
+        // If echo is enabled, write the character to the echo
+        // buffer so that the user gets some immediate feedback.
         //
-        while(MAP_UARTSpaceAvail(ui32Base) && !TX_BUFFER_EMPTY)
+        if(!psUART->bDisableEcho)
+        {
+            EchoWrite(psUART, (const char *)&cChar, 1);
+        }
+    }
+    else
+    {
+        psUART->ui32RxDropped++;
+    }
+
+    //
+    // Hand the characters to the reader.  With echo enabled this
+    // happens at the end of each line, or when the buffer fills so
+    // a line longer than the buffer can't stall UARTStdioGets().
+    //
+    if(psUART->bDisableEcho || (cChar == '\r') ||
+       ((ui32Edit - psUART->ui32RxReadIndex) >= RX_BUFFER_SIZE(psUART)))
+    {
+        RING_BARRIER();
+        psUART->ui32RxWriteIndex = ui32Edit;
+    }
+
+    return(ui32Edit);
+}
+#endif
+
+#ifdef UART_DMA
+//*****************************************************************************
+//
+// Points one RX ping-pong control structure at its block.
+//
+//*****************************************************************************
+static void
+UARTDMARxArm(tUARTStdio *psUART, uint32_t ui32Select)
+{
+    MAP_uDMAChannelTransferSet(psUART->ui32DMARxChannel | ui32Select,
+                               UDMA_MODE_PINGPONG,
+                               (void *)(psUART->ui32Base + UART_O_DR),
+                               psUART->pcRxDMABuffer[(ui32Select ==
+                                                      UDMA_ALT_SELECT) ?
+                                                     1 : 0],
+                               UART_RX_DMA_BLOCK);
+}
+
+//*****************************************************************************
+//
+// Sets up both uDMA channels for an instance's UART and enables DMA requests.
+//
+//*****************************************************************************
+static void
+UARTDMAConfig(tUARTStdio *psUART)
+{
+    uint32_t ui32PortNum;
+
+    ui32PortNum = psUART->ui32PortNum;
+
+    //
+    // Map the channels to this UART.
+    //
+    MAP_uDMAChannelAssign(g_ui32UARTDMAAssign[ui32PortNum][0]);
+    MAP_uDMAChannelAssign(g_ui32UARTDMAAssign[ui32PortNum][1]);
+    psUART->ui32DMARxChannel =
+        DMA_CHANNEL(g_ui32UARTDMAAssign[ui32PortNum][0]);
+    psUART->ui32DMATxChannel =
+        DMA_CHANNEL(g_ui32UARTDMAAssign[ui32PortNum][1]);
+
+    //
+    // RX: burst requests only, so whatever is below the FIFO trigger level
+    // waits for the receive timeout.
+    //
+    MAP_uDMAChannelAttributeDisable(psUART->ui32DMARxChannel,
+                                    UDMA_ATTR_ALTSELECT |
+                                    UDMA_ATTR_HIGH_PRIORITY |
+                                    UDMA_ATTR_REQMASK);
+    MAP_uDMAChannelAttributeEnable(psUART->ui32DMARxChannel,
+                                   UDMA_ATTR_USEBURST);
+    MAP_uDMAChannelControlSet(psUART->ui32DMARxChannel | UDMA_PRI_SELECT,
+                              UDMA_SIZE_8 | UDMA_SRC_INC_NONE |
+                              UDMA_DST_INC_8 | UDMA_ARB_4);
+    MAP_uDMAChannelControlSet(psUART->ui32DMARxChannel | UDMA_ALT_SELECT,
+                              UDMA_SIZE_8 | UDMA_SRC_INC_NONE |
+                              UDMA_DST_INC_8 | UDMA_ARB_4);
+    UARTDMARxArm(psUART, UDMA_PRI_SELECT);
+    UARTDMARxArm(psUART, UDMA_ALT_SELECT);
+    psUART->ui32DMARxSelect = UDMA_PRI_SELECT;
+    MAP_uDMAChannelEnable(psUART->ui32DMARxChannel);
+
+    //
+    // TX: one basic transfer per contiguous run of the transmit buffer.
+    //
+    MAP_uDMAChannelAttributeDisable(psUART->ui32DMATxChannel, UDMA_ATTR_ALL);
+    MAP_uDMAChannelControlSet(psUART->ui32DMATxChannel | UDMA_PRI_SELECT,
+                              UDMA_SIZE_8 | UDMA_SRC_INC_8 |
+                              UDMA_DST_INC_NONE | UDMA_ARB_4);
+    psUART->ui32DMATxCount = 0;
+
+    //
+    // FIFO triggers to match the 4 byte arbitration size of the 16 byte
+    // FIFOs: RX requests a burst once 4 bytes (2/8) are waiting and TX once
+    // the FIFO has drained to 12 bytes (6/8), leaving room for 4 more.
+    //
+    MAP_UARTFIFOLevelSet(psUART->ui32Base, UART_FIFO_TX6_8, UART_FIFO_RX2_8);
+    MAP_UARTDMAEnable(psUART->ui32Base, UART_DMA_RX | UART_DMA_TX);
+}
+
+//*****************************************************************************
+//
+// Moves received data from the ping-pong blocks into the receive buffer.
+// Called from the interrupt handler.  Full blocks are taken in order and
+// re-armed.  On a receive timeout the channel is stopped, the part of the
+// current block already filled is taken, the FIFO is emptied by hand and
+// the block is re-armed from the start.
+//
+// Returns the new edit index.
+//
+//*****************************************************************************
+static uint32_t
+UARTDMARxService(tUARTStdio *psUART, uint32_t ui32Edit, bool bTimeout)
+{
+    unsigned char *pcBlock;
+    uint32_t ui32Count;
+    uint32_t ui32Idx;
+
+    //
+    // Stop the channel first so the current block can't complete while we
+    // look at it.
+    //
+    if(bTimeout)
+    {
+        MAP_uDMAChannelDisable(psUART->ui32DMARxChannel);
+    }
+
+    //
+    // Take every finished block.
+    //
+    while(MAP_uDMAChannelModeGet(psUART->ui32DMARxChannel |
+                                 psUART->ui32DMARxSelect) == UDMA_MODE_STOP)
+    {
+        pcBlock = psUART->pcRxDMABuffer[(psUART->ui32DMARxSelect ==
+                                         UDMA_ALT_SELECT) ? 1 : 0];
+
+        for(ui32Idx = 0; ui32Idx < UART_RX_DMA_BLOCK; ui32Idx++)
         {
-            MAP_UARTCharPutNonBlocking(ui32Base,
-                                      g_pcUARTTxBuffer[g_ui32UARTTxReadIndex]);
-            ADVANCE_TX_BUFFER_INDEX(g_ui32UARTTxReadIndex);
+            ui32Edit = UARTRxChar(psUART, ui32Edit, pcBlock[ui32Idx]);
         }
 
+        UARTDMARxArm(psUART, psUART->ui32DMARxSelect);
+        psUART->ui32DMARxSelect ^= UDMA_ALT_SELECT;
+    }
+
+    if(bTimeout)
+    {
         //
-        // Reenable the UART interrupt.
+        // Part of the current block, then whatever is left in the FIFO.
         //
-        MAP_IntEnable(g_ui32UARTInt[g_ui32PortNum]);
+        pcBlock = psUART->pcRxDMABuffer[(psUART->ui32DMARxSelect ==
+                                         UDMA_ALT_SELECT) ? 1 : 0];
+        ui32Count = UART_RX_DMA_BLOCK -
+                    MAP_uDMAChannelSizeGet(psUART->ui32DMARxChannel |
+                                           psUART->ui32DMARxSelect);
+
+        for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+        {
+            ui32Edit = UARTRxChar(psUART, ui32Edit, pcBlock[ui32Idx]);
+        }
+
+        while(MAP_UARTCharsAvail(psUART->ui32Base))
+        {
+            ui32Edit = UARTRxChar(psUART, ui32Edit,
+                                  MAP_UARTCharGetNonBlocking(psUART->ui32Base) &
+                                  0xFF);
+        }
+
+        UARTDMARxArm(psUART, psUART->ui32DMARxSelect);
+        MAP_uDMAChannelEnable(psUART->ui32DMARxChannel);
     }
+
+    return(ui32Edit);
 }
 #endif
 
 //*****************************************************************************
 //
-//! Configures the UART console.
+// Take as many bytes from the echo and transmit buffers as we have space for
+// and move them into the UART transmit FIFO.  Only called from the interrupt
+// handler, which makes it the single consumer of the transmit buffer.  In
+// uDMA mode the transmit buffer goes to the TX channel instead and only the
+// echo is written to the FIFO directly.
+//
+// Returns true if the TX FIFO interrupt is needed to carry on.
+//
+//*****************************************************************************
+#ifdef UART_BUFFERED
+static bool
+UARTPrimeTransmit(tUARTStdio *psUART)
+{
+    uint32_t ui32Base;
+    uint32_t ui32Read;
+    uint32_t ui32Write;
+
+    ui32Base = psUART->ui32Base;
+
+#ifdef UART_DMA
+    //
+    // Retire a finished transfer.  While one is still running there is
+    // nothing to do, its completion brings us back here.
+    //
+    if(psUART->ui32DMATxCount != 0)
+    {
+        if(MAP_uDMAChannelIsEnabled(psUART->ui32DMATxChannel))
+        {
+            return(false);
+        }
+
+        RING_BARRIER();
+        psUART->ui32TxReadIndex += psUART->ui32DMATxCount;
+        psUART->ui32DMATxCount = 0;
+    }
+#endif
+
+    //
+    // Echo goes first so typing stays responsive behind long output.
+    //
+    while((psUART->ui32EchoReadIndex != psUART->ui32EchoWriteIndex) &&
+          MAP_UARTSpaceAvail(ui32Base))
+    {
+        MAP_UARTCharPutNonBlocking(ui32Base,
+                                   psUART->pcEchoBuffer[
+                                       psUART->ui32EchoReadIndex &
+                                       ECHO_BUFFER_MASK]);
+        psUART->ui32EchoReadIndex++;
+    }
+
+    //
+    // Take a snapshot of the transmit buffer.  Everything up to the write
+    // index was completely written before the index was published.
+    //
+    ui32Read = psUART->ui32TxReadIndex;
+    ui32Write = psUART->ui32TxWriteIndex;
+    RING_BARRIER();
+
+#ifdef UART_DMA
+    //
+    // Let the echo drain through the FIFO first so it stays in order, the
+    // TX interrupt comes back when there is space.
+    //
+    if(psUART->ui32EchoReadIndex != psUART->ui32EchoWriteIndex)
+    {
+        return(true);
+    }
+
+    //
+    // Hand the next contiguous run of the buffer to the TX channel.  The
+    // read index moves up once the transfer has finished.
+    //
+    if(ui32Read != ui32Write)
+    {
+        uint32_t ui32Count;
+        uint32_t ui32Contig;
+
+        ui32Count = ui32Write - ui32Read;
+        ui32Contig = TX_BUFFER_SIZE(psUART) - (ui32Read & psUART->ui32TxMask);
+        if(ui32Count > ui32Contig)
+        {
+            ui32Count = ui32Contig;
+        }
+        if(ui32Count > DMA_MAX_TRANSFER)
+        {
+            ui32Count = DMA_MAX_TRANSFER;
+        }
+
+        MAP_uDMAChannelTransferSet(psUART->ui32DMATxChannel | UDMA_PRI_SELECT,
+                                   UDMA_MODE_BASIC,
+                                   &psUART->pcTxBuffer[ui32Read &
+                                                       psUART->ui32TxMask],
+                                   (void *)(ui32Base + UART_O_DR), ui32Count);
+        psUART->ui32DMATxCount = ui32Count;
+        MAP_uDMAChannelEnable(psUART->ui32DMATxChannel);
+    }
+
+    return(false);
+#else
+
+    while((ui32Read != ui32Write) && MAP_UARTSpaceAvail(ui32Base))
+    {
+        MAP_UARTCharPutNonBlocking(ui32Base,
+                                   psUART->pcTxBuffer[ui32Read &
+                                                      psUART->ui32TxMask]);
+        ui32Read++;
+    }
+
+    //
+    // Hand the slots back to UARTStdioWrite().
+    //
+    RING_BARRIER();
+    psUART->ui32TxReadIndex = ui32Read;
+
+    return((ui32Read != ui32Write) ||
+           (psUART->ui32EchoReadIndex != psUART->ui32EchoWriteIndex));
+#endif
+}
+#endif
+
+//*****************************************************************************
+//
+//! Opens a UART console instance.
 //!
-//! \param ui32PortNum is the number of UART port to use for the serial console
-//! (0-2)
+//! \param psUART points to the instance to initialize.  It must stay valid
+//! for as long as the console is in use.
+//! \param ui32PortNum is the number of UART port to use for the console (0-2)
 //! \param ui32Baud is the bit rate that the UART is to be configured to use.
 //! \param ui32SrcClock is the frequency of the source clock for the UART
 //! module.
+//! \param pcTxBuffer points to the transmit buffer for this instance.
+//! \param ui32TxSize is the size of the transmit buffer, a power of two.
+//! \param pcRxBuffer points to the receive buffer for this instance.
+//! \param ui32RxSize is the size of the receive buffer, a power of two.
 //!
 //! This function will configure the specified serial port to be used as a
-//! serial console.  The serial parameters are set to the baud rate
-//! specified by the \e ui32Baud parameter and use 8 bit, no parity, and 1 stop
-//! bit.
+//! console and return a handle for the UARTStdio functions that take one.
+//! The serial parameters are set to the baud rate specified by the
+//! \e ui32Baud parameter and use 8 bit, no parity, and 1 stop bit.  Any
+//! number of instances may be open, one per UART, each with its own buffers
+//! and echo setting.  Echo starts out enabled.
 //!
-//! This function must be called prior to using any of the other UART console
-//! functions: UARTprintf() or UARTgets().  This function assumes that the
-//! caller has previously configured the relevant UART pins for operation as a
-//! UART rather than as GPIOs.
+//! The buffers are only used when the module is built with
+//! \b UART_BUFFERED; otherwise they may be 0.  In buffered mode the
+//! interrupt for the port must reach UARTStdioIntProcess() for this
+//! instance, which the UARTStdio0IntHandler() to UARTStdio2IntHandler()
+//! entry points do when placed in the vector table.
 //!
-//! \return None.
+//! This function assumes that the caller has previously configured the
+//! relevant UART pins for operation as a UART rather than as GPIOs.
+//!
+//! \return Returns the handle for the instance (\e psUART), or 0 if the
+//! UART is not present.
 //
 //*****************************************************************************
-void
-UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
+UARTStdioHandle
+UARTStdioInit(tUARTStdio *psUART, uint32_t ui32PortNum, uint32_t ui32Baud,
+              uint32_t ui32SrcClock, unsigned char *pcTxBuffer,
+              uint32_t ui32TxSize, unsigned char *pcRxBuffer,
+              uint32_t ui32RxSize)
 {
     //
     // Check the arguments.
     //
+    ASSERT(psUART != 0);
     ASSERT((ui32PortNum == 0) || (ui32PortNum == 1) ||
            (ui32PortNum == 2));
 
 #ifdef UART_BUFFERED
+    ASSERT((pcTxBuffer != 0) && (pcRxBuffer != 0));
+    ASSERT((ui32TxSize != 0) && ((ui32TxSize & (ui32TxSize - 1)) == 0));
+    ASSERT((ui32RxSize != 0) && ((ui32RxSize & (ui32RxSize - 1)) == 0));
+
     //
-    // In buffered mode, we only allow a single instance to be opened.
+    // In buffered mode, we only allow a single instance per UART to be
+    // opened.
     //
-    ASSERT(g_ui32Base == 0);
+    ASSERT(g_psUARTStdioPort[ui32PortNum] == 0);
 #endif
 
     //
@@ -351,13 +820,15 @@ UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
     //
     if(!MAP_SysCtlPeripheralPresent(g_ui32UARTPeriph[ui32PortNum]))
     {
-        return;
+        return(0);
     }
 
     //
     // Select the base address of the UART.
     //
-    g_ui32Base = g_ui32UARTBase[ui32PortNum];
+    psUART->ui32Base = g_ui32UARTBase[ui32PortNum];
+    psUART->ui32PortNum = ui32PortNum;
+    psUART->bLastWasCR = false;
 
     //
     // Enable the UART peripheral for use.
@@ -367,7 +838,7 @@ UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
     //
     // Configure the UART for 115200, n, 8, 1
     //
-    MAP_UARTConfigSetExpClk(g_ui32Base, ui32SrcClock, ui32Baud,
+    MAP_UARTConfigSetExpClk(psUART->ui32Base, ui32SrcClock, ui32Baud,
                             (UART_CONFIG_PAR_NONE | UART_CONFIG_STOP_ONE |
                              UART_CONFIG_WLEN_8));
 
@@ -376,18 +847,31 @@ UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
     // Set the UART to interrupt whenever the TX FIFO is almost empty or
     // when any character is received.
     //
-    MAP_UARTFIFOLevelSet(g_ui32Base, UART_FIFO_TX1_8, UART_FIFO_RX1_8);
+    MAP_UARTFIFOLevelSet(psUART->ui32Base, UART_FIFO_TX1_8, UART_FIFO_RX1_8);
 
     //
-    // Flush both the buffers.
+    // Start with echo on and both buffers empty.
     //
-    UARTFlushRx();
-    UARTFlushTx(true);
+    psUART->bDisableEcho = false;
+    psUART->pfnRxHook = 0;
+    psUART->pvRxHookArg = 0;
+    psUART->pcTxBuffer = pcTxBuffer;
+    psUART->ui32TxMask = ui32TxSize - 1;
+    psUART->ui32TxWriteIndex = 0;
+    psUART->ui32TxReadIndex = 0;
+    psUART->pcRxBuffer = pcRxBuffer;
+    psUART->ui32RxMask = ui32RxSize - 1;
+    psUART->ui32RxWriteIndex = 0;
+    psUART->ui32RxReadIndex = 0;
+    psUART->ui32RxEditIndex = 0;
+    psUART->ui32RxDropped = 0;
+    psUART->ui32EchoWriteIndex = 0;
+    psUART->ui32EchoReadIndex = 0;
 
     //
-    // Remember which interrupt we are dealing with.
+    // Remember which instance the port's interrupt belongs to.
     //
-    g_ui32PortNum = ui32PortNum;
+    g_psUARTStdioPort[ui32PortNum] = psUART;
 
     //
     // We are configured for buffered output so enable the master interrupt
@@ -395,21 +879,125 @@ UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
     // transmit interrupt in the UART itself until some data has been placed
     // in the transmit buffer.
     //
-    MAP_UARTIntDisable(g_ui32Base, 0xFFFFFFFF);
-    MAP_UARTIntEnable(g_ui32Base, UART_INT_RX | UART_INT_RT);
+    MAP_UARTIntDisable(psUART->ui32Base, 0xFFFFFFFF);
+#ifdef UART_DMA
+    //
+    // The RX channel takes the data, only the receive timeout is needed to
+    // catch the tail of a message.
+    //
+    UARTDMAConfig(psUART);
+    MAP_UARTIntEnable(psUART->ui32Base, UART_INT_RT);
+#else
+    MAP_UARTIntEnable(psUART->ui32Base, UART_INT_RX | UART_INT_RT);
+#endif
     MAP_IntEnable(g_ui32UARTInt[ui32PortNum]);
+#else
+    //
+    // The buffers are not used in unbuffered mode.
+    //
+    (void)pcTxBuffer;
+    (void)ui32TxSize;
+    (void)pcRxBuffer;
+    (void)ui32RxSize;
 #endif
 
     //
     // Enable the UART operation.
     //
-    MAP_UARTEnable(g_ui32Base);
+    MAP_UARTEnable(psUART->ui32Base);
+
+    return(psUART);
 }
 
 //*****************************************************************************
 //
-//! Writes a string of characters to the UART output.
+//! Configures the UART console.
+//!
+//! \param ui32PortNum is the number of UART port to use for the serial console
+//! (0-2)
+//! \param ui32Baud is the bit rate that the UART is to be configured to use.
+//! \param ui32SrcClock is the frequency of the source clock for the UART
+//! module.
+//!
+//! This function will configure the specified serial port to be used as a
+//! serial console.  The serial parameters are set to the baud rate
+//! specified by the \e ui32Baud parameter and use 8 bit, no parity, and 1 stop
+//! bit.  It opens the default instance used by the functions that don't take
+//! a handle, with buffers of \b UART_TX_BUFFER_SIZE and
+//! \b UART_RX_BUFFER_SIZE bytes, and its interrupt is UARTStdioIntHandler().
+//!
+//! This function must be called prior to using any of the other UART console
+//! functions: UARTprintf() or UARTgets().  This function assumes that the
+//! caller has previously configured the relevant UART pins for operation as a
+//! UART rather than as GPIOs.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
+{
+#ifdef UART_BUFFERED
+    //
+    // In buffered mode, we only allow the default instance to be opened
+    // once.
+    //
+    ASSERT(g_sUARTStdio.ui32Base == 0);
+
+    UARTStdioInit(&g_sUARTStdio, ui32PortNum, ui32Baud, ui32SrcClock,
+                  g_pcUARTTxBuffer, UART_TX_BUFFER_SIZE,
+                  g_pcUARTRxBuffer, UART_RX_BUFFER_SIZE);
+#else
+    UARTStdioInit(&g_sUARTStdio, ui32PortNum, ui32Baud, ui32SrcClock,
+                  0, 0, 0, 0);
+#endif
+}
+
+//*****************************************************************************
+//
+//! Closes a UART console instance.
 //!
+//! \param psUART is the handle returned by UARTStdioInit().
+//!
+//! This function disables the UART and its interrupt and releases the port,
+//! so that UARTStdioInit() may open it again, for example with another baud
+//! rate or other buffers.  Anything still in the buffers or the FIFOs is
+//! discarded.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTStdioClose(UARTStdioHandle psUART)
+{
+    //
+    // Check the arguments.
+    //
+    ASSERT(psUART != 0);
+    ASSERT(psUART->ui32Base != 0);
+
+#ifdef UART_BUFFERED
+    //
+    // Stop the interrupt before the instance goes away.
+    //
+    MAP_IntDisable(g_ui32UARTInt[psUART->ui32PortNum]);
+    MAP_UARTIntDisable(psUART->ui32Base, 0xFFFFFFFF);
+#ifdef UART_DMA
+    MAP_uDMAChannelDisable(psUART->ui32DMARxChannel);
+    MAP_uDMAChannelDisable(psUART->ui32DMATxChannel);
+#endif
+    g_psUARTStdioPort[psUART->ui32PortNum] = 0;
+#endif
+
+    MAP_UARTDisable(psUART->ui32Base);
+    psUART->ui32Base = 0;
+}
+
+//*****************************************************************************
+//
+//! Writes a string of characters to a UART console.
+//!
+//! \param psUART is the handle returned by UARTStdioInit().
 //! \param pcBuf points to a buffer containing the string to transmit.
 //! \param ui32Len is the length of the string to transmit.
 //!
@@ -433,16 +1021,30 @@ UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
 //
 //*****************************************************************************
 int
-UARTwrite(const char *pcBuf, uint32_t ui32Len)
+UARTStdioWrite(UARTStdioHandle psUART, const char *pcBuf, uint32_t ui32Len)
 {
 #ifdef UART_BUFFERED
     unsigned int uIdx;
+    uint32_t ui32Write;
+    uint32_t ui32Limit;
+    uint32_t ui32Mask;
+    unsigned char *pcTxBuffer;
 
     //
     // Check for valid arguments.
     //
     ASSERT(pcBuf != 0);
-    ASSERT(g_ui32Base != 0);
+    ASSERT(psUART != 0);
+    ASSERT(psUART->ui32Base != 0);
+
+    //
+    // Work on a local copy of the write index.  The interrupt handler can
+    // only free space while we run, so the limit taken here is safe.
+    //
+    ui32Write = psUART->ui32TxWriteIndex;
+    ui32Limit = psUART->ui32TxReadIndex + TX_BUFFER_SIZE(psUART);
+    ui32Mask = psUART->ui32TxMask;
+    pcTxBuffer = psUART->pcTxBuffer;
 
     //
     // Send the characters
@@ -455,10 +1057,10 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
         //
         if(pcBuf[uIdx] == '\n')
         {
-            if(!TX_BUFFER_FULL)
+            if(ui32Write != ui32Limit)
             {
-                g_pcUARTTxBuffer[g_ui32UARTTxWriteIndex] = '\r';
-                ADVANCE_TX_BUFFER_INDEX(g_ui32UARTTxWriteIndex);
+                pcTxBuffer[ui32Write & ui32Mask] = '\r';
+                ui32Write++;
             }
             else
             {
@@ -472,10 +1074,10 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
         //
         // Send the character to the UART output.
         //
-        if(!TX_BUFFER_FULL)
+        if(ui32Write != ui32Limit)
         {
-            g_pcUARTTxBuffer[g_ui32UARTTxWriteIndex] = pcBuf[uIdx];
-            ADVANCE_TX_BUFFER_INDEX(g_ui32UARTTxWriteIndex);
+            pcTxBuffer[ui32Write & ui32Mask] = pcBuf[uIdx];
+            ui32Write++;
         }
         else
         {
@@ -486,14 +1088,23 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
         }
     }
 
+    //
+    // Publish the new characters once they are all in the buffer.
+    //
+    RING_BARRIER();
+    psUART->ui32TxWriteIndex = ui32Write;
+
     //
     // If we have anything in the buffer, make sure that the UART is set
-    // up to transmit it.
+    // up to transmit it.  Rather than touching the FIFO from here, pend the
+    // UART interrupt so the handler stays the only reader of the buffer.
     //
-    if(!TX_BUFFER_EMPTY)
+    if(!TX_BUFFER_EMPTY(psUART))
     {
-        UARTPrimeTransmit(g_ui32Base);
-        MAP_UARTIntEnable(g_ui32Base, UART_INT_TX);
+#ifndef UART_DMA
+        MAP_UARTIntEnable(psUART->ui32Base, UART_INT_TX);
+#endif
+        MAP_IntPendSet(g_ui32UARTInt[psUART->ui32PortNum]);
     }
 
     //
@@ -506,7 +1117,8 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
     //
     // Check for valid UART base address, and valid arguments.
     //
-    ASSERT(g_ui32Base != 0);
+    ASSERT(psUART != 0);
+    ASSERT(psUART->ui32Base != 0);
     ASSERT(pcBuf != 0);
 
     //
@@ -520,13 +1132,13 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
         //
         if(pcBuf[uIdx] == '\n')
         {
-            MAP_UARTCharPut(g_ui32Base, '\r');
+            MAP_UARTCharPut(psUART->ui32Base, '\r');
         }
 
         //
         // Send the character to the UART output.
         //
-        MAP_UARTCharPut(g_ui32Base, pcBuf[uIdx]);
+        MAP_UARTCharPut(psUART->ui32Base, pcBuf[uIdx]);
     }
 
     //
@@ -536,10 +1148,30 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
 #endif
 }
 
+//*****************************************************************************
+//
+//! Writes a string of characters to the UART output.
+//!
+//! \param pcBuf points to a buffer containing the string to transmit.
+//! \param ui32Len is the length of the string to transmit.
+//!
+//! This function is UARTStdioWrite() on the console opened by
+//! UARTStdioConfig().
+//!
+//! \return Returns the count of characters written.
+//
+//*****************************************************************************
+int
+UARTwrite(const char *pcBuf, uint32_t ui32Len)
+{
+    return(UARTStdioWrite(&g_sUARTStdio, pcBuf, ui32Len));
+}
+
 //*****************************************************************************
 //
 //! A simple UART based get string function, with some line processing.
 //!
+//! \param psUART is the handle returned by UARTStdioInit().
 //! \param pcBuf points to a buffer for the incoming string from the UART.
 //! \param ui32Len is the length of the buffer for storage of the string,
 //! including the trailing 0.
@@ -554,9 +1186,9 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
 //!
 //! In both buffered and unbuffered modes, this function will block until
 //! a termination character is received.  If non-blocking operation is required
-//! in buffered mode, a call to UARTPeek() may be made to determine whether
-//! a termination character already exists in the receive buffer prior to
-//! calling UARTgets().
+//! in buffered mode, a call to UARTStdioPeek() may be made to determine
+//! whether a termination character already exists in the receive buffer prior
+//! to calling UARTStdioGets().
 //!
 //! Since the string will be null terminated, the user must ensure that the
 //! buffer is sized to allow for the additional null character.
@@ -566,7 +1198,7 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
 //
 //*****************************************************************************
 int
-UARTgets(char *pcBuf, uint32_t ui32Len)
+UARTStdioGets(UARTStdioHandle psUART, char *pcBuf, uint32_t ui32Len)
 {
 #ifdef UART_BUFFERED
     uint32_t ui32Count = 0;
@@ -577,7 +1209,8 @@ UARTgets(char *pcBuf, uint32_t ui32Len)
     //
     ASSERT(pcBuf != 0);
     ASSERT(ui32Len != 0);
-    ASSERT(g_ui32Base != 0);
+    ASSERT(psUART != 0);
+    ASSERT(psUART->ui32Base != 0);
 
     //
     // Adjust the length back by 1 to leave space for the trailing
@@ -593,10 +1226,9 @@ UARTgets(char *pcBuf, uint32_t ui32Len)
         //
         // Read the next character from the receive buffer.
         //
-        if(!RX_BUFFER_EMPTY)
+        if(!RX_BUFFER_EMPTY(psUART))
         {
-            cChar = g_pcUARTRxBuffer[g_ui32UARTRxReadIndex];
-            ADVANCE_RX_BUFFER_INDEX(g_ui32UARTRxReadIndex);
+            cChar = RxBufferGet(psUART);
 
             //
             // See if a newline or escape character was received.
@@ -642,14 +1274,14 @@ UARTgets(char *pcBuf, uint32_t ui32Len)
 #else
     uint32_t ui32Count = 0;
     int8_t cChar;
-    static int8_t bLastWasCR = 0;
 
     //
     // Check the arguments.
     //
     ASSERT(pcBuf != 0);
     ASSERT(ui32Len != 0);
-    ASSERT(g_ui32Base != 0);
+    ASSERT(psUART != 0);
+    ASSERT(psUART->ui32Base != 0);
 
     //
     // Adjust the length back by 1 to leave space for the trailing
@@ -665,7 +1297,7 @@ UARTgets(char *pcBuf, uint32_t ui32Len)
         //
         // Read the next character from the console.
         //
-        cChar = MAP_UARTCharGet(g_ui32Base);
+        cChar = MAP_UARTCharGet(psUART->ui32Base);
 
         //
         // See if the backspace key was pressed.
@@ -681,7 +1313,7 @@ UARTgets(char *pcBuf, uint32_t ui32Len)
                 //
                 // Rub out the previous character.
                 //
-                UARTwrite("\b \b", 3);
+                UARTStdioWrite(psUART, "\b \b", 3);
 
                 //
                 // Decrement the number of characters in the buffer.
@@ -699,9 +1331,9 @@ UARTgets(char *pcBuf, uint32_t ui32Len)
         // If this character is LF and last was CR, then just gobble up the
         // character because the EOL processing was taken care of with the CR.
         //
-        if((cChar == '\n') && bLastWasCR)
+        if((cChar == '\n') && psUART->bLastWasCR)
         {
-            bLastWasCR = 0;
+            psUART->bLastWasCR = false;
             continue;
         }
 
@@ -717,7 +1349,7 @@ UARTgets(char *pcBuf, uint32_t ui32Len)
             //
             if(cChar == '\r')
             {
-                bLastWasCR = 1;
+                psUART->bLastWasCR = true;
             }
 
             //
@@ -746,7 +1378,7 @@ UARTgets(char *pcBuf, uint32_t ui32Len)
             //
             // Reflect the character back to the user.
             //
-            MAP_UARTCharPut(g_ui32Base, cChar);
+            MAP_UARTCharPut(psUART->ui32Base, cChar);
         }
     }
 
@@ -758,7 +1390,7 @@ UARTgets(char *pcBuf, uint32_t ui32Len)
     //
     // Send a CRLF pair to the terminal to end the line.
     //
-    UARTwrite("\r\n", 2);
+    UARTStdioWrite(psUART, "\r\n", 2);
 
     //
     // Return the count of int8_ts in the buffer, not counting the trailing 0.
@@ -769,29 +1401,53 @@ UARTgets(char *pcBuf, uint32_t ui32Len)
 
 //*****************************************************************************
 //
-//! Read a single character from the UART, blocking if necessary.
+//! A simple UART based get string function, with some line processing.
+//!
+//! \param pcBuf points to a buffer for the incoming string from the UART.
+//! \param ui32Len is the length of the buffer for storage of the string,
+//! including the trailing 0.
+//!
+//! This function is UARTStdioGets() on the console opened by
+//! UARTStdioConfig().
+//!
+//! \return Returns the count of characters that were stored, not including
+//! the trailing 0.
+//
+//*****************************************************************************
+int
+UARTgets(char *pcBuf, uint32_t ui32Len)
+{
+    return(UARTStdioGets(&g_sUARTStdio, pcBuf, ui32Len));
+}
+
+//*****************************************************************************
+//
+//! Read a single character from a UART console, blocking if necessary.
+//!
+//! \param psUART is the handle returned by UARTStdioInit().
 //!
 //! This function will receive a single character from the UART and store it at
 //! the supplied address.
 //!
 //! In both buffered and unbuffered modes, this function will block until a
 //! character is received.  If non-blocking operation is required in buffered
-//! mode, a call to UARTRxAvail() may be made to determine whether any
-//! characters are currently available for reading.
+//! mode, a call to UARTStdioRxBytesAvail() may be made to determine whether
+//! any characters are currently available for reading.
 //!
 //! \return Returns the character read.
 //
 //*****************************************************************************
 unsigned char
-UARTgetc(void)
+UARTStdioGetc(UARTStdioHandle psUART)
 {
-#ifdef UART_BUFFERED
-    unsigned char cChar;
+    ASSERT(psUART != 0);
+    ASSERT(psUART->ui32Base != 0);
 
+#ifdef UART_BUFFERED
     //
     // Wait for a character to be received.
     //
-    while(RX_BUFFER_EMPTY)
+    while(RX_BUFFER_EMPTY(psUART))
     {
         //
         // Block waiting for a character to be received (if the buffer is
@@ -800,35 +1456,68 @@ UARTgetc(void)
     }
 
     //
-    // Read a character from the buffer.
+    // Read a character from the buffer and return it to the caller.
     //
-    cChar = g_pcUARTRxBuffer[g_ui32UARTRxReadIndex];
-    ADVANCE_RX_BUFFER_INDEX(g_ui32UARTRxReadIndex);
-
-    //
-    // Return the character to the caller.
-    //
-    return(cChar);
+    return(RxBufferGet(psUART));
 #else
     //
     // Block until a character is received by the UART then return it to
     // the caller.
     //
-    return(MAP_UARTCharGet(g_ui32Base));
+    return(MAP_UARTCharGet(psUART->ui32Base));
 #endif
 }
 
+//*****************************************************************************
+//
+//! Read a single character from the UART, blocking if necessary.
+//!
+//! This function is UARTStdioGetc() on the console opened by
+//! UARTStdioConfig().
+//!
+//! \return Returns the character read.
+//
+//*****************************************************************************
+unsigned char
+UARTgetc(void)
+{
+    return(UARTStdioGetc(&g_sUARTStdio));
+}
+
+//*****************************************************************************
+//
+//! Writes formatter output to a UART console.
+//!
+//! \param pvSink is the handle returned by UARTStdioInit().
+//! \param pcBuf points to the characters to write.
+//! \param ui32Len is the number of characters.
+//!
+//! This function is a tUSinkFxn for uvsinkprintf() and ufmtsink(); it is
+//! UARTStdioWrite() with the handle passed as \e pvSink.  UARTStdioVPrintf()
+//! and UARTStdioFmt() print through it.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTStdioSink(void *pvSink, const char *pcBuf, uint32_t ui32Len)
+{
+    UARTStdioWrite((UARTStdioHandle)pvSink, pcBuf, ui32Len);
+}
+
 //*****************************************************************************
 //
 //! A simple UART based vprintf function supporting \%c, \%d, \%p, \%s, \%u,
 //! \%x, and \%X.
 //!
+//! \param psUART is the handle returned by UARTStdioInit().
 //! \param pcString is the format string.
 //! \param vaArgP is a variable argument list pointer whose content will depend
 //! upon the format string passed in \e pcString.
 //!
 //! This function is very similar to the C library <tt>vprintf()</tt> function.
-//! All of its output will be sent to the UART.  Only the following formatting
+//! All of its output will be sent to the UART, through UARTStdioSink() and the
+//! same formatter that uvsnprintf() uses.  Only the following formatting
 //! characters are supported:
 //!
 //! - \%c to print a character
@@ -839,6 +1528,9 @@ UARTgetc(void)
 //! - \%X to print a hexadecimal value using lower case letters (not upper case
 //! letters as would typically be used)
 //! - \%p to print a pointer as a hexadecimal value
+//! - \%e, \%f, or \%g to print a floating-point value, see ufmtfloat()
+//! - \%q to print a Q-format fixed-point value, see ufmtfixed(); it takes two
+//! arguments, the number of fraction bits and then the value
 //! - \%\% to print out a \% character
 //!
 //! For \%s, \%d, \%i, \%u, \%p, \%x, and \%X, an optional number may reside
@@ -849,6 +1541,11 @@ UARTgetc(void)
 //! added to reach eight; ``\%08d'' will use eight characters as well but will
 //! add zeroes instead of spaces.
 //!
+//! For \%e, \%f, \%g, and \%q a precision may follow the width, as in
+//! ``\%8.3f''.  It is the number of digits after the decimal point, or the
+//! number of significant digits for \%g, and defaults to six.  Precision is
+//! ignored by the other conversions.
+//!
 //! The type of the arguments in the variable arguments list must match the
 //! requirements of the format string.  For example, if an integer was passed
 //! where a string was expected, an error of some kind will most likely occur.
@@ -857,397 +1554,78 @@ UARTgetc(void)
 //
 //*****************************************************************************
 void
-UARTvprintf(const char *pcString, va_list vaArgP)
+UARTStdioVPrintf(UARTStdioHandle psUART, const char *pcString, va_list vaArgP)
 {
-    uint32_t ui32Idx, ui32Value, ui32Pos, ui32Count, ui32Base, ui32Neg;
-    char *pcStr, pcBuf[16], cFill;
-
     //
     // Check the arguments.
     //
+    ASSERT(psUART != 0);
     ASSERT(pcString != 0);
 
     //
-    // Loop while there are more characters in the string.
+    // Format through the UART sink.
     //
-    while(*pcString)
-    {
-        //
-        // Find the first non-% character, or the end of the string.
-        //
-        for(ui32Idx = 0;
-            (pcString[ui32Idx] != '%') && (pcString[ui32Idx] != '\0');
-            ui32Idx++)
-        {
-        }
-
-        //
-        // Write this portion of the string.
-        //
-        UARTwrite(pcString, ui32Idx);
-
-        //
-        // Skip the portion of the string that was written.
-        //
-        pcString += ui32Idx;
-
-        //
-        // See if the next character is a %.
-        //
-        if(*pcString == '%')
-        {
-            //
-            // Skip the %.
-            //
-            pcString++;
-
-            //
-            // Set the digit count to zero, and the fill character to space
-            // (in other words, to the defaults).
-            //
-            ui32Count = 0;
-            cFill = ' ';
-
-            //
-            // It may be necessary to get back here to process more characters.
-            // Goto's aren't pretty, but effective.  I feel extremely dirty for
-            // using not one but two of the beasts.
-            //
-again:
-
-            //
-            // Determine how to handle the next character.
-            //
-            switch(*pcString++)
-            {
-                //
-                // Handle the digit characters.
-                //
-                case '0':
-                case '1':
-                case '2':
-                case '3':
-                case '4':
-                case '5':
-                case '6':
-                case '7':
-                case '8':
-                case '9':
-                {
-                    //
-                    // If this is a zero, and it is the first digit, then the
-                    // fill character is a zero instead of a space.
-                    //
-                    if((pcString[-1] == '0') && (ui32Count == 0))
-                    {
-                        cFill = '0';
-                    }
-
-                    //
-                    // Update the digit count.
-                    //
-                    ui32Count *= 10;
-                    ui32Count += pcString[-1] - '0';
-
-                    //
-                    // Get the next character.
-                    //
-                    goto again;
-                }
-
-                //
-                // Handle the %c command.
-                //
-                case 'c':
-                {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ui32Value = va_arg(vaArgP, uint32_t);
-
-                    //
-                    // Print out the character.
-                    //
-                    UARTwrite((char *)&ui32Value, 1);
-
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
-
-                //
-                // Handle the %d and %i commands.
-                //
-                case 'd':
-                case 'i':
-                {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ui32Value = va_arg(vaArgP, uint32_t);
-
-                    //
-                    // Reset the buffer position.
-                    //
-                    ui32Pos = 0;
-
-                    //
-                    // If the value is negative, make it positive and indicate
-                    // that a minus sign is needed.
-                    //
-                    if((int32_t)ui32Value < 0)
-                    {
-                        //
-                        // Make the value positive.
-                        //
-                        ui32Value = -(int32_t)ui32Value;
-
-                        //
-                        // Indicate that the value is negative.
-                        //
-                        ui32Neg = 1;
-                    }
-                    else
-                    {
-                        //
-                        // Indicate that the value is positive so that a minus
-                        // sign isn't inserted.
-                        //
-                        ui32Neg = 0;
-                    }
-
-                    //
-                    // Set the base to 10.
-                    //
-                    ui32Base = 10;
-
-                    //
-                    // Convert the value to ASCII.
-                    //
-                    goto convert;
-                }
+    uvsinkprintf(UARTStdioSink, psUART, pcString, vaArgP);
+}
 
-                //
-                // Handle the %s command.
-                //
-                case 's':
-                {
-                    //
-                    // Get the string pointer from the varargs.
-                    //
-                    pcStr = va_arg(vaArgP, char *);
-
-                    //
-                    // Determine the length of the string.
-                    //
-                    for(ui32Idx = 0; pcStr[ui32Idx] != '\0'; ui32Idx++)
-                    {
-                    }
-
-                    //
-                    // Write the string.
-                    //
-                    UARTwrite(pcStr, ui32Idx);
-
-                    //
-                    // Write any required padding spaces
-                    //
-                    if(ui32Count > ui32Idx)
-                    {
-                        ui32Count -= ui32Idx;
-                        while(ui32Count--)
-                        {
-                            UARTwrite(" ", 1);
-                        }
-                    }
-
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
+//*****************************************************************************
+//
+//! A simple UART based vprintf function supporting \%c, \%d, \%p, \%s, \%u,
+//! \%x, and \%X.
+//!
+//! \param pcString is the format string.
+//! \param vaArgP is a variable argument list pointer whose content will depend
+//! upon the format string passed in \e pcString.
+//!
+//! This function is UARTStdioVPrintf() on the console opened by
+//! UARTStdioConfig().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTvprintf(const char *pcString, va_list vaArgP)
+{
+    UARTStdioVPrintf(&g_sUARTStdio, pcString, vaArgP);
+}
 
-                //
-                // Handle the %u command.
-                //
-                case 'u':
-                {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ui32Value = va_arg(vaArgP, uint32_t);
-
-                    //
-                    // Reset the buffer position.
-                    //
-                    ui32Pos = 0;
-
-                    //
-                    // Set the base to 10.
-                    //
-                    ui32Base = 10;
-
-                    //
-                    // Indicate that the value is positive so that a minus sign
-                    // isn't inserted.
-                    //
-                    ui32Neg = 0;
-
-                    //
-                    // Convert the value to ASCII.
-                    //
-                    goto convert;
-                }
+//*****************************************************************************
+//
+//! A simple UART based printf function supporting \%c, \%d, \%p, \%s, \%u,
+//! \%x, and \%X.
+//!
+//! \param psUART is the handle returned by UARTStdioInit().
+//! \param pcString is the format string.
+//! \param ... are the optional arguments, which depend on the contents of the
+//! format string.
+//!
+//! This function is very similar to the C library <tt>fprintf()</tt> function.
+//! All of its output will be sent to the UART.  The supported formatting
+//! characters are those of UARTStdioVPrintf().
+//!
+//! The type of the arguments after \e pcString must match the requirements of
+//! the format string.  For example, if an integer was passed where a string
+//! was expected, an error of some kind will most likely occur.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTStdioPrintf(UARTStdioHandle psUART, const char *pcString, ...)
+{
+    va_list vaArgP;
 
-                //
-                // Handle the %x and %X commands.  Note that they are treated
-                // identically; in other words, %X will use lower case letters
-                // for a-f instead of the upper case letters it should use.  We
-                // also alias %p to %x.
-                //
-                case 'x':
-                case 'X':
-                case 'p':
-                {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ui32Value = va_arg(vaArgP, uint32_t);
-
-                    //
-                    // Reset the buffer position.
-                    //
-                    ui32Pos = 0;
-
-                    //
-                    // Set the base to 16.
-                    //
-                    ui32Base = 16;
-
-                    //
-                    // Indicate that the value is positive so that a minus sign
-                    // isn't inserted.
-                    //
-                    ui32Neg = 0;
-
-                    //
-                    // Determine the number of digits in the string version of
-                    // the value.
-                    //
-convert:
-                    for(ui32Idx = 1;
-                        (((ui32Idx * ui32Base) <= ui32Value) &&
-                         (((ui32Idx * ui32Base) / ui32Base) == ui32Idx));
-                        ui32Idx *= ui32Base, ui32Count--)
-                    {
-                    }
-
-                    //
-                    // If the value is negative, reduce the count of padding
-                    // characters needed.
-                    //
-                    if(ui32Neg)
-                    {
-                        ui32Count--;
-                    }
-
-                    //
-                    // If the value is negative and the value is padded with
-                    // zeros, then place the minus sign before the padding.
-                    //
-                    if(ui32Neg && (cFill == '0'))
-                    {
-                        //
-                        // Place the minus sign in the output buffer.
-                        //
-                        pcBuf[ui32Pos++] = '-';
-
-                        //
-                        // The minus sign has been placed, so turn off the
-                        // negative flag.
-                        //
-                        ui32Neg = 0;
-                    }
-
-                    //
-                    // Provide additional padding at the beginning of the
-                    // string conversion if needed.
-                    //
-                    if((ui32Count > 1) && (ui32Count < 16))
-                    {
-                        for(ui32Count--; ui32Count; ui32Count--)
-                        {
-                            pcBuf[ui32Pos++] = cFill;
-                        }
-                    }
-
-                    //
-                    // If the value is negative, then place the minus sign
-                    // before the number.
-                    //
-                    if(ui32Neg)
-                    {
-                        //
-                        // Place the minus sign in the output buffer.
-                        //
-                        pcBuf[ui32Pos++] = '-';
-                    }
-
-                    //
-                    // Convert the value into a string.
-                    //
-                    for(; ui32Idx; ui32Idx /= ui32Base)
-                    {
-                        pcBuf[ui32Pos++] =
-                            g_pcHex[(ui32Value / ui32Idx) % ui32Base];
-                    }
-
-                    //
-                    // Write the string.
-                    //
-                    UARTwrite(pcBuf, ui32Pos);
-
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
+    //
+    // Start the varargs processing.
+    //
+    va_start(vaArgP, pcString);
 
-                //
-                // Handle the %% command.
-                //
-                case '%':
-                {
-                    //
-                    // Simply write a single %.
-                    //
-                    UARTwrite(pcString - 1, 1);
-
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
+    UARTStdioVPrintf(psUART, pcString, vaArgP);
 
-                //
-                // Handle all other commands.
-                //
-                default:
-                {
-                    //
-                    // Indicate an error.
-                    //
-                    UARTwrite("ERROR", 5);
-
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
-            }
-        }
-    }
+    //
+    // We're finished with the varargs now.
+    //
+    va_end(vaArgP);
 }
 
 //*****************************************************************************
@@ -1271,6 +1649,9 @@ convert:
 //! - \%X to print a hexadecimal value using lower case letters (not upper case
 //! letters as would typically be used)
 //! - \%p to print a pointer as a hexadecimal value
+//! - \%e, \%f, or \%g to print a floating-point value, see ufmtfloat()
+//! - \%q to print a Q-format fixed-point value, see ufmtfixed(); it takes two
+//! arguments, the number of fraction bits and then the value
 //! - \%\% to print out a \% character
 //!
 //! For \%s, \%d, \%i, \%u, \%p, \%x, and \%X, an optional number may reside
@@ -1281,10 +1662,17 @@ convert:
 //! added to reach eight; ``\%08d'' will use eight characters as well but will
 //! add zeroes instead of spaces.
 //!
+//! For \%e, \%f, \%g, and \%q a precision may follow the width, as in
+//! ``\%8.3f''.  It is the number of digits after the decimal point, or the
+//! number of significant digits for \%g, and defaults to six.  Precision is
+//! ignored by the other conversions.
+//!
 //! The type of the arguments after \e pcString must match the requirements of
 //! the format string.  For example, if an integer was passed where a string
 //! was expected, an error of some kind will most likely occur.
 //!
+//! Output goes to the console opened by UARTStdioConfig().
+//!
 //! \return None.
 //
 //*****************************************************************************
@@ -1298,7 +1686,7 @@ UARTprintf(const char *pcString, ...)
     //
     va_start(vaArgP, pcString);
 
-    UARTvprintf(pcString, vaArgP);
+    UARTStdioVPrintf(&g_sUARTStdio, pcString, vaArgP);
 
     //
     // We're finished with the varargs now.
@@ -1306,10 +1694,64 @@ UARTprintf(const char *pcString, ...)
     va_end(vaArgP);
 }
 
+//*****************************************************************************
+//
+//! Prints with a precompiled format.
+//!
+//! \param psUART is the handle returned by UARTStdioInit().
+//! \param psOps is the format, as returned by the NAME\#\#Ops() function that
+//! UFMT_DEFINE() creates.
+//! \param pvArgs points to the argument structure of the format.
+//!
+//! This function sends the same text as UARTStdioPrintf() would for the
+//! equivalent format string, but walks a table of operations instead of
+//! parsing.  It is normally called through the NAME\#\#Print() function
+//! that UARTSTDIO_FMT_DEFINE() creates, which checks the argument types.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTStdioFmt(UARTStdioHandle psUART, const tUFmtOp *psOps, const void *pvArgs)
+{
+    //
+    // Check the arguments.
+    //
+    ASSERT(psUART != 0);
+    ASSERT(psOps != 0);
+
+    //
+    // Print through the UART sink.
+    //
+    ufmtsink(UARTStdioSink, psUART, psOps, pvArgs);
+}
+
+//*****************************************************************************
+//
+//! Prints with a precompiled format.
+//!
+//! \param psOps is the format, as returned by the NAME\#\#Ops() function that
+//! UFMT_DEFINE() creates.
+//! \param pvArgs points to the argument structure of the format.
+//!
+//! This function is UARTStdioFmt() on the console opened by
+//! UARTStdioConfig().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTfmt(const tUFmtOp *psOps, const void *pvArgs)
+{
+    UARTStdioFmt(&g_sUARTStdio, psOps, pvArgs);
+}
+
 //*****************************************************************************
 //
 //! Returns the number of bytes available in the receive buffer.
 //!
+//! \param psUART is the handle returned by UARTStdioInit().
+//!
 //! This function, available only when the module is built to operate in
 //! buffered mode using \b UART_BUFFERED, may be used to determine the number
 //! of bytes of data currently available in the receive buffer.
@@ -1318,10 +1760,40 @@ UARTprintf(const char *pcString, ...)
 //
 //*****************************************************************************
 #if defined(UART_BUFFERED) || defined(DOXYGEN)
+int
+UARTStdioRxBytesAvail(UARTStdioHandle psUART)
+{
+    return(RX_BUFFER_USED(psUART));
+}
+
 int
 UARTRxBytesAvail(void)
 {
-    return(RX_BUFFER_USED);
+    return(UARTStdioRxBytesAvail(&g_sUARTStdio));
+}
+#endif
+
+//*****************************************************************************
+//
+//! Returns the number of received bytes lost to a full receive buffer.
+//!
+//! \param psUART is the handle returned by UARTStdioInit().
+//!
+//! This function, available only when the module is built to operate in
+//! buffered mode using \b UART_BUFFERED, returns how many received characters
+//! the interrupt handler has thrown away since the instance was opened
+//! because the application did not read the receive buffer fast enough.
+//! Bytes lost to a hardware FIFO overrun are not included, see
+//! UARTRxErrorGet().
+//!
+//! \return Returns the number of dropped bytes.
+//
+//*****************************************************************************
+#if defined(UART_BUFFERED) || defined(DOXYGEN)
+uint32_t
+UARTStdioRxDropped(UARTStdioHandle psUART)
+{
+    return(psUART->ui32RxDropped);
 }
 #endif
 
@@ -1330,6 +1802,8 @@ UARTRxBytesAvail(void)
 //
 //! Returns the number of bytes free in the transmit buffer.
 //!
+//! \param psUART is the handle returned by UARTStdioInit().
+//!
 //! This function, available only when the module is built to operate in
 //! buffered mode using \b UART_BUFFERED, may be used to determine the amount
 //! of space currently available in the transmit buffer.
@@ -1337,10 +1811,16 @@ UARTRxBytesAvail(void)
 //! \return Returns the number of free bytes.
 //
 //*****************************************************************************
+int
+UARTStdioTxBytesFree(UARTStdioHandle psUART)
+{
+    return(TX_BUFFER_FREE(psUART));
+}
+
 int
 UARTTxBytesFree(void)
 {
-    return(TX_BUFFER_FREE);
+    return(UARTStdioTxBytesFree(&g_sUARTStdio));
 }
 #endif
 
@@ -1348,6 +1828,7 @@ UARTTxBytesFree(void)
 //
 //! Looks ahead in the receive buffer for a particular character.
 //!
+//! \param psUART is the handle returned by UARTStdioInit().
 //! \param ucChar is the character that is to be searched for.
 //!
 //! This function, available only when the module is built to operate in
@@ -1365,7 +1846,7 @@ UARTTxBytesFree(void)
 //*****************************************************************************
 #if defined(UART_BUFFERED) || defined(DOXYGEN)
 int
-UARTPeek(unsigned char ucChar)
+UARTStdioPeek(UARTStdioHandle psUART, unsigned char ucChar)
 {
     int iCount;
     int iAvail;
@@ -1374,15 +1855,16 @@ UARTPeek(unsigned char ucChar)
     //
     // How many characters are there in the receive buffer?
     //
-    iAvail = (int)RX_BUFFER_USED;
-    ui32ReadIndex = g_ui32UARTRxReadIndex;
+    iAvail = (int)RX_BUFFER_USED(psUART);
+    ui32ReadIndex = psUART->ui32RxReadIndex;
+    RING_BARRIER();
 
     //
     // Check all the unread characters looking for the one passed.
     //
     for(iCount = 0; iCount < iAvail; iCount++)
     {
-        if(g_pcUARTRxBuffer[ui32ReadIndex] == ucChar)
+        if(psUART->pcRxBuffer[ui32ReadIndex & psUART->ui32RxMask] == ucChar)
         {
             //
             // We found it so return the index
@@ -1394,7 +1876,7 @@ UARTPeek(unsigned char ucChar)
             //
             // This one didn't match so move on to the next character.
             //
-            ADVANCE_RX_BUFFER_INDEX(ui32ReadIndex);
+            ui32ReadIndex++;
         }
     }
 
@@ -1404,44 +1886,43 @@ UARTPeek(unsigned char ucChar)
     //
     return(-1);
 }
+
+int
+UARTPeek(unsigned char ucChar)
+{
+    return(UARTStdioPeek(&g_sUARTStdio, ucChar));
+}
 #endif
 
 //*****************************************************************************
 //
 //! Flushes the receive buffer.
 //!
+//! \param psUART is the handle returned by UARTStdioInit().
+//!
 //! This function, available only when the module is built to operate in
 //! buffered mode using \b UART_BUFFERED, may be used to discard any data
-//! received from the UART but not yet read using UARTgets().
+//! received from the UART but not yet read using UARTStdioGets().
 //!
 //! \return None.
 //
 //*****************************************************************************
 #if defined(UART_BUFFERED) || defined(DOXYGEN)
 void
-UARTFlushRx(void)
+UARTStdioFlushRx(UARTStdioHandle psUART)
 {
-    uint32_t ui32Int;
-
-    //
-    // Temporarily turn off interrupts.
-    //
-    ui32Int = MAP_IntMasterDisable();
-
     //
-    // Flush the receive buffer.
+    // Flush the receive buffer.  The read index belongs to the reader so
+    // catching it up with the write index needs no locking.  A line still
+    // being edited by the interrupt handler is not affected.
     //
-    g_ui32UARTRxReadIndex = 0;
-    g_ui32UARTRxWriteIndex = 0;
+    psUART->ui32RxReadIndex = psUART->ui32RxWriteIndex;
+}
 
-    //
-    // If interrupts were enabled when we turned them off, turn them
-    // back on again.
-    //
-    if(!ui32Int)
-    {
-        MAP_IntMasterEnable();
-    }
+void
+UARTFlushRx(void)
+{
+    UARTStdioFlushRx(&g_sUARTStdio);
 }
 #endif
 
@@ -1449,21 +1930,22 @@ UARTFlushRx(void)
 //
 //! Flushes the transmit buffer.
 //!
+//! \param psUART is the handle returned by UARTStdioInit().
 //! \param bDiscard indicates whether any remaining data in the buffer should
 //! be discarded (\b true) or transmitted (\b false).
 //!
 //! This function, available only when the module is built to operate in
 //! buffered mode using \b UART_BUFFERED, may be used to flush the transmit
 //! buffer, either discarding or transmitting any data received via calls to
-//! UARTprintf() that is waiting to be transmitted.  On return, the transmit
-//! buffer will be empty.
+//! UARTStdioPrintf() that is waiting to be transmitted.  On return, the
+//! transmit buffer will be empty.
 //!
 //! \return None.
 //
 //*****************************************************************************
 #if defined(UART_BUFFERED) || defined(DOXYGEN)
 void
-UARTFlushTx(bool bDiscard)
+UARTStdioFlushTx(UARTStdioHandle psUART, bool bDiscard)
 {
     uint32_t ui32Int;
 
@@ -1473,16 +1955,25 @@ UARTFlushTx(bool bDiscard)
     if(bDiscard)
     {
         //
-        // The remaining data should be discarded, so temporarily turn off
-        // interrupts.
+        // The remaining data should be discarded.  This moves the read index
+        // which belongs to the interrupt handler, so temporarily turn off
+        // interrupts.  This is the one place the buffer is locked and it is
+        // not on the data path.
         //
         ui32Int = MAP_IntMasterDisable();
 
         //
         // Flush the transmit buffer.
         //
-        g_ui32UARTTxReadIndex = 0;
-        g_ui32UARTTxWriteIndex = 0;
+#ifdef UART_DMA
+        //
+        // Abandon a transfer in progress along with the rest.
+        //
+        MAP_uDMAChannelDisable(psUART->ui32DMATxChannel);
+        psUART->ui32DMATxCount = 0;
+#endif
+        psUART->ui32TxReadIndex = psUART->ui32TxWriteIndex;
+        psUART->ui32EchoReadIndex = psUART->ui32EchoWriteIndex;
 
         //
         // If interrupts were enabled when we turned them off, turn them
@@ -1498,17 +1989,24 @@ UARTFlushTx(bool bDiscard)
         //
         // Wait for all remaining data to be transmitted before returning.
         //
-        while(!TX_BUFFER_EMPTY)
+        while(!TX_BUFFER_EMPTY(psUART))
         {
         }
     }
 }
+
+void
+UARTFlushTx(bool bDiscard)
+{
+    UARTStdioFlushTx(&g_sUARTStdio, bDiscard);
+}
 #endif
 
 //*****************************************************************************
 //
 //! Enables or disables echoing of received characters to the transmitter.
 //!
+//! \param psUART is the handle returned by UARTStdioInit().
 //! \param bEnable must be set to \b true to enable echo or \b false to
 //! disable it.
 //!
@@ -1520,65 +2018,188 @@ UARTFlushTx(bool bDiscard)
 //! where this module is being used to provide a convenient, buffered serial
 //! interface over which application-specific binary protocols are being run,
 //! however, echo may be undesirable and this function can be used to disable
-//! it.
+//! it.  Each instance has its own setting, so a command line on one UART and
+//! a binary link on another can run side by side.
+//!
+//! While echo is enabled, received characters reach UARTStdioGetc(),
+//! UARTStdioPeek() and UARTStdioRxBytesAvail() a line at a time, once the line
+//! is terminated, so that backspace can still edit it.  With echo disabled
+//! every character is available as soon as it is received.
 //!
 //! \return None.
 //
 //*****************************************************************************
 #if defined(UART_BUFFERED) || defined(DOXYGEN)
+void
+UARTStdioEchoSet(UARTStdioHandle psUART, bool bEnable)
+{
+    psUART->bDisableEcho = !bEnable;
+}
+
 void
 UARTEchoSet(bool bEnable)
 {
-    g_bDisableEcho = !bEnable;
+    UARTStdioEchoSet(&g_sUARTStdio, bEnable);
 }
 #endif
 
 //*****************************************************************************
 //
-//! Handles UART interrupts.
+//! Routes received characters to a function instead of the receive buffer.
 //!
-//! This function handles interrupts from the UART.  It will copy data from the
-//! transmit buffer to the UART transmit FIFO if space is available, and it
-//! will copy data from the UART receive FIFO to the receive buffer if data is
-//! available.
+//! \param psUART is the handle returned by UARTStdioInit().
+//! \param pfnRxHook is the function to call for each received character, or
+//! 0 to go back to the receive buffer.
+//! \param pvArg is passed to \e pfnRxHook.
+//!
+//! This function, available only when the module is built to operate in
+//! buffered mode using \b UART_BUFFERED, lets a protocol decoder take the
+//! received data straight from the interrupt handler, in order and without
+//! line editing or echo.  The hook runs in interrupt context and must be
+//! short.
 //!
 //! \return None.
 //
 //*****************************************************************************
 #if defined(UART_BUFFERED) || defined(DOXYGEN)
 void
-UARTStdioIntHandler(void)
+UARTStdioRxHookSet(UARTStdioHandle psUART, tUARTStdioRxHook pfnRxHook,
+                   void *pvArg)
 {
-    uint32_t ui32Ints;
-    int8_t cChar;
-    int32_t i32Char;
-    static bool bLastWasCR = false;
+    uint32_t ui32Int;
+
+    //
+    // The interrupt handler must never see the new function with the old
+    // argument.
+    //
+    ui32Int = MAP_IntMasterDisable();
+    psUART->pvRxHookArg = pvArg;
+    psUART->pfnRxHook = pfnRxHook;
+    if(!ui32Int)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+#endif
+
+//*****************************************************************************
+//
+//! Reserves the free part of the transmit buffer for direct writing.
+//!
+//! \param psUART is the handle returned by UARTStdioInit().
+//! \param psSpan is filled in with the location of the free space.
+//!
+//! This function, available only when the module is built to operate in
+//! buffered mode using \b UART_BUFFERED, lets an encoder build its output in
+//! place in the transmit buffer instead of in a buffer of its own that is
+//! then copied by UARTStdioWrite().  The region may wrap around the end of
+//! the buffer, so byte \e n goes to
+//! <tt>psSpan->pcBuf[(psSpan->ui32Start + n) & psSpan->ui32Mask]</tt>.
+//! Nothing is sent until UARTStdioTxCommit() is called, and no other
+//! transmit function may be called on the instance in between.  Data is
+//! sent exactly as written, without LF to CRLF translation.
+//!
+//! \return Returns the number of bytes that may be written.
+//
+//*****************************************************************************
+#if defined(UART_BUFFERED) || defined(DOXYGEN)
+uint32_t
+UARTStdioTxReserve(UARTStdioHandle psUART, tUARTStdioTxSpan *psSpan)
+{
+    ASSERT(psUART != 0);
+    ASSERT(psSpan != 0);
+
+    psSpan->pcBuf = psUART->pcTxBuffer;
+    psSpan->ui32Mask = psUART->ui32TxMask;
+    psSpan->ui32Start = psUART->ui32TxWriteIndex;
+
+    return(TX_BUFFER_FREE(psUART));
+}
+#endif
+
+//*****************************************************************************
+//
+//! Sends data written into a region reserved by UARTStdioTxReserve().
+//!
+//! \param psUART is the handle returned by UARTStdioInit().
+//! \param ui32Len is the number of bytes written at the start of the region,
+//! no more than UARTStdioTxReserve() returned.
+//!
+//! This function, available only when the module is built to operate in
+//! buffered mode using \b UART_BUFFERED, publishes the bytes to the
+//! interrupt handler in one step, so a frame is either queued whole or not
+//! at all.
+//!
+//! \return None.
+//
+//*****************************************************************************
+#if defined(UART_BUFFERED) || defined(DOXYGEN)
+void
+UARTStdioTxCommit(UARTStdioHandle psUART, uint32_t ui32Len)
+{
+    ASSERT(ui32Len <= (uint32_t)TX_BUFFER_FREE(psUART));
+
+    if(ui32Len == 0)
+    {
+        return;
+    }
 
     //
-    // Get and clear the current interrupt source(s)
+    // Publish the bytes and start the transmitter as UARTStdioWrite() does.
     //
-    ui32Ints = MAP_UARTIntStatus(g_ui32Base, true);
-    MAP_UARTIntClear(g_ui32Base, ui32Ints);
+    RING_BARRIER();
+    psUART->ui32TxWriteIndex += ui32Len;
+
+#ifndef UART_DMA
+    MAP_UARTIntEnable(psUART->ui32Base, UART_INT_TX);
+#endif
+    MAP_IntPendSet(g_ui32UARTInt[psUART->ui32PortNum]);
+}
+#endif
+
+//*****************************************************************************
+//
+//! Handles UART interrupts for a console instance.
+//!
+//! \param psUART is the handle returned by UARTStdioInit().
+//!
+//! This function handles interrupts from the instance's UART.  It will copy
+//! data from the transmit buffer to the UART transmit FIFO if space is
+//! available, and it will copy data from the UART receive FIFO to the receive
+//! buffer if data is available.  It is meant to be called from the interrupt
+//! handler of the UART when UARTStdio0IntHandler() to UARTStdio2IntHandler()
+//! can't be used directly.
+//!
+//! \return None.
+//
+//*****************************************************************************
+#if defined(UART_BUFFERED) || defined(DOXYGEN)
+void
+UARTStdioIntProcess(UARTStdioHandle psUART)
+{
+    uint32_t ui32Ints;
+    uint32_t ui32Edit;
+    uint32_t ui32Base;
+
+    ui32Base = psUART->ui32Base;
 
     //
-    // Are we being interrupted because the TX FIFO has space available?
+    // Get and clear the current interrupt source(s).  This may be nothing
+    // at all if UARTStdioWrite() pended the interrupt to start a transmission
+    // or a uDMA transfer finished.
     //
-    if(ui32Ints & UART_INT_TX)
-    {
-        //
-        // Move as many bytes as we can into the transmit FIFO.
-        //
-        UARTPrimeTransmit(g_ui32Base);
+    ui32Ints = MAP_UARTIntStatus(ui32Base, true);
+    MAP_UARTIntClear(ui32Base, ui32Ints);
 
-        //
-        // If the output buffer is empty, turn off the transmit interrupt.
-        //
-        if(TX_BUFFER_EMPTY)
-        {
-            MAP_UARTIntDisable(g_ui32Base, UART_INT_TX);
-        }
-    }
+    ui32Edit = psUART->ui32RxEditIndex;
 
+#ifdef UART_DMA
+    //
+    // Collect finished receive blocks, and on a timeout the partial one.
+    //
+    ui32Edit = UARTDMARxService(psUART, ui32Edit,
+                                (ui32Ints & UART_INT_RT) != 0);
+#else
     //
     // Are we being interrupted due to a received character?
     //
@@ -1587,127 +2208,89 @@ UARTStdioIntHandler(void)
         //
         // Get all the available characters from the UART.
         //
-        while(MAP_UARTCharsAvail(g_ui32Base))
+        while(MAP_UARTCharsAvail(ui32Base))
         {
-            //
-            // Read a character
-            //
-            i32Char = MAP_UARTCharGetNonBlocking(g_ui32Base);
-            cChar = (unsigned char)(i32Char & 0xFF);
+            ui32Edit = UARTRxChar(psUART, ui32Edit,
+                                  MAP_UARTCharGetNonBlocking(ui32Base) &
+                                  0xFF);
+        }
+    }
+#endif
 
-            //
-            // If echo is disabled, we skip the various text filtering
-            // operations that would typically be required when supporting a
-            // command line.
-            //
-            if(!g_bDisableEcho)
-            {
-                //
-                // Handle backspace by erasing the last character in the
-                // buffer.
-                //
-                if(cChar == '\b')
-                {
-                    //
-                    // If there are any characters already in the buffer, then
-                    // delete the last.
-                    //
-                    if(!RX_BUFFER_EMPTY)
-                    {
-                        //
-                        // Rub out the previous character on the users
-                        // terminal.
-                        //
-                        UARTwrite("\b \b", 3);
-
-                        //
-                        // Decrement the number of characters in the buffer.
-                        //
-                        if(g_ui32UARTRxWriteIndex == 0)
-                        {
-                            g_ui32UARTRxWriteIndex = UART_RX_BUFFER_SIZE - 1;
-                        }
-                        else
-                        {
-                            g_ui32UARTRxWriteIndex--;
-                        }
-                    }
-
-                    //
-                    // Skip ahead to read the next character.
-                    //
-                    continue;
-                }
+    psUART->ui32RxEditIndex = ui32Edit;
 
-                //
-                // If this character is LF and last was CR, then just gobble up
-                // the character since we already echoed the previous CR and we
-                // don't want to store 2 characters in the buffer if we don't
-                // need to.
-                //
-                if((cChar == '\n') && bLastWasCR)
-                {
-                    bLastWasCR = false;
-                    continue;
-                }
+    //
+    // Move as many bytes as we can into the transmit FIFO.  This runs for a
+    // TX interrupt, for echo output and for the pend from UARTStdioWrite().
+    // If nothing is left, turn off the transmit interrupt.
+    //
+    if(UARTPrimeTransmit(psUART))
+    {
+        MAP_UARTIntEnable(ui32Base, UART_INT_TX);
+    }
+    else
+    {
+        MAP_UARTIntDisable(ui32Base, UART_INT_TX);
+    }
+}
+#endif
 
-                //
-                // See if a newline or escape character was received.
-                //
-                if((cChar == '\r') || (cChar == '\n') || (cChar == 0x1b))
-                {
-                    //
-                    // If the character is a CR, then it may be followed by an
-                    // LF which should be paired with the CR.  So remember that
-                    // a CR was received.
-                    //
-                    if(cChar == '\r')
-                    {
-                        bLastWasCR = 1;
-                    }
-
-                    //
-                    // Regardless of the line termination character received,
-                    // put a CR in the receive buffer as a marker telling
-                    // UARTgets() where the line ends.  We also send an
-                    // additional LF to ensure that the local terminal echo
-                    // receives both CR and LF.
-                    //
-                    cChar = '\r';
-                    UARTwrite("\n", 1);
-                }
-            }
+//*****************************************************************************
+//
+//! Handles UART interrupts for the console opened by UARTStdioConfig().
+//!
+//! This function handles interrupts from the UART.  It will copy data from the
+//! transmit buffer to the UART transmit FIFO if space is available, and it
+//! will copy data from the UART receive FIFO to the receive buffer if data is
+//! available.
+//!
+//! \return None.
+//
+//*****************************************************************************
+#if defined(UART_BUFFERED) || defined(DOXYGEN)
+void
+UARTStdioIntHandler(void)
+{
+    UARTStdioIntProcess(&g_sUARTStdio);
+}
+#endif
 
-            //
-            // If there is space in the receive buffer, put the character
-            // there, otherwise throw it away.
-            //
-            if(!RX_BUFFER_FULL)
-            {
-                //
-                // Store the new character in the receive buffer
-                //
-                g_pcUARTRxBuffer[g_ui32UARTRxWriteIndex] =
-                    (unsigned char)(i32Char & 0xFF);
-                ADVANCE_RX_BUFFER_INDEX(g_ui32UARTRxWriteIndex);
+//*****************************************************************************
+//
+//! Handles the interrupt of UART0, UART1 or UART2 for whichever instance was
+//! opened on that port.
+//!
+//! These functions may be placed directly in the vector table, one per port
+//! in use.  An interrupt from a port with no open instance is ignored.
+//!
+//! \return None.
+//
+//*****************************************************************************
+#if defined(UART_BUFFERED) || defined(DOXYGEN)
+void
+UARTStdio0IntHandler(void)
+{
+    if(g_psUARTStdioPort[0])
+    {
+        UARTStdioIntProcess(g_psUARTStdioPort[0]);
+    }
+}
 
-                //
-                // If echo is enabled, write the character to the transmit
-                // buffer so that the user gets some immediate feedback.
-                //
-                if(!g_bDisableEcho)
-                {
-                    UARTwrite((const char *)&cChar, 1);
-                }
-            }
-        }
+void
+UARTStdio1IntHandler(void)
+{
+    if(g_psUARTStdioPort[1])
+    {
+        UARTStdioIntProcess(g_psUARTStdioPort[1]);
+    }
+}
 
-        //
-        // If we wrote anything to the transmit buffer, make sure it actually
-        // gets transmitted.
-        //
-        UARTPrimeTransmit(g_ui32Base);
-        MAP_UARTIntEnable(g_ui32Base, UART_INT_TX);
+void
+UARTStdio2IntHandler(void)
+{
+    if(g_psUARTStdioPort[2])
+    {
+        UARTStdioIntProcess(g_psUARTStdioPort[2]);
     }
 }
 #endif
@@ -26,6 +26,7 @@
 #define __UARTSTDIO_H__
 
 #include <stdarg.h>
+#include "utils/ustdlib.h"
 
 //*****************************************************************************
 //
@@ -55,11 +56,217 @@ extern "C"
 
 //*****************************************************************************
 //
-// Prototypes for the APIs.
+// If built with UART_DMA (on top of UART_BUFFERED), the buffers are moved by
+// the uDMA controller.  The application must enable the uDMA controller and
+// set its control table before calling UARTStdioConfig().  The following
+// label defines the size of each of the two receive blocks.
 //
 //*****************************************************************************
+#ifdef UART_DMA
+#ifndef UART_BUFFERED
+#error "UART_DMA requires UART_BUFFERED"
+#endif
+#ifndef UART_RX_DMA_BLOCK
+#define UART_RX_DMA_BLOCK       64
+#endif
+#endif
+
+//*****************************************************************************
+//
+// In buffered mode each instance keeps a small ring for the echo of received
+// characters.  The size must be a power of two.
+//
+//*****************************************************************************
+#ifdef UART_BUFFERED
+#ifndef UART_ECHO_BUFFER_SIZE
+#define UART_ECHO_BUFFER_SIZE   32
+#endif
+#endif
+
+#ifdef UART_BUFFERED
+//*****************************************************************************
+//
+//! A function that takes received characters in place of the receive buffer,
+//! see UARTStdioRxHookSet().  It is called from the interrupt handler.
+//
+//*****************************************************************************
+typedef void (*tUARTStdioRxHook)(void *pvArg, unsigned char ucChar);
+
+//*****************************************************************************
+//
+//! A region of a transmit buffer reserved by UARTStdioTxReserve().  Byte
+//! \e n of the region is <tt>pcBuf[(ui32Start + n) & ui32Mask]</tt>.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned char *pcBuf;
+    uint32_t ui32Mask;
+    uint32_t ui32Start;
+}
+tUARTStdioTxSpan;
+#endif
+
+//*****************************************************************************
+//
+//! The state of one UART console.  The application allocates one per UART
+//! it opens with UARTStdioInit(), along with that console's buffers, and
+//! must not touch the members.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The base address and number of the UART, 0 while not open.
+    //
+    uint32_t ui32Base;
+    uint32_t ui32PortNum;
+
+    //
+    // Set while the last received character was a CR so that a following
+    // LF can be dropped.
+    //
+    bool bLastWasCR;
+
+#ifdef UART_BUFFERED
+    //
+    // Set to skip line editing and echo, for binary protocols.
+    //
+    bool bDisableEcho;
+
+    //
+    // When set, received characters go to the hook instead of the receive
+    // buffer.
+    //
+    tUARTStdioRxHook pfnRxHook;
+    void *pvRxHookArg;
+
+    //
+    // Transmit ring, UARTStdioWrite() moves the write index and the
+    // interrupt handler the read index.
+    //
+    unsigned char *pcTxBuffer;
+    uint32_t ui32TxMask;
+    volatile uint32_t ui32TxWriteIndex;
+    volatile uint32_t ui32TxReadIndex;
+
+    //
+    // Receive ring.  The interrupt handler assembles the current line at
+    // the edit index and publishes it by moving the write index.
+    //
+    unsigned char *pcRxBuffer;
+    uint32_t ui32RxMask;
+    volatile uint32_t ui32RxWriteIndex;
+    volatile uint32_t ui32RxReadIndex;
+    uint32_t ui32RxEditIndex;
+
+    //
+    // Received characters thrown away because the receive ring was full.
+    //
+    volatile uint32_t ui32RxDropped;
+
+    //
+    // Echo ring, only used by the interrupt handler.
+    //
+    unsigned char pcEchoBuffer[UART_ECHO_BUFFER_SIZE];
+    uint32_t ui32EchoWriteIndex;
+    uint32_t ui32EchoReadIndex;
+
+#ifdef UART_DMA
+    //
+    // uDMA channels, the bytes in the running TX transfer and the RX
+    // ping-pong blocks with the control structure that completes next.
+    //
+    uint32_t ui32DMARxChannel;
+    uint32_t ui32DMATxChannel;
+    uint32_t ui32DMATxCount;
+    uint32_t ui32DMARxSelect;
+    unsigned char pcRxDMABuffer[2][UART_RX_DMA_BLOCK];
+#endif
+#endif
+}
+tUARTStdio;
+
+//*****************************************************************************
+//
+//! The handle of an open console, as returned by UARTStdioInit().
+//
+//*****************************************************************************
+typedef tUARTStdio *UARTStdioHandle;
+
+//*****************************************************************************
+//
+//! Defines a precompiled format, see UFMT_DEFINE(), that can also be printed
+//! to a UART.
+//!
+//! \param NAME is the name of the format.
+//! \param LIST is a macro listing its pieces.
+//!
+//! On top of what UFMT_DEFINE() creates, this adds NAME\#\#Print(), which
+//! takes a UARTStdioHandle followed by the arguments of the format and
+//! prints through UARTStdioFmt().  To print to the console opened by
+//! UARTStdioConfig(), fill in a tNAME\#\#Args and pass it to UARTfmt() with
+//! NAME\#\#Ops().
+//
+//*****************************************************************************
+#define UARTSTDIO_FMT_DEFINE(NAME, LIST)                                      \
+    UFMT_DEFINE(NAME, LIST)                                                   \
+                                                                              \
+    static inline void                                                        \
+    NAME##Print(UARTStdioHandle psUFmtUART LIST(UFMT_PRM_))                   \
+    {                                                                         \
+        t##NAME##Args sUFmtArgs = { 0 LIST(UFMT_VAL_) };                      \
+                                                                              \
+        UARTStdioFmt(psUFmtUART, NAME##Ops(), &sUFmtArgs);                    \
+    }
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.  The functions taking a UARTStdioHandle work on
+// any open instance, the rest on the instance opened by UARTStdioConfig().
+//
+//*****************************************************************************
+extern UARTStdioHandle UARTStdioInit(tUARTStdio *psUART, uint32_t ui32Port,
+                                     uint32_t ui32Baud, uint32_t ui32SrcClock,
+                                     unsigned char *pcTxBuffer,
+                                     uint32_t ui32TxSize,
+                                     unsigned char *pcRxBuffer,
+                                     uint32_t ui32RxSize);
+extern void UARTStdioClose(UARTStdioHandle psUART);
+extern int UARTStdioGets(UARTStdioHandle psUART, char *pcBuf,
+                         uint32_t ui32Len);
+extern unsigned char UARTStdioGetc(UARTStdioHandle psUART);
+extern void UARTStdioFmt(UARTStdioHandle psUART, const tUFmtOp *psOps,
+                         const void *pvArgs);
+extern void UARTStdioPrintf(UARTStdioHandle psUART, const char *pcString,
+                            ...);
+extern void UARTStdioSink(void *pvSink, const char *pcBuf, uint32_t ui32Len);
+extern void UARTStdioVPrintf(UARTStdioHandle psUART, const char *pcString,
+                             va_list vaArgP);
+extern int UARTStdioWrite(UARTStdioHandle psUART, const char *pcBuf,
+                          uint32_t ui32Len);
+#ifdef UART_BUFFERED
+extern int UARTStdioPeek(UARTStdioHandle psUART, unsigned char ucChar);
+extern void UARTStdioFlushTx(UARTStdioHandle psUART, bool bDiscard);
+extern void UARTStdioFlushRx(UARTStdioHandle psUART);
+extern int UARTStdioRxBytesAvail(UARTStdioHandle psUART);
+extern uint32_t UARTStdioRxDropped(UARTStdioHandle psUART);
+extern int UARTStdioTxBytesFree(UARTStdioHandle psUART);
+extern void UARTStdioEchoSet(UARTStdioHandle psUART, bool bEnable);
+extern void UARTStdioRxHookSet(UARTStdioHandle psUART,
+                               tUARTStdioRxHook pfnRxHook, void *pvArg);
+extern uint32_t UARTStdioTxReserve(UARTStdioHandle psUART,
+                                   tUARTStdioTxSpan *psSpan);
+extern void UARTStdioTxCommit(UARTStdioHandle psUART, uint32_t ui32Len);
+extern void UARTStdioIntProcess(UARTStdioHandle psUART);
+extern void UARTStdio0IntHandler(void);
+extern void UARTStdio1IntHandler(void);
+extern void UARTStdio2IntHandler(void);
+#endif
+
 extern void UARTStdioConfig(uint32_t ui32Port, uint32_t ui32Baud,
                             uint32_t ui32SrcClock);
+extern void UARTfmt(const tUFmtOp *psOps, const void *pvArgs);
 extern int UARTgets(char *pcBuf, uint32_t ui32Len);
 extern unsigned char UARTgetc(void);
 extern void UARTprintf(const char *pcString, ...);
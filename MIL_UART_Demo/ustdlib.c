@@ -22,6 +22,8 @@
 //
 //*****************************************************************************
 
+#include <limits.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include "driverlib/debug.h"
 #include "utils/ustdlib.h"
@@ -41,6 +43,84 @@
 //*****************************************************************************
 static const char * const g_pcHex = "0123456789abcdef";
 
+//*****************************************************************************
+//
+// The decimal digit pairs "00" through "99", used to convert two digits per
+// step.
+//
+//*****************************************************************************
+static const char g_pcDigitPairs[200] =
+    "00010203040506070809101112131415161718192021222324252627282930313233"
+    "34353637383940414243444546474849505152535455565758596061626364656667"
+    "6869707172737475767778798081828384858687888990919293949596979899";
+
+//*****************************************************************************
+//
+// The powers of ten that fit in 32 bits, used to count decimal digits.
+//
+//*****************************************************************************
+static const uint32_t g_pui32Pow10[9] =
+{
+    10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+//*****************************************************************************
+//
+// Divides a 32-bit value by 100 with a multiply by the reciprocal.  The
+// result is exact for every 32-bit value.  This is what an optimizing
+// compiler emits for a constant divide anyway, but spelling it out keeps
+// debug (-O0) builds off the hardware divider as well.
+//
+//*****************************************************************************
+#define UDIV100(x)              ((uint32_t)(((uint64_t)(x) * 0x51EB851F) >> 37))
+
+//*****************************************************************************
+//
+// Ten to the power k, for k from 0 to 9.
+//
+//*****************************************************************************
+#define UPOW10(k)               ((k) ? g_pui32Pow10[(k) - 1] : 1)
+
+//*****************************************************************************
+//
+// The powers of ten that are exact in a double, used to scale floating-point
+// values for conversion.
+//
+//*****************************************************************************
+static const double g_pdPow10[23] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+    1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+//*****************************************************************************
+//
+// The string functions work a word at a time on aligned data.  UHASZERO() is
+// nonzero if any byte of a 32-bit word is zero; its lowest set bit marks the
+// first zero byte, and bits above it may be false hits, so the word is
+// rescanned a byte at a time.  An aligned word never crosses a page or an MPU
+// region boundary, so reading the whole word that holds a terminator can't
+// fault even though the bytes after it are outside the string.
+//
+// Building with USTDLIB_BYTE_STRINGS drops the word loops and leaves the
+// original byte at a time functions.
+//
+//*****************************************************************************
+#ifndef USTDLIB_BYTE_STRINGS
+#define UHASZERO(x)             (((x) - 0x01010101) & ~(x) & 0x80808080)
+#define UALIGNED(p)             (((uintptr_t)(p) & 3) == 0)
+#define USAMEALIGN(p1, p2)      ((((uintptr_t)(p1) ^ (uintptr_t)(p2)) & 3) == 0)
+
+//
+// A word that may alias the character data it is read from.
+//
+#if defined(__GNUC__)
+typedef uint32_t __attribute__((__may_alias__)) tUWord;
+#else
+typedef uint32_t tUWord;
+#endif
+#endif
+
 //*****************************************************************************
 //
 //! Copies a certain number of characters from one string to another.
@@ -58,6 +138,9 @@ static const char * const g_pcHex = "0123456789abcdef";
 //! that the destination string will only be NULL terminated if the number of
 //! characters to be copied is greater than the length of \e s2.
 //!
+//! When \e s1 and \e s2 have the same alignment the copy and the padding are
+//! done four characters at a time.
+//!
 //! \return Returns \e s1.
 //
 //*****************************************************************************
@@ -77,6 +160,44 @@ ustrncpy(char * restrict s1, const char * restrict s2, size_t n)
     //
     count = 0;
 
+#ifndef USTDLIB_BYTE_STRINGS
+    if(USAMEALIGN(s1, s2))
+    {
+        //
+        // Copy up to a word boundary a character at a time.
+        //
+        while(n && !UALIGNED(s2 + count) && s2[count])
+        {
+            s1[count] = s2[count];
+            count++;
+            n--;
+        }
+
+        //
+        // Then copy whole words until one holds the terminator.  The
+        // character loop can stop on a terminator that is not word aligned,
+        // so only go on to words from an aligned, non-zero character, and
+        // only look at that character if n still covers it.
+        //
+        if(n && s2[count] && UALIGNED(s2 + count))
+        {
+            while(n >= 4)
+            {
+                uint32_t ui32Word;
+
+                ui32Word = *(const tUWord *)(s2 + count);
+                if(UHASZERO(ui32Word))
+                {
+                    break;
+                }
+                *(tUWord *)(s1 + count) = ui32Word;
+                count += 4;
+                n -= 4;
+            }
+        }
+    }
+#endif
+
     //
     // Copy the source string until we run out of source characters or
     // destination space.
@@ -88,6 +209,23 @@ ustrncpy(char * restrict s1, const char * restrict s2, size_t n)
         n--;
     }
 
+#ifndef USTDLIB_BYTE_STRINGS
+    //
+    // Pad to a word boundary, then a word at a time.
+    //
+    while(n && !UALIGNED(s1 + count))
+    {
+        s1[count++] = (char)0;
+        n--;
+    }
+    while(n >= 4)
+    {
+        *(tUWord *)(s1 + count) = 0;
+        count += 4;
+        n -= 4;
+    }
+#endif
+
     //
     // Pad the destination if we are not yet done.
     //
@@ -105,1480 +243,4160 @@ ustrncpy(char * restrict s1, const char * restrict s2, size_t n)
 
 //*****************************************************************************
 //
-//! A simple vsnprintf function supporting \%c, \%d, \%p, \%s, \%u, \%x, and
-//! \%X.
-//!
-//! \param s points to the buffer where the converted string is stored.
-//! \param n is the size of the buffer.
-//! \param format is the format string.
-//! \param arg is the list of optional arguments, which depend on the
-//! contents of the format string.
+//! Counts the digits needed to print a number.
 //!
-//! This function is very similar to the C library <tt>vsnprintf()</tt>
-//! function.  Only the following formatting characters are supported:
+//! \param ui32Value is the number.
+//! \param ui32Base is the base to print it in, either 10 or 16.
 //!
-//! - \%c to print a character
-//! - \%d or \%i to print a decimal value
-//! - \%s to print a string
-//! - \%u to print an unsigned decimal value
-//! - \%x to print a hexadecimal value using lower case letters
-//! - \%X to print a hexadecimal value using lower case letters (not upper case
-//! letters as would typically be used)
-//! - \%p to print a pointer as a hexadecimal value
-//! - \%\% to print out a \% character
+//! This function determines how many characters unumtostr() produces for
+//! \e ui32Value without dividing.  Decimal digits are counted by comparing
+//! against the powers of ten, hexadecimal digits by shifting.
 //!
-//! For \%d, \%i, \%p, \%s, \%u, \%x, and \%X, an optional number may reside
-//! between the \% and the format character, which specifies the minimum number
-//! of characters to use for that value; if preceded by a 0 then the extra
-//! characters will be filled with zeros instead of spaces.  For example,
-//! ``\%8d'' will use eight characters to print the decimal value with spaces
-//! added to reach eight; ``\%08d'' will use eight characters as well but will
-//! add zeroes instead of spaces.
+//! \return Returns the number of digits, from 1 to 10.
+//
+//*****************************************************************************
+uint32_t
+unumdigits(uint32_t ui32Value, uint32_t ui32Base)
+{
+    uint32_t ui32Digits;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT((ui32Base == 10) || (ui32Base == 16));
+
+    //
+    // Every number has at least one digit.
+    //
+    ui32Digits = 1;
+
+    if(ui32Base == 16)
+    {
+        //
+        // Add a digit for every non-zero nibble above the first.
+        //
+        while((ui32Digits < 8) && (ui32Value >> (ui32Digits * 4)))
+        {
+            ui32Digits++;
+        }
+    }
+    else
+    {
+        //
+        // Add a digit for every power of ten the value reaches.
+        //
+        while((ui32Digits < 10) &&
+              (ui32Value >= g_pui32Pow10[ui32Digits - 1]))
+        {
+            ui32Digits++;
+        }
+    }
+
+    //
+    // Return the digit count.
+    //
+    return(ui32Digits);
+}
+
+//*****************************************************************************
+//
+//! Converts a number to a string of digits.
 //!
-//! The type of the arguments after \e format must match the requirements of
-//! the format string.  For example, if an integer was passed where a string
-//! was expected, an error of some kind will most likely occur.
+//! \param pcBuf points to the buffer where the digits are stored.
+//! \param ui32Value is the number to convert.
+//! \param ui32Base is the base to convert to, either 10 or 16.
+//! \param ui32Digits is the number of digits, as returned by unumdigits().
 //!
-//! The \e n parameter limits the number of characters that will be
-//! stored  in the buffer pointed to by \e s to prevent the possibility of
-//! a buffer  overflow.  The buffer size should be large enough to hold the
-//! expected converted output string, including the null termination character.
+//! This function stores exactly \e ui32Digits characters in \e pcBuf, most
+//! significant first, without a NULL terminator.  It is the conversion core
+//! shared by uvsnprintf() and UARTprintf().
 //!
-//! The function will return the number of characters that would be converted
-//! as if there were no limit on the buffer size.  Therefore it is possible for
-//! the function to return a count that is greater than the specified buffer
-//! size.  If this happens, it means that the output was truncated.
+//! The digits are produced from the least significant end.  Base 10 takes
+//! two digits per step, using a multiply by the reciprocal of 100 and a table
+//! of digit pairs; base 16 takes one digit per nibble.  Neither path uses
+//! the hardware divider.
 //!
-//! \return Returns the number of characters that were to be stored, not
-//! including the NULL termination character, regardless of space in the
-//! buffer.
+//! \return None.
 //
 //*****************************************************************************
-int
-uvsnprintf(char * restrict s, size_t n, const char * restrict format,
-           va_list arg)
+void
+unumtostr(char *pcBuf, uint32_t ui32Value, uint32_t ui32Base,
+          uint32_t ui32Digits)
 {
-    unsigned long ulIdx, ulValue, ulCount, ulBase, ulNeg;
-    char *pcStr, cFill;
-    int iConvertCount = 0;
+    uint32_t ui32Quot, ui32Rem;
+    char *pcEnd;
 
     //
     // Check the arguments.
     //
-    ASSERT(s);
-    ASSERT(n);
-    ASSERT(format);
+    ASSERT(pcBuf);
+    ASSERT((ui32Base == 10) || (ui32Base == 16));
+    ASSERT(ui32Digits == unumdigits(ui32Value, ui32Base));
 
     //
-    // Adjust buffer size limit to allow one space for null termination.
+    // Fill the buffer from the end.
     //
-    if(n)
+    pcEnd = pcBuf + ui32Digits;
+
+    //
+    // Hexadecimal digits come straight from the nibbles.
+    //
+    if(ui32Base == 16)
     {
-        n--;
+        while(pcEnd != pcBuf)
+        {
+            *--pcEnd = g_pcHex[ui32Value & 15];
+            ui32Value >>= 4;
+        }
+
+        return;
     }
 
     //
-    // Initialize the count of characters converted.
+    // Peel off two decimal digits at a time.
     //
-    iConvertCount = 0;
+    while(ui32Value >= 100)
+    {
+        ui32Quot = UDIV100(ui32Value);
+        ui32Rem = (ui32Value - (ui32Quot * 100)) * 2;
+        ui32Value = ui32Quot;
+
+        pcEnd -= 2;
+        pcEnd[0] = g_pcDigitPairs[ui32Rem];
+        pcEnd[1] = g_pcDigitPairs[ui32Rem + 1];
+    }
 
     //
-    // Loop while there are more characters in the format string.
+    // One or two digits are left.
     //
-    while(*format)
+    if(ui32Value >= 10)
     {
-        //
-        // Find the first non-% character, or the end of the string.
-        //
-        for(ulIdx = 0; (format[ulIdx] != '%') && (format[ulIdx] != '\0');
-            ulIdx++)
-        {
-        }
+        pcEnd[-2] = g_pcDigitPairs[ui32Value * 2];
+        pcEnd[-1] = g_pcDigitPairs[(ui32Value * 2) + 1];
+    }
+    else
+    {
+        pcEnd[-1] = '0' + ui32Value;
+    }
+}
 
-        //
-        // Write this portion of the string to the output buffer.  If there are
-        // more characters to write than there is space in the buffer, then
-        // only write as much as will fit in the buffer.
-        //
-        if(ulIdx > n)
-        {
-            ustrncpy(s, format, n);
-            s += n;
-            n = 0;
-        }
-        else
-        {
-            ustrncpy(s, format, ulIdx);
-            s += ulIdx;
-            n -= ulIdx;
-        }
+//*****************************************************************************
+//
+// Stores a number as exactly ui32Digits decimal digits, with leading zeros,
+// and returns a pointer just past the last one.
+//
+//*****************************************************************************
+static char *
+ufmtzeros(char *pcBuf, uint32_t ui32Value, uint32_t ui32Digits)
+{
+    uint32_t ui32Len;
 
-        //
-        // Update the conversion count.  This will be the number of characters
-        // that should have been written, even if there was not room in the
-        // buffer.
-        //
-        iConvertCount += ulIdx;
+    ui32Len = unumdigits(ui32Value, 10);
 
-        //
-        // Skip the portion of the format string that was written.
-        //
-        format += ulIdx;
+    for(; ui32Digits > ui32Len; ui32Digits--)
+    {
+        *pcBuf++ = '0';
+    }
 
-        //
-        // See if the next character is a %.
-        //
-        if(*format == '%')
-        {
-            //
-            // Skip the %.
-            //
-            format++;
+    unumtostr(pcBuf, ui32Value, 10, ui32Len);
 
-            //
-            // Set the digit count to zero, and the fill character to space
-            // (that is, to the defaults).
-            //
-            ulCount = 0;
-            cFill = ' ';
+    return(pcBuf + ui32Len);
+}
 
-            //
-            // It may be necessary to get back here to process more characters.
-            // Goto's aren't pretty, but effective.  I feel extremely dirty for
-            // using not one but two of the beasts.
-            //
-again:
+//*****************************************************************************
+//
+// Stores an integer part, and if ui32Prec is not zero a decimal point and
+// ui32Prec fraction digits, and returns a pointer just past the last one.
+//
+//*****************************************************************************
+static char *
+ufmtpoint(char *pcBuf, uint32_t ui32Int, uint32_t ui32Frac, uint32_t ui32Prec)
+{
+    uint32_t ui32Len;
 
-            //
-            // Determine how to handle the next character.
-            //
-            switch(*format++)
-            {
-                //
-                // Handle the digit characters.
-                //
-                case '0':
-                case '1':
-                case '2':
-                case '3':
-                case '4':
-                case '5':
-                case '6':
-                case '7':
-                case '8':
-                case '9':
-                {
-                    //
-                    // If this is a zero, and it is the first digit, then the
-                    // fill character is a zero instead of a space.
-                    //
-                    if((format[-1] == '0') && (ulCount == 0))
-                    {
-                        cFill = '0';
-                    }
+    ui32Len = unumdigits(ui32Int, 10);
+    unumtostr(pcBuf, ui32Int, 10, ui32Len);
+    pcBuf += ui32Len;
 
-                    //
-                    // Update the digit count.
-                    //
-                    ulCount *= 10;
-                    ulCount += format[-1] - '0';
+    if(ui32Prec)
+    {
+        *pcBuf++ = '.';
+        pcBuf = ufmtzeros(pcBuf, ui32Frac, ui32Prec);
+    }
 
-                    //
-                    // Get the next character.
-                    //
-                    goto again;
-                }
+    return(pcBuf);
+}
 
-                //
-                // Handle the %c command.
-                //
-                case 'c':
-                {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ulValue = va_arg(arg, unsigned long);
+//*****************************************************************************
+//
+// Multiplies a value by ten to the power i32Exp.  Exponents up to 22 take a
+// single correctly rounded multiply or divide, since those powers of ten are
+// exact in a double.
+//
+//*****************************************************************************
+static double
+uscale10(double dValue, int32_t i32Exp)
+{
+    while(i32Exp > 22)
+    {
+        dValue *= 1e22;
+        i32Exp -= 22;
+    }
 
-                    //
-                    // Copy the character to the output buffer, if there is
-                    // room.  Update the buffer size remaining.
-                    //
-                    if(n != 0)
-                    {
-                        *s++ = (char)ulValue;
-                        n--;
-                    }
+    while(i32Exp < -22)
+    {
+        dValue /= 1e22;
+        i32Exp += 22;
+    }
 
-                    //
-                    // Update the conversion count.
-                    //
-                    iConvertCount++;
+    if(i32Exp < 0)
+    {
+        return(dValue / g_pdPow10[-i32Exp]);
+    }
 
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
+    return(dValue * g_pdPow10[i32Exp]);
+}
 
-                //
-                // Handle the %d and %i commands.
-                //
-                case 'd':
-                case 'i':
-                {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ulValue = va_arg(arg, unsigned long);
+//*****************************************************************************
+//
+// Returns the sign of dA * dB - dC, computed exactly, where dC is close to
+// the product.  The product is split into a rounded part and its exact
+// error using Dekker's method, so only double adds and multiplies are
+// needed.
+//
+//*****************************************************************************
+static int32_t
+uprodcmp(double dA, double dB, double dC)
+{
+    double dAH, dAL, dBH, dBL, dProd, dErr;
 
-                    //
-                    // If the value is negative, make it positive and indicate
-                    // that a minus sign is needed.
-                    //
-                    if((long)ulValue < 0)
-                    {
-                        //
-                        // Make the value positive.
-                        //
-                        ulValue = -(long)ulValue;
+    //
+    // Split each factor into two halves of 26 bits.
+    //
+    dAH = dA * 134217729.0;
+    dAH = dAH - (dAH - dA);
+    dAL = dA - dAH;
+    dBH = dB * 134217729.0;
+    dBH = dBH - (dBH - dB);
+    dBL = dB - dBH;
 
-                        //
-                        // Indicate that the value is negative.
-                        //
-                        ulNeg = 1;
-                    }
-                    else
-                    {
-                        //
-                        // Indicate that the value is positive so that a
-                        // negative sign isn't inserted.
-                        //
-                        ulNeg = 0;
-                    }
+    //
+    // The rounded product plus dErr is exactly dA * dB.  Since dC is close
+    // to the product, dProd - dC is exact as well.
+    //
+    dProd = dA * dB;
+    dErr = (((dAH * dBH) - dProd) + (dAH * dBL) + (dAL * dBH)) + (dAL * dBL);
+    dErr += dProd - dC;
 
-                    //
-                    // Set the base to 10.
-                    //
-                    ulBase = 10;
+    return((dErr > 0) - (dErr < 0));
+}
 
-                    //
-                    // Convert the value to ASCII.
-                    //
-                    goto convert;
-                }
+//*****************************************************************************
+//
+// Returns the sign of the rounding error in dScaled, the result of
+// uscale10(dValue, i32Exp): 1 if the exact value is larger, -1 if it is
+// smaller, and 0 if dScaled is exact or the scaling took more than one
+// step.
+//
+//*****************************************************************************
+static int32_t
+uscaleerr(double dValue, int32_t i32Exp, double dScaled)
+{
+    if((i32Exp > 22) || (i32Exp < -22))
+    {
+        return(0);
+    }
 
-                //
-                // Handle the %s command.
-                //
-                case 's':
-                {
-                    //
-                    // Get the string pointer from the varargs.
-                    //
-                    pcStr = va_arg(arg, char *);
+    if(i32Exp < 0)
+    {
+        return(-uprodcmp(dScaled, g_pdPow10[-i32Exp], dValue));
+    }
 
-                    //
-                    // Determine the length of the string.
-                    //
-                    for(ulIdx = 0; pcStr[ulIdx] != '\0'; ulIdx++)
-                    {
-                    }
+    return(uprodcmp(dValue, g_pdPow10[i32Exp], dScaled));
+}
 
-                    //
-                    // Update the convert count to include any padding that
-                    // should be necessary (regardless of whether we have space
-                    // to write it or not).
-                    //
-                    if(ulCount > ulIdx)
-                    {
-                        iConvertCount += (ulCount - ulIdx);
-                    }
+//*****************************************************************************
+//
+// Rounds a scaled value to an integer, to nearest.  The value must be below
+// 2^52 so that the fraction is exact.  A fraction of exactly one half may
+// only look that way because of rounding in the scaling, so i32Err, the
+// sign of that rounding error, breaks the tie; ties that are real go to
+// even.
+//
+//*****************************************************************************
+static uint64_t
+uround(double dValue, int32_t i32Err)
+{
+    uint64_t ui64Int;
+    double dRem;
 
-                    //
-                    // Copy the string to the output buffer.  Only copy as much
-                    // as will fit in the buffer.  Update the output buffer
-                    // pointer and the space remaining.
-                    //
-                    if(ulIdx > n)
-                    {
-                        ustrncpy(s, pcStr, n);
-                        s += n;
-                        n = 0;
-                    }
-                    else
-                    {
-                        ustrncpy(s, pcStr, ulIdx);
-                        s += ulIdx;
-                        n -= ulIdx;
-
-                        //
-                        // Write any required padding spaces assuming there is
-                        // still space in the buffer.
-                        //
-                        if(ulCount > ulIdx)
-                        {
-                            ulCount -= ulIdx;
-                            if(ulCount > n)
-                            {
-                                ulCount = n;
-                            }
-                            n = -ulCount;
-
-                            while(ulCount--)
-                            {
-                                *s++ = ' ';
-                            }
-                        }
-                    }
+    ui64Int = (uint64_t)dValue;
+    dRem = dValue - (double)ui64Int;
 
-                    //
-                    // Update the conversion count.  This will be the number of
-                    // characters that should have been written, even if there
-                    // was not room in the buffer.
-                    //
-                    iConvertCount += ulIdx;
+    if((dRem > 0.5) ||
+       ((dRem == 0.5) && ((i32Err > 0) || ((i32Err == 0) && (ui64Int & 1)))))
+    {
+        ui64Int++;
+    }
 
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
+    return(ui64Int);
+}
 
-                //
-                // Handle the %u command.
-                //
-                case 'u':
-                {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ulValue = va_arg(arg, unsigned long);
+//*****************************************************************************
+//
+// Rounds a positive, finite, non-zero value to ui32Prec + 1 significant
+// digits.  Returns the digits as an integer between 10^ui32Prec and
+// 10^(ui32Prec + 1) - 1 and stores the decimal exponent of the first digit
+// in *pi32Exp.
+//
+//*****************************************************************************
+static uint64_t
+ufmtsig(double dValue, uint32_t ui32Prec, int32_t *pi32Exp)
+{
+    union
+    {
+        double d;
+        uint64_t u;
+    } uBits;
+    uint64_t ui64Digits, ui64Low;
+    int32_t i32Bin, i32Exp;
+    double dScaled;
 
-                    //
-                    // Set the base to 10.
-                    //
-                    ulBase = 10;
+    //
+    // Get the binary exponent, bringing subnormals into the normal range
+    // first.
+    //
+    uBits.d = dValue;
+    i32Bin = (int32_t)((uBits.u >> 52) & 0x7FF) - 1023;
+    if(i32Bin == -1023)
+    {
+        uBits.d = dValue * 18014398509481984.0;
+        i32Bin = (int32_t)((uBits.u >> 52) & 0x7FF) - 1023 - 54;
+    }
 
-                    //
-                    // Indicate that the value is positive so that a minus sign
-                    // isn't inserted.
-                    //
-                    ulNeg = 0;
+    //
+    // Estimate the decimal exponent as floor(i32Bin * log10(2)).  The
+    // estimate can be one off either way, which the scaling below corrects.
+    //
+    i32Exp = i32Bin * 78913;
+    i32Exp = (i32Exp >= 0) ? (i32Exp >> 18) : -((-i32Exp + 262143) >> 18);
 
-                    //
-                    // Convert the value to ASCII.
-                    //
-                    goto convert;
-                }
+    //
+    // Scale the value so that it has ui32Prec + 1 digits before the decimal
+    // point.
+    //
+    ui64Low = UPOW10(ui32Prec);
+    dScaled = uscale10(dValue, (int32_t)ui32Prec - i32Exp);
+    if(dScaled >= (double)(ui64Low * 10))
+    {
+        i32Exp++;
+        dScaled = uscale10(dValue, (int32_t)ui32Prec - i32Exp);
+    }
+    else if(dScaled < (double)ui64Low)
+    {
+        i32Exp--;
+        dScaled = uscale10(dValue, (int32_t)ui32Prec - i32Exp);
+    }
 
-                //
-                // Handle the %x and %X commands.  Note that they are treated
-                // identically; that is, %X will use lower case letters for a-f
-                // instead of the upper case letters is should use.  We also
-                // alias %p to %x.
-                //
-                case 'x':
-                case 'X':
-                case 'p':
-                {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ulValue = va_arg(arg, unsigned long);
+    //
+    // Round to an integer.  Rounding up can carry into a new digit, as in
+    // 9.9999 becoming 10.000.
+    //
+    ui64Digits = uround(dScaled, uscaleerr(dValue, (int32_t)ui32Prec - i32Exp,
+                                           dScaled));
+    if(ui64Digits >= (ui64Low * 10))
+    {
+        ui64Digits = ui64Low;
+        i32Exp++;
+    }
 
-                    //
-                    // Set the base to 16.
-                    //
-                    ulBase = 16;
+    *pi32Exp = i32Exp;
 
-                    //
-                    // Indicate that the value is positive so that a minus sign
-                    // isn't inserted.
-                    //
-                    ulNeg = 0;
+    return(ui64Digits);
+}
 
-                    //
-                    // Determine the number of digits in the string version of
-                    // the value.
-                    //
-convert:
-                    for(ulIdx = 1;
-                        (((ulIdx * ulBase) <= ulValue) &&
-                         (((ulIdx * ulBase) / ulBase) == ulIdx));
-                        ulIdx *= ulBase, ulCount--)
-                    {
-                    }
+//*****************************************************************************
+//
+// Stores ui32Prec + 1 significant digits in exponent form, for example
+// 1.234560e+02, and returns a pointer just past the last character.
+//
+//*****************************************************************************
+static char *
+ufmtexp(char *pcBuf, uint64_t ui64Digits, int32_t i32Exp, uint32_t ui32Prec)
+{
+    uint64_t ui64Low;
+    uint32_t ui32Lead;
 
-                    //
-                    // If the value is negative, reduce the count of padding
-                    // characters needed.
-                    //
-                    if(ulNeg)
-                    {
-                        ulCount--;
-                    }
+    //
+    // Split off the leading digit by counting rather than dividing.
+    //
+    ui64Low = UPOW10(ui32Prec);
+    for(ui32Lead = 0; ui64Digits >= (ui64Low * (ui32Lead + 1)); ui32Lead++)
+    {
+    }
 
-                    //
-                    // If the value is negative and the value is padded with
-                    // zeros, then place the minus sign before the padding.
-                    //
-                    if(ulNeg && (n != 0) && (cFill == '0'))
-                    {
-                        //
-                        // Place the minus sign in the output buffer.
-                        //
-                        *s++ = '-';
-                        n--;
-
-                        //
-                        // Update the conversion count.
-                        //
-                        iConvertCount++;
-
-                        //
-                        // The minus sign has been placed, so turn off the
-                        // negative flag.
-                        //
-                        ulNeg = 0;
-                    }
+    pcBuf = ufmtpoint(pcBuf, ui32Lead,
+                      (uint32_t)(ui64Digits - (ui64Low * ui32Lead)), ui32Prec);
 
-                    //
-                    // See if there are more characters in the specified field
-                    // width than there are in the conversion of this value.
-                    //
-                    if((ulCount > 1) && (ulCount < 65536))
-                    {
-                        //
-                        // Loop through the required padding characters.
-                        //
-                        for(ulCount--; ulCount; ulCount--)
-                        {
-                            //
-                            // Copy the character to the output buffer if there
-                            // is room.
-                            //
-                            if(n != 0)
-                            {
-                                *s++ = cFill;
-                                n--;
-                            }
-
-                            //
-                            // Update the conversion count.
-                            //
-                            iConvertCount++;
-                        }
-                    }
+    //
+    // The exponent always has a sign and at least two digits.
+    //
+    *pcBuf++ = 'e';
+    if(i32Exp < 0)
+    {
+        *pcBuf++ = '-';
+        i32Exp = -i32Exp;
+    }
+    else
+    {
+        *pcBuf++ = '+';
+    }
 
-                    //
-                    // If the value is negative, then place the minus sign
-                    // before the number.
-                    //
-                    if(ulNeg && (n != 0))
-                    {
-                        //
-                        // Place the minus sign in the output buffer.
-                        //
-                        *s++ = '-';
-                        n--;
-
-                        //
-                        // Update the conversion count.
-                        //
-                        iConvertCount++;
-                    }
+    return(ufmtzeros(pcBuf, (uint32_t)i32Exp, 2));
+}
 
-                    //
-                    // Convert the value into a string.
-                    //
-                    for(; ulIdx; ulIdx /= ulBase)
-                    {
-                        //
-                        // Copy the character to the output buffer if there is
-                        // room.
-                        //
-                        if(n != 0)
-                        {
-                            *s++ = g_pcHex[(ulValue / ulIdx) % ulBase];
-                            n--;
-                        }
+//*****************************************************************************
+//
+// Stores a positive value below 2^32 - 1 with ui32Prec fraction digits and
+// returns a pointer just past the last character.
+//
+//*****************************************************************************
+static char *
+ufmtfix(char *pcBuf, double dValue, uint32_t ui32Prec)
+{
+    uint32_t ui32Int, ui32Frac;
+    int32_t i32Err;
+    double dFrac;
 
-                        //
-                        // Update the conversion count.
-                        //
-                        iConvertCount++;
-                    }
+    //
+    // Split off the integer part.  The subtraction is exact, the scaling of
+    // the fraction may not be.
+    //
+    ui32Int = (uint32_t)dValue;
+    dFrac = dValue - ui32Int;
+    i32Err = uprodcmp(dFrac, g_pdPow10[ui32Prec], dFrac * g_pdPow10[ui32Prec]);
+    dFrac *= g_pdPow10[ui32Prec];
 
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
+    //
+    // Round the fraction to nearest, with real ties to even on the last
+    // printed digit, and carry into the integer part if it rounds up to one.
+    //
+    ui32Frac = (uint32_t)dFrac;
+    dFrac -= ui32Frac;
+    if((dFrac > 0.5) ||
+       ((dFrac == 0.5) &&
+        ((i32Err > 0) ||
+         ((i32Err == 0) && ((ui32Prec ? ui32Frac : ui32Int) & 1)))))
+    {
+        ui32Frac++;
+        if(ui32Frac == UPOW10(ui32Prec))
+        {
+            ui32Frac = 0;
+            ui32Int++;
+        }
+    }
 
-                //
-                // Handle the %% command.
-                //
-                case '%':
-                {
+    return(ufmtpoint(pcBuf, ui32Int, ui32Frac, ui32Prec));
+}
+
+//*****************************************************************************
+//
+//! Converts a floating-point number to a string.
+//!
+//! \param pcBuf points to the buffer where the string is stored; it must hold
+//! at least \b UFMT_FLOAT_MAX characters.
+//! \param dValue is the number to convert.
+//! \param cFormat is the conversion, one of \b e, \b f, or \b g.
+//! \param ui32Prec is the precision, or \b UFMT_PREC_NONE for the default
+//! of 6.
+//!
+//! This function is the floating-point core shared by uvsnprintf() and
+//! UARTprintf().  It follows the C library \%e, \%f, and \%g conversions,
+//! including a leading minus sign, with these limits:
+//!
+//! - the precision is capped at \b UFMT_PREC_MAX
+//! - \%f of a value of 2^32 - 1 or more is printed as \%e
+//! - infinity and NaN are printed as \e inf and \e nan
+//!
+//! Results are rounded to nearest with ties to even, the same as the C
+//! library.  The value is scaled by a power of ten in double precision and
+//! the rounding error of that step is recovered exactly, so a result that
+//! only looks like a tie is settled correctly.  The one exception is \%e and
+//! \%g of a value that needs more than 22 places of scaling, such as 1e-30;
+//! a value that close to a halfway point can round either way.
+//!
+//! Past the scaling only the integer unit is used.  The scaling is double
+//! precision, since varargs promote floats to double and the Cortex-M4 FPU
+//! is single precision only.
+//!
+//! \return Returns the number of characters stored, not including a NULL
+//! terminator, which is not stored.
+//
+//*****************************************************************************
+uint32_t
+ufmtfloat(char *pcBuf, double dValue, char cFormat, uint32_t ui32Prec)
+{
+    union
+    {
+        double d;
+        uint64_t u;
+    } uBits;
+    uint64_t ui64Digits;
+    int32_t i32Exp;
+    char *pcOut, *pcEnd, *pcTrim;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(pcBuf);
+    ASSERT((cFormat == 'e') || (cFormat == 'f') || (cFormat == 'g'));
+
+    pcOut = pcBuf;
+
+    //
+    // Take the sign from the sign bit, so that -0.0 keeps its minus sign.
+    //
+    uBits.d = dValue;
+    if(uBits.u >> 63)
+    {
+        *pcOut++ = '-';
+        dValue = -dValue;
+    }
+
+    //
+    // Infinity and NaN have an all ones exponent.
+    //
+    if(((uBits.u >> 52) & 0x7FF) == 0x7FF)
+    {
+        ustrncpy(pcOut, (uBits.u << 12) ? "nan" : "inf", 3);
+        return((pcOut + 3) - pcBuf);
+    }
+
+    //
+    // Apply the default and maximum precision.
+    //
+    if(ui32Prec == UFMT_PREC_NONE)
+    {
+        ui32Prec = 6;
+    }
+    else if(ui32Prec > UFMT_PREC_MAX)
+    {
+        ui32Prec = UFMT_PREC_MAX;
+    }
+
+    //
+    // %f while the integer part fits in 32 bits.
+    //
+    if((cFormat == 'f') && (dValue < 4294967295.0))
+    {
+        pcEnd = ufmtfix(pcOut, dValue, ui32Prec);
+        return(pcEnd - pcBuf);
+    }
+
+    //
+    // %e, and %f of a value too large for it.
+    //
+    if(cFormat != 'g')
+    {
+        ui64Digits = 0;
+        i32Exp = 0;
+        if(dValue != 0.0)
+        {
+            ui64Digits = ufmtsig(dValue, ui32Prec, &i32Exp);
+        }
+
+        pcEnd = ufmtexp(pcOut, ui64Digits, i32Exp, ui32Prec);
+        return(pcEnd - pcBuf);
+    }
+
+    //
+    // %g uses the precision as the number of significant digits, picks %e
+    // or %f by the exponent after rounding, and drops trailing zeros.
+    //
+    if(dValue == 0.0)
+    {
+        *pcOut = '0';
+        return((pcOut + 1) - pcBuf);
+    }
+
+    if(ui32Prec == 0)
+    {
+        ui32Prec = 1;
+    }
+
+    ui64Digits = ufmtsig(dValue, ui32Prec - 1, &i32Exp);
+    if((i32Exp < -4) || (i32Exp >= (int32_t)ui32Prec))
+    {
+        pcEnd = ufmtexp(pcOut, ui64Digits, i32Exp, ui32Prec - 1);
+    }
+    else if(i32Exp < 0)
+    {
+        //
+        // Below one the rounded digits follow "0." and -i32Exp - 1 zeros.
+        //
+        pcOut[0] = '0';
+        pcOut[1] = '.';
+        for(pcEnd = pcOut + 2, pcTrim = pcEnd - i32Exp - 1; pcEnd != pcTrim;
+            pcEnd++)
+        {
+            *pcEnd = '0';
+        }
+        pcEnd = ufmtzeros(pcEnd, (uint32_t)ui64Digits, ui32Prec);
+    }
+    else
+    {
+        //
+        // Otherwise the decimal point goes after the first i32Exp + 1 of
+        // the rounded digits, if any are left after them.
+        //
+        pcEnd = ufmtzeros(pcOut, (uint32_t)ui64Digits, ui32Prec);
+        pcTrim = pcOut + i32Exp + 1;
+        if(pcTrim == pcEnd)
+        {
+            return(pcEnd - pcBuf);
+        }
+        for(pcOut = pcEnd; pcOut != pcTrim; pcOut--)
+        {
+            *pcOut = pcOut[-1];
+        }
+        *pcTrim = '.';
+        pcEnd++;
+    }
+
+    //
+    // Find the end of the fraction, which is either the exponent or the end
+    // of the string.  There is nothing to trim without a decimal point.
+    //
+    for(pcTrim = pcBuf; (pcTrim != pcEnd) && (*pcTrim != '.'); pcTrim++)
+    {
+    }
+    if(pcTrim == pcEnd)
+    {
+        return(pcEnd - pcBuf);
+    }
+    for(; (pcTrim != pcEnd) && (*pcTrim != 'e'); pcTrim++)
+    {
+    }
+
+    //
+    // Back up over the trailing zeros, and the decimal point if no fraction
+    // digits are left, then move the exponent down.
+    //
+    for(pcOut = pcTrim; pcOut[-1] == '0'; pcOut--)
+    {
+    }
+    if(pcOut[-1] == '.')
+    {
+        pcOut--;
+    }
+
+    while(pcTrim != pcEnd)
+    {
+        *pcOut++ = *pcTrim++;
+    }
+
+    return(pcOut - pcBuf);
+}
+
+//*****************************************************************************
+//
+//! Converts a fixed-point number to a string.
+//!
+//! \param pcBuf points to the buffer where the string is stored; it must hold
+//! at least \b UFMT_FLOAT_MAX characters.
+//! \param i32Value is the number, a signed 32-bit value with \e ui32FracBits
+//! fraction bits (Q format).
+//! \param ui32FracBits is the number of fraction bits, from 0 to 31.
+//! \param ui32Prec is the number of fraction digits to print, or
+//! \b UFMT_PREC_NONE for the default of 6.
+//!
+//! This function prints a Q-format value as a decimal number with
+//! \e ui32Prec digits after the decimal point, with a leading minus sign if
+//! negative.  For example, 0x00018000 with 16 fraction bits prints as
+//! 1.500000.  The conversion uses only integer arithmetic and rounds exactly,
+//! to nearest with ties to even.
+//!
+//! \return Returns the number of characters stored, not including a NULL
+//! terminator, which is not stored.
+//
+//*****************************************************************************
+uint32_t
+ufmtfixed(char *pcBuf, int32_t i32Value, uint32_t ui32FracBits,
+          uint32_t ui32Prec)
+{
+    uint32_t ui32Mag, ui32Int, ui32Frac, ui32Mask;
+    uint64_t ui64Scaled, ui64Rem, ui64Half;
+    char *pcOut;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(pcBuf);
+    ASSERT(ui32FracBits < 32);
+
+    pcOut = pcBuf;
+
+    //
+    // Apply the default and maximum precision.
+    //
+    if(ui32Prec == UFMT_PREC_NONE)
+    {
+        ui32Prec = 6;
+    }
+    else if(ui32Prec > UFMT_PREC_MAX)
+    {
+        ui32Prec = UFMT_PREC_MAX;
+    }
+
+    //
+    // Work on the magnitude.  Negating in unsigned arithmetic handles the
+    // most negative value.
+    //
+    ui32Mag = (uint32_t)i32Value;
+    if(i32Value < 0)
+    {
+        *pcOut++ = '-';
+        ui32Mag = -ui32Mag;
+    }
+
+    ui32Mask = (1UL << ui32FracBits) - 1;
+    ui32Int = ui32Mag >> ui32FracBits;
+
+    //
+    // Scale the fraction bits to decimal digits.  The product is below 2^61
+    // so the remainder, and with it the rounding, is exact.
+    //
+    ui64Scaled = (uint64_t)(ui32Mag & ui32Mask) * UPOW10(ui32Prec);
+    ui32Frac = (uint32_t)(ui64Scaled >> ui32FracBits);
+    ui64Rem = ui64Scaled & ui32Mask;
+    ui64Half = (ui32Mask + 1ULL) >> 1;
+
+    if(ui32FracBits &&
+       ((ui64Rem > ui64Half) ||
+        ((ui64Rem == ui64Half) && ((ui32Prec ? ui32Frac : ui32Int) & 1))))
+    {
+        ui32Frac++;
+        if(ui32Frac == UPOW10(ui32Prec))
+        {
+            ui32Frac = 0;
+            ui32Int++;
+        }
+    }
+
+    return(ufmtpoint(pcOut, ui32Int, ui32Frac, ui32Prec) - pcBuf);
+}
+
+//*****************************************************************************
+//
+// The number of characters the formatters collect before calling the sink.
+//
+//*****************************************************************************
+#define USINK_STAGE_SIZE        32
+
+//*****************************************************************************
+//
+// The output side of the formatters.  Short pieces (literal runs, numbers,
+// padding) are collected in pcBuf so that the sink is called once per
+// ui32Size characters rather than once per piece.  Without a sink, pcBuf is
+// the caller's buffer and the output is cut off when it is full.
+//
+//*****************************************************************************
+typedef struct
+{
+    tUSinkFxn pfnSink;
+    void *pvSink;
+    char *pcBuf;
+    uint32_t ui32Len;
+    uint32_t ui32Size;
+}
+tUSinkStage;
+
+//*****************************************************************************
+//
+// Runs of fill characters, used by usinkpad().
+//
+//*****************************************************************************
+static const char g_pcFillSpaces[16] =
+{
+    ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ',
+    ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '
+};
+static const char g_pcFillZeros[16] =
+{
+    '0', '0', '0', '0', '0', '0', '0', '0',
+    '0', '0', '0', '0', '0', '0', '0', '0'
+};
+
+//*****************************************************************************
+//
+// Hands the collected characters to the sink.
+//
+//*****************************************************************************
+static void
+usinkflush(tUSinkStage *psStage)
+{
+    if(psStage->pfnSink && psStage->ui32Len)
+    {
+        psStage->pfnSink(psStage->pvSink, psStage->pcBuf, psStage->ui32Len);
+        psStage->ui32Len = 0;
+    }
+}
+
+//*****************************************************************************
+//
+// Sends ui32Len characters towards the sink.  Pieces that do not fit in the
+// stage buffer go to the sink directly, after what was collected before
+// them.
+//
+//*****************************************************************************
+static void
+usinkput(tUSinkStage *psStage, const char *pcStr, uint32_t ui32Len)
+{
+    uint32_t ui32Idx;
+    char *pcOut;
+
+    if(ui32Len > (psStage->ui32Size - psStage->ui32Len))
+    {
+        if(!psStage->pfnSink)
+        {
+            ui32Len = psStage->ui32Size - psStage->ui32Len;
+        }
+        else
+        {
+            usinkflush(psStage);
+            if(ui32Len > psStage->ui32Size)
+            {
+                psStage->pfnSink(psStage->pvSink, pcStr, ui32Len);
+                return;
+            }
+        }
+    }
+
+    pcOut = psStage->pcBuf + psStage->ui32Len;
+    for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+    {
+        pcOut[ui32Idx] = pcStr[ui32Idx];
+    }
+    psStage->ui32Len += ui32Len;
+}
+
+//*****************************************************************************
+//
+// Sends ui32Count copies of the fill character towards the sink.
+//
+//*****************************************************************************
+static void
+usinkpad(tUSinkStage *psStage, char cFill, uint32_t ui32Count)
+{
+    const char *pcFill;
+    uint32_t ui32Len;
+
+    pcFill = (cFill == '0') ? g_pcFillZeros : g_pcFillSpaces;
+
+    while(ui32Count)
+    {
+        ui32Len = (ui32Count > 16) ? 16 : ui32Count;
+        usinkput(psStage, pcFill, ui32Len);
+        ui32Count -= ui32Len;
+    }
+}
+
+//*****************************************************************************
+//
+// Sends one converted field towards the sink, padded to ui32Width.  Strings
+// (bLeft) are padded on the right with spaces.  Numbers are padded on the
+// left, and zero padding goes between the sign and the digits.  Returns the
+// number of characters sent.
+//
+//*****************************************************************************
+static uint32_t
+usinkfield(tUSinkStage *psStage, const char *pcStr, uint32_t ui32Len,
+           uint32_t ui32Width, char cFill, bool bLeft)
+{
+    uint32_t ui32Pad, ui32Total;
+
+    ui32Pad = (ui32Width > ui32Len) ? (ui32Width - ui32Len) : 0;
+    ui32Total = ui32Len + ui32Pad;
+
+    if(bLeft)
+    {
+        usinkput(psStage, pcStr, ui32Len);
+        usinkpad(psStage, ' ', ui32Pad);
+        return(ui32Total);
+    }
+
+    if((cFill == '0') && (*pcStr == '-'))
+    {
+        usinkput(psStage, pcStr, 1);
+        pcStr++;
+        ui32Len--;
+    }
+    usinkpad(psStage, cFill, ui32Pad);
+    usinkput(psStage, pcStr, ui32Len);
+
+    return(ui32Total);
+}
+
+//*****************************************************************************
+//
+//! Writes formatter output to a memory buffer.
+//!
+//! \param pvSink points to a tUSinkBuf giving where the output goes and how
+//! much room is left.
+//! \param pcBuf points to the characters to write.
+//! \param ui32Len is the number of characters.
+//!
+//! This function is a tUSinkFxn for uvsinkprintf() and ufmtsink(), for
+//! output that is built up over several calls.  It stores as many of the
+//! characters as fit and drops the rest; it does not store a NULL terminator.
+//! A single formatted string is better made with uvsnprintf(), which
+//! converts straight into the buffer.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+usinkbuf(void *pvSink, const char *pcBuf, uint32_t ui32Len)
+{
+    tUSinkBuf *psBuf;
+    uint32_t ui32Idx;
+    char *pcOut;
+
+    psBuf = pvSink;
+
+    if(ui32Len > psBuf->ui32Left)
+    {
+        ui32Len = psBuf->ui32Left;
+    }
+
+    //
+    // The pieces are counted, not NULL terminated, and may hold zeros (a %c
+    // of 0), so copy exactly ui32Len characters.  Long pieces with matching
+    // alignment go a word at a time.
+    //
+    pcOut = psBuf->pcBuf;
+    ui32Idx = 0;
+#ifndef USTDLIB_BYTE_STRINGS
+    if((ui32Len >= 16) && USAMEALIGN(pcOut, pcBuf))
+    {
+        while(!UALIGNED(pcBuf + ui32Idx))
+        {
+            pcOut[ui32Idx] = pcBuf[ui32Idx];
+            ui32Idx++;
+        }
+        while((ui32Len - ui32Idx) >= 4)
+        {
+            *(tUWord *)(pcOut + ui32Idx) = *(const tUWord *)(pcBuf + ui32Idx);
+            ui32Idx += 4;
+        }
+    }
+#endif
+    for(; ui32Idx < ui32Len; ui32Idx++)
+    {
+        pcOut[ui32Idx] = pcBuf[ui32Idx];
+    }
+
+    psBuf->pcBuf = pcOut + ui32Len;
+    psBuf->ui32Left -= ui32Len;
+}
+
+//*****************************************************************************
+//
+// The formatter of uvsinkprintf() and uvsnprintf(), writing to a stage set
+// up by the caller.
+//
+//*****************************************************************************
+static int
+uvstageprintf(tUSinkStage *psStage, const char *format, va_list arg)
+{
+    unsigned long ulIdx, ulValue, ulCount, ulBase, ulPrec;
+    char *pcStr, pcNum[UFMT_FLOAT_MAX], cFill;
+    int iConvertCount;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(format);
+
+    //
+    // Initialize the count of characters converted.
+    //
+    iConvertCount = 0;
+
+    //
+    // Loop while there are more characters in the format string.
+    //
+    while(*format)
+    {
+        //
+        // Find the first non-% character, or the end of the string.
+        //
+        for(ulIdx = 0; (format[ulIdx] != '%') && (format[ulIdx] != '\0');
+            ulIdx++)
+        {
+        }
+
+        //
+        // Write this portion of the string.
+        //
+        if(ulIdx)
+        {
+            usinkput(psStage, format, ulIdx);
+            iConvertCount += ulIdx;
+        }
+
+        //
+        // Skip the portion of the format string that was written.
+        //
+        format += ulIdx;
+
+        //
+        // See if the next character is a %.
+        //
+        if(*format == '%')
+        {
+            //
+            // Skip the %.
+            //
+            format++;
+
+            //
+            // Set the digit count to zero, and the fill character to space
+            // (that is, to the defaults).
+            //
+            ulCount = 0;
+            ulPrec = UFMT_PREC_NONE;
+            cFill = ' ';
+
+            //
+            // It may be necessary to get back here to process more characters.
+            // Goto's aren't pretty, but effective.  I feel extremely dirty for
+            // using not one but two of the beasts.
+            //
+again:
+
+            //
+            // Determine how to handle the next character.
+            //
+            switch(*format++)
+            {
+                //
+                // Handle the digit characters.
+                //
+                case '0':
+                case '1':
+                case '2':
+                case '3':
+                case '4':
+                case '5':
+                case '6':
+                case '7':
+                case '8':
+                case '9':
+                {
+                    //
+                    // If this is a zero, and it is the first digit, then the
+                    // fill character is a zero instead of a space.
+                    //
+                    if((format[-1] == '0') && (ulCount == 0))
+                    {
+                        cFill = '0';
+                    }
+
+                    //
+                    // Update the digit count.
+                    //
+                    ulCount *= 10;
+                    ulCount += format[-1] - '0';
+
+                    //
+                    // Get the next character.
+                    //
+                    goto again;
+                }
+
+                //
+                // Handle the precision, which is the digit string following
+                // a period.
+                //
+                case '.':
+                {
+                    for(ulPrec = 0; (*format >= '0') && (*format <= '9');
+                        format++)
+                    {
+                        ulPrec *= 10;
+                        ulPrec += *format - '0';
+                    }
+
+                    //
+                    // Get the next character.
+                    //
+                    goto again;
+                }
+
+                //
+                // Handle the %c command.
+                //
+                case 'c':
+                {
+                    //
+                    // Get the value from the varargs and write it, ignoring
+                    // any width.
+                    //
+                    pcNum[0] = (char)va_arg(arg, unsigned long);
+                    usinkput(psStage, pcNum, 1);
+                    iConvertCount++;
+
+                    //
+                    // This command has been handled.
+                    //
+                    break;
+                }
+
+                //
+                // Handle the %d and %i commands.
+                //
+                case 'd':
+                case 'i':
+                {
+                    //
+                    // Get the value from the varargs.
+                    //
+                    ulValue = va_arg(arg, unsigned long);
+
+                    //
+                    // If the value is negative, make it positive and start
+                    // the conversion with a minus sign.
+                    //
+                    ulIdx = 0;
+                    if((long)ulValue < 0)
+                    {
+                        ulValue = -(long)ulValue;
+                        pcNum[ulIdx++] = '-';
+                    }
+
+                    //
+                    // Set the base to 10.
+                    //
+                    ulBase = 10;
+
+                    //
+                    // Convert the value to ASCII.
+                    //
+                    goto convert;
+                }
+
+                //
+                // Handle the %s command.
+                //
+                case 's':
+                {
+                    //
+                    // Get the string pointer from the varargs.
+                    //
+                    pcStr = va_arg(arg, char *);
+
+                    //
+                    // Write the string, followed by any padding spaces.
+                    //
+                    iConvertCount += usinkfield(psStage, pcStr, ustrlen(pcStr),
+                                                ulCount, ' ', true);
+
+                    //
+                    // This command has been handled.
+                    //
+                    break;
+                }
+
+                //
+                // Handle the %u command.
+                //
+                case 'u':
+                {
+                    //
+                    // Get the value from the varargs.
+                    //
+                    ulValue = va_arg(arg, unsigned long);
+                    ulIdx = 0;
+
+                    //
+                    // Set the base to 10.
+                    //
+                    ulBase = 10;
+
+                    //
+                    // Convert the value to ASCII.
+                    //
+                    goto convert;
+                }
+
+                //
+                // Handle the %x and %X commands.  Note that they are treated
+                // identically; that is, %X will use lower case letters for a-f
+                // instead of the upper case letters is should use.  We also
+                // alias %p to %x.
+                //
+                case 'x':
+                case 'X':
+                case 'p':
+                {
+                    //
+                    // Get the value from the varargs.
+                    //
+                    ulValue = va_arg(arg, unsigned long);
+                    ulIdx = 0;
+
+                    //
+                    // Set the base to 16.
+                    //
+                    ulBase = 16;
+
+                    //
+                    // Convert the value into a string, after the sign if
+                    // there is one.
+                    //
+convert:
+                    ulBase = unumdigits(ulValue, ulBase) | (ulBase << 8);
+
+                    //
+                    // Without a width, and with room for the longest value,
+                    // convert straight into the output.
+                    //
+                    if((ulCount == 0) &&
+                       ((psStage->ui32Size - psStage->ui32Len) >= 11))
+                    {
+                        pcStr = psStage->pcBuf + psStage->ui32Len;
+                        if(ulIdx)
+                        {
+                            *pcStr++ = '-';
+                        }
+                        unumtostr(pcStr, ulValue, ulBase >> 8, ulBase & 0xFF);
+                        ulIdx += ulBase & 0xFF;
+                        psStage->ui32Len += ulIdx;
+                        iConvertCount += ulIdx;
+                        break;
+                    }
+
+                    unumtostr(pcNum + ulIdx, ulValue, ulBase >> 8,
+                              ulBase & 0xFF);
+                    ulIdx += ulBase & 0xFF;
+
+                    //
+                    // Write the converted value.
+                    //
+                    goto number;
+                }
+
+                //
+                // Handle the %e, %f, and %g commands.
+                //
+                case 'e':
+                case 'f':
+                case 'g':
+                {
+                    //
+                    // Convert the value from the varargs.
+                    //
+                    ulIdx = ufmtfloat(pcNum, va_arg(arg, double), format[-1],
+                                      ulPrec);
+
+                    //
+                    // Zero padding is not used for inf and nan.
+                    //
+                    if(pcNum[pcNum[0] == '-'] > '9')
+                    {
+                        cFill = ' ';
+                    }
+
+                    //
+                    // Write the converted value.
+                    //
+                    goto number;
+                }
+
+                //
+                // Handle the %q command.
+                //
+                case 'q':
+                {
+                    //
+                    // Get the number of fraction bits and then the value from
+                    // the varargs.
+                    //
+                    ulBase = va_arg(arg, unsigned long);
+                    ulValue = va_arg(arg, unsigned long);
+
+                    //
+                    // Convert the value.
+                    //
+                    ulIdx = ufmtfixed(pcNum, (int32_t)ulValue, ulBase, ulPrec);
+
+                    //
+                    // Write the converted value, padded to the field width.
+                    //
+number:
+                    iConvertCount += usinkfield(psStage, pcNum, ulIdx, ulCount,
+                                                cFill, false);
+
+                    //
+                    // This command has been handled.
+                    //
+                    break;
+                }
+
+                //
+                // Handle the %% command.
+                //
+                case '%':
+                {
                     //
                     // Simply write a single %.
                     //
-                    if(n != 0)
-                    {
-                        *s++ = format[-1];
-                        n--;
-                    }
+                    usinkput(psStage, format - 1, 1);
+                    iConvertCount++;
+
+                    //
+                    // This command has been handled.
+                    //
+                    break;
+                }
+
+                //
+                // Handle all other commands.
+                //
+                default:
+                {
+                    //
+                    // Indicate an error.
+                    //
+                    usinkput(psStage, "ERROR", 5);
+                    iConvertCount += 5;
+
+                    //
+                    // This command has been handled.
+                    //
+                    break;
+                }
+            }
+        }
+    }
+
+    //
+    // Return the number of characters in the full converted string.
+    //
+    return(iConvertCount);
+}
+
+//*****************************************************************************
+//
+//! A vprintf function that writes through a sink, supporting \%c, \%d, \%p,
+//! \%s, \%u, \%x, and \%X.
+//!
+//! \param pfnSink is the function that receives the output.
+//! \param pvSink is passed to \e pfnSink with each piece of output.
+//! \param format is the format string.
+//! \param arg is the list of optional arguments, which depend on the
+//! contents of the format string.
+//!
+//! This function is the formatter behind uvsnprintf() and UARTprintf().  It
+//! does not store its output; it hands it to \e pfnSink as it goes, so the
+//! same code can print to a buffer, a UART, or anything else a sink is
+//! written for.  Short pieces are collected on the stack and passed on 32
+//! characters at a time, and a long string argument or run of the format
+//! string is passed on as it is, so the sink must accept any length.
+//!
+//! The supported formatting characters are those of uvsnprintf().
+//!
+//! \return Returns the number of characters sent to the sink.
+//
+//*****************************************************************************
+int
+uvsinkprintf(tUSinkFxn pfnSink, void *pvSink, const char *format, va_list arg)
+{
+    char pcBuf[USINK_STAGE_SIZE];
+    tUSinkStage sStage;
+    int iConvertCount;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(pfnSink);
+
+    //
+    // Format through a stage buffer on the stack, then send what is left.
+    //
+    sStage.pfnSink = pfnSink;
+    sStage.pvSink = pvSink;
+    sStage.pcBuf = pcBuf;
+    sStage.ui32Len = 0;
+    sStage.ui32Size = sizeof(pcBuf);
+    iConvertCount = uvstageprintf(&sStage, format, arg);
+    usinkflush(&sStage);
+
+    return(iConvertCount);
+}
+
+//*****************************************************************************
+//
+//! A printf function that writes through a sink.
+//!
+//! \param pfnSink is the function that receives the output.
+//! \param pvSink is passed to \e pfnSink with each piece of output.
+//! \param format is the format string.
+//! \param ... are the optional arguments, which depend on the contents of the
+//! format string.
+//!
+//! This function is uvsinkprintf() with a variable argument list.
+//!
+//! \return Returns the number of characters sent to the sink.
+//
+//*****************************************************************************
+int
+usinkprintf(tUSinkFxn pfnSink, void *pvSink, const char *format, ...)
+{
+    va_list arg;
+    int ret;
+
+    //
+    // Start the varargs processing.
+    //
+    va_start(arg, format);
+
+    ret = uvsinkprintf(pfnSink, pvSink, format, arg);
+
+    //
+    // End the varargs processing.
+    //
+    va_end(arg);
+
+    //
+    // Return the conversion count.
+    //
+    return(ret);
+}
+
+//*****************************************************************************
+//
+//! A simple vsnprintf function supporting \%c, \%d, \%p, \%s, \%u, \%x, and
+//! \%X.
+//!
+//! \param s points to the buffer where the converted string is stored.
+//! \param n is the size of the buffer.
+//! \param format is the format string.
+//! \param arg is the list of optional arguments, which depend on the
+//! contents of the format string.
+//!
+//! This function is very similar to the C library <tt>vsnprintf()</tt>
+//! function.  Only the following formatting characters are supported:
+//!
+//! - \%c to print a character
+//! - \%d or \%i to print a decimal value
+//! - \%s to print a string
+//! - \%u to print an unsigned decimal value
+//! - \%x to print a hexadecimal value using lower case letters
+//! - \%X to print a hexadecimal value using lower case letters (not upper case
+//! letters as would typically be used)
+//! - \%p to print a pointer as a hexadecimal value
+//! - \%e, \%f, or \%g to print a floating-point value, see ufmtfloat()
+//! - \%q to print a Q-format fixed-point value, see ufmtfixed(); it takes two
+//! arguments, the number of fraction bits and then the value
+//! - \%\% to print out a \% character
+//!
+//! For \%d, \%i, \%p, \%s, \%u, \%x, and \%X, an optional number may reside
+//! between the \% and the format character, which specifies the minimum number
+//! of characters to use for that value; if preceded by a 0 then the extra
+//! characters will be filled with zeros instead of spaces.  For example,
+//! ``\%8d'' will use eight characters to print the decimal value with spaces
+//! added to reach eight; ``\%08d'' will use eight characters as well but will
+//! add zeroes instead of spaces.
+//!
+//! For \%e, \%f, \%g, and \%q a precision may follow the width, as in
+//! ``\%8.3f''.  It is the number of digits after the decimal point, or the
+//! number of significant digits for \%g, and defaults to six.  Precision is
+//! ignored by the other conversions.
+//!
+//! The type of the arguments after \e format must match the requirements of
+//! the format string.  For example, if an integer was passed where a string
+//! was expected, an error of some kind will most likely occur.
+//!
+//! The \e n parameter limits the number of characters that will be
+//! stored  in the buffer pointed to by \e s to prevent the possibility of
+//! a buffer  overflow.  The buffer size should be large enough to hold the
+//! expected converted output string, including the null termination character.
+//!
+//! The function will return the number of characters that would be converted
+//! as if there were no limit on the buffer size.  Therefore it is possible for
+//! the function to return a count that is greater than the specified buffer
+//! size.  If this happens, it means that the output was truncated.
+//!
+//! \return Returns the number of characters that were to be stored, not
+//! including the NULL termination character, regardless of space in the
+//! buffer.
+//
+//*****************************************************************************
+int
+uvsnprintf(char * restrict s, size_t n, const char * restrict format,
+           va_list arg)
+{
+    tUSinkStage sStage;
+    int iConvertCount;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(s);
+    ASSERT(n);
+    ASSERT(format);
+
+    //
+    // Convert straight into the buffer, leaving one space for null
+    // termination.
+    //
+    sStage.pfnSink = 0;
+    sStage.pvSink = 0;
+    sStage.pcBuf = s;
+    sStage.ui32Len = 0;
+    sStage.ui32Size = n ? (n - 1) : 0;
+    iConvertCount = uvstageprintf(&sStage, format, arg);
+
+    //
+    // Null terminate the string in the buffer.
+    //
+    if(n)
+    {
+        s[sStage.ui32Len] = 0;
+    }
+
+    //
+    // Return the number of characters in the full converted string.
+    //
+    return(iConvertCount);
+}
+
+//*****************************************************************************
+//
+//! A simple sprintf function supporting \%c, \%d, \%p, \%s, \%u, \%x, and \%X.
+//!
+//! \param s is the buffer where the converted string is stored.
+//! \param format is the format string.
+//! \param ... are the optional arguments, which depend on the contents of the
+//! format string.
+//!
+//! This function is very similar to the C library <tt>sprintf()</tt> function.
+//! Only the following formatting characters are supported:
+//!
+//! - \%c to print a character
+//! - \%d or \%i to print a decimal value
+//! - \%s to print a string
+//! - \%u to print an unsigned decimal value
+//! - \%x to print a hexadecimal value using lower case letters
+//! - \%X to print a hexadecimal value using lower case letters (not upper case
+//! letters as would typically be used)
+//! - \%p to print a pointer as a hexadecimal value
+//! - \%e, \%f, or \%g to print a floating-point value, see ufmtfloat()
+//! - \%q to print a Q-format fixed-point value, see ufmtfixed(); it takes two
+//! arguments, the number of fraction bits and then the value
+//! - \%\% to print out a \% character
+//!
+//! For \%d, \%i, \%p, \%s, \%u, \%x, and \%X, an optional number may reside
+//! between the \% and the format character, which specifies the minimum number
+//! of characters to use for that value; if preceded by a 0 then the extra
+//! characters will be filled with zeros instead of spaces.  For example,
+//! ``\%8d'' will use eight characters to print the decimal value with spaces
+//! added to reach eight; ``\%08d'' will use eight characters as well but will
+//! add zeros instead of spaces.
+//!
+//! For \%e, \%f, \%g, and \%q a precision may follow the width, as in
+//! ``\%8.3f''.  It is the number of digits after the decimal point, or the
+//! number of significant digits for \%g, and defaults to six.  Precision is
+//! ignored by the other conversions.
+//!
+//! The type of the arguments after \e format must match the requirements of
+//! the format string.  For example, if an integer was passed where a string
+//! was expected, an error of some kind will most likely occur.
+//!
+//! The caller must ensure that the buffer \e s is large enough to hold the
+//! entire converted string, including the null termination character.
+//!
+//! \return Returns the count of characters that were written to the output
+//! buffer, not including the NULL termination character.
+//
+//*****************************************************************************
+int
+usprintf(char * restrict s, const char *format, ...)
+{
+    va_list arg;
+    int ret;
+
+    //
+    // Start the varargs processing.
+    //
+    va_start(arg, format);
+
+    //
+    // Call vsnprintf to perform the conversion.  Use a large number for the
+    // buffer size.
+    //
+    ret = uvsnprintf(s, 0xffff, format, arg);
+
+    //
+    // End the varargs processing.
+    //
+    va_end(arg);
+
+    //
+    // Return the conversion count.
+    //
+    return(ret);
+}
+
+//*****************************************************************************
+//
+//! A simple snprintf function supporting \%c, \%d, \%p, \%s, \%u, \%x, and
+//! \%X.
+//!
+//! \param s is the buffer where the converted string is stored.
+//! \param n is the size of the buffer.
+//! \param format is the format string.
+//! \param ... are the optional arguments, which depend on the contents of the
+//! format string.
+//!
+//! This function is very similar to the C library <tt>sprintf()</tt> function.
+//! Only the following formatting characters are supported:
+//!
+//! - \%c to print a character
+//! - \%d or \%i to print a decimal value
+//! - \%s to print a string
+//! - \%u to print an unsigned decimal value
+//! - \%x to print a hexadecimal value using lower case letters
+//! - \%X to print a hexadecimal value using lower case letters (not upper case
+//! letters as would typically be used)
+//! - \%p to print a pointer as a hexadecimal value
+//! - \%e, \%f, or \%g to print a floating-point value, see ufmtfloat()
+//! - \%q to print a Q-format fixed-point value, see ufmtfixed(); it takes two
+//! arguments, the number of fraction bits and then the value
+//! - \%\% to print out a \% character
+//!
+//! For \%d, \%i, \%p, \%s, \%u, \%x, and \%X, an optional number may reside
+//! between the \% and the format character, which specifies the minimum number
+//! of characters to use for that value; if preceded by a 0 then the extra
+//! characters will be filled with zeros instead of spaces.  For example,
+//! ``\%8d'' will use eight characters to print the decimal value with spaces
+//! added to reach eight; ``\%08d'' will use eight characters as well but will
+//! add zeros instead of spaces.
+//!
+//! For \%e, \%f, \%g, and \%q a precision may follow the width, as in
+//! ``\%8.3f''.  It is the number of digits after the decimal point, or the
+//! number of significant digits for \%g, and defaults to six.  Precision is
+//! ignored by the other conversions.
+//!
+//! The type of the arguments after \e format must match the requirements of
+//! the format string.  For example, if an integer was passed where a string
+//! was expected, an error of some kind will most likely occur.
+//!
+//! The function will copy at most \e n - 1 characters into the buffer
+//! \e s.  One space is reserved in the buffer for the null termination
+//! character.
+//!
+//! The function will return the number of characters that would be converted
+//! as if there were no limit on the buffer size.  Therefore it is possible for
+//! the function to return a count that is greater than the specified buffer
+//! size.  If this happens, it means that the output was truncated.
+//!
+//! \return Returns the number of characters that were to be stored, not
+//! including the NULL termination character, regardless of space in the
+//! buffer.
+//
+//*****************************************************************************
+int
+usnprintf(char * restrict s, size_t n, const char * restrict format, ...)
+{
+    va_list arg;
+    int ret;
+
+    //
+    // Start the varargs processing.
+    //
+    va_start(arg, format);
+
+    //
+    // Call vsnprintf to perform the conversion.
+    //
+    ret = uvsnprintf(s, n, format, arg);
+
+    //
+    // End the varargs processing.
+    //
+    va_end(arg);
+
+    //
+    // Return the conversion count.
+    //
+    return(ret);
+}
+
+//*****************************************************************************
+//
+//! Converts the argument of one operation of a precompiled format.
+//!
+//! \param psOp is the operation.
+//! \param pvArgs points to the argument structure of the format.
+//! \param pcBuf points to a buffer of at least \b UFMT_FLOAT_MAX characters.
+//! \param ppcStr is where the location of the text is stored.
+//!
+//! This function produces the text of one operation of a format built by
+//! UFMT_DEFINE(), without any padding to the field width.  Characters and
+//! numbers are converted into \e pcBuf.  Literals and strings are not
+//! copied; \e *ppcStr is set to the text itself instead.  It is the
+//! conversion core of ufmtsink().
+//!
+//! \return Returns the length of the text at \e *ppcStr.
+//
+//*****************************************************************************
+uint32_t
+ufmtarg(const tUFmtOp *psOp, const void *pvArgs, char *pcBuf,
+        const char **ppcStr)
+{
+    uint32_t ui32Value, ui32Base, ui32Digits;
+    const char *pcArg;
+    char *pcOut;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(psOp);
+    ASSERT(pcBuf);
+    ASSERT(ppcStr);
+
+    //
+    // Find the argument, and assume the text is converted into the buffer.
+    //
+    pcArg = (const char *)pvArgs + psOp->ui16Arg;
+    pcOut = pcBuf;
+    *ppcStr = pcBuf;
+
+    switch(psOp->ui8Op)
+    {
+        //
+        // Literal text is used as is.
+        //
+        case UFMT_LIT:
+        {
+            *ppcStr = psOp->pcLit;
+            return(psOp->ui16Arg);
+        }
+
+        //
+        // So is a string argument.
+        //
+        case UFMT_STR:
+        {
+            *ppcStr = *(const char * const *)pcArg;
+            return(ustrlen(*ppcStr));
+        }
+
+        //
+        // A character is copied.
+        //
+        case UFMT_CHAR:
+        {
+            *pcOut = *pcArg;
+            return(1);
+        }
+
+        //
+        // Floating-point and fixed-point values have their own conversions.
+        //
+        case UFMT_FLOAT:
+        {
+            return(ufmtfloat(pcBuf, *(const double *)pcArg, psOp->ui8Aux,
+                             psOp->ui8Prec));
+        }
+        case UFMT_FIXED:
+        {
+            return(ufmtfixed(pcBuf, *(const int32_t *)pcArg, psOp->ui8Aux,
+                             psOp->ui8Prec));
+        }
+
+        //
+        // A signed value gets a minus sign and is converted as its
+        // magnitude.
+        //
+        case UFMT_INT:
+        {
+            ui32Value = *(const uint32_t *)pcArg;
+            if((int32_t)ui32Value < 0)
+            {
+                *pcOut++ = '-';
+                ui32Value = -ui32Value;
+            }
+            ui32Base = 10;
+            break;
+        }
+
+        case UFMT_UINT:
+        {
+            ui32Value = *(const uint32_t *)pcArg;
+            ui32Base = 10;
+            break;
+        }
+
+        case UFMT_HEX:
+        {
+            ui32Value = *(const uint32_t *)pcArg;
+            ui32Base = 16;
+            break;
+        }
+
+        //
+        // There is nothing to print for anything else.
+        //
+        default:
+        {
+            return(0);
+        }
+    }
+
+    //
+    // Convert the integer.
+    //
+    ui32Digits = unumdigits(ui32Value, ui32Base);
+    unumtostr(pcOut, ui32Value, ui32Base, ui32Digits);
+
+    return((pcOut + ui32Digits) - pcBuf);
+}
+
+//*****************************************************************************
+//
+// The interpreter of ufmtsink() and ufmtrun(), writing to a stage set up by
+// the caller.
+//
+//*****************************************************************************
+static int
+ufmtstage(tUSinkStage *psStage, const tUFmtOp *psOps, const void *pvArgs)
+{
+    char pcNum[UFMT_FLOAT_MAX], cFill;
+    const char *pcStr;
+    uint32_t ui32Len;
+    int iConvertCount;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(psOps);
+
+    iConvertCount = 0;
+
+    for(; psOps->ui8Op != UFMT_END; psOps++)
+    {
+        //
+        // Literals and unpadded integers make up most of a typical format.
+        // Literals are copied as they are, and integers are converted
+        // straight into the output when the longest one fits.
+        //
+        if(psOps->ui8Op == UFMT_LIT)
+        {
+            usinkput(psStage, psOps->pcLit, psOps->ui16Arg);
+            iConvertCount += psOps->ui16Arg;
+            continue;
+        }
+        if((psOps->ui8Op >= UFMT_INT) && (psOps->ui8Op <= UFMT_HEX) &&
+           (psOps->ui8Width == 0) &&
+           ((psStage->ui32Size - psStage->ui32Len) >= 11))
+        {
+            ui32Len = ufmtarg(psOps, pvArgs,
+                              psStage->pcBuf + psStage->ui32Len, &pcStr);
+            psStage->ui32Len += ui32Len;
+            iConvertCount += ui32Len;
+            continue;
+        }
+
+        //
+        // Otherwise get the text of this operation.
+        //
+        ui32Len = ufmtarg(psOps, pvArgs, pcNum, &pcStr);
+        if(psOps->ui8Width == 0)
+        {
+            usinkput(psStage, pcStr, ui32Len);
+            iConvertCount += ui32Len;
+            continue;
+        }
+
+        //
+        // Zero padding is not used for inf and nan.
+        //
+        cFill = psOps->cFill;
+        if((psOps->ui8Op == UFMT_FLOAT) && (pcStr[*pcStr == '-'] > '9'))
+        {
+            cFill = ' ';
+        }
+
+        //
+        // Write the text padded to the field width.
+        //
+        iConvertCount += usinkfield(psStage, pcStr, ui32Len, psOps->ui8Width,
+                                    cFill, psOps->ui8Op == UFMT_STR);
+    }
+
+    return(iConvertCount);
+}
+
+//*****************************************************************************
+//
+//! Prints with a precompiled format through a sink.
+//!
+//! \param pfnSink is the function that receives the output.
+//! \param pvSink is passed to \e pfnSink with each piece of output.
+//! \param psOps is the format, as returned by the NAME\#\#Ops() function that
+//! UFMT_DEFINE() creates.
+//! \param pvArgs points to the argument structure of the format.
+//!
+//! This function is the interpreter behind ufmtrun() and UARTStdioFmt().  It
+//! produces the same text as uvsinkprintf() would for the equivalent format
+//! string, including the padding rules, but walks a table of operations
+//! instead of parsing.
+//!
+//! \return Returns the number of characters sent to the sink.
+//
+//*****************************************************************************
+int
+ufmtsink(tUSinkFxn pfnSink, void *pvSink, const tUFmtOp *psOps,
+         const void *pvArgs)
+{
+    char pcBuf[USINK_STAGE_SIZE];
+    tUSinkStage sStage;
+    int iConvertCount;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(pfnSink);
+
+    //
+    // Print through a stage buffer on the stack, then send what is left.
+    //
+    sStage.pfnSink = pfnSink;
+    sStage.pvSink = pvSink;
+    sStage.pcBuf = pcBuf;
+    sStage.ui32Len = 0;
+    sStage.ui32Size = sizeof(pcBuf);
+    iConvertCount = ufmtstage(&sStage, psOps, pvArgs);
+    usinkflush(&sStage);
+
+    return(iConvertCount);
+}
+
+//*****************************************************************************
+//
+//! Prints with a precompiled format.
+//!
+//! \param s points to the buffer where the converted string is stored.
+//! \param n is the size of the buffer.
+//! \param psOps is the format, as returned by the NAME\#\#Ops() function that
+//! UFMT_DEFINE() creates.
+//! \param pvArgs points to the argument structure of the format.
+//!
+//! This function is the buffer version of ufmtsink(), and the one behind the
+//! functions made by UFMT_DEFINE(); it is not normally called directly.  It
+//! produces the same text as uvsnprintf() would for the equivalent format
+//! string.
+//!
+//! \return Returns the number of characters that were to be stored, not
+//! including the NULL termination character, regardless of space in the
+//! buffer.
+//
+//*****************************************************************************
+int
+ufmtrun(char * restrict s, size_t n, const tUFmtOp *psOps, const void *pvArgs)
+{
+    tUSinkStage sStage;
+    int iConvertCount;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(s);
+    ASSERT(n);
+
+    //
+    // Convert straight into the buffer, leaving one space for null
+    // termination.
+    //
+    sStage.pfnSink = 0;
+    sStage.pvSink = 0;
+    sStage.pcBuf = s;
+    sStage.ui32Len = 0;
+    sStage.ui32Size = n ? (n - 1) : 0;
+    iConvertCount = ufmtstage(&sStage, psOps, pvArgs);
+
+    //
+    // Null terminate the string in the buffer.
+    //
+    if(n)
+    {
+        s[sStage.ui32Len] = 0;
+    }
+
+    return(iConvertCount);
+}
+
+//*****************************************************************************
+//
+// This array contains the number of days in each month of the year, in a
+// non-leap year.
+//
+//*****************************************************************************
+static const uint8_t g_pui8DaysInMonth[12] =
+{
+    31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+};
+
+//*****************************************************************************
+//
+// The number of days from March 1, 0000 to January 1, 1970 in the proleptic
+// Gregorian calendar, and the number of days in a 400 year era.
+//
+//*****************************************************************************
+#define UDAYS_TO_EPOCH          719468
+#define UDAYS_PER_ERA           146097
+
+//*****************************************************************************
+//
+// Returns 1 if the year (counted from 1900, as in tm_year) is a leap year.
+//
+//*****************************************************************************
+static int32_t
+uleapyear(int32_t i32Year)
+{
+    i32Year += 1900;
+
+    return(((i32Year & 3) == 0) &&
+           (((i32Year % 100) != 0) || ((i32Year % 400) == 0)));
+}
+
+//*****************************************************************************
+//
+// Returns the number of days from January 1, 1970 to the given date, which
+// may be negative.  i32Mon is from 0 to 11 and i32Year is counted from 1900,
+// as in a struct tm.
+//
+// The year is taken to start on March 1 so that the leap day falls at its
+// end.  Then each 400 year era has the same number of days, the day of the
+// year does not depend on whether the year is a leap year, and the days
+// before each month follow the straight line (153 * month + 2) / 5.  There
+// are no loops or tables.
+//
+//*****************************************************************************
+static int32_t
+udaysfromcivil(int32_t i32Year, int32_t i32Mon, int32_t i32MDay)
+{
+    int32_t i32Era;
+    uint32_t ui32YoE, ui32DoY, ui32DoE;
+
+    //
+    // Count the year from March, with January and February at the end of the
+    // year before.
+    //
+    i32Year += 1900;
+    if(i32Mon < 2)
+    {
+        i32Year--;
+        i32Mon += 12;
+    }
+
+    //
+    // Split the year into the 400 year era and the year of the era.
+    //
+    i32Era = ((i32Year >= 0) ? i32Year : (i32Year - 399)) / 400;
+    ui32YoE = (uint32_t)(i32Year - (i32Era * 400));
+
+    //
+    // Find the day of the year and of the era.
+    //
+    ui32DoY = ((153 * (uint32_t)(i32Mon - 2)) + 2) / 5 + i32MDay - 1;
+    ui32DoE = (ui32YoE * 365) + (ui32YoE / 4) - (ui32YoE / 100) + ui32DoY;
+
+    return((i32Era * UDAYS_PER_ERA) + (int32_t)ui32DoE - UDAYS_TO_EPOCH);
+}
+
+//*****************************************************************************
+//
+// Fills in the date fields of a struct tm (the year, month, day of the month,
+// day of the year, and day of the week) from the number of days since
+// January 1, 1970.  This is the inverse of udaysfromcivil().
+//
+//*****************************************************************************
+static void
+ucivilfromdays(int32_t i32Days, struct tm *tm)
+{
+    int32_t i32Era;
+    uint32_t ui32DoE, ui32YoE, ui32DoY, ui32Mon;
+
+    //
+    // January 1, 1970 was a Thursday.
+    //
+    tm->tm_wday = (int)(((i32Days % 7) + 11) % 7);
+
+    //
+    // Count from March 1, 0000 and split into the 400 year era and the day of
+    // the era.
+    //
+    i32Days += UDAYS_TO_EPOCH;
+    i32Era = ((i32Days >= 0) ? i32Days : (i32Days - (UDAYS_PER_ERA - 1))) /
+             UDAYS_PER_ERA;
+    ui32DoE = (uint32_t)(i32Days - (i32Era * UDAYS_PER_ERA));
+
+    //
+    // Find the year of the era, correcting for the leap days before it, and
+    // the day of that year.
+    //
+    ui32YoE = (ui32DoE - (ui32DoE / 1460) + (ui32DoE / 36524) -
+               (ui32DoE / (UDAYS_PER_ERA - 1))) / 365;
+    ui32DoY = ui32DoE - ((365 * ui32YoE) + (ui32YoE / 4) - (ui32YoE / 100));
+
+    //
+    // Find the month, counted from March, and the day of the month.
+    //
+    ui32Mon = ((5 * ui32DoY) + 2) / 153;
+    tm->tm_mday = (int)(ui32DoY - (((153 * ui32Mon) + 2) / 5) + 1);
+
+    //
+    // Go back to a year starting in January.
+    //
+    tm->tm_year = (int)((i32Era * 400) + (int32_t)ui32YoE - 1900);
+    if(ui32Mon < 10)
+    {
+        tm->tm_mon = (int)(ui32Mon + 2);
+        tm->tm_yday = (int)(ui32DoY + 59 + uleapyear(tm->tm_year));
+    }
+    else
+    {
+        tm->tm_year++;
+        tm->tm_mon = (int)(ui32Mon - 10);
+        tm->tm_yday = (int)(ui32DoY - 306);
+    }
+}
+
+//*****************************************************************************
+//
+//! Converts from seconds to calendar date and time, with 64-bit seconds.
+//!
+//! \param i64Time is the number of seconds, which may be negative.
+//! \param tm is a pointer to the time structure that is filled in with the
+//! broken down date and time.
+//!
+//! This function is ulocaltime() for a 64-bit signed count of seconds since
+//! midnight GMT on January 1, 1970, so it is not limited to the range of a
+//! 32-bit \b time_t.  Dates before 1970 are in the proleptic Gregorian
+//! calendar.  The day count must fit in 32 bits, which allows about five
+//! million years either side of 1970.
+//!
+//! The date is computed directly from the day count, in constant time.
+//! Times that fit in 32 bits take a path that uses only 32-bit division.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ulocaltime64(int64_t i64Time, struct tm *tm)
+{
+    uint32_t ui32Secs;
+    int64_t i64Days;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(tm);
+
+    //
+    // Split the time into days and seconds into the day, rounding the days
+    // down for negative times.
+    //
+    if((uint64_t)i64Time <= 0xFFFFFFFF)
+    {
+        i64Days = (uint32_t)i64Time / 86400;
+        ui32Secs = (uint32_t)i64Time - ((uint32_t)i64Days * 86400);
+    }
+    else
+    {
+        i64Days = i64Time / 86400;
+        ui32Secs = (uint32_t)(i64Time - (i64Days * 86400));
+        if((int32_t)ui32Secs < 0)
+        {
+            ui32Secs += 86400;
+            i64Days--;
+        }
+    }
+
+    ASSERT((i64Days >= -(INT32_MAX - UDAYS_TO_EPOCH)) &&
+           (i64Days <= (INT32_MAX - UDAYS_TO_EPOCH)));
+
+    //
+    // Extract the hours, minutes, and seconds.
+    //
+    tm->tm_hour = (int)(ui32Secs / 3600);
+    ui32Secs -= (uint32_t)tm->tm_hour * 3600;
+    tm->tm_min = (int)(ui32Secs / 60);
+    tm->tm_sec = (int)(ui32Secs - ((uint32_t)tm->tm_min * 60));
+
+    //
+    // Extract the date.
+    //
+    ucivilfromdays((int32_t)i64Days, tm);
+}
+
+//*****************************************************************************
+//
+//! Converts from seconds to calendar date and time.
+//!
+//! \param timer is the number of seconds.
+//! \param tm is a pointer to the time structure that is filled in with the
+//! broken down date and time.
+//!
+//! This function converts a number of seconds since midnight GMT on January 1,
+//! 1970 (traditional Unix epoch) into the equivalent month, day, year, hours,
+//! minutes, and seconds representation.  The day of the week and the day of
+//! the year are filled in as well.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ulocaltime(time_t timer, struct tm *tm)
+{
+    ulocaltime64((int64_t)timer, tm);
+}
+
+//*****************************************************************************
+//
+//! Advances a calendar date and time by one second.
+//!
+//! \param tm is a pointer to the time structure to advance.
+//!
+//! This function moves the broken down time in \e tm forward by one second,
+//! carrying into the minutes, hours, and the date as needed, without
+//! converting to and from seconds.  It is meant for keeping a calendar that
+//! is stepped by a one second tick, such as the timestamp of a log.  Nearly
+//! every call only touches the seconds.
+//!
+//! The structure must hold a valid time with the day of the week and the day
+//! of the year filled in, as ulocaltime() leaves it.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+utimetick(struct tm *tm)
+{
+    //
+    // Check the arguments.
+    //
+    ASSERT(tm);
+
+    //
+    // Carry through the time of day.
+    //
+    if(++tm->tm_sec < 60)
+    {
+        return;
+    }
+    tm->tm_sec = 0;
+    if(++tm->tm_min < 60)
+    {
+        return;
+    }
+    tm->tm_min = 0;
+    if(++tm->tm_hour < 24)
+    {
+        return;
+    }
+    tm->tm_hour = 0;
+
+    //
+    // It is a new day.
+    //
+    tm->tm_wday = (tm->tm_wday == 6) ? 0 : (tm->tm_wday + 1);
+    tm->tm_yday++;
+    if((tm->tm_mday < g_pui8DaysInMonth[tm->tm_mon]) ||
+       ((tm->tm_mon == 1) && (tm->tm_mday == 28) && uleapyear(tm->tm_year)))
+    {
+        tm->tm_mday++;
+        return;
+    }
+    tm->tm_mday = 1;
+
+    //
+    // It is a new month, and maybe a new year.
+    //
+    if(++tm->tm_mon < 12)
+    {
+        return;
+    }
+    tm->tm_mon = 0;
+    tm->tm_yday = 0;
+    tm->tm_year++;
+}
+
+//*****************************************************************************
+//
+//! Converts calendar date and time to 64-bit seconds.
+//!
+//! \param timeptr is a pointer to the time structure that is filled in with
+//! the broken down date and time.
+//!
+//! This function is umktime() returning a 64-bit signed count of seconds since
+//! midnight GMT on January 1, 1970, so it is not limited to the range of a
+//! 32-bit \b time_t.  Dates before 1970 give negative counts.  The day of the
+//! week and the day of the year in \e timeptr are ignored.
+//!
+//! Fields outside their usual ranges are carried into the next larger field,
+//! as with the C library <tt>mktime()</tt>; for example, a month of 12 is
+//! January of the next year and a day of the month of 0 is the last day of
+//! the month before.
+//!
+//! \return Returns the calendar time and date as seconds.
+//
+//*****************************************************************************
+int64_t
+umktime64(struct tm *timeptr)
+{
+    int32_t i32Year, i32Mon;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(timeptr);
+
+    //
+    // Bring the month into range, carrying whole years.
+    //
+    i32Year = timeptr->tm_year + (timeptr->tm_mon / 12);
+    i32Mon = timeptr->tm_mon % 12;
+    if(i32Mon < 0)
+    {
+        i32Mon += 12;
+        i32Year--;
+    }
+
+    //
+    // The other fields carry on their own once everything is in seconds.
+    //
+    return(((int64_t)udaysfromcivil(i32Year, i32Mon, 1) * 86400) +
+           ((int64_t)(timeptr->tm_mday - 1) * 86400) +
+           ((int64_t)timeptr->tm_hour * 3600) +
+           ((int64_t)timeptr->tm_min * 60) + timeptr->tm_sec);
+}
+
+//*****************************************************************************
+//
+//! Converts calendar date and time to seconds.
+//!
+//! \param timeptr is a pointer to the time structure that is filled in with
+//! the broken down date and time.
+//!
+//! This function converts the date and time represented by the \e timeptr
+//! structure pointer to the number of seconds since midnight GMT on January 1,
+//! 1970 (traditional Unix epoch).  Fields outside their usual ranges are
+//! carried as described for umktime64().
+//!
+//! \return Returns the calendar time and date as seconds.  If the conversion
+//! was not possible, because the time does not fit in a \b time_t, then the
+//! function returns (time_t)(-1).
+//
+//*****************************************************************************
+time_t
+umktime(struct tm *timeptr)
+{
+    int64_t i64Time;
+
+    i64Time = umktime64(timeptr);
+
+    //
+    // Return an error if the time cannot be represented.
+    //
+    if((int64_t)(time_t)i64Time != i64Time)
+    {
+        return((time_t)-1);
+    }
+
+    return((time_t)i64Time);
+}
+
+#ifndef USTDLIB_BYTE_STRINGS
+//*****************************************************************************
+//
+// Converts an aligned word of four decimal digits, the first in the low byte.
+// Returns false if any of the four characters is not a digit.
+//
+// A character is a digit if its high nibble is 3 and adding 6 leaves it at 3.
+// The digits are then combined in pairs, as bytes, and the pairs as halfwords;
+// no lane can carry into the next.
+//
+//*****************************************************************************
+static bool
+uword10(uint32_t ui32Word, uint32_t *pui32Value)
+{
+    if(((ui32Word & 0xF0F0F0F0) |
+        (((ui32Word + 0x06060606) & 0xF0F0F0F0) >> 4)) != 0x33333333)
+    {
+        return(false);
+    }
+
+    ui32Word &= 0x0F0F0F0F;
+    ui32Word = ((ui32Word * 10) + (ui32Word >> 8)) & 0x00FF00FF;
+    *pui32Value = ((ui32Word * 100) + (ui32Word >> 16)) & 0x0000FFFF;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Converts an aligned word of four hexadecimal digits, either case, the first
+// in the low byte.  Returns false if any of the four characters is not a hex
+// digit.
+//
+// For characters below 0x80, adding 0x80 - lo sets bit 7 of a byte when it
+// is at least lo, and adding 0x7F - hi sets it when it is above hi, so each
+// range test is two adds.  Letters are tested with case folded.
+//
+//*****************************************************************************
+static bool
+uword16(uint32_t ui32Word, uint32_t *pui32Value)
+{
+    uint32_t ui32Digit, ui32Alpha;
+
+    if(ui32Word & 0x80808080)
+    {
+        return(false);
+    }
+
+    ui32Digit = (ui32Word + 0x50505050) & ~(ui32Word + 0x46464646);
+    ui32Alpha = ((ui32Word | 0x20202020) + 0x1F1F1F1F) &
+                ~((ui32Word | 0x20202020) + 0x19191919);
+    if(((ui32Digit | ui32Alpha) & 0x80808080) != 0x80808080)
+    {
+        return(false);
+    }
+
+    ui32Word = (ui32Word & 0x0F0F0F0F) + (((ui32Alpha >> 7) & 0x01010101) * 9);
+    ui32Word = ((ui32Word << 4) + (ui32Word >> 8)) & 0x00FF00FF;
+    *pui32Value = ((ui32Word << 8) + (ui32Word >> 16)) & 0x0000FFFF;
+
+    return(true);
+}
+#endif
+
+//*****************************************************************************
+//
+//! Converts a string into its numeric equivalent.
+//!
+//! \param nptr is a pointer to the string containing the integer.
+//! \param endptr is a pointer that will be set to the first character past
+//! the integer in the string.
+//! \param base is the radix to use for the conversion; can be zero to
+//! auto-select the radix or between 2 and 16 to explicitly specify the radix.
+//!
+//! This function is very similar to the C library <tt>strtoul()</tt> function.
+//! It scans a string for the first token (that is, non-white space) and
+//! converts the value at that location in the string into an integer value.
+//!
+//! Decimal and hexadecimal digits are converted eight at a time where the
+//! string is word aligned, and a character at a time elsewhere.  Only aligned
+//! words are read, and a word is only read once the one before it was all
+//! digits, so nothing past the end of the string is touched beyond the word
+//! that holds its end.
+//!
+//! \return Returns the result of the conversion.  If the value does not fit
+//! in an <tt>unsigned long</tt>, all of its digits are still consumed and
+//! the function returns \b ULONG_MAX.
+//
+//*****************************************************************************
+unsigned long
+ustrtoul(const char * restrict nptr, const char ** restrict endptr, int base)
+{
+    unsigned long ulRet, ulDigit, ulNeg, ulValid, ulMax, ulLim;
+    const char *pcPtr;
+    bool bOverflow;
+#ifndef USTDLIB_BYTE_STRINGS
+    uint32_t ui32Hi, ui32Lo;
+#endif
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(nptr);
+    ASSERT((base == 0) || ((base > 1) && (base <= 16)));
+
+    //
+    // Initially, the result is zero.
+    //
+    ulRet = 0;
+    ulNeg = 0;
+    ulValid = 0;
+    bOverflow = false;
+
+    //
+    // Skip past any leading white space.
+    //
+    pcPtr = nptr;
+    while((*pcPtr == ' ') || (*pcPtr == '\t'))
+    {
+        pcPtr++;
+    }
+
+    //
+    // Take a leading + or - from the value.
+    //
+    if(*pcPtr == '-')
+    {
+        ulNeg = 1;
+        pcPtr++;
+    }
+    else if(*pcPtr == '+')
+    {
+        pcPtr++;
+    }
 
-                    //
-                    // Update the conversion count.
-                    //
-                    iConvertCount++;
+    //
+    // See if the radix was not specified, or is 16, and the value starts with
+    // "0x" or "0X" (to indicate a hex value).
+    //
+    if(((base == 0) || (base == 16)) && (*pcPtr == '0') &&
+       ((pcPtr[1] == 'x') || (pcPtr[1] == 'X')))
+    {
+        //
+        // Skip the leading "0x".
+        //
+        pcPtr += 2;
+
+        //
+        // Set the radix to 16.
+        //
+        base = 16;
+    }
+
+    //
+    // See if the radix was not specified.
+    //
+    if(base == 0)
+    {
+        //
+        // See if the value starts with "0".
+        //
+        if(*pcPtr == '0')
+        {
+            //
+            // Values that start with "0" are assumed to be radix 8.
+            //
+            base = 8;
+        }
+        else
+        {
+            //
+            // Otherwise, the values are assumed to be radix 10.
+            //
+            base = 10;
+        }
+    }
+
+    //
+    // A digit can be added to values up to ulMax, and to ulMax itself if the
+    // digit is no more than ulLim.
+    //
+    ulMax = ULONG_MAX / (unsigned long)base;
+    ulLim = ULONG_MAX % (unsigned long)base;
+
+    //
+    // Loop while there are more valid digits to consume.
+    //
+    while(1)
+    {
+#ifndef USTDLIB_BYTE_STRINGS
+        //
+        // At a word boundary in a decimal value, take eight digits at a time
+        // while they can't overflow the result, then four.
+        //
+        if((base == 10) && UALIGNED(pcPtr))
+        {
+            while((ulRet <= ((ULONG_MAX - 9999) / 10000)) &&
+                  uword10(*(const tUWord *)pcPtr, &ui32Hi))
+            {
+                if((ulRet <= ((ULONG_MAX - 99999999) / 100000000)) &&
+                   uword10(*(const tUWord *)(pcPtr + 4), &ui32Lo))
+                {
+                    ulRet = (ulRet * 100000000) + (ui32Hi * 10000) + ui32Lo;
+                    pcPtr += 8;
+                }
+                else
+                {
+                    ulRet = (ulRet * 10000) + ui32Hi;
+                    pcPtr += 4;
+                }
+                ulValid = 1;
+            }
+        }
+
+        //
+        // Likewise for a hexadecimal value.
+        //
+        else if((base == 16) && UALIGNED(pcPtr))
+        {
+            while((ulRet <= (ULONG_MAX >> 16)) &&
+                  uword16(*(const tUWord *)pcPtr, &ui32Hi))
+            {
+                if((ulRet <= ((ULONG_MAX >> 16) >> 16)) &&
+                   uword16(*(const tUWord *)(pcPtr + 4), &ui32Lo))
+                {
+                    ulRet = (((ulRet << 16) << 16) + (ui32Hi << 16) + ui32Lo);
+                    pcPtr += 8;
+                }
+                else
+                {
+                    ulRet = (ulRet << 16) + ui32Hi;
+                    pcPtr += 4;
+                }
+                ulValid = 1;
+            }
+        }
+#endif
+
+        //
+        // See if this character is a number.
+        //
+        if((*pcPtr >= '0') && (*pcPtr <= '9'))
+        {
+            //
+            // Convert the character to its integer equivalent.
+            //
+            ulDigit = *pcPtr - '0';
+        }
+
+        //
+        // Otherwise, see if this character is an upper case letter.
+        //
+        else if((*pcPtr >= 'A') && (*pcPtr <= 'Z'))
+        {
+            //
+            // Convert the character to its integer equivalent.
+            //
+            ulDigit = *pcPtr - 'A' + 10;
+        }
+
+        //
+        // Otherwise, see if this character is a lower case letter.
+        //
+        else if((*pcPtr >= 'a') && (*pcPtr <= 'z'))
+        {
+            //
+            // Convert the character to its integer equivalent.
+            //
+            ulDigit = *pcPtr - 'a' + 10;
+        }
+
+        //
+        // Otherwise, this is not a valid character.
+        //
+        else
+        {
+            //
+            // Stop converting this value.
+            //
+            break;
+        }
+
+        //
+        // See if this digit is valid for the chosen radix.
+        //
+        if(ulDigit >= (unsigned long)base)
+        {
+            //
+            // Stop converting this value.
+            //
+            break;
+        }
+
+        //
+        // Add this digit to the converted value, unless that would overflow.
+        // The remaining digits are still consumed.
+        //
+        if((ulRet < ulMax) || ((ulRet == ulMax) && (ulDigit <= ulLim)))
+        {
+            ulRet *= base;
+            ulRet += ulDigit;
+        }
+        else
+        {
+            bOverflow = true;
+        }
+        pcPtr++;
+
+        //
+        // Since a digit has been added, this is now a valid result.
+        //
+        ulValid = 1;
+    }
+
+    //
+    // Set the return string pointer to the first character not consumed.
+    //
+    if(endptr)
+    {
+        *endptr = ulValid ? pcPtr : nptr;
+    }
+
+    //
+    // Return the converted value.
+    //
+    if(bOverflow)
+    {
+        return(ULONG_MAX);
+    }
+    return(ulNeg ? (0 - ulRet) : ulRet);
+}
+
+//*****************************************************************************
+//
+// The powers of ten that are exact in a float, for the ustrtof() fast path.
+//
+//*****************************************************************************
+static const float g_pfPow10[11] =
+{
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+//*****************************************************************************
+//
+// Ten to the power r, for r from 0 to 27, and ten to the power 28q, for q
+// from -13 to 11, as 64-bit mantissas with the top bit set and binary
+// exponents, so 10^r is g_pui64Pow10Small[r] * 2^g_pi16Pow10SmallExp[r].
+// The small powers are exact; the large ones are rounded down.  Together
+// they give any power of ten from 10^-364 to 10^335 with two lookups.
+//
+//*****************************************************************************
+static const uint64_t g_pui64Pow10Small[28] =
+{
+    0x8000000000000000ULL,
+    0xA000000000000000ULL,
+    0xC800000000000000ULL,
+    0xFA00000000000000ULL,
+    0x9C40000000000000ULL,
+    0xC350000000000000ULL,
+    0xF424000000000000ULL,
+    0x9896800000000000ULL,
+    0xBEBC200000000000ULL,
+    0xEE6B280000000000ULL,
+    0x9502F90000000000ULL,
+    0xBA43B74000000000ULL,
+    0xE8D4A51000000000ULL,
+    0x9184E72A00000000ULL,
+    0xB5E620F480000000ULL,
+    0xE35FA931A0000000ULL,
+    0x8E1BC9BF04000000ULL,
+    0xB1A2BC2EC5000000ULL,
+    0xDE0B6B3A76400000ULL,
+    0x8AC7230489E80000ULL,
+    0xAD78EBC5AC620000ULL,
+    0xD8D726B7177A8000ULL,
+    0x878678326EAC9000ULL,
+    0xA968163F0A57B400ULL,
+    0xD3C21BCECCEDA100ULL,
+    0x84595161401484A0ULL,
+    0xA56FA5B99019A5C8ULL,
+    0xCECB8F27F4200F3AULL
+};
+
+static const int16_t g_pi16Pow10SmallExp[28] =
+{
+    -63, -60, -57, -54, -50, -47, -44, -40, -37, -34,
+    -30, -27, -24, -20, -17, -14, -10, -7, -4, 0,
+    3, 6, 10, 13, 16, 20, 23, 26
+};
+
+static const uint64_t g_pui64Pow10Big[25] =
+{
+    0xE1AFA13AFBD14D6DULL,
+    0xE3E27A444D8D98B7ULL,
+    0xE61ACF033D1A45DFULL,
+    0xE858AD248F5C22C9ULL,
+    0xEA9C227723EE8BCBULL,
+    0xECE53CEC4A314EBDULL,
+    0xEF340A98172AACE4ULL,
+    0xF18899B1BC3F8CA1ULL,
+    0xF3E2F893DEC3F126ULL,
+    0xF64335BCF065D37DULL,
+    0xF8A95FCF88747D94ULL,
+    0xFB158592BE068D2EULL,
+    0xFD87B5F28300CA0DULL,
+    0x8000000000000000ULL,
+    0x813F3978F8940984ULL,
+    0x82818F1281ED449FULL,
+    0x83C7088E1AAB65DBULL,
+    0x850FADC09923329EULL,
+    0x865B86925B9BC5C2ULL,
+    0x87AA9AFF79042286ULL,
+    0x88FCF317F22241E2ULL,
+    0x8A5296FFE33CC92FULL,
+    0x8BAB8EEFB6409C1AULL,
+    0x8D07E33455637EB2ULL,
+    0x8E679C2F5E44FF8FULL
+};
+
+static const int16_t g_pi16Pow10BigExp[25] =
+{
+    -1273, -1180, -1087, -994, -901, -808, -715, -622, -529, -436,
+    -343, -250, -157, -63, 30, 123, 216, 309, 402, 495,
+    588, 681, 774, 867, 960
+};
+
+//*****************************************************************************
+//
+// The number of 32-bit words in the big number used to settle close
+// conversions.  It holds a fraction of up to 1075 bits, the bits below the
+// smallest double, times ten.
+//
+//*****************************************************************************
+#define UBIG_WORDS              36
+
+//*****************************************************************************
+//
+// A decimal number as read by uparsedec().
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The first 19 significant digits and the power of ten that scales them,
+    // so the value is about ui64Mant * 10^i32Exp.
+    //
+    uint64_t ui64Mant;
+    int32_t i32Exp;
+
+    //
+    // Set if nonzero digits past the 19th were dropped from ui64Mant.
+    //
+    bool bTrunc;
+
+    //
+    // The significant digits as written, from the first nonzero one to the
+    // end of the mantissa, and the position of the decimal point, so the
+    // value is exactly 0.d1d2d3... * 10^i32Point.
+    //
+    const char *pcFirst;
+    const char *pcEnd;
+    int32_t i32Point;
+
+    //
+    // Set for "inf" or "infinity", and for "nan", ignoring case.
+    //
+    bool bInf;
+    bool bNaN;
+
+    //
+    // Set for a leading minus sign.
+    //
+    bool bNeg;
+}
+tUDecimal;
+
+//*****************************************************************************
+//
+// Compares the next characters of pcStr with the lower case word pcWord,
+// ignoring case, and returns the number matched if all of them were or 0 if
+// not.
+//
+//*****************************************************************************
+static uint32_t
+umatchword(const char *pcStr, const char *pcWord)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; pcWord[ui32Idx]; ui32Idx++)
+    {
+        if((pcStr[ui32Idx] | 0x20) != pcWord[ui32Idx])
+        {
+            return(0);
+        }
+    }
+
+    return(ui32Idx);
+}
+
+//*****************************************************************************
+//
+// Reads a decimal floating-point number: white space, an optional sign, then
+// digits with an optional decimal point and an optional exponent, or "inf",
+// "infinity" or "nan".  The digits are taken as integers so nothing is
+// rounded yet.
+//
+// Returns a pointer past the number, or nptr if there was none.
+//
+//*****************************************************************************
+static const char *
+uparsedec(const char *nptr, tUDecimal *psDec)
+{
+    const char *pcPtr;
+    uint32_t ui32Sig, ui32Len;
+    int32_t i32Exp;
+    bool bValid, bPoint, bExpNeg;
+
+    psDec->ui64Mant = 0;
+    psDec->i32Exp = 0;
+    psDec->bTrunc = false;
+    psDec->pcFirst = 0;
+    psDec->bInf = false;
+    psDec->bNaN = false;
+    psDec->bNeg = false;
+
+    //
+    // Skip past any leading white space.
+    //
+    pcPtr = nptr;
+    while((*pcPtr == ' ') || (*pcPtr == '\t'))
+    {
+        pcPtr++;
+    }
+
+    //
+    // Take a leading + or - from the value.
+    //
+    if(*pcPtr == '-')
+    {
+        psDec->bNeg = true;
+        pcPtr++;
+    }
+    else if(*pcPtr == '+')
+    {
+        pcPtr++;
+    }
 
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
+    //
+    // Infinity and not-a-number, as printed by ufmtfloat().
+    //
+    if((ui32Len = umatchword(pcPtr, "inf")) != 0)
+    {
+        psDec->bInf = true;
+        ui32Len = umatchword(pcPtr, "infinity") ? 8 : ui32Len;
+        return(pcPtr + ui32Len);
+    }
+    if((ui32Len = umatchword(pcPtr, "nan")) != 0)
+    {
+        psDec->bNaN = true;
+        return(pcPtr + ui32Len);
+    }
 
-                //
-                // Handle all other commands.
-                //
-                default:
-                {
-                    //
-                    // Indicate an error.
-                    //
-                    if(n >= 5)
-                    {
-                        ustrncpy(s, "ERROR", 5);
-                        s += 5;
-                        n -= 5;
-                    }
-                    else
-                    {
-                        ustrncpy(s, "ERROR", n);
-                        s += n;
-                        n = 0;
-                    }
+    //
+    // Take the digits, with at most one decimal point among them.  Leading
+    // zeros only move the decimal point.  The first 19 significant digits
+    // go into the mantissa, the rest only need to be counted.
+    //
+    ui32Sig = 0;
+    bValid = false;
+    bPoint = false;
+    for(;; pcPtr++)
+    {
+        if((*pcPtr == '.') && !bPoint)
+        {
+            bPoint = true;
+            continue;
+        }
+        if((*pcPtr < '0') || (*pcPtr > '9'))
+        {
+            break;
+        }
 
-                    //
-                    // Update the conversion count.
-                    //
-                    iConvertCount += 5;
+        bValid = true;
 
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
+        if(!psDec->pcFirst && (*pcPtr == '0'))
+        {
+            if(bPoint)
+            {
+                psDec->i32Exp--;
+            }
+            continue;
+        }
+        if(!psDec->pcFirst)
+        {
+            psDec->pcFirst = pcPtr;
+        }
+
+        if(ui32Sig < 19)
+        {
+            psDec->ui64Mant = (psDec->ui64Mant * 10) + (*pcPtr - '0');
+            ui32Sig++;
+            if(bPoint)
+            {
+                psDec->i32Exp--;
+            }
+        }
+        else
+        {
+            if(*pcPtr != '0')
+            {
+                psDec->bTrunc = true;
+            }
+            if(!bPoint)
+            {
+                psDec->i32Exp++;
             }
         }
     }
 
     //
-    // Null terminate the string in the buffer.
+    // A lone decimal point is not a number.
     //
-    *s = 0;
+    if(!bValid)
+    {
+        return(nptr);
+    }
+    psDec->pcEnd = pcPtr;
 
     //
-    // Return the number of characters in the full converted string.
+    // See if the next character is an "e" followed by a valid exponent.
+    // Exponents too large to matter are clamped.
     //
-    return(iConvertCount);
+    if(((pcPtr[0] == 'e') || (pcPtr[0] == 'E')) &&
+       (((pcPtr[1] >= '0') && (pcPtr[1] <= '9')) ||
+        (((pcPtr[1] == '+') || (pcPtr[1] == '-')) &&
+         (pcPtr[2] >= '0') && (pcPtr[2] <= '9'))))
+    {
+        pcPtr++;
+        bExpNeg = (*pcPtr == '-');
+        if((*pcPtr == '+') || (*pcPtr == '-'))
+        {
+            pcPtr++;
+        }
+
+        for(i32Exp = 0; (*pcPtr >= '0') && (*pcPtr <= '9'); pcPtr++)
+        {
+            if(i32Exp < 100000)
+            {
+                i32Exp = (i32Exp * 10) + (*pcPtr - '0');
+            }
+        }
+
+        psDec->i32Exp += bExpNeg ? -i32Exp : i32Exp;
+    }
+
+    psDec->i32Point = psDec->i32Exp + (int32_t)ui32Sig;
+
+    return(pcPtr);
 }
 
 //*****************************************************************************
 //
-//! A simple sprintf function supporting \%c, \%d, \%p, \%s, \%u, \%x, and \%X.
-//!
-//! \param s is the buffer where the converted string is stored.
-//! \param format is the format string.
-//! \param ... are the optional arguments, which depend on the contents of the
-//! format string.
-//!
-//! This function is very similar to the C library <tt>sprintf()</tt> function.
-//! Only the following formatting characters are supported:
-//!
-//! - \%c to print a character
-//! - \%d or \%i to print a decimal value
-//! - \%s to print a string
-//! - \%u to print an unsigned decimal value
-//! - \%x to print a hexadecimal value using lower case letters
-//! - \%X to print a hexadecimal value using lower case letters (not upper case
-//! letters as would typically be used)
-//! - \%p to print a pointer as a hexadecimal value
-//! - \%\% to print out a \% character
-//!
-//! For \%d, \%i, \%p, \%s, \%u, \%x, and \%X, an optional number may reside
-//! between the \% and the format character, which specifies the minimum number
-//! of characters to use for that value; if preceded by a 0 then the extra
-//! characters will be filled with zeros instead of spaces.  For example,
-//! ``\%8d'' will use eight characters to print the decimal value with spaces
-//! added to reach eight; ``\%08d'' will use eight characters as well but will
-//! add zeros instead of spaces.
-//!
-//! The type of the arguments after \e format must match the requirements of
-//! the format string.  For example, if an integer was passed where a string
-//! was expected, an error of some kind will most likely occur.
-//!
-//! The caller must ensure that the buffer \e s is large enough to hold the
-//! entire converted string, including the null termination character.
-//!
-//! \return Returns the count of characters that were written to the output
-//! buffer, not including the NULL termination character.
+// Returns the next significant digit of psDec from *ppcPtr, or 0 once they
+// have all been read.
 //
 //*****************************************************************************
-int
-usprintf(char * restrict s, const char *format, ...)
+static uint32_t
+unextdigit(const tUDecimal *psDec, const char **ppcPtr)
 {
-    va_list arg;
-    int ret;
-
-    //
-    // Start the varargs processing.
-    //
-    va_start(arg, format);
+    if(**ppcPtr == '.')
+    {
+        (*ppcPtr)++;
+    }
+    if(*ppcPtr >= psDec->pcEnd)
+    {
+        return(0);
+    }
 
-    //
-    // Call vsnprintf to perform the conversion.  Use a large number for the
-    // buffer size.
-    //
-    ret = uvsnprintf(s, 0xffff, format, arg);
+    return(*(*ppcPtr)++ - '0');
+}
 
-    //
-    // End the varargs processing.
-    //
-    va_end(arg);
+//*****************************************************************************
+//
+// Returns true if psDec has any nonzero digit at or after pcPtr.
+//
+//*****************************************************************************
+static bool
+umoredigits(const tUDecimal *psDec, const char *pcPtr)
+{
+    for(; pcPtr < psDec->pcEnd; pcPtr++)
+    {
+        if((*pcPtr >= '1') && (*pcPtr <= '9'))
+        {
+            return(true);
+        }
+    }
 
-    //
-    // Return the conversion count.
-    //
-    return(ret);
+    return(false);
 }
 
 //*****************************************************************************
 //
-//! A simple snprintf function supporting \%c, \%d, \%p, \%s, \%u, \%x, and
-//! \%X.
-//!
-//! \param s is the buffer where the converted string is stored.
-//! \param n is the size of the buffer.
-//! \param format is the format string.
-//! \param ... are the optional arguments, which depend on the contents of the
-//! format string.
-//!
-//! This function is very similar to the C library <tt>sprintf()</tt> function.
-//! Only the following formatting characters are supported:
-//!
-//! - \%c to print a character
-//! - \%d or \%i to print a decimal value
-//! - \%s to print a string
-//! - \%u to print an unsigned decimal value
-//! - \%x to print a hexadecimal value using lower case letters
-//! - \%X to print a hexadecimal value using lower case letters (not upper case
-//! letters as would typically be used)
-//! - \%p to print a pointer as a hexadecimal value
-//! - \%\% to print out a \% character
-//!
-//! For \%d, \%i, \%p, \%s, \%u, \%x, and \%X, an optional number may reside
-//! between the \% and the format character, which specifies the minimum number
-//! of characters to use for that value; if preceded by a 0 then the extra
-//! characters will be filled with zeros instead of spaces.  For example,
-//! ``\%8d'' will use eight characters to print the decimal value with spaces
-//! added to reach eight; ``\%08d'' will use eight characters as well but will
-//! add zeros instead of spaces.
-//!
-//! The type of the arguments after \e format must match the requirements of
-//! the format string.  For example, if an integer was passed where a string
-//! was expected, an error of some kind will most likely occur.
-//!
-//! The function will copy at most \e n - 1 characters into the buffer
-//! \e s.  One space is reserved in the buffer for the null termination
-//! character.
-//!
-//! The function will return the number of characters that would be converted
-//! as if there were no limit on the buffer size.  Therefore it is possible for
-//! the function to return a count that is greater than the specified buffer
-//! size.  If this happens, it means that the output was truncated.
-//!
-//! \return Returns the number of characters that were to be stored, not
-//! including the NULL termination character, regardless of space in the
-//! buffer.
+// Compares the decimal number in psDec with ui64Mid * 2^i32Exp2 exactly,
+// reading the digits as written.  The binary value is turned into decimal
+// digits one at a time, its integer part in a 64-bit integer or a big
+// number and its fraction in a big number.
+//
+// Returns 1, 0, or -1 as the decimal number is greater, equal, or less.
 //
 //*****************************************************************************
-int
-usnprintf(char * restrict s, size_t n, const char * restrict format, ...)
+static int32_t
+udeccmp(const tUDecimal *psDec, uint64_t ui64Mid, int32_t i32Exp2)
 {
-    va_list arg;
-    int ret;
+    uint32_t pui32Big[UBIG_WORDS];
+    uint32_t ui32Words, ui32Idx, ui32Digit, ui32Mid[3], ui32Hi, ui32Shift;
+    uint64_t ui64Acc, ui64Int;
+    const char *pcPtr;
+    int32_t i32Count;
+    bool bZero;
+
+    pcPtr = psDec->pcFirst;
+    i32Count = psDec->i32Point;
+
+    if(i32Exp2 >= 0)
+    {
+        //
+        // The binary value is an integer of at least one, which a decimal
+        // below one can't reach.
+        //
+        if(i32Count <= 0)
+        {
+            return(-1);
+        }
+
+        //
+        // Build the integer part of the decimal number.  It can't be more
+        // than a few digits longer than the largest double, or the value
+        // would have been taken as infinite.
+        //
+        ui32Words = 1;
+        pui32Big[0] = 0;
+        for(; i32Count > 0; i32Count--)
+        {
+            ui64Acc = unextdigit(psDec, &pcPtr);
+            for(ui32Idx = 0; ui32Idx < ui32Words; ui32Idx++)
+            {
+                ui64Acc += (uint64_t)pui32Big[ui32Idx] * 10;
+                pui32Big[ui32Idx] = (uint32_t)ui64Acc;
+                ui64Acc >>= 32;
+            }
+            if(ui64Acc && (ui32Words < UBIG_WORDS))
+            {
+                pui32Big[ui32Words++] = (uint32_t)ui64Acc;
+            }
+        }
+
+        //
+        // Split ui64Mid shifted left by i32Exp2 into three words starting at
+        // word i32Exp2 / 32, then compare from the top word down.
+        //
+        ui32Shift = i32Exp2 & 31;
+        ui32Mid[0] = (uint32_t)(ui64Mid << ui32Shift);
+        ui32Mid[1] = (uint32_t)((ui64Mid << ui32Shift) >> 32);
+        ui32Mid[2] = ui32Shift ? (uint32_t)(ui64Mid >> (64 - ui32Shift)) : 0;
+        ui32Shift = (uint32_t)i32Exp2 / 32;
+
+        for(ui32Idx = ((ui32Shift + 3) > ui32Words) ? (ui32Shift + 3) :
+                                                      ui32Words;
+            ui32Idx-- > 0; )
+        {
+            ui32Hi = ((ui32Idx >= ui32Shift) && (ui32Idx < (ui32Shift + 3))) ?
+                     ui32Mid[ui32Idx - ui32Shift] : 0;
+            ui32Digit = (ui32Idx < ui32Words) ? pui32Big[ui32Idx] : 0;
+            if(ui32Digit != ui32Hi)
+            {
+                return((ui32Digit > ui32Hi) ? 1 : -1);
+            }
+        }
+
+        //
+        // The integer parts match, any fraction makes the decimal greater.
+        //
+        return(umoredigits(psDec, pcPtr) ? 1 : 0);
+    }
 
     //
-    // Start the varargs processing.
+    // The binary value has a fraction of ui32Shift bits.  Compare the
+    // integer parts first.
     //
-    va_start(arg, format);
+    ui32Shift = (uint32_t)-i32Exp2;
+    ui64Int = (ui32Shift < 64) ? (ui64Mid >> ui32Shift) : 0;
+
+    if(i32Count > 0)
+    {
+        for(ui64Acc = 0; i32Count > 0; i32Count--)
+        {
+            ui64Acc = (ui64Acc * 10) + unextdigit(psDec, &pcPtr);
+            if(ui64Acc > ui64Int)
+            {
+                return(1);
+            }
+        }
+        if(ui64Acc < ui64Int)
+        {
+            return(-1);
+        }
+    }
+
+    //
+    // Put the fraction in the big number, then produce its decimal digits
+    // by multiplying by ten and taking the bits above the fraction.  A
+    // decimal below 0.1 starts with zeros.
+    //
+    ui32Words = (ui32Shift / 32) + 2;
+    for(ui32Idx = 0; ui32Idx < ui32Words; ui32Idx++)
+    {
+        pui32Big[ui32Idx] = 0;
+    }
+    ui64Acc = (ui32Shift < 64) ?
+              (ui64Mid & (((uint64_t)1 << ui32Shift) - 1)) : ui64Mid;
+    pui32Big[0] = (uint32_t)ui64Acc;
+    pui32Big[1] = (uint32_t)(ui64Acc >> 32);
+
+    while(1)
+    {
+        //
+        // Multiply the fraction by ten and take the next digit off the top.
+        //
+        ui64Acc = 0;
+        bZero = true;
+        for(ui32Idx = 0; ui32Idx < ui32Words; ui32Idx++)
+        {
+            ui64Acc += (uint64_t)pui32Big[ui32Idx] * 10;
+            pui32Big[ui32Idx] = (uint32_t)ui64Acc;
+            ui64Acc >>= 32;
+        }
+        ui32Idx = ui32Shift / 32;
+        ui32Hi = pui32Big[ui32Idx] >> (ui32Shift & 31);
+        if((ui32Shift & 31) && ((ui32Idx + 1) < ui32Words))
+        {
+            ui32Hi |= pui32Big[ui32Idx + 1] << (32 - (ui32Shift & 31));
+        }
+        pui32Big[ui32Idx] &= ((uint32_t)1 << (ui32Shift & 31)) - 1;
+        for(ui32Idx++; ui32Idx < ui32Words; ui32Idx++)
+        {
+            pui32Big[ui32Idx] = 0;
+        }
+        for(ui32Idx = 0; ui32Idx <= (ui32Shift / 32); ui32Idx++)
+        {
+            if(pui32Big[ui32Idx])
+            {
+                bZero = false;
+            }
+        }
 
-    //
-    // Call vsnprintf to perform the conversion.
-    //
-    ret = uvsnprintf(s, n, format, arg);
+        //
+        // Compare with the next decimal digit.
+        //
+        if(i32Count < 0)
+        {
+            ui32Digit = 0;
+            i32Count++;
+        }
+        else
+        {
+            if((pcPtr >= psDec->pcEnd) ||
+               ((*pcPtr == '.') && ((pcPtr + 1) >= psDec->pcEnd)))
+            {
+                //
+                // The decimal ran out first, so it is less unless the
+                // binary value has no more digits either.
+                //
+                return((ui32Hi || !bZero) ? -1 : 0);
+            }
+            ui32Digit = unextdigit(psDec, &pcPtr);
+        }
 
-    //
-    // End the varargs processing.
-    //
-    va_end(arg);
+        if(ui32Digit != ui32Hi)
+        {
+            return((ui32Digit > ui32Hi) ? 1 : -1);
+        }
 
-    //
-    // Return the conversion count.
-    //
-    return(ret);
+        //
+        // The binary value ran out, so the decimal is greater if it has any
+        // more digits.
+        //
+        if(bZero)
+        {
+            return(umoredigits(psDec, pcPtr) ? 1 : 0);
+        }
+    }
 }
 
 //*****************************************************************************
 //
-// This array contains the number of days in a year at the beginning of each
-// month of the year, in a non-leap year.
+// Returns the high 64 bits of the 128-bit product of two 64-bit values.
 //
 //*****************************************************************************
-static const time_t g_psDaysToMonth[12] =
+static uint64_t
+umulhi64(uint64_t ui64A, uint64_t ui64B)
 {
-    0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
-};
+    uint64_t ui64LL, ui64LH, ui64HL, ui64HH, ui64Mid;
+
+    ui64LL = (uint64_t)(uint32_t)ui64A * (uint32_t)ui64B;
+    ui64LH = (uint64_t)(uint32_t)ui64A * (uint32_t)(ui64B >> 32);
+    ui64HL = (uint64_t)(uint32_t)(ui64A >> 32) * (uint32_t)ui64B;
+    ui64HH = (uint64_t)(uint32_t)(ui64A >> 32) * (uint32_t)(ui64B >> 32);
+
+    ui64Mid = (ui64LL >> 32) + (uint32_t)ui64LH + (uint32_t)ui64HL;
+
+    return(ui64HH + (ui64LH >> 32) + (ui64HL >> 32) + (ui64Mid >> 32));
+}
 
 //*****************************************************************************
 //
-//! Converts from seconds to calendar date and time.
-//!
-//! \param timer is the number of seconds.
-//! \param tm is a pointer to the time structure that is filled in with the
-//! broken down date and time.
-//!
-//! This function converts a number of seconds since midnight GMT on January 1,
-//! 1970 (traditional Unix epoch) into the equivalent month, day, year, hours,
-//! minutes, and seconds representation.
-//!
-//! \return None.
+// Multiplies a 64-bit mantissa with the top bit set by ten to the power
+// i32Exp10, from -364 to 335, leaving the top bit set, and adds the binary
+// exponent of the product to *pi32Exp2.
+//
+// The result is never above the true product and is less than 8 units
+// below it.
 //
 //*****************************************************************************
-void
-ulocaltime(time_t timer, struct tm *tm)
+static uint64_t
+umulpow10(uint64_t ui64Mant, int32_t i32Exp10, int32_t *pi32Exp2)
 {
-    time_t temp, months;
-
-    //
-    // Extract the number of seconds, converting time to the number of minutes.
-    //
-    temp = timer / 60;
-    tm->tm_sec = timer - (temp * 60);
-    timer = temp;
-
-    //
-    // Extract the number of minutes, converting time to the number of hours.
-    //
-    temp = timer / 60;
-    tm->tm_min = timer - (temp * 60);
-    timer = temp;
+    uint64_t ui64Pow;
+    int32_t i32Big, i32Small;
 
     //
-    // Extract the number of hours, converting time to the number of days.
+    // Split the power into 28q + r and put the two parts together.
     //
-    temp = timer / 24;
-    tm->tm_hour = timer - (temp * 24);
-    timer = temp;
+    i32Big = (i32Exp10 + (13 * 28)) / 28;
+    i32Small = i32Exp10 + (13 * 28) - (i32Big * 28);
 
-    //
-    // Compute the day of the week.
-    //
-    tm->tm_wday = (timer + 4) % 7;
+    ui64Pow = g_pui64Pow10Small[i32Small];
+    *pi32Exp2 += g_pi16Pow10SmallExp[i32Small];
 
-    //
-    // Compute the number of leap years that have occurred since 1968, the
-    // first leap year before 1970.  For the beginning of a leap year, cut the
-    // month loop below at March so that the leap day is classified as February
-    // 29 followed by March 1, instead of March 1 followed by another March 1.
-    //
-    timer += 366 + 365;
-    temp = timer / ((4 * 365) + 1);
-    if((timer - (temp * ((4 * 365) + 1))) > (31 + 28))
-    {
-        temp++;
-        months = 12;
-    }
-    else
+    if(i32Big != 13)
     {
-        months = 2;
+        ui64Pow = umulhi64(ui64Pow, g_pui64Pow10Big[i32Big]);
+        *pi32Exp2 += g_pi16Pow10BigExp[i32Big] + 64;
+        if(!(ui64Pow >> 63))
+        {
+            ui64Pow <<= 1;
+            (*pi32Exp2)--;
+        }
     }
 
     //
-    // Extract the year.
-    //
-    tm->tm_year = ((timer - temp) / 365) + 68;
-    timer -= ((tm->tm_year - 68) * 365) + temp;
-
-    //
-    // Extract the month.
+    // Then the mantissa.
     //
-    for(temp = 0; temp < months; temp++)
+    ui64Mant = umulhi64(ui64Mant, ui64Pow);
+    *pi32Exp2 += 64;
+    if(!(ui64Mant >> 63))
     {
-        if(g_psDaysToMonth[temp] > timer)
-        {
-            break;
-        }
+        ui64Mant <<= 1;
+        (*pi32Exp2)--;
     }
-    tm->tm_mon = temp - 1;
 
-    //
-    // Extract the day of the month.
-    //
-    tm->tm_mday = timer - g_psDaysToMonth[temp - 1] + 1;
+    return(ui64Mant);
 }
 
 //*****************************************************************************
 //
-//! Compares two time structures and determines if one is greater than,
-//! less than, or equal to the other.
-//!
-//! \param t1 is the first time structure to compare.
-//! \param t2 is the second time structure to compare.
-//!
-//! This function compares two time structures and returns a signed number
-//! to indicate the result of the comparison.  If the time represented by
-//! \e t1 is greater than the time represented by \e t2 then a positive
-//! number is returned.  Likewise if \e t1 is less than \e t2 then a
-//! negative number is returned.  If the two times are equal then the function
-//! returns 0.
-//!
-//! \return Returns 0 if the two times are equal, +1 if \e t1 is greater
-//! than \e t2, and -1 if \e t1 is less than \e t2.
+// Converts a decimal number to the bits of a binary floating-point number
+// with ui32Bits bits of mantissa, counting the hidden one, whose values are
+// m * 2^k with k from i32KMin to i32KMax.  The sign is left to the caller.
+//
+// The value is worked out to 64 bits from the first 19 digits.  That is
+// enough to round correctly unless it lies very close to half way between
+// two results, which is settled exactly by udeccmp().
 //
 //*****************************************************************************
-static int
-ucmptime(struct tm *t1, struct tm *t2)
+static uint64_t
+udectobits(const tUDecimal *psDec, uint32_t ui32Bits, int32_t i32KMin,
+           int32_t i32KMax)
 {
-    //
-    // Compare each field in descending signficance to determine if
-    // greater than, less than, or equal.
-    //
-    if(t1->tm_year > t2->tm_year)
+    uint64_t ui64Mant, ui64Rem, ui64Half;
+    uint32_t ui32Lead, ui32Shift, ui32Err;
+    int32_t i32Exp2, i32K;
+    int32_t i32Digits;
+    uint64_t ui64Inf;
+
+    ui64Inf = (uint64_t)(i32KMax - i32KMin + 2) << (ui32Bits - 1);
+
+    if(psDec->bInf)
     {
-        return(1);
+        return(ui64Inf);
     }
-    else if(t1->tm_year < t2->tm_year)
+    if(psDec->bNaN)
     {
-        return(-1);
+        return(ui64Inf | ((uint64_t)1 << (ui32Bits - 2)));
     }
-    else if(t1->tm_mon > t2->tm_mon)
+    if(psDec->ui64Mant == 0)
     {
-        return(1);
+        return(0);
     }
-    else if(t1->tm_mon < t2->tm_mon)
+
+    //
+    // Values far outside the range are infinite or zero.  The limits only
+    // need to be loose, close ones are sorted out below.
+    //
+    i32Digits = psDec->i32Point;
+    if(i32Digits > ((i32KMax + (int32_t)ui32Bits) * 3 / 10 + 2))
     {
-        return(-1);
+        return(ui64Inf);
     }
-    else if(t1->tm_mday > t2->tm_mday)
+    if(i32Digits < ((i32KMin * 3 / 10) - 2))
     {
-        return(1);
+        return(0);
     }
-    else if(t1->tm_mday < t2->tm_mday)
+
+    //
+    // Normalize the mantissa and scale it by the power of ten.
+    //
+    ui64Mant = psDec->ui64Mant;
+    for(ui32Lead = 0; !(ui64Mant >> 63); ui32Lead++)
     {
-        return(-1);
+        ui64Mant <<= 1;
     }
-    else if(t1->tm_hour > t2->tm_hour)
+    i32Exp2 = -(int32_t)ui32Lead;
+    ui64Mant = umulpow10(ui64Mant, psDec->i32Exp, &i32Exp2);
+
+    //
+    // The true value is ui64Mant * 2^i32Exp2 plus less than ui32Err units.
+    // Dropped digits can add up to 2^-59 of the value.
+    //
+    ui32Err = psDec->bTrunc ? 48 : 8;
+
+    //
+    // Find the exponent of the result and how many bits are below it,
+    // more for a subnormal.
+    //
+    ui32Shift = 64 - ui32Bits;
+    i32K = i32Exp2 + (int32_t)ui32Shift;
+    if(i32K > i32KMax)
     {
-        return(1);
+        return(ui64Inf);
     }
-    else if(t1->tm_hour < t2->tm_hour)
+    if(i32K < i32KMin)
     {
-        return(-1);
+        ui32Shift += i32KMin - i32K;
+        i32K = i32KMin;
+
+        //
+        // Around half the smallest subnormal the result is that or zero.
+        //
+        if(ui32Shift > 64)
+        {
+            if((ui32Shift > 65) || (ui64Mant < (0 - (uint64_t)ui32Err)))
+            {
+                return(0);
+            }
+            return((udeccmp(psDec, 1, i32KMin - 1) > 0) ? 1 : 0);
+        }
     }
-    else if(t1->tm_min > t2->tm_min)
+
+    //
+    // Round to nearest.  The bits below the result can't tell if the value
+    // is just below or just above half way when half way is within the
+    // error, so then compare with half way exactly.  Ties go to even.
+    //
+    if(ui32Shift < 64)
     {
-        return(1);
+        ui64Rem = ui64Mant & (((uint64_t)1 << ui32Shift) - 1);
+        ui64Mant >>= ui32Shift;
     }
-    else if(t1->tm_min < t2->tm_min)
+    else
     {
-        return(-1);
+        ui64Rem = ui64Mant;
+        ui64Mant = 0;
     }
-    else if(t1->tm_sec > t2->tm_sec)
+    ui64Half = (uint64_t)1 << (ui32Shift - 1);
+
+    if(ui64Rem > ui64Half)
     {
-        return(1);
+        ui64Mant++;
     }
-    else if(t1->tm_sec < t2->tm_sec)
+    else if((ui64Half - ui64Rem) <= ui32Err)
     {
-        return(-1);
+        int32_t i32Cmp;
+
+        i32Cmp = udeccmp(psDec, (ui64Mant * 2) + 1, i32K - 1);
+        if((i32Cmp > 0) || ((i32Cmp == 0) && (ui64Mant & 1)))
+        {
+            ui64Mant++;
+        }
     }
-    else
+
+    //
+    // Rounding up may carry into the next power of two.
+    //
+    if(ui64Mant >> ui32Bits)
     {
-        //
-        // Reaching this branch of the conditional means that all of the
-        // fields are equal, and thus the two times are equal.
-        //
-        return(0);
+        ui64Mant >>= 1;
+        i32K++;
+        if(i32K > i32KMax)
+        {
+            return(ui64Inf);
+        }
+    }
+
+    //
+    // A subnormal keeps a zero exponent field.  A normal value's hidden one
+    // is added to the exponent field below it, so only the exponent above
+    // the smallest needs to be added.
+    //
+    if(!(ui64Mant >> (ui32Bits - 1)))
+    {
+        return(ui64Mant);
     }
+
+    return(((uint64_t)(i32K - i32KMin) << (ui32Bits - 1)) + ui64Mant);
 }
 
 //*****************************************************************************
 //
-//! Converts calendar date and time to seconds.
+//! Converts a string into its floating-point equivalent.
 //!
-//! \param timeptr is a pointer to the time structure that is filled in with
-//! the broken down date and time.
+//! \param nptr is a pointer to the string containing the floating-point
+//! value.
+//! \param endptr is a pointer that will be set to the first character past
+//! the floating-point value in the string.
 //!
-//! This function converts the date and time represented by the \e timeptr
-//! structure pointer to the number of seconds since midnight GMT on January 1,
-//! 1970 (traditional Unix epoch).
+//! This function is very similar to the C library <tt>strtof()</tt> function.
+//! It scans a string for the first token (that is, non-white space) and
+//! converts the value at that location in the string into a floating-point
+//! value.  "inf", "infinity" and "nan" are recognized, ignoring case.
 //!
-//! \return Returns the calendar time and date as seconds.  If the conversion
-//! was not possible then the function returns (uint32_t)(-1).
+//! The result is correctly rounded.  Values with up to seven digits and a
+//! power of ten of at most ten take a single float multiply or divide;
+//! others are worked out with integer arithmetic, see ustrtod().
+//!
+//! \return Returns the result of the conversion.
 //
 //*****************************************************************************
-time_t
-umktime(struct tm *timeptr)
+float
+ustrtof(const char *nptr, const char **endptr)
 {
-    struct tm sTimeGuess;
-    unsigned long ulTimeGuess = 0x80000000;
-    unsigned long ulAdjust = 0x40000000;
-    int iSign;
+    tUDecimal sDec;
+    const char *pcEnd;
+    union
+    {
+        float f;
+        uint32_t ui32;
+    }
+    uValue;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(nptr);
 
     //
-    // Seed the binary search with the first guess.
+    // Read the number.
     //
-    ulocaltime(ulTimeGuess, &sTimeGuess);
-    iSign = ucmptime(timeptr, &sTimeGuess);
+    pcEnd = uparsedec(nptr, &sDec);
 
     //
-    // While the time is not yet found, execute a binary search.
+    // Set the return string pointer to the first character not consumed.
     //
-    while(iSign && ulAdjust)
+    if(endptr)
     {
-        //
-        // Adjust the time guess up or down depending on the result of the
-        // last compare.
-        //
-        ulTimeGuess = ((iSign > 0) ? (ulTimeGuess + ulAdjust) :
-                       (ulTimeGuess - ulAdjust));
-        ulAdjust /= 2;
+        *endptr = pcEnd;
+    }
 
-        //
-        // Compare the new time guess against the time pointed at by the
-        // function parameters.
-        //
-        ulocaltime(ulTimeGuess, &sTimeGuess);
-        iSign = ucmptime(timeptr, &sTimeGuess);
+    if(pcEnd == nptr)
+    {
+        return(0);
     }
 
     //
-    // If the above loop was exited with iSign == 0, that means that the
-    // time in seconds was found, so return that value to the caller.
+    // A mantissa that is exact in a float times an exact power of ten needs
+    // one correctly rounded operation.
     //
-    if(iSign == 0)
+    if(!sDec.bTrunc && (sDec.ui64Mant <= (1 << 24)) && !sDec.bInf &&
+       !sDec.bNaN && (sDec.i32Exp >= -10) && (sDec.i32Exp <= 10))
     {
-        return(ulTimeGuess);
+        uValue.f = (float)(uint32_t)sDec.ui64Mant;
+        if(sDec.i32Exp < 0)
+        {
+            uValue.f /= g_pfPow10[-sDec.i32Exp];
+        }
+        else
+        {
+            uValue.f *= g_pfPow10[sDec.i32Exp];
+        }
+
+        return(sDec.bNeg ? -uValue.f : uValue.f);
     }
 
-    //
-    // Otherwise the time could not be converted so return an error.
-    //
-    else
+    uValue.ui32 = (uint32_t)udectobits(&sDec, 24, -149, 104);
+    if(sDec.bNeg)
     {
-        return((unsigned long)-1);
+        uValue.ui32 |= 0x80000000;
     }
+
+    return(uValue.f);
 }
 
 //*****************************************************************************
 //
-//! Converts a string into its numeric equivalent.
+//! Converts a string into its double-precision floating-point equivalent.
 //!
-//! \param nptr is a pointer to the string containing the integer.
+//! \param nptr is a pointer to the string containing the floating-point
+//! value.
 //! \param endptr is a pointer that will be set to the first character past
-//! the integer in the string.
-//! \param base is the radix to use for the conversion; can be zero to
-//! auto-select the radix or between 2 and 16 to explicitly specify the radix.
+//! the floating-point value in the string.
 //!
-//! This function is very similar to the C library <tt>strtoul()</tt> function.
-//! It scans a string for the first token (that is, non-white space) and
-//! converts the value at that location in the string into an integer value.
+//! This function is very similar to the C library <tt>strtod()</tt> function.
+//! It accepts the same forms as ustrtof().
+//!
+//! The result is correctly rounded, so a double printed with 17 significant
+//! digits reads back unchanged.  Up to 15 digits with a power of ten of at
+//! most 22 take a single double multiply or divide.  Otherwise the first 19
+//! digits are scaled by a table of powers of ten in 64-bit integer
+//! arithmetic, and only a value within a few parts in 2^64 of half way
+//! between two doubles is settled by comparing it digit by digit with the
+//! half way point, which is slower.
 //!
 //! \return Returns the result of the conversion.
 //
 //*****************************************************************************
-unsigned long
-ustrtoul(const char * restrict nptr, const char ** restrict endptr, int base)
+double
+ustrtod(const char *nptr, const char **endptr)
 {
-    unsigned long ulRet, ulDigit, ulNeg, ulValid;
-    const char *pcPtr;
+    tUDecimal sDec;
+    const char *pcEnd;
+    union
+    {
+        double d;
+        uint64_t ui64;
+    }
+    uValue;
 
     //
     // Check the arguments.
     //
     ASSERT(nptr);
-    ASSERT((base == 0) || ((base > 1) && (base <= 16)));
 
     //
-    // Initially, the result is zero.
+    // Read the number.
     //
-    ulRet = 0;
-    ulNeg = 0;
-    ulValid = 0;
+    pcEnd = uparsedec(nptr, &sDec);
 
     //
-    // Skip past any leading white space.
+    // Set the return string pointer to the first character not consumed.
     //
-    pcPtr = nptr;
-    while((*pcPtr == ' ') || (*pcPtr == '\t'))
+    if(endptr)
     {
-        pcPtr++;
+        *endptr = pcEnd;
+    }
+
+    if(pcEnd == nptr)
+    {
+        return(0);
+    }
+
+    //
+    // A mantissa that is exact in a double times an exact power of ten needs
+    // one correctly rounded operation.
+    //
+    if(!sDec.bTrunc && (sDec.ui64Mant <= ((uint64_t)1 << 53)) &&
+       !sDec.bInf && !sDec.bNaN && (sDec.i32Exp >= -22) &&
+       (sDec.i32Exp <= 22))
+    {
+        uValue.d = (double)sDec.ui64Mant;
+        if(sDec.i32Exp < 0)
+        {
+            uValue.d /= g_pdPow10[-sDec.i32Exp];
+        }
+        else
+        {
+            uValue.d *= g_pdPow10[sDec.i32Exp];
+        }
+
+        return(sDec.bNeg ? -uValue.d : uValue.d);
     }
 
+    uValue.ui64 = udectobits(&sDec, 53, -1074, 971);
+    if(sDec.bNeg)
+    {
+        uValue.ui64 |= (uint64_t)1 << 63;
+    }
+
+    return(uValue.d);
+}
+
+//*****************************************************************************
+//
+//! Returns the length of a null-terminated string.
+//!
+//! \param s is a pointer to the string whose length is to be found.
+//!
+//! This function is very similar to the C library <tt>strlen()</tt> function.
+//! It determines the length of the null-terminated string passed and returns
+//! this to the caller.
+//!
+//! This implementation assumes that single byte character strings are passed
+//! and will return incorrect values if passed some UTF-8 strings.
+//!
+//! Once past the first word boundary the string is searched four characters
+//! at a time.
+//!
+//! \return Returns the length of the string pointed to by \e s.
+//
+//*****************************************************************************
+size_t
+ustrlen(const char *s)
+{
+    size_t len;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(s);
+
+    //
+    // Initialize the length.
+    //
+    len = 0;
+
+#ifndef USTDLIB_BYTE_STRINGS
     //
-    // Take a leading + or - from the value.
+    // Step to a word boundary, then skip whole words until one holds a zero.
+    // The loop below finds which byte it is.
     //
-    if(*pcPtr == '-')
+    while(!UALIGNED(s + len))
     {
-        ulNeg = 1;
-        pcPtr++;
+        if(!s[len])
+        {
+            return(len);
+        }
+        len++;
     }
-    else if(*pcPtr == '+')
+    while(!UHASZERO(*(const tUWord *)(s + len)))
     {
-        pcPtr++;
+        len += 4;
     }
+#endif
 
     //
-    // See if the radix was not specified, or is 16, and the value starts with
-    // "0x" or "0X" (to indicate a hex value).
+    // Step throug the string looking for a zero character (marking its end).
     //
-    if(((base == 0) || (base == 16)) && (*pcPtr == '0') &&
-       ((pcPtr[1] == 'x') || (pcPtr[1] == 'X')))
+    while(s[len])
     {
         //
-        // Skip the leading "0x".
-        //
-        pcPtr += 2;
-
-        //
-        // Set the radix to 16.
+        // Zero not found so move on to the next character.
         //
-        base = 16;
+        len++;
     }
 
+    return(len);
+}
+
+//*****************************************************************************
+//
+// Finds the first \e c or terminator in at most \e n characters of \e s,
+// a word at a time once aligned.
+//
+// Returns a pointer to the character found, or \e s + \e n if there was
+// neither.
+//
+//*****************************************************************************
+static const char *
+uscanchr(const char *s, char c, size_t n)
+{
+#ifndef USTDLIB_BYTE_STRINGS
+    uint32_t ui32Pattern, ui32Word;
+
     //
-    // See if the radix was not specified.
+    // Step to a word boundary.
     //
-    if(base == 0)
+    while(n && !UALIGNED(s))
     {
-        //
-        // See if the value starts with "0".
-        //
-        if(*pcPtr == '0')
-        {
-            //
-            // Values that start with "0" are assumed to be radix 8.
-            //
-            base = 8;
-        }
-        else
+        if((*s == c) || !*s)
         {
-            //
-            // Otherwise, the values are assumed to be radix 10.
-            //
-            base = 10;
+            return(s);
         }
+        s++;
+        n--;
     }
 
     //
-    // Loop while there are more valid digits to consume.
+    // Skip words that hold neither the character nor a zero.
     //
-    while(1)
+    ui32Pattern = (uint32_t)(unsigned char)c * 0x01010101;
+    while(n >= 4)
     {
-        //
-        // See if this character is a number.
-        //
-        if((*pcPtr >= '0') && (*pcPtr <= '9'))
+        ui32Word = *(const tUWord *)s;
+        if(UHASZERO(ui32Word) || UHASZERO(ui32Word ^ ui32Pattern))
         {
-            //
-            // Convert the character to its integer equivalent.
-            //
-            ulDigit = *pcPtr++ - '0';
+            break;
         }
+        s += 4;
+        n -= 4;
+    }
+#endif
 
-        //
-        // Otherwise, see if this character is an upper case letter.
-        //
-        else if((*pcPtr >= 'A') && (*pcPtr <= 'Z'))
-        {
-            //
-            // Convert the character to its integer equivalent.
-            //
-            ulDigit = *pcPtr++ - 'A' + 10;
-        }
+    //
+    // Find the character within the word, or in what is left.
+    //
+    while(n && (*s != c) && *s)
+    {
+        s++;
+        n--;
+    }
 
-        //
-        // Otherwise, see if this character is a lower case letter.
-        //
-        else if((*pcPtr >= 'a') && (*pcPtr <= 'z'))
+    return(s);
+}
+
+//*****************************************************************************
+//
+// Finds the maximal suffix of the \e n character string \e pucStr, under the
+// normal character order or, with \e bReverse, the reverse order.  This is
+// the critical factorization step of the Two-Way search.
+//
+// Returns the position before the suffix, (size_t)-1 for the whole string,
+// and sets \e *pPeriod to the period of the suffix.
+//
+//*****************************************************************************
+static size_t
+umaxsuffix(const unsigned char *pucStr, size_t n, bool bReverse,
+           size_t *pPeriod)
+{
+    size_t i, j, k, p;
+
+    i = (size_t)-1;
+    j = 0;
+    k = 1;
+    p = 1;
+
+    while((j + k) < n)
+    {
+        if(pucStr[i + k] == pucStr[j + k])
         {
             //
-            // Convert the character to its integer equivalent.
+            // Still matching, step over a whole period at a time.
             //
-            ulDigit = *pcPtr++ - 'a' + 10;
+            if(k == p)
+            {
+                j += p;
+                k = 1;
+            }
+            else
+            {
+                k++;
+            }
         }
-
-        //
-        // Otherwise, this is not a valid character.
-        //
-        else
+        else if((pucStr[i + k] > pucStr[j + k]) != bReverse)
         {
             //
-            // Stop converting this value.
+            // The suffix at j is smaller, so it extends the period.
             //
-            break;
+            j += k;
+            k = 1;
+            p = j - i;
         }
-
-        //
-        // See if this digit is valid for the chosen radix.
-        //
-        if(ulDigit >= base)
+        else
         {
             //
-            // Since this was not a valid digit, move the pointer back to the
-            // character that therefore should not have been consumed.
-            //
-            pcPtr--;
-
-            //
-            // Stop converting this value.
+            // The suffix at j is larger, start over from it.
             //
-            break;
+            i = j++;
+            k = 1;
+            p = 1;
         }
-
-        //
-        // Add this digit to the converted value.
-        //
-        ulRet *= base;
-        ulRet += ulDigit;
-
-        //
-        // Since a digit has been added, this is now a valid result.
-        //
-        ulValid = 1;
     }
 
-    //
-    // Set the return string pointer to the first character not consumed.
-    //
-    if(endptr)
-    {
-        *endptr = ulValid ? pcPtr : nptr;
-    }
+    *pPeriod = p;
 
-    //
-    // Return the converted value.
-    //
-    return(ulNeg ? (0 - ulRet) : ulRet);
+    return(i);
 }
 
 //*****************************************************************************
 //
-// An array of the value of ten raised to the power-of-two exponents.  This is
-// used for converting the decimal exponent into the floating-point value of
-// 10^exp.
-//
-//*****************************************************************************
-static const float g_pfExponents[] =
-{
-    1.0e+01,
-    1.0e+02,
-    1.0e+04,
-    1.0e+08,
-    1.0e+16,
-    1.0e+32,
-};
-
-//*****************************************************************************
-//
-//! Converts a string into its floating-point equivalent.
+//! Finds a substring within a string.
 //!
-//! \param nptr is a pointer to the string containing the floating-point
-//! value.
-//! \param endptr is a pointer that will be set to the first character past
-//! the floating-point value in the string.
+//! \param s1 is a pointer to the string that will be searched.
+//! \param s2 is a pointer to the substring that is to be found within
+//! \e s1.
 //!
-//! This function is very similar to the C library <tt>strtof()</tt> function.
-//! It scans a string for the first token (that is, non-white space) and
-//! converts the value at that location in the string into a floating-point
-//! value.
+//! This function is very similar to the C library <tt>strstr()</tt> function.
+//! It scans a string for the first instance of a given substring and returns
+//! a pointer to that substring.  If the substring cannot be found, a NULL
+//! pointer is returned.
 //!
-//! \return Returns the result of the conversion.
+//! The search is the Two-Way algorithm, which takes time linear in the
+//! length of \e s1 whatever the strings hold and needs no memory beyond a
+//! few variables.  Stretches of \e s1 that can't start a match are skipped
+//! a word at a time by looking for the first character of \e s2.  The end
+//! of \e s1 is found as the search goes, so a match near the start of a
+//! long string is found without reading the rest.
+//!
+//! \return Returns a pointer to the first occurrence of \e s2 within
+//! \e s1 or NULL if no match is found.
 //
 //*****************************************************************************
-float
-ustrtof(const char *nptr, const char **endptr)
+char *
+ustrstr(const char *s1, const char *s2)
 {
-    unsigned long ulNeg, ulExp, ulExpNeg, ulValid, ulIdx;
-    float fRet, fDigit, fExp;
-    const char *pcPtr;
+    const unsigned char *pucHay, *pucEnd, *pucNeedle;
+    size_t n, ms, p, ms2, p2, mem, mem0, k;
 
     //
     // Check the arguments.
     //
-    ASSERT(nptr);
-
-    //
-    // Initially, the result is zero.
-    //
-    fRet = 0;
-    ulNeg = 0;
-    ulValid = 0;
+    ASSERT(s1);
+    ASSERT(s2);
 
     //
-    // Skip past any leading white space.
+    // Get the length of the string to be found.  An empty string is found
+    // at the start.
     //
-    pcPtr = nptr;
-    while((*pcPtr == ' ') || (*pcPtr == '\t'))
+    n = ustrlen(s2);
+    if(n == 0)
     {
-        pcPtr++;
+        return((char *)s1);
     }
 
     //
-    // Take a leading + or - from the value.
+    // Move to the first place the substring could start.
     //
-    if(*pcPtr == '-')
+    s1 = uscanchr(s1, s2[0], (size_t)-1);
+    if(!*s1)
     {
-        ulNeg = 1;
-        pcPtr++;
+        return((char *)0);
     }
-    else if(*pcPtr == '+')
+    if(n == 1)
     {
-        pcPtr++;
+        return((char *)s1);
     }
 
+    pucNeedle = (const unsigned char *)s2;
+
     //
-    // Loop while there are valid digits to consume.
+    // Split the substring at its critical factorization, the later of the
+    // maximal suffixes under the two character orders.
     //
-    while((*pcPtr >= '0') && (*pcPtr <= '9'))
+    ms = umaxsuffix(pucNeedle, n, false, &p);
+    ms2 = umaxsuffix(pucNeedle, n, true, &p2);
+    if((ms2 + 1) > (ms + 1))
     {
-        //
-        // Add this digit to the converted value.
-        //
-        fRet *= 10;
-        fRet += *pcPtr++ - '0';
-
-        //
-        // Since a digit has been added, this is now a valid result.
-        //
-        ulValid = 1;
+        ms = ms2;
+        p = p2;
     }
 
     //
-    // See if the next character is a period and the character after that is a
-    // digit, indicating the start of the fractional portion of the value.
+    // If the left part repeats with the period of the right part, the whole
+    // substring is periodic and the matched prefix is remembered across a
+    // shift by one period.  Otherwise the shift can be longer than the left
+    // part and nothing is remembered.
     //
-    if((*pcPtr == '.') && (pcPtr[1] >= '0') && (pcPtr[1] <= '9'))
+    for(k = 0; (k < (ms + 1)) && (pucNeedle[k] == pucNeedle[k + p]); k++)
     {
-        //
-        // Skip the period.
-        //
-        pcPtr++;
-
-        //
-        // Loop while there are valid fractional digits to consume.
-        //
-        fDigit = 0.1;
-        while((*pcPtr >= '0') && (*pcPtr <= '9'))
-        {
-            //
-            // Add this digit to the converted value.
-            //
-            fRet += (*pcPtr++ - '0') * fDigit;
-            fDigit /= (float)10.0;
-
-            //
-            // Since a digit has been added, this is now a valid result.
-            //
-            ulValid = 1;
-        }
     }
-
-    //
-    // See if the next character is an "e" and a valid number has been
-    // converted, indicating the start of the exponent.
-    //
-    if(((pcPtr[0] == 'e') || (pcPtr[0] == 'E')) && (ulValid == 1) &&
-       (((pcPtr[1] >= '0') && (pcPtr[1] <= '9')) ||
-        (((pcPtr[1] == '+') || (pcPtr[1] == '-')) &&
-         (pcPtr[2] >= '0') && (pcPtr[2] <= '9'))))
+    if(k < (ms + 1))
     {
-        //
-        // Skip the "e".
-        //
-        pcPtr++;
+        mem0 = 0;
+        p = (((ms + 1) > (n - ms - 1)) ? (ms + 1) : (n - ms - 1)) + 1;
+    }
+    else
+    {
+        mem0 = n - p;
+    }
 
-        //
-        // Take a leading + or - from the exponenet.
-        //
-        ulExpNeg = 0;
-        if(*pcPtr == '-')
-        {
-            ulExpNeg = 1;
-            pcPtr++;
-        }
-        else if(*pcPtr == '+')
-        {
-            pcPtr++;
-        }
+    pucHay = (const unsigned char *)s1;
+    pucEnd = pucHay;
+    mem = 0;
 
+    while(1)
+    {
         //
-        // Loop while there are valid digits in the exponent.
+        // Everything below pucEnd is known not to be the terminator.  Make
+        // sure there is room for the substring, looking ahead by at least
+        // 64 characters at a time.
         //
-        ulExp = 0;
-        while((*pcPtr >= '0') && (*pcPtr <= '9'))
+        if((size_t)(pucEnd - pucHay) < n)
         {
-            //
-            // Add this digit to the converted value.
-            //
-            ulExp *= 10;
-            ulExp += *pcPtr++ - '0';
+            k = n | 63;
+            s1 = uscanchr((const char *)pucEnd, 0, k);
+            if(s1 != ((const char *)pucEnd + k))
+            {
+                pucEnd = (const unsigned char *)s1;
+                if((size_t)(pucEnd - pucHay) < n)
+                {
+                    return((char *)0);
+                }
+            }
+            else
+            {
+                pucEnd += k;
+            }
         }
 
         //
-        // Raise ten to the power of the exponent.  Do this via binary
-        // decomposition; for each binary bit set in the exponent, multiply the
-        // floating-point representation by ten raised to that binary value
-        // (extracted from the table above).
+        // With nothing remembered, skip ahead to the next place the first
+        // character matches.
         //
-        fExp = 1;
-        for(ulIdx = 0; ulIdx < 7; ulIdx++)
+        if(!mem && (*pucHay != pucNeedle[0]))
         {
-            if(ulExp & (1 << ulIdx))
+            s1 = uscanchr((const char *)pucHay + 1, s2[0], (size_t)-1);
+            if(!*s1)
+            {
+                return((char *)0);
+            }
+            pucHay = (const unsigned char *)s1;
+            if(pucHay > pucEnd)
             {
-                fExp *= g_pfExponents[ulIdx];
+                pucEnd = pucHay;
             }
+            continue;
         }
 
         //
-        // If the exponent is negative, then the exponent needs to be inverted.
+        // Compare the right part.  A mismatch shifts past the characters
+        // that did match.
         //
-        if(ulExpNeg == 1)
+        for(k = ((ms + 1) > mem) ? (ms + 1) : mem;
+            (k < n) && (pucNeedle[k] == pucHay[k]); k++)
+        {
+        }
+        if(k < n)
         {
-            fExp = 1 / fExp;
+            pucHay += k - ms;
+            mem = 0;
+            continue;
         }
 
         //
-        // Multiply the result by the computed exponent value.
+        // Compare the left part, right to left, stopping at what is known to
+        // match already.
         //
-        fRet *= fExp;
-    }
-
-    //
-    // Set the return string pointer to the first character not consumed.
-    //
-    if(endptr)
-    {
-        *endptr = ulValid ? pcPtr : nptr;
-    }
+        for(k = ms + 1; (k > mem) && (pucNeedle[k - 1] == pucHay[k - 1]); k--)
+        {
+        }
+        if(k <= mem)
+        {
+            return((char *)pucHay);
+        }
 
-    //
-    // Return the converted value.
-    //
-    return(ulNeg ? (0 - fRet) : fRet);
+        //
+        // Shift by the period.
+        //
+        pucHay += p;
+        mem = mem0;
+    }
 }
 
 //*****************************************************************************
 //
-//! Returns the length of a null-terminated string.
-//!
-//! \param s is a pointer to the string whose length is to be found.
+//! Prepares a set of keywords for ustrkeys().
 //!
-//! This function is very similar to the C library <tt>strlen()</tt> function.
-//! It determines the length of the null-terminated string passed and returns
-//! this to the caller.
+//! \param psKeys points to the keyword set to initialize.
+//! \param ppcKeys points to an array of keyword strings.  The array and the
+//! strings must stay valid while the set is in use.
+//! \param ui32Count is the number of keywords in the array.
 //!
-//! This implementation assumes that single byte character strings are passed
-//! and will return incorrect values if passed some UTF-8 strings.
+//! This function records which characters start a keyword so ustrkeys() can
+//! pass over every other character with one table lookup.  Empty keywords
+//! are never found.
 //!
-//! \return Returns the length of the string pointed to by \e s.
+//! \return None.
 //
 //*****************************************************************************
-size_t
-ustrlen(const char *s)
+void
+ustrkeysinit(tUStrKeys *psKeys, const char * const *ppcKeys,
+             uint32_t ui32Count)
 {
-    size_t len;
+    uint32_t ui32Idx;
+    unsigned char ucChar;
 
     //
     // Check the arguments.
     //
-    ASSERT(s);
+    ASSERT(psKeys);
+    ASSERT(ppcKeys || !ui32Count);
 
-    //
-    // Initialize the length.
-    //
-    len = 0;
+    psKeys->ppcKeys = ppcKeys;
+    psKeys->ui32Count = ui32Count;
+
+    for(ui32Idx = 0; ui32Idx < 8; ui32Idx++)
+    {
+        psKeys->pui32First[ui32Idx] = 0;
+    }
 
     //
-    // Step throug the string looking for a zero character (marking its end).
+    // Mark the first character of each keyword.
     //
-    while(s[len])
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
     {
-        //
-        // Zero not found so move on to the next character.
-        //
-        len++;
+        ucChar = (unsigned char)ppcKeys[ui32Idx][0];
+        if(ucChar)
+        {
+            psKeys->pui32First[ucChar >> 5] |= (uint32_t)1 << (ucChar & 31);
+        }
     }
-
-    return(len);
 }
 
 //*****************************************************************************
 //
-//! Finds a substring within a string.
+//! Finds the first of several keywords within a string.
 //!
-//! \param s1 is a pointer to the string that will be searched.
-//! \param s2 is a pointer to the substring that is to be found within
-//! \e s1.
+//! \param s is a pointer to the string that will be searched.
+//! \param psKeys is the keyword set, prepared by ustrkeysinit().
+//! \param pui32Key points to where the index of the keyword found is
+//! written, or is NULL.
 //!
-//! This function is very similar to the C library <tt>strstr()</tt> function.
-//! It scans a string for the first instance of a given substring and returns
-//! a pointer to that substring.  If the substring cannot be found, a NULL
-//! pointer is returned.
+//! This function looks for all of the keywords in one pass over \e s, which
+//! suits filtering lines of log output on a list of words.  The keywords
+//! are only compared at characters that start one of them.  If more than one
+//! keyword starts at the first match, the one earliest in the array wins.
 //!
-//! \return Returns a pointer to the first occurrence of \e s2 within
-//! \e s1 or NULL if no match is found.
+//! The time taken grows with the length of \e s times the length of the
+//! keywords sharing a first character, so long keywords that share a
+//! prefix are better searched for with ustrstr().
+//!
+//! \return Returns a pointer to the first keyword found in \e s, or NULL if
+//! there are none.
 //
 //*****************************************************************************
 char *
-ustrstr(const char *s1, const char *s2)
+ustrkeys(const char *s, const tUStrKeys *psKeys, uint32_t *pui32Key)
 {
-    size_t n;
+    const char *pcKey;
+    uint32_t ui32Idx;
+    unsigned char ucChar;
+    size_t k;
 
     //
-    // Get the length of the string to be found.
+    // Check the arguments.
     //
-    n = ustrlen(s2);
+    ASSERT(s);
+    ASSERT(psKeys);
 
-    //
-    // Loop while we have not reached the end of the string.
-    //
-    while(*s1)
+    for(; *s; s++)
     {
         //
-        // Check to see if the substring appears at this position.
+        // Pass over characters that start no keyword.
         //
-        if(ustrncmp(s2, s1, n) == 0)
+        ucChar = (unsigned char)*s;
+        if(!(psKeys->pui32First[ucChar >> 5] & ((uint32_t)1 << (ucChar & 31))))
         {
-            //
-            // It does so return the pointer.
-            //
-            return((char *)s1);
+            continue;
         }
 
         //
-        // Move to the next position in the string being searched.
+        // Try each keyword that starts with this character.  The comparison
+        // stops at the end of the string since the keyword can't match its
+        // terminator.
         //
-        s1++;
+        for(ui32Idx = 0; ui32Idx < psKeys->ui32Count; ui32Idx++)
+        {
+            pcKey = psKeys->ppcKeys[ui32Idx];
+            if(pcKey[0] != *s)
+            {
+                continue;
+            }
+
+            for(k = 1; pcKey[k] && (pcKey[k] == s[k]); k++)
+            {
+            }
+
+            if(!pcKey[k])
+            {
+                if(pui32Key)
+                {
+                    *pui32Key = ui32Idx;
+                }
+                return((char *)s);
+            }
+        }
     }
 
-    //
-    // We reached the end of the string without finding the substring so
-    // return NULL.
-    //
     return((char *)0);
 }
 
@@ -1692,6 +4510,9 @@ ustrcasecmp(const char *s1, const char *s2)
 //! either string before \e n characters are compared.  In this case, the
 //! int16_ter string is deemed the lesser.
 //!
+//! When \e s1 and \e s2 have the same alignment, matching characters are
+//! skipped four at a time.
+//!
 //! \return Returns 0 if the two strings are equal, -1 if \e s1 is less
 //! than \e s2 and 1 if \e s1 is greater than \e s2.
 //
@@ -1699,6 +4520,44 @@ ustrcasecmp(const char *s1, const char *s2)
 int
 ustrncmp(const char *s1, const char *s2, size_t n)
 {
+#ifndef USTDLIB_BYTE_STRINGS
+    if(USAMEALIGN(s1, s2))
+    {
+        //
+        // Compare up to a word boundary a character at a time, leaving a
+        // difference or the end of the strings to the loop below.
+        //
+        while(n && !UALIGNED(s1) && *s1 && (*s1 == *s2))
+        {
+            s1++;
+            s2++;
+            n--;
+        }
+
+        //
+        // Then skip whole words while they match and hold no terminator.
+        // The word that stops this is settled by the loop below, so the
+        // result is the same as comparing a character at a time.
+        //
+        if(UALIGNED(s1))
+        {
+            while(n >= 4)
+            {
+                uint32_t ui32Word;
+
+                ui32Word = *(const tUWord *)s1;
+                if((ui32Word != *(const tUWord *)s2) || UHASZERO(ui32Word))
+                {
+                    break;
+                }
+                s1 += 4;
+                s2 += 4;
+                n -= 4;
+            }
+        }
+    }
+#endif
+
     //
     // Loop while there are more characters.
     //
@@ -1768,10 +4627,313 @@ ustrcmp(const char *s1, const char *s2)
 
 //*****************************************************************************
 //
-// Random Number Generator Seed Value
+// The polynomials that move a xoshiro128++ state forward by 2^64 and by 2^96
+// steps, one bit per power of the step, lowest first.
+//
+//*****************************************************************************
+static const uint32_t g_pui32RandJump[4] =
+{
+    0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b
+};
+static const uint32_t g_pui32RandLongJump[4] =
+{
+    0xb523952e, 0x0b6f099f, 0xccf5a0ef, 0x1c580662
+};
+
+//*****************************************************************************
+//
+// Rotates a 32-bit value left.
+//
+//*****************************************************************************
+#define UROTL(x, k)             (((x) << (k)) | ((x) >> (32 - (k))))
+
+//*****************************************************************************
+//
+// The generator behind urand() and usrand(), in the state usrand(1) gives.
+//
+//*****************************************************************************
+static tURand g_sRand =
+{
+    { 0x89025cc1, 0x910a2dec, 0x658eec67, 0xbeeb8da1 }
+};
+
+//*****************************************************************************
+//
+//! Seeds a random number generator.
+//!
+//! \param psRand points to the generator state.
+//! \param ui64Seed is the seed.
+//!
+//! This function sets up a xoshiro128++ generator from a 64-bit seed.  The
+//! seed is spread over the 128 bits of state with SplitMix64, so that nearby
+//! seeds such as 1 and 2 still give unrelated sequences, and the state is
+//! never all zero.
+//!
+//! To get several independent streams, seed one generator and then, for each
+//! stream, copy it and call urandjump() on the original.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+urandseed(tURand *psRand, uint64_t ui64Seed)
+{
+    uint64_t ui64Mix;
+    uint32_t ui32Idx;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(psRand);
+
+    for(ui32Idx = 0; ui32Idx < 4; ui32Idx += 2)
+    {
+        //
+        // Take the next SplitMix64 output.
+        //
+        ui64Seed += 0x9e3779b97f4a7c15ULL;
+        ui64Mix = ui64Seed;
+        ui64Mix = (ui64Mix ^ (ui64Mix >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        ui64Mix = (ui64Mix ^ (ui64Mix >> 27)) * 0x94d049bb133111ebULL;
+        ui64Mix ^= ui64Mix >> 31;
+
+        psRand->pui32State[ui32Idx] = (uint32_t)ui64Mix;
+        psRand->pui32State[ui32Idx + 1] = (uint32_t)(ui64Mix >> 32);
+    }
+}
+
+//*****************************************************************************
+//
+//! Generates a random number.
+//!
+//! \param psRand points to the generator state.
+//!
+//! This function returns the next number from a xoshiro128++ generator.  The
+//! generator has 128 bits of state and a period of 2^128 - 1, and its output
+//! passes the usual statistical test suites.  Each step is a handful of
+//! shifts, rotates, adds, and exclusive ors.
+//!
+//! \return Returns a random 32-bit number.
+//
+//*****************************************************************************
+uint32_t
+urandnext(tURand *psRand)
+{
+    uint32_t ui32S0, ui32S1, ui32S2, ui32S3, ui32Result;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(psRand);
+
+    ui32S0 = psRand->pui32State[0];
+    ui32S1 = psRand->pui32State[1];
+    ui32S2 = psRand->pui32State[2];
+    ui32S3 = psRand->pui32State[3];
+
+    ui32Result = UROTL(ui32S0 + ui32S3, 7) + ui32S0;
+
+    ui32S2 ^= ui32S0;
+    ui32S3 ^= ui32S1;
+    psRand->pui32State[0] = ui32S0 ^ ui32S3;
+    psRand->pui32State[1] = ui32S1 ^ ui32S2;
+    psRand->pui32State[2] = ui32S2 ^ (ui32S1 << 9);
+    psRand->pui32State[3] = UROTL(ui32S3, 11);
+
+    return(ui32Result);
+}
+
+//*****************************************************************************
+//
+//! Generates a random number below a bound.
+//!
+//! \param psRand points to the generator state.
+//! \param ui32Bound is the number of possible results, or 0 for all 2^32.
+//!
+//! This function returns a number from 0 to \e ui32Bound - 1 with every value
+//! equally likely, which taking the remainder of urandnext() does not give.
+//! The random number is multiplied by the bound and the top 32 bits of the
+//! product are the result.  The few products whose low bits fall in the
+//! part that would make some results more likely are rejected and drawn
+//! again; the division that finds that part is only needed when the low bits
+//! are below the bound, so it is rarely done.
+//!
+//! \return Returns the random number.
+//
+//*****************************************************************************
+uint32_t
+urandrange(tURand *psRand, uint32_t ui32Bound)
+{
+    uint64_t ui64Prod;
+    uint32_t ui32Limit;
+
+    if(ui32Bound == 0)
+    {
+        return(urandnext(psRand));
+    }
+
+    ui64Prod = (uint64_t)urandnext(psRand) * ui32Bound;
+
+    if((uint32_t)ui64Prod < ui32Bound)
+    {
+        //
+        // Reject the 2^32 mod ui32Bound lowest values.
+        //
+        ui32Limit = -ui32Bound % ui32Bound;
+        while((uint32_t)ui64Prod < ui32Limit)
+        {
+            ui64Prod = (uint64_t)urandnext(psRand) * ui32Bound;
+        }
+    }
+
+    return((uint32_t)(ui64Prod >> 32));
+}
+
+//*****************************************************************************
+//
+//! Generates a random floating-point number.
+//!
+//! \param psRand points to the generator state.
+//!
+//! This function returns a float from 0 up to, but not including, 1, made
+//! from the top 24 bits of urandnext() so every result is equally likely.
+//!
+//! \return Returns the random number.
+//
+//*****************************************************************************
+float
+urandfloat(tURand *psRand)
+{
+    return((float)(urandnext(psRand) >> 8) * (1.0f / 16777216.0f));
+}
+
+//*****************************************************************************
+//
+//! Fills a buffer with random bytes.
+//!
+//! \param psRand points to the generator state.
+//! \param pvBuf points to the buffer.
+//! \param ui32Len is the number of bytes to fill.
+//!
+//! This function fills the buffer with output from urandnext(), least
+//! significant byte first, storing a word at a time where the buffer is
+//! aligned.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+urandfill(tURand *psRand, void *pvBuf, uint32_t ui32Len)
+{
+    unsigned char *pucBuf;
+    uint32_t ui32Value, ui32Idx;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(pvBuf || !ui32Len);
+
+    pucBuf = pvBuf;
+
+#ifndef USTDLIB_BYTE_STRINGS
+    //
+    // Store whole words while the buffer is aligned.
+    //
+    if(UALIGNED(pucBuf))
+    {
+        for(; ui32Len >= 4; ui32Len -= 4)
+        {
+            *(tUWord *)pucBuf = urandnext(psRand);
+            pucBuf += 4;
+        }
+    }
+#endif
+
+    //
+    // Store any other bytes one at a time.
+    //
+    while(ui32Len)
+    {
+        ui32Value = urandnext(psRand);
+        for(ui32Idx = 0; (ui32Idx < 4) && ui32Len; ui32Idx++, ui32Len--)
+        {
+            *pucBuf++ = (unsigned char)ui32Value;
+            ui32Value >>= 8;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Moves a generator forward by the number of steps a jump polynomial stands
+// for, by adding up the states it picks out along the first 128 steps.
+//
+//*****************************************************************************
+static void
+urandjumpby(tURand *psRand, const uint32_t *pui32Poly)
+{
+    uint32_t pui32Sum[4], ui32Idx, ui32Bit;
+
+    pui32Sum[0] = pui32Sum[1] = pui32Sum[2] = pui32Sum[3] = 0;
+
+    for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+    {
+        for(ui32Bit = 1; ui32Bit; ui32Bit <<= 1)
+        {
+            if(pui32Poly[ui32Idx] & ui32Bit)
+            {
+                pui32Sum[0] ^= psRand->pui32State[0];
+                pui32Sum[1] ^= psRand->pui32State[1];
+                pui32Sum[2] ^= psRand->pui32State[2];
+                pui32Sum[3] ^= psRand->pui32State[3];
+            }
+            urandnext(psRand);
+        }
+    }
+
+    psRand->pui32State[0] = pui32Sum[0];
+    psRand->pui32State[1] = pui32Sum[1];
+    psRand->pui32State[2] = pui32Sum[2];
+    psRand->pui32State[3] = pui32Sum[3];
+}
+
+//*****************************************************************************
+//
+//! Moves a random number generator forward by 2^64 steps.
+//!
+//! \param psRand points to the generator state.
+//!
+//! This function advances the generator as if urandnext() had been called
+//! 2^64 times, at the cost of 128 calls.  It splits one sequence into up to
+//! 2^64 streams that do not overlap: copy the generator for each stream and
+//! jump the original after each copy.  urandlongjump() moves by 2^96 steps,
+//! to split the streams further.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+urandjump(tURand *psRand)
+{
+    urandjumpby(psRand, g_pui32RandJump);
+}
+
+//*****************************************************************************
+//
+//! Moves a random number generator forward by 2^96 steps.
+//!
+//! \param psRand points to the generator state.
+//!
+//! This function is urandjump() with a step of 2^96.
+//!
+//! \return None.
 //
 //*****************************************************************************
-static unsigned int g_iRandomSeed = 1;
+void
+urandlongjump(tURand *psRand)
+{
+    urandjumpby(psRand, g_pui32RandLongJump);
+}
 
 //*****************************************************************************
 //
@@ -1789,7 +4951,7 @@ static unsigned int g_iRandomSeed = 1;
 void
 usrand(unsigned int seed)
 {
-    g_iRandomSeed = seed;
+    urandseed(&g_sRand, seed);
 }
 
 //*****************************************************************************
@@ -1798,6 +4960,8 @@ usrand(unsigned int seed)
 //!
 //! This function is very similar to the C library <tt>rand()</tt> function.
 //! It will generate a pseudo-random number sequence based on the seed value.
+//! It uses a single generator shared by all callers; code that wants its own
+//! sequence, or several, should keep a tURand and use urandnext().
 //!
 //! \return A pseudo-random number will be returned.
 //
@@ -1805,17 +4969,7 @@ usrand(unsigned int seed)
 int
 urand(void)
 {
-    //
-    // Generate a new pseudo-random number with a linear congruence random
-    // number generator.  This new random number becomes the seed for the next
-    // random number.
-    //
-    g_iRandomSeed = (g_iRandomSeed * 1664525) + 1013904223;
-
-    //
-    // Return the new random number.
-    //
-    return((int)g_iRandomSeed);
+    return((int)urandnext(&g_sRand));
 }
 
 //*****************************************************************************
@@ -31,6 +31,8 @@
 //
 //*****************************************************************************
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 
 //*****************************************************************************
@@ -44,14 +46,325 @@ extern "C"
 {
 #endif
 
+//*****************************************************************************
+//
+// The precision value meaning none was given, and the largest precision
+// ufmtfloat() and ufmtfixed() honor.
+//
+//*****************************************************************************
+#define UFMT_PREC_NONE          0xFFFFFFFF
+#define UFMT_PREC_MAX           9
+
+//*****************************************************************************
+//
+// The size of buffer that ufmtfloat() and ufmtfixed() need.
+//
+//*****************************************************************************
+#define UFMT_FLOAT_MAX          24
+
+//*****************************************************************************
+//
+//! A set of keywords to search for with ustrkeys(), set up by
+//! ustrkeysinit().
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The keywords and how many there are.
+    //
+    const char * const *ppcKeys;
+    uint32_t ui32Count;
+
+    //
+    // One bit for each character that starts a keyword.
+    //
+    uint32_t pui32First[8];
+}
+tUStrKeys;
+
+//*****************************************************************************
+//
+//! The state of a random number generator, set up by urandseed().
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t pui32State[4];
+}
+tURand;
+
+//*****************************************************************************
+//
+//! A function that receives the output of uvsinkprintf() or ufmtsink(),
+//! \e ui32Len characters at \e pcBuf at a time.  The text is not NULL
+//! terminated.  \e pvSink is the value given to the formatter.
+//
+//*****************************************************************************
+typedef void (*tUSinkFxn)(void *pvSink, const char *pcBuf, uint32_t ui32Len);
+
+//*****************************************************************************
+//
+//! The state of usinkbuf(), a sink that writes to a memory buffer.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Where the next character goes and how many more fit.
+    //
+    char *pcBuf;
+    size_t ui32Left;
+}
+tUSinkBuf;
+
+//*****************************************************************************
+//
+// The operations of a precompiled format, see UFMT_DEFINE().
+//
+//*****************************************************************************
+#define UFMT_END                0
+#define UFMT_LIT                1
+#define UFMT_CHAR               2
+#define UFMT_INT                3
+#define UFMT_UINT               4
+#define UFMT_HEX                5
+#define UFMT_STR                6
+#define UFMT_FLOAT              7
+#define UFMT_FIXED              8
+
+//*****************************************************************************
+//
+//! One operation of a precompiled format.  A format is an array of these
+//! ending with \b UFMT_END, normally built by UFMT_DEFINE().
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The operation, one of the UFMT_ values above.
+    //
+    uint8_t ui8Op;
+
+    //
+    // The fill character, ' ' or '0', and the minimum field width.
+    //
+    char cFill;
+    uint8_t ui8Width;
+
+    //
+    // The precision of \b UFMT_FLOAT and \b UFMT_FIXED.
+    //
+    uint8_t ui8Prec;
+
+    //
+    // The style of \b UFMT_FLOAT ('e', 'f', or 'g'), or the number of fraction
+    // bits of \b UFMT_FIXED.
+    //
+    uint8_t ui8Aux;
+
+    //
+    // The length of a literal, or the offset of the argument in the argument
+    // structure.
+    //
+    uint16_t ui16Arg;
+
+    //
+    // The text of a literal.
+    //
+    const char *pcLit;
+}
+tUFmtOp;
+
+//*****************************************************************************
+//
+//! Defines a precompiled format.
+//!
+//! \param NAME is the name of the format.
+//! \param LIST is a macro listing its pieces, see below.
+//!
+//! A format that is printed often, such as a fixed log line, can be described
+//! once as a list of pieces instead of as a format string.  The list is a
+//! macro taking one parameter, F, with each piece written as F\#\#KIND(...):
+//!
+//! - F\#\#LIT("text") for literal text, which must be a string literal
+//! - F\#\#CHAR(name) for a \b char, like \%c
+//! - F\#\#INT(name, fill, width) for an \b int32_t, like \%d
+//! - F\#\#UINT(name, fill, width) for a \b uint32_t, like \%u
+//! - F\#\#HEX(name, fill, width) for a \b uint32_t, like \%x
+//! - F\#\#STR(name, width) for a <tt>const char *</tt>, like \%s
+//! - F\#\#FLOAT(name, style, fill, width, prec) for a \b double, like
+//! \%e, \%f, or \%g with \e style set to 'e', 'f', or 'g'
+//! - F\#\#FIXED(name, bits, fill, width, prec) for an \b int32_t with
+//! \e bits fraction bits, like \%q
+//!
+//! \e fill is ' ' or '0' and \e width is the minimum field width, 0 for
+//! none.  For example (with the line continuations of the macro left out):
+//!
+//! \verbatim
+//! #define LOG_ADC(F)
+//!     F##LIT("adc ")
+//!     F##UINT(ui32Chan, ' ', 0)
+//!     F##LIT(" = 0x")
+//!     F##HEX(ui32Raw, '0', 3)
+//!     F##LIT(", ")
+//!     F##FLOAT(dVolts, 'f', ' ', 0, 3)
+//!     F##LIT(" V\n")
+//!
+//! UFMT_DEFINE(LogAdc, LOG_ADC)
+//! \endverbatim
+//!
+//! produces the same text as
+//! <tt>usnprintf(s, n, "adc %u = 0x%03x, %.3f V\n", ...)</tt> through
+//!
+//! \verbatim
+//! int LogAdc(char *s, size_t n, uint32_t ui32Chan, uint32_t ui32Raw,
+//!            double dVolts);
+//! \endverbatim
+//!
+//! which returns the length of the full text as usnprintf() does.  The
+//! arguments have real types, so the compiler catches the wrong number of
+//! them or a pointer passed for a number, which a format string cannot.  The
+//! format is never parsed at run time: the list becomes a constant table of
+//! tUFmtOp and the arguments are packed into a structure for ufmtrun().
+//! The table and the structure type are also available, as NAME\#\#Ops()
+//! and tNAME\#\#Args, for other interpreters such as UARTStdioFmt().
+//!
+//! The definitions are static, so this belongs in the source file that uses
+//! the format.
+//
+//*****************************************************************************
+#define UFMT_DEFINE(NAME, LIST)                                               \
+    typedef struct                                                            \
+    {                                                                         \
+        char cUFmtNone;                                                       \
+        LIST(UFMT_FLD_)                                                       \
+    }                                                                         \
+    t##NAME##Args;                                                            \
+                                                                              \
+    static inline const tUFmtOp *                                             \
+    NAME##Ops(void)                                                           \
+    {                                                                         \
+        typedef t##NAME##Args tUFmtArgs;                                      \
+        static const tUFmtOp psOps[] =                                        \
+        {                                                                     \
+            LIST(UFMT_TBL_)                                                   \
+            { UFMT_END, 0, 0, 0, 0, sizeof(tUFmtArgs), 0 }                    \
+        };                                                                    \
+                                                                              \
+        return(psOps);                                                        \
+    }                                                                         \
+                                                                              \
+    static inline int                                                         \
+    NAME(char *pcUFmtBuf, size_t ui32UFmtSize LIST(UFMT_PRM_))                \
+    {                                                                         \
+        t##NAME##Args sUFmtArgs = { 0 LIST(UFMT_VAL_) };                      \
+                                                                              \
+        return(ufmtrun(pcUFmtBuf, ui32UFmtSize, NAME##Ops(), &sUFmtArgs));    \
+    }
+
+//*****************************************************************************
+//
+// The expansions of each piece of a UFMT_DEFINE() list: a field of the
+// argument structure, an entry of the table, a function parameter, and a
+// structure initializer.
+//
+//*****************************************************************************
+#define UFMT_FLD_LIT(s)
+#define UFMT_FLD_CHAR(name)     char name;
+#define UFMT_FLD_INT(name, fill, width)                                       \
+                                int32_t name;
+#define UFMT_FLD_UINT(name, fill, width)                                      \
+                                uint32_t name;
+#define UFMT_FLD_HEX(name, fill, width)                                       \
+                                uint32_t name;
+#define UFMT_FLD_STR(name, width)                                             \
+                                const char *name;
+#define UFMT_FLD_FLOAT(name, style, fill, width, prec)                        \
+                                double name;
+#define UFMT_FLD_FIXED(name, bits, fill, width, prec)                         \
+                                int32_t name;
+
+#define UFMT_TBL_LIT(s)                                                       \
+    { UFMT_LIT, 0, 0, 0, 0, sizeof("" s) - 1, "" s },
+#define UFMT_TBL_CHAR(name)                                                   \
+    { UFMT_CHAR, 0, 0, 0, 0, offsetof(tUFmtArgs, name), 0 },
+#define UFMT_TBL_INT(name, fill, width)                                       \
+    { UFMT_INT, fill, width, 0, 0, offsetof(tUFmtArgs, name), 0 },
+#define UFMT_TBL_UINT(name, fill, width)                                      \
+    { UFMT_UINT, fill, width, 0, 0, offsetof(tUFmtArgs, name), 0 },
+#define UFMT_TBL_HEX(name, fill, width)                                       \
+    { UFMT_HEX, fill, width, 0, 0, offsetof(tUFmtArgs, name), 0 },
+#define UFMT_TBL_STR(name, width)                                             \
+    { UFMT_STR, ' ', width, 0, 0, offsetof(tUFmtArgs, name), 0 },
+#define UFMT_TBL_FLOAT(name, style, fill, width, prec)                        \
+    { UFMT_FLOAT, fill, width, prec, style, offsetof(tUFmtArgs, name), 0 },
+#define UFMT_TBL_FIXED(name, bits, fill, width, prec)                         \
+    { UFMT_FIXED, fill, width, prec, bits, offsetof(tUFmtArgs, name), 0 },
+
+#define UFMT_PRM_LIT(s)
+#define UFMT_PRM_CHAR(name)     , char name
+#define UFMT_PRM_INT(name, fill, width)                                       \
+                                , int32_t name
+#define UFMT_PRM_UINT(name, fill, width)                                      \
+                                , uint32_t name
+#define UFMT_PRM_HEX(name, fill, width)                                       \
+                                , uint32_t name
+#define UFMT_PRM_STR(name, width)                                             \
+                                , const char *name
+#define UFMT_PRM_FLOAT(name, style, fill, width, prec)                        \
+                                , double name
+#define UFMT_PRM_FIXED(name, bits, fill, width, prec)                         \
+                                , int32_t name
+
+#define UFMT_VAL_LIT(s)
+#define UFMT_VAL_CHAR(name)     , name
+#define UFMT_VAL_INT(name, fill, width)                                       \
+                                , name
+#define UFMT_VAL_UINT(name, fill, width)                                      \
+                                , name
+#define UFMT_VAL_HEX(name, fill, width)                                       \
+                                , name
+#define UFMT_VAL_STR(name, width)                                             \
+                                , name
+#define UFMT_VAL_FLOAT(name, style, fill, width, prec)                        \
+                                , name
+#define UFMT_VAL_FIXED(name, bits, fill, width, prec)                         \
+                                , name
+
 //*****************************************************************************
 //
 // Prototypes for the APIs.
 //
 //*****************************************************************************
+extern uint32_t ufmtarg(const tUFmtOp *psOp, const void *pvArgs, char *pcBuf,
+                        const char **ppcStr);
+extern uint32_t ufmtfixed(char *pcBuf, int32_t i32Value,
+                          uint32_t ui32FracBits, uint32_t ui32Prec);
+extern uint32_t ufmtfloat(char *pcBuf, double dValue, char cFormat,
+                          uint32_t ui32Prec);
+extern int ufmtrun(char * restrict s, size_t n, const tUFmtOp *psOps,
+                   const void *pvArgs);
+extern int ufmtsink(tUSinkFxn pfnSink, void *pvSink, const tUFmtOp *psOps,
+                    const void *pvArgs);
 extern void ulocaltime(time_t timer, struct tm *tm);
+extern void ulocaltime64(int64_t i64Time, struct tm *tm);
 extern time_t umktime(struct tm *timeptr);
+extern int64_t umktime64(struct tm *timeptr);
+extern uint32_t unumdigits(uint32_t ui32Value, uint32_t ui32Base);
+extern void unumtostr(char *pcBuf, uint32_t ui32Value, uint32_t ui32Base,
+                      uint32_t ui32Digits);
 extern int urand(void);
+extern void urandfill(tURand *psRand, void *pvBuf, uint32_t ui32Len);
+extern float urandfloat(tURand *psRand);
+extern void urandjump(tURand *psRand);
+extern void urandlongjump(tURand *psRand);
+extern uint32_t urandnext(tURand *psRand);
+extern uint32_t urandrange(tURand *psRand, uint32_t ui32Bound);
+extern void urandseed(tURand *psRand, uint64_t ui64Seed);
+extern void usinkbuf(void *pvSink, const char *pcBuf, uint32_t ui32Len);
+extern int usinkprintf(tUSinkFxn pfnSink, void *pvSink, const char *format,
+                       ...);
 extern int usnprintf(char * restrict s, size_t n, const char * restrict format,
                      ...);
 extern int usprintf(char * restrict s, const char * restrict format, ...);
@@ -62,11 +375,20 @@ extern size_t ustrlen(const char *s);
 extern int ustrncasecmp(const char *s1, const char *s2, size_t n);
 extern int ustrncmp(const char *s1, const char *s2, size_t n);
 extern char *ustrncpy(char * restrict s1, const char * restrict s2, size_t n);
+extern char *ustrkeys(const char *s, const tUStrKeys *psKeys,
+                      uint32_t *pui32Key);
+extern void ustrkeysinit(tUStrKeys *psKeys, const char * const *ppcKeys,
+                         uint32_t ui32Count);
 extern char *ustrstr(const char *s1, const char *s2);
+extern double ustrtod(const char * restrict nptr,
+                      const char ** restrict endptr);
 extern float ustrtof(const char * restrict nptr,
                      const char ** restrict endptr);
 extern unsigned long int ustrtoul(const char * restrict nptr,
                                   const char ** restrict endptr, int base);
+extern void utimetick(struct tm *tm);
+extern int uvsinkprintf(tUSinkFxn pfnSink, void *pvSink, const char *format,
+                        va_list arg);
 extern int uvsnprintf(char * restrict s, size_t n,
                       const char * restrict format, va_list arg);
 
@@ -0,0 +1,399 @@
+/*
+ * Name: MIL_CANBridge.c
+ * Author: Marquez Jones
+ * Desc: Routing bridge between CAN0 and CAN1
+ *       see MIL_CANBridge.h
+ */
+
+/* INCLUDES */
+//includes
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_can.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/can.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+
+//MIL includes
+#include "MIL_CAN.h"
+#include "MIL_CANBridge.h"
+#include "MIL_CANTrace.h"
+
+/********************************************DEFINES******************************/
+
+#define QUEUE_MASK      (MIL_BRIDGE_QUEUE_SIZE - 1)
+
+//one token per frame, kept in thousandths so the 1ms refill is exact
+#define TOKEN_SCALE     1000
+
+/********************************************TYPES******************************/
+
+typedef struct {
+    uint32_t id;
+    uint32_t flags;         //MSG_OBJ_EXTENDED_ID | MSG_OBJ_REMOTE_FRAME
+    uint8_t  dlc;
+    uint8_t  data[8];       //not used for a remote frame
+} tBridgeFrame;
+
+/*
+ * Everything the ISRs need for one controller
+ */
+typedef struct {
+    uint32_t base;
+    tBridgeFrame queue[MIL_BRIDGE_QUEUE_SIZE];  //frames to transmit here
+    uint32_t head;
+    uint32_t tail;
+    uint32_t busy;                              //one bit per TX mailbox
+    tCANBridgeStats stats;
+} tBridgeCtl;
+
+/********************************************GLOBAL DATA******************************/
+
+static tBridgeCtl g_psCtl[2];
+
+static const tCANRoute *g_psRoutes;
+static tCANRouteState *g_psStates;
+static uint32_t g_ui32RouteCount;
+
+static volatile uint32_t g_ui32Ms = 0;
+
+/**************************************HELPERS********************************************/
+
+/*
+ * Desc: loads queued frames into free mailboxes
+ */
+static void TxPump(tBridgeCtl *psCtl){
+
+    tCANMsgObject sObj;
+
+    while((psCtl->head != psCtl->tail) && (psCtl->busy != 0xFF)){
+
+        tBridgeFrame *psFrame = &psCtl->queue[psCtl->tail & QUEUE_MASK];
+        uint32_t box = 0;
+
+        //lowest free mailbox
+        while(psCtl->busy & (1u << box)){
+            box++;
+        }
+
+        sObj.ui32MsgID = psFrame->id;
+        sObj.ui32MsgIDMask = 0;
+        sObj.ui32Flags = MSG_OBJ_TX_INT_ENABLE |
+                         (psFrame->flags & MSG_OBJ_EXTENDED_ID);
+        sObj.ui32MsgLen = psFrame->dlc;
+
+        //a remote frame goes out as a request with the same dlc, no data
+        if(psFrame->flags & MSG_OBJ_REMOTE_FRAME){
+            sObj.pui8MsgData = 0;
+            CANMessageSet(psCtl->base, MIL_BRIDGE_TX_OBJ_FIRST + box, &sObj,
+                          MSG_OBJ_TYPE_TX_REMOTE);
+        }
+        else{
+            sObj.pui8MsgData = psFrame->data;
+            CANMessageSet(psCtl->base, MIL_BRIDGE_TX_OBJ_FIRST + box, &sObj,
+                          MSG_OBJ_TYPE_TX);
+        }
+
+        psCtl->busy |= 1u << box;
+        psCtl->tail++;
+
+    }
+
+}
+
+/*
+ * Desc: token bucket check for one route
+ *
+ * Returns: true if the frame may be forwarded
+ */
+static bool RateAllow(const tCANRoute *psRoute, tCANRouteState *psState){
+
+    uint32_t now;
+    uint32_t cap;
+    uint32_t elapsed;
+
+    if(psRoute->max_rate == 0){
+        return true;
+    }
+
+    //refill rate frames/s = rate milli-frames per ms
+    now = g_ui32Ms;
+    cap = psRoute->max_burst * TOKEN_SCALE;
+    elapsed = now - psState->last_ms;
+
+    //an empty bucket is full again after cap / rate + 1 ms at the
+    //most, a longer gap adds nothing and would only overflow below
+    if(elapsed > ((cap / psRoute->max_rate) + 1)){
+        elapsed = (cap / psRoute->max_rate) + 1;
+    }
+
+    psState->tokens += elapsed * psRoute->max_rate;
+    if(psState->tokens > cap){
+        psState->tokens = cap;
+    }
+
+    psState->last_ms = now;
+
+    if(psState->tokens < TOKEN_SCALE){
+        return false;
+    }
+
+    psState->tokens -= TOKEN_SCALE;
+
+    return true;
+
+}
+
+/*
+ * Desc: routes one received frame to the other controller
+ */
+static void Route(mil_bridge_ctl src, const tBridgeFrame *psFrame){
+
+    bool ext = (psFrame->flags & MSG_OBJ_EXTENDED_ID) != 0;
+    tBridgeCtl *psDst = &g_psCtl[src ^ 1];
+    tBridgeFrame *psEntry;
+
+    for(uint32_t idx = 0; idx < g_ui32RouteCount; idx++){
+
+        const tCANRoute *psRoute = &g_psRoutes[idx];
+        tCANRouteState *psState = &g_psStates[idx];
+
+        if((psRoute->src != src) || (psRoute->extended != ext) ||
+           (psFrame->id < psRoute->id_first) ||
+           (psFrame->id > psRoute->id_last)){
+            continue;
+        }
+
+        //first match wins
+        if(!RateAllow(psRoute, psState)){
+            psState->rate_dropped++;
+            return;
+        }
+
+        if((psDst->head - psDst->tail) >= MIL_BRIDGE_QUEUE_SIZE){
+            psState->queue_dropped++;
+            return;
+        }
+
+        psEntry = &psDst->queue[psDst->head & QUEUE_MASK];
+
+        psEntry->id = (psFrame->id & psRoute->keep_mask) | psRoute->set_bits;
+
+        //set_bits can't push a standard ID past 11 bits
+        if(!ext){
+            psEntry->id &= MIL_BRIDGE_STD_ID_MASK;
+        }
+        psEntry->flags = psFrame->flags;
+        psEntry->dlc = psFrame->dlc;
+
+        //a remote frame has no payload to carry
+        if(!(psFrame->flags & MSG_OBJ_REMOTE_FRAME)){
+            for(uint32_t byte = 0; byte < psFrame->dlc; byte++){
+                psEntry->data[byte] = psFrame->data[byte];
+            }
+        }
+
+        psDst->head++;
+
+        psState->forwarded++;
+
+        //straight into a mailbox if one is free
+        TxPump(psDst);
+
+        return;
+
+    }
+
+    g_psCtl[src].stats.unrouted++;
+
+}
+
+/*
+ * Desc: sets up one controller's RX FIFO
+ */
+static void RxFifoInit(uint32_t base){
+
+    tCANMsgObject sObj;
+
+    sObj.ui32MsgID = 0;
+    sObj.ui32MsgIDMask = 0;
+    sObj.ui32MsgLen = 8;
+    sObj.pui8MsgData = 0;
+
+    for(uint32_t obj = MIL_BRIDGE_RX_OBJ_FIRST; obj <= MIL_BRIDGE_RX_OBJ_LAST;
+        obj++){
+
+        sObj.ui32Flags = MSG_OBJ_USE_ID_FILTER | MSG_OBJ_RX_INT_ENABLE;
+
+        //all but the last object chain into the next
+        if(obj != MIL_BRIDGE_RX_OBJ_LAST){
+            sObj.ui32Flags |= MSG_OBJ_FIFO;
+        }
+
+        CANMessageSet(base, obj, &sObj, MSG_OBJ_TYPE_RX);
+
+    }
+
+}
+
+/*
+ * Desc: common ISR body for both controllers
+ */
+static void BridgeISR(mil_bridge_ctl ctl){
+
+    tBridgeCtl *psCtl = &g_psCtl[ctl];
+    tCANMsgObject sObj;
+    tBridgeFrame sFrame;
+    uint32_t cause;
+
+    while((cause = CANIntStatus(psCtl->base, CAN_INT_STS_CAUSE)) != 0){
+
+        if(cause == CAN_INT_INTID_STATUS){
+
+            //reading the status register clears the interrupt
+            MIL_CANTraceRecordError(g_ui32Ms, ctl,
+                                    CANStatusGet(psCtl->base, CAN_STS_CONTROL));
+
+        }
+        else if(cause <= MIL_BRIDGE_RX_OBJ_LAST){
+
+            sObj.pui8MsgData = sFrame.data;
+
+            CANMessageGet(psCtl->base, cause, &sObj, true);
+
+            sFrame.id = sObj.ui32MsgID;
+            sFrame.flags = sObj.ui32Flags &
+                           (MSG_OBJ_EXTENDED_ID | MSG_OBJ_REMOTE_FRAME);
+            sFrame.dlc = sObj.ui32MsgLen;
+
+            if(sObj.ui32Flags & MSG_OBJ_DATA_LOST){
+                psCtl->stats.lost++;
+            }
+
+            psCtl->stats.received++;
+
+            MIL_CANTraceRecord(g_ui32Ms, ctl, &sObj);
+
+            Route(ctl, &sFrame);
+
+        }
+        else{
+
+            //TX mailbox done
+            CANIntClear(psCtl->base, cause);
+
+            psCtl->busy &= ~(1u << (cause - MIL_BRIDGE_TX_OBJ_FIRST));
+            psCtl->stats.sent++;
+
+        }
+
+    }
+
+    TxPump(psCtl);
+
+}
+
+/**************************************FUNCTIONS********************************************/
+
+/*
+ * Desc: initializes both controllers, the RX FIFOs, the
+ *       millisecond timer and the bridge interrupts
+ *
+ * Inputs: route table, matching state array(one per route),
+ *         number of routes, port CAN0 is wired to
+ * Assumes: Port A clock and CAN0 port clock enabled
+ */
+void MIL_CANBridgeInit(const tCANRoute *psRoutes, tCANRouteState *psStates,
+                       uint32_t count, mil_port can0_port){
+
+    g_psRoutes = psRoutes;
+    g_psStates = psStates;
+    g_ui32RouteCount = count;
+
+    //buckets start full
+    for(uint32_t idx = 0; idx < count; idx++){
+        psStates[idx].tokens = psRoutes[idx].max_burst * TOKEN_SCALE;
+        psStates[idx].last_ms = 0;
+        psStates[idx].forwarded = 0;
+        psStates[idx].rate_dropped = 0;
+        psStates[idx].queue_dropped = 0;
+    }
+
+    //trace timestamps are the millisecond tick
+    MIL_CANTraceInit(1000);
+
+    g_psCtl[MIL_BRIDGE_CAN0].base = CAN0_BASE;
+    g_psCtl[MIL_BRIDGE_CAN1].base = CAN1_BASE;
+
+    /************CAN***************/
+    MIL_InitCAN0(can0_port);
+    MIL_InitCAN1();
+
+    RxFifoInit(CAN0_BASE);
+    RxFifoInit(CAN1_BASE);
+
+    MIL_CAN0IntEnable(&MIL_CANBridgeCAN0ISR);
+    MIL_CAN1IntEnable(&MIL_CANBridgeCAN1ISR);
+
+    /************TIMER1***************/
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER1));
+
+    TimerConfigure(TIMER1_BASE, TIMER_CFG_PERIODIC);
+    TimerLoadSet(TIMER1_BASE, TIMER_A, (SysCtlClockGet() / 1000) - 1);
+    TimerIntRegister(TIMER1_BASE, TIMER_A, &MIL_CANBridgeTimer1ISR);
+    TimerIntEnable(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+    IntEnable(INT_TIMER1A);
+    TimerEnable(TIMER1_BASE, TIMER_A);
+
+}
+
+/*
+ * Desc: copies the counters for one controller
+ */
+void MIL_CANBridgeStatsGet(mil_bridge_ctl ctl, tCANBridgeStats *psStats){
+
+    bool masked = IntMasterDisable();
+
+    *psStats = g_psCtl[ctl].stats;
+
+    if(!masked){
+        IntMasterEnable();
+    }
+
+}
+
+/********************************************ISR DEFINITIONS******************************/
+
+/*
+ * Desc: CAN0 ISR, forwards CAN0 -> CAN1
+ */
+void MIL_CANBridgeCAN0ISR(void){
+
+    BridgeISR(MIL_BRIDGE_CAN0);
+
+}
+
+/*
+ * Desc: CAN1 ISR, forwards CAN1 -> CAN0
+ */
+void MIL_CANBridgeCAN1ISR(void){
+
+    BridgeISR(MIL_BRIDGE_CAN1);
+
+}
+
+/*
+ * Desc: Timer1 ISR, millisecond tick for the rate limits
+ */
+void MIL_CANBridgeTimer1ISR(void){
+
+    TimerIntClear(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+
+    g_ui32Ms++;
+
+}
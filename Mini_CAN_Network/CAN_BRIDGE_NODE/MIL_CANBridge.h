@@ -0,0 +1,142 @@
+/*
+ * Name: MIL_CANBridge.h
+ * Author: Marquez Jones
+ * Desc: Routing bridge between CAN0 and CAN1
+ *       Splits one busy bus into two lower load segments by only
+ *       forwarding the frames each side actually needs
+ *
+ * Routing:
+ *       The application supplies a table of routes. A frame
+ *       received on the route's source controller whose ID is in
+ *       [id_first, id_last] is forwarded to the other controller.
+ *       The first matching route wins, frames matching no route
+ *       stay on their own segment
+ *
+ *       ID rewrite: out_id = (id & keep_mask) | set_bits
+ *       use keep_mask = MIL_BRIDGE_ID_KEEP and set_bits = 0 to
+ *       forward unchanged, a standard frame keeps only the low
+ *       11 bits of the result
+ *
+ *       Rate limit: token bucket of max_rate frames per second
+ *       with a burst of max_burst frames(at least 1), max_rate = 0
+ *       disables it. The bucket refills by max_rate thousandths of a
+ *       frame per millisecond up to max_burst frames, so a rate above
+ *       1000 frames/s lets more than one frame through per tick
+ *
+ * Notes: Forwarding is ISR to ISR. The receiving controller's ISR
+ *        matches the route and loads the frame straight into a free
+ *        mailbox on the other controller, or queues it for the
+ *        other controller's TX complete interrupt. The main loop is
+ *        never involved
+ *
+ *        CAN0, CAN1 and Timer1A interrupts must stay at the same
+ *        priority since the queues assume they never preempt each
+ *        other
+ *
+ *        Every received frame and bus error is also logged by
+ *        MIL_CANTrace, the application decides when to export it
+ *
+ * Hardware Notes:
+ *       CAN0 on the port given to MIL_CANBridgeInit
+ *       CAN1 PA0 - CANRX  PA1 - CANTX
+ */
+
+#ifndef MIL_CANBRIDGE_H_
+#define MIL_CANBRIDGE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//MIL includes
+#include "MIL_CAN.h"
+
+/****************************CONFIG*************************************/
+
+//frames waiting for a mailbox on each controller, power of two
+#ifndef MIL_BRIDGE_QUEUE_SIZE
+#define MIL_BRIDGE_QUEUE_SIZE   32
+#endif
+
+//message objects 1-24 form the RX FIFO, 25-32 are TX mailboxes
+#define MIL_BRIDGE_RX_OBJ_FIRST 1
+#define MIL_BRIDGE_RX_OBJ_LAST  24
+#define MIL_BRIDGE_TX_OBJ_FIRST 25
+#define MIL_BRIDGE_TX_OBJ_LAST  32
+
+//keep every ID bit
+#define MIL_BRIDGE_ID_KEEP      0x1FFFFFFF
+
+//ID bits of a standard frame
+#define MIL_BRIDGE_STD_ID_MASK  0x7FF
+
+/****************************TYPES**************************************/
+
+/*
+ * Desc: controller selection
+ */
+typedef enum {
+    MIL_BRIDGE_CAN0,
+    MIL_BRIDGE_CAN1
+}mil_bridge_ctl;
+
+/*
+ * Desc: one routing table entry(can live in flash)
+ */
+typedef struct {
+    mil_bridge_ctl src;     //controller the frame arrives on
+    uint32_t id_first;      //ID range, inclusive
+    uint32_t id_last;
+    bool     extended;      //range applies to extended IDs
+    uint32_t keep_mask;     //ID rewrite
+    uint32_t set_bits;
+    uint32_t max_rate;      //frames per second, 0 = unlimited
+    uint32_t max_burst;     //frames
+} tCANRoute;
+
+/*
+ * Desc: per route run time state and counters(RAM)
+ */
+typedef struct {
+    uint32_t tokens;        //milli-frames
+    uint32_t last_ms;
+    uint32_t forwarded;     //frames forwarded
+    uint32_t rate_dropped;  //frames over the rate limit
+    uint32_t queue_dropped; //frames lost because the queue was full
+} tCANRouteState;
+
+/*
+ * Desc: per controller counters
+ */
+typedef struct {
+    uint32_t received;      //frames received
+    uint32_t unrouted;      //frames no route wanted
+    uint32_t sent;          //frames transmitted
+    uint32_t lost;          //frames overwritten in the RX FIFO
+} tCANBridgeStats;
+
+/****************************FUNCTIONS**********************************/
+
+/*
+ * Desc: initializes both controllers, the RX FIFOs, the
+ *       millisecond timer and the bridge interrupts
+ *
+ * Inputs: route table, matching state array(one per route),
+ *         number of routes, port CAN0 is wired to
+ * Assumes: Port A clock and CAN0 port clock enabled
+ */
+void MIL_CANBridgeInit(const tCANRoute *psRoutes, tCANRouteState *psStates,
+                       uint32_t count, mil_port can0_port);
+
+/*
+ * Desc: copies the counters for one controller
+ */
+void MIL_CANBridgeStatsGet(mil_bridge_ctl ctl, tCANBridgeStats *psStats);
+
+/*
+ * Desc: ISRs registered by MIL_CANBridgeInit
+ */
+void MIL_CANBridgeCAN0ISR(void);
+void MIL_CANBridgeCAN1ISR(void);
+void MIL_CANBridgeTimer1ISR(void);
+
+#endif /* MIL_CANBRIDGE_H_ */
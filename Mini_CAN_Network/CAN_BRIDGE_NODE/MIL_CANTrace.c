@@ -0,0 +1,490 @@
+/*
+ * Name: MIL_CANTrace.c
+ * Author: Marquez Jones
+ * Desc: Always on CAN trace logger
+ *       see MIL_CANTrace.h
+ */
+
+/* INCLUDES */
+//includes
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/can.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/uart.h"
+
+//MIL includes
+#include "MIL_CANTrace.h"
+
+/********************************************DEFINES******************************/
+
+#define TRACE_MASK              (MIL_TRACE_SIZE - 1)
+
+//controller states worth a record when they change
+#define ERR_STATE_BITS          (CAN_STATUS_BUS_OFF | CAN_STATUS_EWARN | \
+                                 CAN_STATUS_EPASS)
+
+//Linux CAN error frame encoding(linux/can/error.h)
+#define CAN_ERR_FLAG            0x20000000
+#define CAN_ERR_CRTL            0x00000004
+#define CAN_ERR_PROT            0x00000008
+#define CAN_ERR_ACK             0x00000020
+#define CAN_ERR_BUSOFF          0x00000040
+
+#define CAN_ERR_CRTL_RX_WARNING 0x04
+#define CAN_ERR_CRTL_TX_WARNING 0x08
+#define CAN_ERR_CRTL_RX_PASSIVE 0x10
+#define CAN_ERR_CRTL_TX_PASSIVE 0x20
+
+#define CAN_ERR_PROT_FORM       0x02
+#define CAN_ERR_PROT_STUFF      0x04
+#define CAN_ERR_PROT_BIT0       0x08
+#define CAN_ERR_PROT_BIT1       0x10
+#define CAN_ERR_PROT_LOC_CRC_SEQ 0x08
+
+/********************************************GLOBAL DATA******************************/
+
+static tCANTraceRecord g_psRing[MIL_TRACE_SIZE];
+
+//next record to write, the oldest one once the ring is full
+static uint32_t g_ui32Head = 0;
+static bool g_bFull = false;
+
+static volatile mil_trace_state g_eState = MIL_TRACE_RUNNING;
+
+//trigger
+static bool g_bTrigArmed = false;
+static bool g_bTrigOnError = false;
+static uint32_t g_ui32TrigId = 0;
+static uint32_t g_ui32TrigMask = 0;
+static uint32_t g_ui32TrigPost = 0;
+static uint32_t g_ui32PostLeft = 0;
+
+//the trigger fired and nobody has exported or discarded the capture
+static bool g_bUnread = false;
+
+//last error state recorded per controller
+static uint32_t g_pui32ErrState[2];
+
+static uint32_t g_ui32TicksPerSec = 1000;
+
+/**************************************HELPERS********************************************/
+
+/*
+ * Desc: starts the post trigger countdown
+ */
+static void Fire(uint32_t post){
+
+    g_bTrigArmed = false;
+    g_bUnread = true;
+
+    if(post == 0){
+        g_eState = MIL_TRACE_FROZEN;
+    }
+    else{
+        g_ui32PostLeft = post;
+        g_eState = MIL_TRACE_TRIGGERED;
+    }
+
+}
+
+/*
+ * Desc: trigger and freeze bookkeeping after a record is written
+ */
+static void Advance(bool fire){
+
+    g_ui32Head = (g_ui32Head + 1) & TRACE_MASK;
+
+    if(g_ui32Head == 0){
+        g_bFull = true;
+    }
+
+    if(g_eState == MIL_TRACE_TRIGGERED){
+        if(--g_ui32PostLeft == 0){
+            g_eState = MIL_TRACE_FROZEN;
+        }
+    }
+    else if(fire){
+        Fire(g_ui32TrigPost);
+    }
+
+}
+
+/*
+ * Desc: blocking string and number output for the exporter
+ */
+static void PutStr(uint32_t base, const char *str){
+
+    while(*str){
+        UARTCharPut(base, *str++);
+    }
+
+}
+
+static void PutHex(uint32_t base, uint32_t value, uint32_t digits){
+
+    static const char hex[] = "0123456789ABCDEF";
+
+    while(digits--){
+        UARTCharPut(base, hex[(value >> (digits * 4)) & 0xF]);
+    }
+
+}
+
+static void PutDec(uint32_t base, uint32_t value, uint32_t digits){
+
+    char buf[10];
+
+    for(uint32_t idx = digits; idx > 0; idx--){
+        buf[idx - 1] = '0' + (value % 10);
+        value /= 10;
+    }
+
+    for(uint32_t idx = 0; idx < digits; idx++){
+        UARTCharPut(base, buf[idx]);
+    }
+
+}
+
+/*
+ * Desc: converts an error record to a Linux CAN error frame
+ */
+static uint32_t ErrorFrame(const tCANTraceRecord *psRec, uint8_t *data){
+
+    uint32_t id = CAN_ERR_FLAG;
+    uint32_t status = psRec->id;
+
+    memset(data, 0, 8);
+
+    switch(status & CAN_STATUS_LEC_MSK){
+
+        case CAN_STATUS_LEC_STUFF:
+            id |= CAN_ERR_PROT;
+            data[2] = CAN_ERR_PROT_STUFF;
+            break;
+        case CAN_STATUS_LEC_FORM:
+            id |= CAN_ERR_PROT;
+            data[2] = CAN_ERR_PROT_FORM;
+            break;
+        case CAN_STATUS_LEC_ACK:
+            id |= CAN_ERR_ACK;
+            break;
+        case CAN_STATUS_LEC_BIT1:
+            id |= CAN_ERR_PROT;
+            data[2] = CAN_ERR_PROT_BIT1;
+            break;
+        case CAN_STATUS_LEC_BIT0:
+            id |= CAN_ERR_PROT;
+            data[2] = CAN_ERR_PROT_BIT0;
+            break;
+        case CAN_STATUS_LEC_CRC:
+            id |= CAN_ERR_PROT;
+            data[3] = CAN_ERR_PROT_LOC_CRC_SEQ;
+            break;
+        default:
+            break;
+
+    }
+
+    //the controller doesn't say which direction, report both
+    if(status & CAN_STATUS_EWARN){
+        id |= CAN_ERR_CRTL;
+        data[1] |= CAN_ERR_CRTL_RX_WARNING | CAN_ERR_CRTL_TX_WARNING;
+    }
+
+    if(status & CAN_STATUS_EPASS){
+        id |= CAN_ERR_CRTL;
+        data[1] |= CAN_ERR_CRTL_RX_PASSIVE | CAN_ERR_CRTL_TX_PASSIVE;
+    }
+
+    if(status & CAN_STATUS_BUS_OFF){
+        id |= CAN_ERR_BUSOFF;
+    }
+
+    return id;
+
+}
+
+/*
+ * Desc: writes one record as a candump -L line
+ *
+ *       (ssssssssss.uuuuuu) canN III#DDDD
+ */
+static void ExportRecord(uint32_t base, const tCANTraceRecord *psRec){
+
+    uint32_t sec = psRec->ts / g_ui32TicksPerSec;
+    uint32_t frac = psRec->ts % g_ui32TicksPerSec;
+    uint32_t usec = (uint32_t)(((uint64_t)frac * 1000000) / g_ui32TicksPerSec);
+    uint8_t err_data[8];
+    const uint8_t *data = psRec->data;
+    uint32_t dlc = psRec->dlc;
+
+    UARTCharPut(base, '(');
+    PutDec(base, sec, 10);
+    UARTCharPut(base, '.');
+    PutDec(base, usec, 6);
+    PutStr(base, ") can");
+    UARTCharPut(base, '0' + psRec->chan);
+    UARTCharPut(base, ' ');
+
+    if(psRec->flags & MIL_TRACE_ERR){
+        PutHex(base, ErrorFrame(psRec, err_data), 8);
+        data = err_data;
+        dlc = 8;
+    }
+    else if(psRec->flags & MIL_TRACE_EXT){
+        PutHex(base, psRec->id, 8);
+    }
+    else{
+        PutHex(base, psRec->id, 3);
+    }
+
+    UARTCharPut(base, '#');
+
+    if(psRec->flags & MIL_TRACE_RTR){
+        UARTCharPut(base, 'R');
+    }
+    else{
+        for(uint32_t idx = 0; idx < dlc; idx++){
+            PutHex(base, data[idx], 2);
+        }
+    }
+
+    PutStr(base, "\r\n");
+
+}
+
+/**************************************FUNCTIONS********************************************/
+
+/*
+ * Desc: clears the ring and starts recording
+ *
+ * Inputs: timestamp ticks per second(1000 for a ms tick),
+ *         used only to print timestamps
+ */
+void MIL_CANTraceInit(uint32_t ticks_per_sec){
+
+    g_ui32TicksPerSec = ticks_per_sec;
+    g_bTrigArmed = false;
+
+    MIL_CANTraceRestart();
+
+}
+
+/*
+ * Desc: records one received frame
+ *
+ * Notes: hot path, keep it branch light
+ *
+ * Inputs: timestamp, controller number(0 = can0),
+ *         frame as returned by CANMessageGet
+ */
+void MIL_CANTraceRecord(uint32_t ts, uint32_t chan, const tCANMsgObject *psMsg){
+
+    tCANTraceRecord *psRec;
+
+    if(g_eState == MIL_TRACE_FROZEN){
+        return;
+    }
+
+    psRec = &g_psRing[g_ui32Head];
+
+    psRec->ts = ts;
+    psRec->id = psMsg->ui32MsgID;
+    psRec->flags = psMsg->ui32Flags &
+                   (MIL_TRACE_EXT | MIL_TRACE_RTR | MIL_TRACE_LOST);
+    psRec->chan = chan;
+    psRec->dlc = psMsg->ui32MsgLen;
+
+    //fixed size copy becomes two word moves, a remote frame
+    //has no payload and its buffer was never filled
+    if(psMsg->ui32Flags & MSG_OBJ_REMOTE_FRAME){
+        memset(psRec->data, 0, 8);
+    }
+    else{
+        memcpy(psRec->data, psMsg->pui8MsgData, 8);
+    }
+
+    Advance(g_bTrigArmed && (g_ui32TrigMask != 0) &&
+            (((psMsg->ui32MsgID ^ g_ui32TrigId) & g_ui32TrigMask) == 0));
+
+}
+
+/*
+ * Desc: records a bus error or error state change
+ *
+ * Notes: the error states(warning, passive, bus off) are only
+ *        recorded when they change so a node sitting in error
+ *        passive doesn't flood the ring
+ *
+ * Inputs: timestamp, controller number,
+ *         value read from CANStatusGet(base, CAN_STS_CONTROL)
+ */
+void MIL_CANTraceRecordError(uint32_t ts, uint32_t chan, uint32_t status){
+
+    tCANTraceRecord *psRec;
+    uint32_t lec = status & CAN_STATUS_LEC_MSK;
+    uint32_t state = status & ERR_STATE_BITS;
+
+    if((lec == CAN_STATUS_LEC_NONE) || (lec == CAN_STATUS_LEC_MSK)){
+
+        if(state == g_pui32ErrState[chan & 1]){
+            return;
+        }
+
+        //no new bus error, only the state changed
+        status &= ~CAN_STATUS_LEC_MSK;
+
+    }
+
+    g_pui32ErrState[chan & 1] = state;
+
+    if(g_eState == MIL_TRACE_FROZEN){
+        return;
+    }
+
+    psRec = &g_psRing[g_ui32Head];
+
+    psRec->ts = ts;
+    psRec->id = status;
+    psRec->flags = MIL_TRACE_ERR;
+    psRec->chan = chan;
+    psRec->dlc = 0;
+
+    Advance(g_bTrigArmed && g_bTrigOnError);
+
+}
+
+/*
+ * Desc: arms the trigger
+ *
+ * Inputs: id/mask - fires on a frame with (frame_id & mask) == (id & mask)
+ *                   mask = 0 disables ID matching
+ *         on_error - also fires on any recorded bus error
+ *         post - records to take after the trigger before freezing
+ * Returns: false if a capture hasn't been read yet, nothing changes
+ *
+ * Notes: restarts recording if the trace was frozen and read
+ */
+bool MIL_CANTraceTriggerSet(uint32_t id, uint32_t mask, bool on_error,
+                            uint32_t post){
+
+    bool masked = IntMasterDisable();
+
+    //triggered or frozen by the trigger, keep the capture
+    if(g_bUnread){
+        if(!masked){
+            IntMasterEnable();
+        }
+        return false;
+    }
+
+    g_ui32TrigId = id;
+    g_ui32TrigMask = mask;
+    g_bTrigOnError = on_error;
+    g_ui32TrigPost = post;
+    g_bTrigArmed = true;
+
+    if(g_eState != MIL_TRACE_RUNNING){
+        g_ui32Head = 0;
+        g_bFull = false;
+        g_eState = MIL_TRACE_RUNNING;
+    }
+
+    if(!masked){
+        IntMasterEnable();
+    }
+
+    return true;
+
+}
+
+/*
+ * Desc: fires the trigger by hand
+ *
+ * Inputs: records to take before freezing, 0 freezes immediately
+ */
+void MIL_CANTraceTrigger(uint32_t post){
+
+    bool masked = IntMasterDisable();
+
+    if(g_eState == MIL_TRACE_RUNNING){
+        Fire(post);
+    }
+
+    if(!masked){
+        IntMasterEnable();
+    }
+
+}
+
+/*
+ * Desc: clears the ring and resumes recording,
+ *       an armed trigger stays armed
+ *
+ * Notes: discards a capture that hasn't been read
+ */
+void MIL_CANTraceRestart(void){
+
+    bool masked = IntMasterDisable();
+
+    g_ui32Head = 0;
+    g_bFull = false;
+    g_bUnread = false;
+    g_pui32ErrState[0] = 0;
+    g_pui32ErrState[1] = 0;
+    g_eState = MIL_TRACE_RUNNING;
+
+    if(!masked){
+        IntMasterEnable();
+    }
+
+}
+
+/*
+ * Desc: returns the current state
+ */
+mil_trace_state MIL_CANTraceStateGet(void){
+
+    return g_eState;
+
+}
+
+/*
+ * Desc: streams the ring over a UART in candump -L format
+ *
+ * Inputs: UART base
+ * Returns: records written
+ *
+ * Notes: freezes the trace first so the records can't change
+ *        underneath the export, call MIL_CANTraceRestart afterwards
+ */
+uint32_t MIL_CANTraceExport(uint32_t uart_base){
+
+    uint32_t first;
+    uint32_t count;
+
+    //a single store, the ISRs see either state
+    g_eState = MIL_TRACE_FROZEN;
+    g_bUnread = false;
+
+    //oldest record is head once the ring has wrapped
+    if(g_bFull){
+        first = g_ui32Head;
+        count = MIL_TRACE_SIZE;
+    }
+    else{
+        first = 0;
+        count = g_ui32Head;
+    }
+
+    for(uint32_t idx = 0; idx < count; idx++){
+        ExportRecord(uart_base, &g_psRing[(first + idx) & TRACE_MASK]);
+    }
+
+    return count;
+
+}
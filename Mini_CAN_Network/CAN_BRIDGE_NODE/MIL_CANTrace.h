@@ -0,0 +1,171 @@
+/*
+ * Name: MIL_CANTrace.h
+ * Author: Marquez Jones
+ * Desc: Always on CAN trace logger
+ *       Keeps the most recent frames in a RAM ring so there's a
+ *       record to look at when the bus misbehaves in the field
+ *
+ * Recording:
+ *       The CAN ISR calls MIL_CANTraceRecord for every received
+ *       frame and MIL_CANTraceRecordError for bus errors. Each call
+ *       copies one fixed 20 byte record into the ring and bumps an
+ *       index, no loops and no division, so it costs a few dozen
+ *       cycles and can stay enabled in production. When the ring is
+ *       full the oldest record is overwritten
+ *
+ * Trigger/freeze:
+ *       MIL_CANTraceTriggerSet arms a trigger on an ID match and/or
+ *       on bus errors. Once it fires, post more records are taken
+ *       and then the ring freezes, leaving the history leading up to
+ *       the event plus what followed it. MIL_CANTraceTrigger fires
+ *       it by hand(button, command, fault handler). The trigger
+ *       can't be re-armed until the capture has been exported or
+ *       thrown away with MIL_CANTraceRestart
+ *
+ * Export:
+ *       MIL_CANTraceExport streams the ring oldest first over a UART
+ *       in candump -L log format so it can be fed straight into
+ *       can-utils(canplayer, log2asc) or read by eye:
+ *
+ *       (0000000012.345000) can0 123#DEADBEEF
+ *       (0000000012.346000) can1 12345678#R
+ *       (0000000012.350000) can0 20000088#0000080000000000
+ *
+ *       Bus errors come out as Linux CAN error frames
+ *
+ * Notes: MIL_CANTraceRecord and MIL_CANTraceRecordError must only be
+ *        called from ISRs of the same priority. The rest of the API
+ *        is for the main loop
+ */
+
+#ifndef MIL_CANTRACE_H_
+#define MIL_CANTRACE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driverlib/can.h"
+
+/****************************CONFIG*************************************/
+
+//records kept, power of two(20 bytes each)
+#ifndef MIL_TRACE_SIZE
+#define MIL_TRACE_SIZE          256
+#endif
+
+//record flags
+#define MIL_TRACE_EXT           MSG_OBJ_EXTENDED_ID
+#define MIL_TRACE_RTR           MSG_OBJ_REMOTE_FRAME
+#define MIL_TRACE_LOST          MSG_OBJ_DATA_LOST
+#define MIL_TRACE_ERR           0x8000
+
+/****************************TYPES**************************************/
+
+/*
+ * Desc: one trace record
+ *
+ * Notes: for MIL_TRACE_ERR records id holds the controller status
+ *        register(CAN_STS_CONTROL) instead of a CAN ID
+ */
+typedef struct {
+    uint32_t ts;            //caller's time base
+    uint32_t id;
+    uint16_t flags;         //MIL_TRACE_xxx
+    uint8_t  chan;          //controller number
+    uint8_t  dlc;
+    uint8_t  data[8];
+} tCANTraceRecord;
+
+/*
+ * Desc: trace states
+ */
+typedef enum {
+    MIL_TRACE_RUNNING,      //recording, trigger(if armed) not seen yet
+    MIL_TRACE_TRIGGERED,    //trigger seen, taking post trigger records
+    MIL_TRACE_FROZEN        //ring no longer changes
+}mil_trace_state;
+
+/****************************FUNCTIONS**********************************/
+
+/*
+ * Desc: clears the ring and starts recording
+ *
+ * Inputs: timestamp ticks per second(1000 for a ms tick),
+ *         used only to print timestamps
+ */
+void MIL_CANTraceInit(uint32_t ticks_per_sec);
+
+/*
+ * Desc: records one received frame
+ *
+ * Inputs: timestamp, controller number(0 = can0),
+ *         frame as returned by CANMessageGet
+ *
+ * Assumes: pui8MsgData points at an 8 byte buffer, all 8
+ *          bytes are copied regardless of length(none for a
+ *          remote frame, its payload is recorded as zeros)
+ *          called from ISR
+ */
+void MIL_CANTraceRecord(uint32_t ts, uint32_t chan, const tCANMsgObject *psMsg);
+
+/*
+ * Desc: records a bus error or error state change
+ *
+ * Inputs: timestamp, controller number,
+ *         value read from CANStatusGet(base, CAN_STS_CONTROL)
+ *
+ * Notes: does nothing when the status holds no error
+ * Assumes: called from ISR
+ */
+void MIL_CANTraceRecordError(uint32_t ts, uint32_t chan, uint32_t status);
+
+/*
+ * Desc: arms the trigger
+ *
+ * Inputs: id/mask - fires on a frame with (frame_id & mask) == (id & mask)
+ *                   mask = 0 disables ID matching
+ *         on_error - also fires on any recorded bus error
+ *         post - records to take after the trigger before freezing
+ * Returns: false if the trigger fired and the capture hasn't been
+ *          exported(MIL_CANTraceExport) or discarded
+ *          (MIL_CANTraceRestart) yet, nothing changes
+ *
+ * Notes: restarts recording if the trace was frozen and read
+ */
+bool MIL_CANTraceTriggerSet(uint32_t id, uint32_t mask, bool on_error,
+                            uint32_t post);
+
+/*
+ * Desc: fires the trigger by hand
+ *
+ * Inputs: records to take before freezing, 0 freezes immediately
+ */
+void MIL_CANTraceTrigger(uint32_t post);
+
+/*
+ * Desc: clears the ring and resumes recording,
+ *       an armed trigger stays armed
+ *
+ * Notes: discards a capture that hasn't been read
+ */
+void MIL_CANTraceRestart(void);
+
+/*
+ * Desc: returns the current state
+ */
+mil_trace_state MIL_CANTraceStateGet(void);
+
+/*
+ * Desc: streams the ring over a UART in candump -L format
+ *
+ * Inputs: UART base
+ * Returns: records written
+ *
+ * Notes: freezes the trace first so the records can't change
+ *        underneath the export, call MIL_CANTraceRestart afterwards
+ *        blocks until every line is in the UART FIFO
+ *
+ * Assumes: UART already configured
+ */
+uint32_t MIL_CANTraceExport(uint32_t uart_base);
+
+#endif /* MIL_CANTRACE_H_ */
@@ -0,0 +1,162 @@
+/*
+ * Name: CAN_BRIDGE_NODE
+ * Author: Marquez Jones
+ * Desc: Splits the lab bus into two segments with CAN0 and CAN1
+ *       and forwards only the frames listed in the routing table
+ *
+ * Notes:
+ *       forwarding is fully interrupt driven, main only sets things
+ *       up and serves the trace dump
+ *       routing details are in MIL_CANBridge.h
+ *
+ *       Trace: send any character on the UART to get the trace ring
+ *       back in candump -L format, recording restarts afterwards.
+ *       The trace freezes on its own 32 frames after a bus error
+ *
+ *       Example segments:
+ *       CAN0 - motor controllers(0x100-0x1FF)
+ *       CAN1 - sensors(0x200-0x27F) and the LCD node(0x300)
+ *
+ * Hardware Notes:
+ *                 CAN0 on Port B
+ *                 PB4 - CANRX
+ *                 PB5 - CANTX
+ *
+ *                 CAN1 on Port A
+ *                 PA0 - CANRX
+ *                 PA1 - CANTX
+ *
+ *                 Each segment needs its own transceiver and
+ *                 termination resistors(120 Ohms) on each node
+ *
+ *                 UART1 on Port B(115.2k) for the trace dump
+ *                 PB0 - UART RX
+ *                 PB1 - UART TX
+ */
+
+//includes
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_can.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/can.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/uart.h"
+
+//MIL Includes
+#include "MIL_CAN.h"
+#include "MIL_CANBridge.h"
+#include "MIL_CANTrace.h"
+
+/********************************************FXN PROTO******************************/
+
+/*
+ * Desc: UART1 for the trace dump, polled
+ *       115.2k 8N1
+ */
+void InitTraceUART(void);
+
+/********************************************ROUTING TABLE******************************/
+
+/*
+ * src, id_first, id_last, extended, keep_mask, set_bits, max_rate, max_burst
+ */
+static const tCANRoute g_psRoutes[] = {
+
+    //motor status up to the sensor segment
+    {MIL_BRIDGE_CAN0, 0x100, 0x1FF, false, MIL_BRIDGE_ID_KEEP, 0, 0, 0},
+
+    //sensor data down to the motors, at most 200 frames/s
+    {MIL_BRIDGE_CAN1, 0x200, 0x27F, false, MIL_BRIDGE_ID_KEEP, 0, 200, 10},
+
+    //LCD node messages show up as 0x380 on the motor segment
+    {MIL_BRIDGE_CAN1, 0x300, 0x300, false, 0x07F, 0x380, 50, 5},
+
+};
+
+#define ROUTE_COUNT (sizeof(g_psRoutes) / sizeof(g_psRoutes[0]))
+
+//per route counters, watch these in the debugger
+static tCANRouteState g_psRouteStates[ROUTE_COUNT];
+
+/*********************************************MAIN**********************************/
+
+int main(void){
+
+    //set system clock to 16MHZ
+    SysCtlClockSet(SYSCTL_SYSDIV_1 |
+                   SYSCTL_USE_OSC  |
+                   SYSCTL_OSC_MAIN |
+                   SYSCTL_XTAL_16MHZ);
+
+    /************BRIDGE INIT START***************/
+
+    //enable gpio clocks for both controllers
+    /*
+     * Check MIL_CAN.h for when this function
+     * should be used
+     */
+    MIL_CANPortClkEnable(MIL_PORT_A);
+    MIL_CANPortClkEnable(MIL_PORT_B);
+
+    MIL_CANBridgeInit(g_psRoutes, g_psRouteStates, ROUTE_COUNT, MIL_PORT_B);
+
+    //keep the history around the first bus error
+    MIL_CANTraceTriggerSet(0, 0, true, 32);
+
+    /************BRIDGE INIT END***************/
+
+    InitTraceUART();
+
+    IntMasterEnable();
+
+    while(1){
+
+        //frames are forwarded ISR to ISR, main only dumps the trace
+        if(UARTCharsAvail(UART1_BASE)){
+
+            UARTCharGet(UART1_BASE);
+
+            MIL_CANTraceExport(UART1_BASE);
+
+            //re-arm and start over
+            MIL_CANTraceTriggerSet(0, 0, true, 32);
+
+        }
+
+    }
+
+}
+
+/**************************************FUNCTION DEFINITIONS********************************************/
+
+/*
+ * Desc: UART1 for the trace dump, polled
+ *       115.2k 8N1
+ *
+ * Hardware Notes: UART1 on Port B used
+ *       UART RX: PB0
+ *       UART TX: PB1
+ */
+void InitTraceUART(void){
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART1);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UART1));
+
+    //Port B clock is already on for CAN0
+    GPIOPinConfigure(GPIO_PB0_U1RX);
+    GPIOPinConfigure(GPIO_PB1_U1TX);
+    GPIOPinTypeUART(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+
+    UARTConfigSetExpClk(UART1_BASE, SysCtlClockGet(), 115200,
+                        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+                            UART_CONFIG_PAR_NONE));
+
+    UARTEnable(UART1_BASE);
+
+}
@@ -0,0 +1,64 @@
+/*
+ * Name: CANDB_Signals.h
+ * Author: Marquez Jones
+ * Desc: Signal database for the Mini CAN Network
+ *       This is the DBC-like description that MIL_CANDB.h
+ *       turns into pack/unpack code
+ *
+ * How to add a message:
+ *       1. add a signal list macro CANDB_SIGS_<Msg>(SIG, M)
+ *          with one SIG(M, name, start, len, order, sign, factor, offset)
+ *          per signal
+ *            start  - DBC start bit
+ *            len    - length in bits(1-32)
+ *            order  - LE(Intel) or BE(Motorola)
+ *            sign   - UNSIGNED or SIGNED
+ *            factor - physical = raw * factor + offset
+ *       2. add MSG(<Msg>, id, dlc, flags, CANDB_SIGS_<Msg>) to
+ *          CANDB_MESSAGES
+ *
+ * Notes: both nodes on the bus must use the same copy of this file
+ */
+
+#ifndef CANDB_SIGNALS_H_
+#define CANDB_SIGNALS_H_
+
+/*
+ * Periodic node status
+ */
+#define CANDB_SIGS_NodeStatus(SIG, M)                                  \
+    SIG(M, Uptime,      0,  24, LE, UNSIGNED, 1,     0)                \
+    SIG(M, Temperature, 24, 10, LE, SIGNED,   0.25f, 0)                \
+    SIG(M, BusLoad,     34, 7,  LE, UNSIGNED, 1,     0)                \
+    SIG(M, ErrorFlags,  41, 8,  LE, UNSIGNED, 1,     0)                \
+    SIG(M, Counter,     60, 4,  LE, UNSIGNED, 1,     0)
+
+/*
+ * Motor command(Motorola byte order like most of our motor drivers)
+ */
+#define CANDB_SIGS_MotorCmd(SIG, M)                                    \
+    SIG(M, Speed,       7,  16, BE, SIGNED,   0.1f,  0)                \
+    SIG(M, Torque,      23, 12, BE, UNSIGNED, 0.05f, -100.0f)          \
+    SIG(M, Mode,        27, 3,  BE, UNSIGNED, 1,     0)                \
+    SIG(M, Enable,      40, 1,  LE, UNSIGNED, 1,     0)
+
+/*
+ * Transmit slot counters of the TX node's string frame
+ * (see tMILCANTxSlot), they wrap at 16 bits
+ */
+#define CANDB_SIGS_TxStats(SIG, M)                                     \
+    SIG(M, Sent,         0,  16, LE, UNSIGNED, 1, 0)                   \
+    SIG(M, Superseded,   16, 16, LE, UNSIGNED, 1, 0)                   \
+    SIG(M, StaleDropped, 32, 16, LE, UNSIGNED, 1, 0)                   \
+    SIG(M, Busy,         48, 16, LE, UNSIGNED, 1, 0)
+
+/*
+ * Message list
+ * MSG(msg, id, dlc, flags, signal list)
+ */
+#define CANDB_MESSAGES(MSG)                                            \
+    MSG(NodeStatus, 0x100, 8, MSG_OBJ_NO_FLAGS, CANDB_SIGS_NodeStatus) \
+    MSG(MotorCmd,   0x120, 6, MSG_OBJ_NO_FLAGS, CANDB_SIGS_MotorCmd)   \
+    MSG(TxStats,    0x140, 8, MSG_OBJ_NO_FLAGS, CANDB_SIGS_TxStats)
+
+#endif /* CANDB_SIGNALS_H_ */
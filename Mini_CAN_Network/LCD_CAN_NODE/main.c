@@ -101,11 +101,12 @@ int main(void){
     uint8_t pCANMsgData[8];
 
     /*
-     * in order to receive any ID
-     * set both ID and Mask to 0 then enable Filter
+     * only the strings(ID 1) are for the display, a full
+     * mask lets nothing else through, e.g. the TX node's
+     * TxStats frames
      */
-    CANMsgObj.ui32MsgID = 0;
-    CANMsgObj.ui32MsgIDMask = 0;
+    CANMsgObj.ui32MsgID = 1;
+    CANMsgObj.ui32MsgIDMask = 0x7FF;
     CANMsgObj.ui32Flags = MSG_OBJ_USE_ID_FILTER;
     CANMsgObj.ui32MsgLen = 8;
 
@@ -0,0 +1,376 @@
+/*
+ * Name: MIL_CAN.c
+ * Author: Marquez Jones
+ * Desc: A set of wrapper functions I designed
+ *       to standardized CAN use in the Lab
+ *
+ * Notes: CAN devices should be run at 100k bps
+ *        and PCBs on the network should have on
+ *        board termination resistors
+ */
+
+/* INCLUDES */
+//includes
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_can.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/can.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/sysctl.h"
+
+//MIL includes
+#include"MIL_CAN.h"
+
+/*
+ * Desc: enables CAN0 which can be enabled on
+ *       Ports B,E, or F
+ *
+ * Notes: Does not enable interrupts
+ *        or port clocks
+ *        PORT and Interrupts
+ *        must be enabled outside funciton
+ *
+ * Hardware Notes:
+ * PF0 - CANRX  PB4 - CANRX  PE4 - CANRX
+ * PF3 - CANTX  PB5 - CANTX  PE5 - CANTX
+ *
+ * Inputs: port from mil_port enum
+ * Assumes: Port clocks are enabled
+ */
+void MIL_InitCAN0(mil_port port){
+
+
+    //pin configuration
+    /*
+     * Depending on the port, different pins
+     * need to be configured
+     */
+    switch(port){
+        case MIL_PORT_B:
+            GPIOPinConfigure(GPIO_PB4_CAN0RX);
+            GPIOPinConfigure(GPIO_PB5_CAN0TX);
+            GPIOPinTypeCAN(GPIO_PORTB_BASE, GPIO_PIN_4 | GPIO_PIN_5);
+            break;
+        case MIL_PORT_E:
+            GPIOPinConfigure(GPIO_PE4_CAN0RX);
+            GPIOPinConfigure(GPIO_PE5_CAN0TX);
+            GPIOPinTypeCAN(GPIO_PORTE_BASE, GPIO_PIN_4 | GPIO_PIN_5);
+            break;
+        case MIL_PORT_F:
+            GPIOPinConfigure(GPIO_PF0_CAN0RX);
+            GPIOPinConfigure(GPIO_PF3_CAN0TX);
+            GPIOPinTypeCAN(GPIO_PORTF_BASE, GPIO_PIN_0 | GPIO_PIN_3);
+            break;
+    }
+
+    //enable CAN peripheral
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_CAN0);
+
+    //Initialize CAN controller
+    CANInit(CAN0_BASE);
+
+    //Set can retry to true
+    /*
+     * Retry is controller wide, frames that should not
+     * keep retrying past a deadline use MIL_TX_DEADLINE
+     * slots instead
+     */
+    CANRetrySet(CAN0_BASE,1);
+
+    //Set bit rates
+    CANBitRateSet(CAN0_BASE, SysCtlClockGet(), 100000);
+
+    //enable CAN
+    CANEnable(CAN0_BASE);
+
+}
+
+/*
+ * Desc: enables CAN1
+ *       CAN 1 is restricted
+ *       to Port A so there's
+ *       no input parameter
+ *
+ *
+ * Notes: Does not enable interrupts
+ *        or port clocks
+ *        PORT A and Interrupts
+ *        must be enabled outside function
+ *
+ * Hardware Notes:
+ * PA0 - CANRX
+ * PA1 - CANTX
+ *
+ * Assumes: Port clock enabled
+ */
+void MIL_InitCAN1(void){
+
+    //sets CAN as available pin functions
+    GPIOPinConfigure(GPIO_PA0_CAN1RX);
+    GPIOPinConfigure(GPIO_PA1_CAN1TX);
+    GPIOPinTypeCAN(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+
+    //enable CAN peripheral
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_CAN1);
+
+    //Initialize CAN controller
+    CANInit(CAN1_BASE);
+
+    //Set can retry to true
+    CANRetrySet(CAN1_BASE,1);
+
+    //Set bit rates
+    CANBitRateSet(CAN1_BASE, SysCtlClockGet(), 100000);
+
+    //enable CAN
+    CANEnable(CAN1_BASE);
+
+
+}
+
+/*
+ * Desc: Enables interrupts on CAN0
+ *
+ * Notes: The Tiva CAN system has two
+ *        separate interrupt sources.
+ *        Either a controller error has
+ *        occured(Tiva side) or there's
+ *        a status change which can result
+ *        from message transfer or a system
+ *        bus error.
+ *
+ *        Further diagnostics in required in
+ *        the external program
+ *
+ * Inputs: A pointer to your custom ISR
+ * Assumes: Nothing
+ */
+void MIL_CAN0IntEnable(void (*func_ptr)(void)){
+
+    //set a custom ISR
+    CANIntRegister(CAN0_BASE, func_ptr);
+
+    //enable status interrupts
+    //errors due to controller errors are ignored
+    CANIntEnable(CAN0_BASE, CAN_INT_MASTER | CAN_INT_STATUS);
+
+    IntEnable(INT_CAN0);
+
+}
+
+/*
+ * Desc: Enables interrupts on CAN1
+ *
+ * Notes: see CAN0
+ */
+void MIL_CAN1IntEnable(void (*func_ptr)(void)){
+
+    //set a custom ISR
+    CANIntRegister(CAN1_BASE, func_ptr);
+
+    //enable status interrupts
+    //errors due to controller errors are ignored
+    CANIntEnable(CAN1_BASE, CAN_INT_MASTER | CAN_INT_STATUS);
+
+    IntEnable(INT_CAN1);
+
+
+
+}
+
+/*
+ * Desc: Enables the Port associated with the CAN system
+ *
+ * Note: For sake of your program making sense,
+ *       only call this function if your CAN shares the
+ *       port with no other GPIOs or peripherals
+ *
+ *       This just called the GPIO clock enable for
+ *       the port
+ */
+void MIL_CANPortClkEnable(mil_port port){
+
+    switch(port){
+
+        case MIL_PORT_A:
+            SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+            break;
+        case MIL_PORT_B:
+            SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+            break;
+        case MIL_PORT_E:
+            SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE);
+            break;
+        case MIL_PORT_F:
+            SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
+            break;
+
+    }
+
+}
+
+/*
+ * Desc: checks whether a slot's frame still has a
+ *       transmit request pending
+ *
+ * Notes: a pulled object keeps its request bit, but it is
+ *        invalid so it is never sent, loaded tells them apart
+ */
+static bool TxPending(const tMILCANTxSlot *slot){
+
+    return slot->loaded &&
+           ((CANStatusGet(slot->base, CAN_STS_TXREQUEST) &
+             (1u << (slot->obj - 1))) != 0);
+
+}
+
+/*
+ * Desc: counts a slot's frame as sent once the controller
+ *       has cleared its transmit request
+ *
+ * Notes: a frame stuck in arbitration or behind bus-off keeps
+ *        its request and isn't counted
+ */
+static void TxSentCheck(tMILCANTxSlot *slot){
+
+    if(slot->loaded && !TxPending(slot)){
+        slot->sent++;
+        slot->loaded = false;
+    }
+
+}
+
+/*
+ * Desc: pulls a slot's frame from its mailbox
+ *
+ * Returns: true if the frame was still waiting, i.e. it will
+ *          never be sent
+ *
+ * Notes: CANMessageClear invalidates the object which withdraws
+ *        its transmit request. Checking the request only after
+ *        that means a frame that finished just before is counted
+ *        as sent instead. A frame already on the wire when it is
+ *        pulled still finishes and can't be told from one that
+ *        was waiting, so it is counted as pulled
+ */
+static bool TxPull(tMILCANTxSlot *slot){
+
+    bool waiting;
+
+    CANMessageClear(slot->base, slot->obj);
+
+    waiting = TxPending(slot);
+
+    if(!waiting){
+        TxSentCheck(slot);
+    }
+
+    slot->loaded = false;
+
+    return waiting;
+
+}
+
+/*
+ * Desc: sets up a transmit slot
+ *
+ * Inputs: slot, controller base, message object(1-32),
+ *         policy, deadline in ticks(MIL_TX_DEADLINE only)
+ *
+ * Notes: ticks are whatever time base the application passes to
+ *        MIL_CANTxSend and MIL_CANTxService, 1ms is typical
+ */
+void MIL_CANTxSlotInit(tMILCANTxSlot *slot, uint32_t base, uint32_t obj,
+                       mil_tx_policy policy, uint32_t deadline){
+
+    slot->base = base;
+    slot->obj = obj;
+    slot->policy = policy;
+    slot->deadline = deadline;
+    slot->expires = 0;
+    slot->sent = 0;
+    slot->superseded = 0;
+    slot->stale_dropped = 0;
+    slot->busy = 0;
+    slot->loaded = false;
+
+}
+
+/*
+ * Desc: sends a frame through a slot according to its policy
+ *
+ * Notes: a pending frame is pulled before the new one is
+ *        loaded so superseded only counts frames that never
+ *        made it out(see TxPull), a previous frame that did
+ *        is counted as sent first
+ *
+ * Inputs: slot, frame to send(ID, flags, length and data),
+ *         current tick
+ */
+mil_tx_result MIL_CANTxSend(tMILCANTxSlot *slot, tCANMsgObject *msg,
+                            uint32_t now){
+
+    mil_tx_result result = MIL_TX_QUEUED;
+
+    TxSentCheck(slot);
+
+    if(TxPending(slot)){
+
+        if(slot->policy == MIL_TX_RELIABLE){
+            slot->busy++;
+            return MIL_TX_BUSY;
+        }
+
+        if(TxPull(slot)){
+            slot->superseded++;
+            result = MIL_TX_SUPERSEDED;
+        }
+
+    }
+
+    CANMessageSet(slot->base, slot->obj, msg, MSG_OBJ_TYPE_TX);
+
+    slot->loaded = true;
+    slot->expires = now + slot->deadline;
+
+    return result;
+
+}
+
+/*
+ * Desc: counts frames that have been sent and drops deadline
+ *       frames that are still pending past their deadline
+ *
+ * Notes: call periodically(timer ISR or main loop) at least as
+ *        often as the shortest deadline
+ *
+ *        the pulled object stays invalid until the next
+ *        MIL_CANTxSend sets it up again
+ *
+ * Inputs: array of slots, number of slots, current tick
+ */
+void MIL_CANTxService(tMILCANTxSlot *slots, uint32_t count, uint32_t now){
+
+    for(uint32_t idx = 0; idx < count; idx++){
+
+        tMILCANTxSlot *slot = &slots[idx];
+
+        TxSentCheck(slot);
+
+        //signed difference handles tick wrap around
+        if((slot->policy == MIL_TX_DEADLINE) &&
+           ((int32_t)(now - slot->expires) >= 0) &&
+           TxPending(slot) && TxPull(slot)){
+
+            slot->stale_dropped++;
+
+        }
+
+    }
+
+}
@@ -0,0 +1,196 @@
+/*
+ * Name: MIL_CAN.h
+ * Author: Marquez Jones
+ * Desc: A set of wrapper functions I designed
+ *       to standardized CAN use in the Lab
+ *       this primarily is to reduce the number
+ *       of bugs caused by the CAN bus
+ *
+ * Notes: CAN devices should be run at 100k bps
+ *        and PCBs on the network should have on
+ *        board termination resistors
+ */
+
+#ifndef MIL_CAN_H_
+#define MIL_CAN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driverlib/can.h"
+
+/*
+ *Desc: Port selection will come from this enum
+ */
+typedef enum {
+    MIL_PORT_A,
+    MIL_PORT_B,
+    MIL_PORT_E,
+    MIL_PORT_F
+}mil_port;
+
+/*
+ * Desc: enables CAN0 which can be enabled on
+ *       Ports B,E, or F
+ *
+ * Notes: Does not enable interrupts
+ *        or port clocks
+ *        PORT and Interrupts
+ *        must be enabled outside funciton
+ *
+ * Hardware Notes:
+ * PF0 - CANRX  PB4 - CANRX  PE4 - CANRX
+ * PF3 - CANTX  PB5 - CANTX  PE5 - CANTX
+ *
+ * Inputs: port from mil_port enum
+ * Assumes: Port clocks are enabled
+ */
+void MIL_InitCAN0(mil_port port);
+
+/*
+ * Desc: enables CAN1
+ *       CAN 1 is restricted
+ *       to Port A so there's
+ *       no input parameter
+ *
+ * Notes: Does not enable interrupts
+ *        or port clocks
+ *        PORT A and Interrupts
+ *        must be enabled outside function
+ *
+ * Hardware Notes:
+ * PA0 - CANRX
+ * PA1 - CANTX
+ *
+ * Assumes: Port clock enabled
+ */
+void MIL_InitCAN1(void);
+
+/*
+ * Desc: Enables interrupts on CAN0
+ *
+ * Notes: The Tiva CAN system has two
+ *        separate interrupt sources.
+ *        Either a controller error has
+ *        occured(Tiva side) or there's
+ *        a status change which can result
+ *        from message transfer or a system
+ *        bus error.
+ *
+ *        Further diagnostics in required in
+ *        the external program
+ *
+ * Inputs: A pointer to your custom ISR
+ * Assumes: Nothing
+ */
+void MIL_CAN0IntEnable(void (*func_ptr)(void));
+
+/*
+ * Desc: Enables interrupts on CAN1
+ *
+ * Notes: see CAN0
+ */
+void MIL_CAN1IntEnable(void (*func_ptr)(void));
+
+/*
+ * Desc: Enables the Port associated with the CAN system
+ *
+ * Note: For sake of your program making sense,
+ *       only call this function if your CAN shares the
+ *       port with no other GPIOs or peripherals
+ *
+ *       This just called the GPIO clock enable for
+ *       the port
+ */
+void MIL_CANPortClkEnable(mil_port port);
+
+/*****************************TX POLICY*************************************/
+
+/*
+ * Desc: per frame transmit policy
+ *
+ *       MIL_TX_RELIABLE - controller retries until the frame is sent,
+ *                         a new send waits(returns MIL_TX_BUSY) while
+ *                         the previous one is still pending
+ *       MIL_TX_REPLACE  - a new value for the same ID overwrites a
+ *                         frame that is still pending(superseded)
+ *       MIL_TX_DEADLINE - replace semantics plus a deadline, a frame
+ *                         still pending when its deadline passes is
+ *                         pulled from the mailbox(stale drop)
+ *
+ * Notes: This is deadline drop, not one-shot. Automatic
+ *        retransmission(CANRetrySet) is a controller wide setting
+ *        on the Tiva so it can't be turned off for a single frame,
+ *        and MIL_InitCAN0/1 leave it on. A deadline frame keeps
+ *        retrying on a busy or broken bus until MIL_CANTxService
+ *        pulls it, after that it stops competing for the bus so
+ *        the next, fresher value goes out instead
+ */
+typedef enum {
+    MIL_TX_RELIABLE,
+    MIL_TX_REPLACE,
+    MIL_TX_DEADLINE
+}mil_tx_policy;
+
+/*
+ * Desc: MIL_CANTxSend results
+ */
+typedef enum {
+    MIL_TX_QUEUED,      //frame loaded into an idle mailbox
+    MIL_TX_SUPERSEDED,  //frame replaced a pending one
+    MIL_TX_BUSY         //reliable frame still pending, nothing loaded
+}mil_tx_result;
+
+/*
+ * Desc: one transmit mailbox(message object) and its policy
+ *
+ * Notes: give each periodic ID its own slot so replacement only
+ *        ever replaces an older value of the same frame
+ */
+typedef struct {
+    uint32_t base;          //CAN0_BASE or CAN1_BASE
+    uint32_t obj;           //message object 1-32
+    mil_tx_policy policy;
+    uint32_t deadline;      //ticks, MIL_TX_DEADLINE only
+    uint32_t expires;       //tick the pending frame goes stale
+    uint32_t sent;          //frames the controller finished sending
+    uint32_t superseded;    //pending frames replaced by a newer value
+    uint32_t stale_dropped; //pending frames pulled at their deadline
+    uint32_t busy;          //reliable sends refused while pending
+    bool loaded;            //a frame was loaded, not sent or pulled yet
+} tMILCANTxSlot;
+
+/*
+ * Desc: sets up a transmit slot
+ *
+ * Inputs: slot, controller base, message object(1-32),
+ *         policy, deadline in ticks(MIL_TX_DEADLINE only)
+ *
+ * Notes: ticks are whatever time base the application passes to
+ *        MIL_CANTxSend and MIL_CANTxService, 1ms is typical
+ */
+void MIL_CANTxSlotInit(tMILCANTxSlot *slot, uint32_t base, uint32_t obj,
+                       mil_tx_policy policy, uint32_t deadline);
+
+/*
+ * Desc: sends a frame through a slot according to its policy
+ *
+ * Inputs: slot, frame to send(ID, flags, length and data),
+ *         current tick
+ */
+mil_tx_result MIL_CANTxSend(tMILCANTxSlot *slot, tCANMsgObject *msg,
+                            uint32_t now);
+
+/*
+ * Desc: counts frames that have been sent and drops deadline
+ *       frames that are still pending past their deadline
+ *
+ * Notes: call periodically(timer ISR or main loop) at least as
+ *        often as the shortest deadline, sent is only brought up
+ *        to date here and in MIL_CANTxSend
+ *
+ * Inputs: array of slots, number of slots, current tick
+ */
+void MIL_CANTxService(tMILCANTxSlot *slots, uint32_t count, uint32_t now);
+
+
+#endif /* MIL_CAN_H_ */
@@ -0,0 +1,1102 @@
+/*
+ * Name: MIL_SLCAN.c
+ * Author: Marquez Jones
+ * Desc: SLCAN(Lawicel) CAN to UART gateway
+ *       see MIL_SLCAN.h for the protocol
+ *
+ * Notes: everything runs from interrupts
+ *        CAN0 ISR   - drains the RX FIFO objects and encodes frames
+ *                     straight into the UART TX ring, frees mailboxes
+ *        UART1 ISR  - parses host bytes, refills the UART TX FIFO and
+ *                     drains the frame backlog
+ *        Timer1 ISR - millisecond timestamp
+ */
+
+/* INCLUDES */
+//includes
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_can.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/can.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "driverlib/uart.h"
+
+//MIL includes
+#include "MIL_CAN.h"
+#include "MIL_SLCAN.h"
+
+/********************************************DEFINES******************************/
+
+#define TX_RING_MASK        (SLCAN_TX_RING_SIZE - 1)
+#define BACKLOG_MASK        (SLCAN_BACKLOG_SIZE - 1)
+#define CANTX_QUEUE_MASK    (SLCAN_CANTX_QUEUE_SIZE - 1)
+
+//longest ASCII frame: T + 8 id + dlc + 16 data + 4 time + CR
+#define MAX_ENCODED_LEN     31
+
+//longest ASCII command from the host
+#define MAX_LINE_LEN        32
+
+//ascii control characters
+#define CR  0x0D
+#define LF  0x0A
+#define BEL 0x07
+
+//binary mode control codes
+#define BIN_HEADER          0xC0
+#define BIN_HEADER_MASK     0xC0
+#define BIN_STATUS          0x80
+#define BIN_EXIT            0x1B
+
+//longest binary message before COBS: header + 4 id + 8 data + 2 time + 2 crc
+#define BIN_MAX_MSG         17
+
+//CRC bytes at the end of a binary message
+#define BIN_CRC_LEN         2
+
+//channel state
+#define CHAN_CLOSED         0
+#define CHAN_OPEN           1
+#define CHAN_LISTEN         2
+
+/********************************************GLOBAL DATA******************************/
+
+static const char g_pcHex[] = "0123456789ABCDEF";
+
+//CRC-16/CCITT-FALSE(poly 0x1021), one nibble at a time
+static const uint16_t g_pui16CRCNibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+//Sn bit rates
+static const uint32_t g_pui32BitRates[9] = {
+    10000, 20000, 50000, 100000, 125000, 250000, 500000, 800000, 1000000
+};
+
+//channel settings
+static uint8_t g_ui8Chan = CHAN_CLOSED;
+static bool g_bBinary = false;
+static bool g_bTimestamps = false;
+static uint8_t g_ui8Status = 0;
+
+//millisecond timestamp(0-59999)
+static volatile uint16_t g_ui16Ms = 0;
+
+//UART TX byte ring, indices run free and are masked on access
+static uint8_t g_pui8TxRing[SLCAN_TX_RING_SIZE];
+static volatile uint32_t g_ui32TxHead = 0;
+static volatile uint32_t g_ui32TxTail = 0;
+
+//CAN->UART frames waiting for ring space
+static tSLCANFrame g_psBacklog[SLCAN_BACKLOG_SIZE];
+static uint32_t g_ui32BacklogHead = 0;
+static uint32_t g_ui32BacklogTail = 0;
+
+//UART->CAN frames waiting for a mailbox
+static tSLCANFrame g_psCANTxQueue[SLCAN_CANTX_QUEUE_SIZE];
+static uint32_t g_ui32CANTxHead = 0;
+static uint32_t g_ui32CANTxTail = 0;
+
+//one bit per TX mailbox, set while the mailbox is pending
+static uint32_t g_ui32MailboxBusy = 0;
+
+//host input state
+static char g_pcLine[MAX_LINE_LEN];
+static uint32_t g_ui32LineLen = 0;
+static uint8_t g_pui8Bin[BIN_MAX_MSG];
+static uint32_t g_ui32BinLen = 0;       //decoded bytes
+static uint16_t g_ui16BinCRC = 0xFFFF;  //CRC of the decoded bytes
+static uint8_t g_ui8BinCode = 0;        //COBS code byte of the block
+static uint8_t g_ui8BinRemaining = 0;   //bytes left in the block
+static bool g_bBinDiscard = false;      //skip to the next 0x00
+
+static tSLCANStats g_sStats;
+
+/********************************************FXN PROTO******************************/
+
+static void UARTPump(void);
+static void BacklogPump(void);
+static void CANTxPump(void);
+
+/**************************************TX RING********************************************/
+
+/*
+ * Desc: bytes free in the UART TX ring
+ */
+static uint32_t TxRingFree(void){
+
+    return SLCAN_TX_RING_SIZE - (g_ui32TxHead - g_ui32TxTail);
+
+}
+
+/*
+ * Desc: copies bytes into the UART TX ring
+ *
+ * Assumes: caller checked TxRingFree
+ */
+static void TxRingWrite(const uint8_t *pui8Data, uint32_t len){
+
+    uint32_t head = g_ui32TxHead;
+
+    for(uint32_t idx = 0; idx < len; idx++){
+        g_pui8TxRing[(head + idx) & TX_RING_MASK] = pui8Data[idx];
+    }
+
+    g_ui32TxHead = head + len;
+
+}
+
+/*
+ * Desc: queues a reply to the host, replies that don't fit are dropped
+ */
+static void Reply(const char *pcReply, uint32_t len){
+
+    if(TxRingFree() >= len){
+        TxRingWrite((const uint8_t *)pcReply, len);
+    }
+
+}
+
+/*
+ * Desc: moves bytes from the TX ring into the UART FIFO and
+ *       keeps the TX interrupt on while there is more to send
+ */
+static void UARTPump(void){
+
+    while((g_ui32TxTail != g_ui32TxHead) && UARTSpaceAvail(UART1_BASE)){
+        UARTCharPutNonBlocking(UART1_BASE,
+                               g_pui8TxRing[g_ui32TxTail & TX_RING_MASK]);
+        g_ui32TxTail++;
+    }
+
+    if(g_ui32TxTail != g_ui32TxHead){
+        UARTIntEnable(UART1_BASE, UART_INT_TX);
+    }
+    else{
+        UARTIntDisable(UART1_BASE, UART_INT_TX);
+    }
+
+}
+
+/**************************************FRAMING********************************************/
+
+/*
+ * Desc: runs one byte through the CRC
+ */
+static uint16_t CRCStep(uint16_t crc, uint8_t data){
+
+    crc = (crc << 4) ^ g_pui16CRCNibble[(crc >> 12) ^ (data >> 4)];
+    crc = (crc << 4) ^ g_pui16CRCNibble[(crc >> 12) ^ (data & 0x0F)];
+
+    return crc;
+
+}
+
+/*
+ * Desc: adds the CRC to a binary message, COBS encodes it and
+ *       ends it with the 0x00 delimiter
+ *
+ * Inputs: message(with room for the CRC), its length, output
+ *         (at least length + BIN_CRC_LEN + 2 bytes)
+ * Returns: encoded length
+ *
+ * Notes: messages are far shorter than a 254 byte COBS block
+ *        so every block ends at a zero or at the end
+ */
+static uint32_t BinaryWrap(uint8_t *pui8Msg, uint32_t len, uint8_t *pui8Out){
+
+    uint16_t crc = 0xFFFF;
+    uint32_t code_pos = 0;
+    uint32_t pos = 1;
+    uint8_t code = 1;
+
+    for(uint32_t idx = 0; idx < len; idx++){
+        crc = CRCStep(crc, pui8Msg[idx]);
+    }
+
+    //big endian so the CRC over the whole message comes out 0
+    pui8Msg[len++] = (uint8_t)(crc >> 8);
+    pui8Msg[len++] = (uint8_t)crc;
+
+    for(uint32_t idx = 0; idx < len; idx++){
+
+        if(pui8Msg[idx]){
+            pui8Out[pos++] = pui8Msg[idx];
+            code++;
+        }
+        else{
+            pui8Out[code_pos] = code;
+            code_pos = pos++;
+            code = 1;
+        }
+
+    }
+
+    pui8Out[code_pos] = code;
+    pui8Out[pos++] = 0;
+
+    return pos;
+
+}
+
+/**************************************ENCODING********************************************/
+
+/*
+ * Desc: writes value as digits hex characters
+ */
+static uint8_t *PutHex(uint8_t *pui8Out, uint32_t value, uint32_t digits){
+
+    while(digits--){
+        *pui8Out++ = g_pcHex[(value >> (4 * digits)) & 0x0F];
+    }
+
+    return pui8Out;
+
+}
+
+/*
+ * Desc: encodes a frame for the host in the current mode
+ *
+ * Returns: encoded length
+ */
+static uint32_t EncodeFrame(const tSLCANFrame *psFrame, uint8_t *pui8Out){
+
+    uint8_t *pui8Ptr = pui8Out;
+    bool ext = (psFrame->flags & SLCAN_FRAME_EXT) != 0;
+    bool rtr = (psFrame->flags & SLCAN_FRAME_RTR) != 0;
+
+    if(g_bBinary){
+
+        uint8_t pui8Msg[BIN_MAX_MSG];
+
+        pui8Ptr = pui8Msg;
+
+        *pui8Ptr++ = BIN_HEADER | psFrame->flags | psFrame->dlc;
+
+        *pui8Ptr++ = (uint8_t)psFrame->id;
+        *pui8Ptr++ = (uint8_t)(psFrame->id >> 8);
+
+        if(ext){
+            *pui8Ptr++ = (uint8_t)(psFrame->id >> 16);
+            *pui8Ptr++ = (uint8_t)(psFrame->id >> 24);
+        }
+
+        if(!rtr){
+            for(uint32_t idx = 0; idx < psFrame->dlc; idx++){
+                *pui8Ptr++ = psFrame->data[idx];
+            }
+        }
+
+        *pui8Ptr++ = (uint8_t)psFrame->timestamp;
+        *pui8Ptr++ = (uint8_t)(psFrame->timestamp >> 8);
+
+        return BinaryWrap(pui8Msg, pui8Ptr - pui8Msg, pui8Out);
+
+    }
+    else{
+
+        //t, T, r or R
+        if(ext){
+            *pui8Ptr++ = rtr ? 'R' : 'T';
+            pui8Ptr = PutHex(pui8Ptr, psFrame->id, 8);
+        }
+        else{
+            *pui8Ptr++ = rtr ? 'r' : 't';
+            pui8Ptr = PutHex(pui8Ptr, psFrame->id, 3);
+        }
+
+        *pui8Ptr++ = '0' + psFrame->dlc;
+
+        if(!rtr){
+            for(uint32_t idx = 0; idx < psFrame->dlc; idx++){
+                pui8Ptr = PutHex(pui8Ptr, psFrame->data[idx], 2);
+            }
+        }
+
+        if(g_bTimestamps){
+            pui8Ptr = PutHex(pui8Ptr, psFrame->timestamp, 4);
+        }
+
+        *pui8Ptr++ = CR;
+
+    }
+
+    return pui8Ptr - pui8Out;
+
+}
+
+/*
+ * Desc: encodes a frame into the TX ring if it fits
+ *
+ * Returns: true if the frame was queued
+ */
+static bool SendFrame(const tSLCANFrame *psFrame){
+
+    uint8_t pui8Enc[MAX_ENCODED_LEN];
+    uint32_t len = EncodeFrame(psFrame, pui8Enc);
+
+    if(TxRingFree() < len){
+        return false;
+    }
+
+    TxRingWrite(pui8Enc, len);
+
+    return true;
+
+}
+
+/*
+ * Desc: hands a received bus frame to the host, keeping order
+ *       with anything already waiting in the backlog
+ */
+static void ForwardToHost(const tSLCANFrame *psFrame){
+
+    //only go straight to the ring if nothing is waiting ahead of us
+    if((g_ui32BacklogHead == g_ui32BacklogTail) && SendFrame(psFrame)){
+        return;
+    }
+
+    if((g_ui32BacklogHead - g_ui32BacklogTail) < SLCAN_BACKLOG_SIZE){
+
+        g_psBacklog[g_ui32BacklogHead & BACKLOG_MASK] = *psFrame;
+        g_ui32BacklogHead++;
+        g_sStats.backlogged++;
+
+    }
+    else{
+
+        g_sStats.dropped++;
+        g_ui8Status |= SLCAN_STS_OVERRUN | SLCAN_STS_RX_FULL;
+
+    }
+
+}
+
+/*
+ * Desc: moves backlogged frames into the TX ring as space frees up
+ */
+static void BacklogPump(void){
+
+    while(g_ui32BacklogHead != g_ui32BacklogTail){
+
+        if(!SendFrame(&g_psBacklog[g_ui32BacklogTail & BACKLOG_MASK])){
+            break;
+        }
+
+        g_ui32BacklogTail++;
+
+    }
+
+}
+
+/**************************************CAN SIDE********************************************/
+
+/*
+ * Desc: loads queued host frames into free TX mailboxes
+ */
+static void CANTxPump(void){
+
+    tCANMsgObject sObj;
+
+    while((g_ui32CANTxHead != g_ui32CANTxTail) &&
+          (g_ui32MailboxBusy != 0xFF)){
+
+        tSLCANFrame *psFrame = &g_psCANTxQueue[g_ui32CANTxTail & CANTX_QUEUE_MASK];
+        uint32_t box = 0;
+
+        //lowest free mailbox
+        while(g_ui32MailboxBusy & (1u << box)){
+            box++;
+        }
+
+        sObj.ui32MsgID = psFrame->id;
+        sObj.ui32MsgIDMask = 0;
+        sObj.ui32Flags = MSG_OBJ_TX_INT_ENABLE;
+        sObj.ui32MsgLen = psFrame->dlc;
+        sObj.pui8MsgData = psFrame->data;
+
+        if(psFrame->flags & SLCAN_FRAME_EXT){
+            sObj.ui32Flags |= MSG_OBJ_EXTENDED_ID;
+        }
+
+        CANMessageSet(CAN0_BASE, SLCAN_TX_OBJ_FIRST + box, &sObj,
+                      (psFrame->flags & SLCAN_FRAME_RTR) ?
+                      MSG_OBJ_TYPE_TX_REMOTE : MSG_OBJ_TYPE_TX);
+
+        g_ui32MailboxBusy |= 1u << box;
+        g_ui32CANTxTail++;
+
+    }
+
+    if((g_ui32CANTxHead - g_ui32CANTxTail) < SLCAN_CANTX_QUEUE_SIZE){
+        g_ui8Status &= ~SLCAN_STS_TX_FULL;
+    }
+
+}
+
+/*
+ * Desc: queues a host frame for the bus
+ *
+ * Returns: false if the queue is full(back pressure to the host)
+ */
+static bool QueueToBus(const tSLCANFrame *psFrame){
+
+    if((g_ui32CANTxHead - g_ui32CANTxTail) >= SLCAN_CANTX_QUEUE_SIZE){
+
+        g_sStats.refused++;
+        g_ui8Status |= SLCAN_STS_TX_FULL;
+
+        return false;
+
+    }
+
+    g_psCANTxQueue[g_ui32CANTxHead & CANTX_QUEUE_MASK] = *psFrame;
+    g_ui32CANTxHead++;
+
+    CANTxPump();
+
+    return true;
+
+}
+
+/*
+ * Desc: opens or closes the CAN channel
+ */
+static void ChannelSet(uint8_t chan){
+
+    if(chan == CHAN_CLOSED){
+
+        CANDisable(CAN0_BASE);
+
+    }
+    else{
+
+        //listen only uses the controller's silent test mode
+        if(chan == CHAN_LISTEN){
+            HWREG(CAN0_BASE + CAN_O_CTL) |= CAN_CTL_TEST;
+            HWREG(CAN0_BASE + CAN_O_TST) |= CAN_TST_SILENT;
+        }
+        else{
+            HWREG(CAN0_BASE + CAN_O_TST) &= ~CAN_TST_SILENT;
+            HWREG(CAN0_BASE + CAN_O_CTL) &= ~CAN_CTL_TEST;
+        }
+
+        CANEnable(CAN0_BASE);
+
+    }
+
+    g_ui8Chan = chan;
+
+}
+
+/**************************************HOST INPUT********************************************/
+
+/*
+ * Desc: hex character to value, -1 if not hex
+ */
+static int32_t HexVal(char c){
+
+    if((c >= '0') && (c <= '9')){
+        return c - '0';
+    }
+    if((c >= 'A') && (c <= 'F')){
+        return c - 'A' + 10;
+    }
+    if((c >= 'a') && (c <= 'f')){
+        return c - 'a' + 10;
+    }
+
+    return -1;
+
+}
+
+/*
+ * Desc: parses digits hex characters
+ *
+ * Returns: false if a character wasn't hex
+ */
+static bool GetHex(const char *pcIn, uint32_t digits, uint32_t *pui32Value){
+
+    uint32_t value = 0;
+
+    for(uint32_t idx = 0; idx < digits; idx++){
+
+        int32_t nibble = HexVal(pcIn[idx]);
+
+        if(nibble < 0){
+            return false;
+        }
+
+        value = (value << 4) | nibble;
+
+    }
+
+    *pui32Value = value;
+
+    return true;
+
+}
+
+/*
+ * Desc: parses a t/T/r/R command into a frame
+ *
+ * Returns: false if malformed
+ */
+static bool ParseFrame(const char *pcLine, uint32_t len, tSLCANFrame *psFrame){
+
+    uint32_t id_digits;
+    uint32_t value;
+    const char *pcPtr = pcLine + 1;
+
+    psFrame->flags = 0;
+
+    if((pcLine[0] == 'T') || (pcLine[0] == 'R')){
+        psFrame->flags |= SLCAN_FRAME_EXT;
+        id_digits = 8;
+    }
+    else{
+        id_digits = 3;
+    }
+
+    if((pcLine[0] == 'r') || (pcLine[0] == 'R')){
+        psFrame->flags |= SLCAN_FRAME_RTR;
+    }
+
+    //id and dlc
+    if((len < 1 + id_digits + 1) || !GetHex(pcPtr, id_digits, &psFrame->id)){
+        return false;
+    }
+
+    pcPtr += id_digits;
+
+    if((*pcPtr < '0') || (*pcPtr > '8')){
+        return false;
+    }
+
+    psFrame->dlc = *pcPtr++ - '0';
+
+    //data
+    if(!(psFrame->flags & SLCAN_FRAME_RTR)){
+
+        if(len < 1 + id_digits + 1 + (2 * psFrame->dlc)){
+            return false;
+        }
+
+        for(uint32_t idx = 0; idx < psFrame->dlc; idx++){
+
+            if(!GetHex(pcPtr, 2, &value)){
+                return false;
+            }
+
+            psFrame->data[idx] = (uint8_t)value;
+            pcPtr += 2;
+
+        }
+
+    }
+
+    return (psFrame->flags & SLCAN_FRAME_EXT) ? (psFrame->id <= 0x1FFFFFFF) :
+                                                (psFrame->id <= 0x7FF);
+
+}
+
+/*
+ * Desc: runs one complete ASCII command line
+ */
+static void RunCommand(const char *pcLine, uint32_t len){
+
+    static const char pcOK[] = {CR};
+    static const char pcErr[] = {BEL};
+    tSLCANFrame sFrame;
+    char pcReply[4];
+
+    if(len == 0){
+        Reply(pcOK, 1);
+        return;
+    }
+
+    switch(pcLine[0]){
+
+        case 'S':
+            if((g_ui8Chan == CHAN_CLOSED) && (len == 2) &&
+               (pcLine[1] >= '0') && (pcLine[1] <= '8')){
+                CANBitRateSet(CAN0_BASE, SysCtlClockGet(),
+                              g_pui32BitRates[pcLine[1] - '0']);
+                Reply(pcOK, 1);
+            }
+            else{
+                Reply(pcErr, 1);
+            }
+            break;
+
+        case 'O':
+        case 'L':
+            if(g_ui8Chan == CHAN_CLOSED){
+                ChannelSet((pcLine[0] == 'O') ? CHAN_OPEN : CHAN_LISTEN);
+                Reply(pcOK, 1);
+            }
+            else{
+                Reply(pcErr, 1);
+            }
+            break;
+
+        case 'C':
+            ChannelSet(CHAN_CLOSED);
+            Reply(pcOK, 1);
+            break;
+
+        case 't':
+        case 'T':
+        case 'r':
+        case 'R':
+            if((g_ui8Chan == CHAN_OPEN) && ParseFrame(pcLine, len, &sFrame) &&
+               QueueToBus(&sFrame)){
+                pcReply[0] = ((pcLine[0] == 't') || (pcLine[0] == 'r')) ?
+                             'z' : 'Z';
+                pcReply[1] = CR;
+                Reply(pcReply, 2);
+            }
+            else{
+                Reply(pcErr, 1);
+            }
+            break;
+
+        case 'F':
+            pcReply[0] = 'F';
+            pcReply[1] = g_pcHex[g_ui8Status >> 4];
+            pcReply[2] = g_pcHex[g_ui8Status & 0x0F];
+            pcReply[3] = CR;
+            Reply(pcReply, 4);
+            g_ui8Status = 0;
+            break;
+
+        case 'V':
+            Reply("V1013\r", 6);
+            break;
+
+        case 'N':
+            Reply("NMIL1\r", 6);
+            break;
+
+        case 'Z':
+            if((len == 2) && ((pcLine[1] == '0') || (pcLine[1] == '1'))){
+                g_bTimestamps = (pcLine[1] == '1');
+                Reply(pcOK, 1);
+            }
+            else{
+                Reply(pcErr, 1);
+            }
+            break;
+
+        case 'B':
+            Reply(pcOK, 1);
+            g_bBinary = true;
+            g_ui32BinLen = 0;
+            g_ui16BinCRC = 0xFFFF;
+            g_ui8BinCode = 0;
+            g_ui8BinRemaining = 0;
+            g_bBinDiscard = false;
+            break;
+
+        default:
+            g_sStats.bad_cmd++;
+            Reply(pcErr, 1);
+            break;
+
+    }
+
+}
+
+/*
+ * Desc: feeds one host byte to the ASCII line parser
+ */
+static void AsciiInput(uint8_t byte){
+
+    if(byte == CR){
+
+        //an overflowed line is reported as one bad command
+        if(g_ui32LineLen > MAX_LINE_LEN){
+            g_sStats.bad_cmd++;
+            Reply("\a", 1);
+        }
+        else{
+            RunCommand(g_pcLine, g_ui32LineLen);
+        }
+
+        g_ui32LineLen = 0;
+
+    }
+    else if(byte != LF){
+
+        if(g_ui32LineLen < MAX_LINE_LEN){
+            g_pcLine[g_ui32LineLen] = byte;
+        }
+
+        //keep counting past the end so the overflow is noticed
+        if(g_ui32LineLen <= MAX_LINE_LEN){
+            g_ui32LineLen++;
+        }
+
+    }
+
+}
+
+/*
+ * Desc: stores one decoded binary byte
+ *
+ * Notes: a message too long for any header is skipped to its end
+ */
+static void BinaryAppend(uint8_t byte){
+
+    if(g_ui32BinLen >= BIN_MAX_MSG){
+        g_bBinDiscard = true;
+        g_sStats.bad_frame++;
+        return;
+    }
+
+    g_pui8Bin[g_ui32BinLen++] = byte;
+    g_ui16BinCRC = CRCStep(g_ui16BinCRC, byte);
+
+}
+
+/*
+ * Desc: checks and runs one decoded binary message
+ */
+static void BinaryMessage(void){
+
+    tSLCANFrame sFrame;
+    uint8_t pui8Refused[2 + BIN_CRC_LEN];
+    uint8_t pui8Enc[8];
+    uint8_t header = g_pui8Bin[0];
+    uint32_t len;
+    uint32_t need;
+
+    //a cut short block, a short message or a bad CRC
+    if((g_ui8BinRemaining != 0) || (g_ui32BinLen < 1 + BIN_CRC_LEN) ||
+       (g_ui16BinCRC != 0)){
+        g_sStats.bad_frame++;
+        return;
+    }
+
+    len = g_ui32BinLen - BIN_CRC_LEN;
+
+    if((header == BIN_EXIT) && (len == 1)){
+        g_bBinary = false;
+        g_ui32LineLen = 0;
+        return;
+    }
+
+    need = 1 + ((header & SLCAN_FRAME_EXT) ? 4 : 2) +
+           ((header & SLCAN_FRAME_RTR) ? 0 : (header & 0x0F));
+
+    //the header must be a frame and account for every byte
+    if(((header & BIN_HEADER_MASK) != BIN_HEADER) || ((header & 0x0F) > 8) ||
+       (len != need)){
+        g_sStats.bad_frame++;
+        return;
+    }
+
+    sFrame.flags = header & (SLCAN_FRAME_EXT | SLCAN_FRAME_RTR);
+    sFrame.dlc = header & 0x0F;
+    sFrame.id = g_pui8Bin[1] | ((uint32_t)g_pui8Bin[2] << 8);
+
+    uint32_t pos = 3;
+
+    if(sFrame.flags & SLCAN_FRAME_EXT){
+        sFrame.id |= ((uint32_t)g_pui8Bin[3] << 16) |
+                     ((uint32_t)g_pui8Bin[4] << 24);
+        pos = 5;
+    }
+
+    for(uint32_t idx = 0; pos < len; idx++, pos++){
+        sFrame.data[idx] = g_pui8Bin[pos];
+    }
+
+    if((g_ui8Chan != CHAN_OPEN) || !QueueToBus(&sFrame)){
+        pui8Refused[0] = BIN_STATUS;
+        pui8Refused[1] = g_ui8Status | SLCAN_STS_TX_FULL;
+        Reply((const char *)pui8Enc, BinaryWrap(pui8Refused, 2, pui8Enc));
+    }
+
+}
+
+/*
+ * Desc: feeds one host byte to the binary COBS decoder
+ *
+ * Notes: whatever went wrong with a message, decoding starts
+ *        over clean at the next 0x00
+ */
+static void BinaryInput(uint8_t byte){
+
+    //delimiter, the message is complete
+    if(byte == 0){
+
+        //back to back delimiters are just idle
+        if(!g_bBinDiscard && g_ui8BinCode){
+            BinaryMessage();
+        }
+
+        g_ui32BinLen = 0;
+        g_ui16BinCRC = 0xFFFF;
+        g_ui8BinCode = 0;
+        g_ui8BinRemaining = 0;
+        g_bBinDiscard = false;
+
+        return;
+
+    }
+
+    if(g_bBinDiscard){
+        return;
+    }
+
+    //code byte
+    if(g_ui8BinRemaining == 0){
+
+        //every block but a full one was followed by a zero
+        if(g_ui8BinCode && (g_ui8BinCode != 0xFF)){
+            BinaryAppend(0);
+        }
+
+        g_ui8BinCode = byte;
+        g_ui8BinRemaining = byte - 1;
+
+        return;
+
+    }
+
+    BinaryAppend(byte);
+    g_ui8BinRemaining--;
+
+}
+
+/**************************************INIT********************************************/
+
+/*
+ * Desc: sets up UART1, CAN0 message objects, the millisecond
+ *       timestamp timer and all gateway interrupts
+ *
+ * Notes: the channel starts closed, the host must send O
+ *
+ * Inputs: port CAN0 is wired to
+ * Assumes: 80MHz system clock, CAN0 port clock enabled
+ */
+void SLCANInit(mil_port port){
+
+    tCANMsgObject sObj;
+
+    /************UART1***************/
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART1);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UART1));
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOB));
+
+    GPIOPinConfigure(GPIO_PB0_U1RX);
+    GPIOPinConfigure(GPIO_PB1_U1TX);
+    GPIOPinTypeUART(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+
+    UARTConfigSetExpClk(UART1_BASE, SysCtlClockGet(), SLCAN_UART_BAUD,
+                        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+                         UART_CONFIG_PAR_NONE));
+
+    /*
+     * FIFOs stay on here, unlike the other UART examples
+     * RX interrupts at half full and the receive timeout
+     * picks up anything left below that
+     */
+    UARTFIFOEnable(UART1_BASE);
+    UARTFIFOLevelSet(UART1_BASE, UART_FIFO_TX1_8, UART_FIFO_RX4_8);
+
+    UARTIntRegister(UART1_BASE, &SLCANUART1ISR);
+    UARTIntEnable(UART1_BASE, UART_INT_RX | UART_INT_RT);
+    IntEnable(INT_UART1);
+
+    UARTEnable(UART1_BASE);
+
+    /************CAN0***************/
+    MIL_InitCAN0(port);
+
+    //channel starts closed
+    CANDisable(CAN0_BASE);
+
+    //objects 1-24 form one RX FIFO accepting every ID
+    sObj.ui32MsgID = 0;
+    sObj.ui32MsgIDMask = 0;
+    sObj.ui32MsgLen = 8;
+    sObj.pui8MsgData = 0;
+
+    for(uint32_t obj = SLCAN_RX_OBJ_FIRST; obj <= SLCAN_RX_OBJ_LAST; obj++){
+
+        sObj.ui32Flags = MSG_OBJ_USE_ID_FILTER | MSG_OBJ_RX_INT_ENABLE;
+
+        //all but the last object chain into the next
+        if(obj != SLCAN_RX_OBJ_LAST){
+            sObj.ui32Flags |= MSG_OBJ_FIFO;
+        }
+
+        CANMessageSet(CAN0_BASE, obj, &sObj, MSG_OBJ_TYPE_RX);
+
+    }
+
+    MIL_CAN0IntEnable(&SLCANCAN0ISR);
+
+    /************TIMER1***************/
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER1));
+
+    TimerConfigure(TIMER1_BASE, TIMER_CFG_PERIODIC);
+    TimerLoadSet(TIMER1_BASE, TIMER_A, (SysCtlClockGet() / 1000) - 1);
+    TimerIntRegister(TIMER1_BASE, TIMER_A, &SLCANTimer1ISR);
+    TimerIntEnable(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+    IntEnable(INT_TIMER1A);
+    TimerEnable(TIMER1_BASE, TIMER_A);
+
+}
+
+/*
+ * Desc: copies the gateway counters
+ */
+void SLCANStatsGet(tSLCANStats *psStats){
+
+    bool masked = IntMasterDisable();
+
+    *psStats = g_sStats;
+
+    if(!masked){
+        IntMasterEnable();
+    }
+
+}
+
+/********************************************ISR DEFINITIONS******************************/
+
+/*
+ * Desc: CAN0 ISR
+ *       drains every pending RX object in one pass(batching)
+ *       and frees finished TX mailboxes
+ */
+void SLCANCAN0ISR(void){
+
+    tCANMsgObject sObj;
+    tSLCANFrame sFrame;
+    uint32_t cause;
+
+    while((cause = CANIntStatus(CAN0_BASE, CAN_INT_STS_CAUSE)) != 0){
+
+        if(cause == CAN_INT_INTID_STATUS){
+
+            //reading the status register clears the interrupt
+            uint32_t status = CANStatusGet(CAN0_BASE, CAN_STS_CONTROL);
+
+            if(status & CAN_STATUS_EWARN){
+                g_ui8Status |= SLCAN_STS_EWARN;
+            }
+            if(status & CAN_STATUS_EPASS){
+                g_ui8Status |= SLCAN_STS_EPASS;
+            }
+            if(status & CAN_STATUS_BUS_OFF){
+                g_ui8Status |= SLCAN_STS_BUS_ERROR;
+            }
+
+        }
+        else if(cause <= SLCAN_RX_OBJ_LAST){
+
+            sObj.pui8MsgData = sFrame.data;
+
+            //read and clear the object
+            CANMessageGet(CAN0_BASE, cause, &sObj, true);
+
+            sFrame.id = sObj.ui32MsgID;
+            sFrame.dlc = sObj.ui32MsgLen;
+            sFrame.timestamp = g_ui16Ms;
+            sFrame.flags = 0;
+
+            if(sObj.ui32Flags & MSG_OBJ_EXTENDED_ID){
+                sFrame.flags |= SLCAN_FRAME_EXT;
+            }
+            if(sObj.ui32Flags & MSG_OBJ_REMOTE_FRAME){
+                sFrame.flags |= SLCAN_FRAME_RTR;
+            }
+            if(sObj.ui32Flags & MSG_OBJ_DATA_LOST){
+                g_ui8Status |= SLCAN_STS_OVERRUN;
+            }
+
+            g_sStats.can_rx++;
+
+            ForwardToHost(&sFrame);
+
+        }
+        else{
+
+            //TX mailbox done
+            CANIntClear(CAN0_BASE, cause);
+
+            g_ui32MailboxBusy &= ~(1u << (cause - SLCAN_TX_OBJ_FIRST));
+            g_sStats.can_tx++;
+
+        }
+
+    }
+
+    CANTxPump();
+
+    UARTPump();
+
+}
+
+/*
+ * Desc: UART1 ISR
+ *       drains the RX FIFO into the parser and refills the TX FIFO
+ */
+void SLCANUART1ISR(void){
+
+    uint32_t ints = UARTIntStatus(UART1_BASE, true);
+
+    UARTIntClear(UART1_BASE, ints);
+
+    if(ints & (UART_INT_RX | UART_INT_RT)){
+
+        while(UARTCharsAvail(UART1_BASE)){
+
+            uint8_t byte = (uint8_t)UARTCharGetNonBlocking(UART1_BASE);
+
+            if(g_bBinary){
+                BinaryInput(byte);
+            }
+            else{
+                AsciiInput(byte);
+            }
+
+        }
+
+    }
+
+    //frames are only ever held back for TX ring space
+    UARTPump();
+    BacklogPump();
+    UARTPump();
+
+}
+
+/*
+ * Desc: Timer1 ISR
+ *       millisecond timestamp, wraps at 60000 like the Lawicel units
+ */
+void SLCANTimer1ISR(void){
+
+    TimerIntClear(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+
+    if(++g_ui16Ms >= 60000){
+        g_ui16Ms = 0;
+    }
+
+}
@@ -0,0 +1,176 @@
+/*
+ * Name: MIL_SLCAN.h
+ * Author: Marquez Jones
+ * Desc: SLCAN(Lawicel) CAN to UART gateway
+ *       Lets PC tools(can-utils slcand, CANHacker, python-can, etc.)
+ *       sniff and inject frames on the lab bus through UART1
+ *
+ * ASCII Commands(all terminated by CR):
+ *       Sn          set bit rate  0=10k 1=20k 2=50k 3=100k 4=125k
+ *                                 5=250k 6=500k 7=800k 8=1M
+ *       O           open channel
+ *       L           open channel listen only(no TX)
+ *       C           close channel
+ *       tiiildd..   transmit standard frame(3 hex ID, dlc, data)
+ *       Tiiiiiiiildd.. transmit extended frame(8 hex ID)
+ *       riiil       transmit standard remote frame
+ *       Riiiiiiiil  transmit extended remote frame
+ *       F           read status flags
+ *       V           read version
+ *       N           read serial number
+ *       Zn          timestamps off(0) or on(1)
+ *       B           switch to binary mode
+ *
+ *       Replies are CR for OK and BEL(0x07) for error. Frames
+ *       queued with t/T are acknowledged with z/Z. Frames received
+ *       from the bus are sent in the same t/T/r/R format with an
+ *       optional 4 hex digit millisecond timestamp(0-59999)
+ *
+ * Binary Mode:
+ *       Compact framing used to keep up with a fully loaded bus
+ *       Each message is
+ *         header  1 byte  0xC0 | EXT(0x20) | RTR(0x10) | dlc
+ *         id      2 bytes(standard) or 4 bytes(extended), LSB first
+ *         data    dlc bytes, none for a remote frame
+ *         time    2 bytes, ms(0-59999) LSB first, gateway->PC only
+ *         crc     2 bytes, CRC-16/CCITT-FALSE of the above, MSB first
+ *
+ *       and is COBS encoded and ended with a single 0x00, the same
+ *       framing as MIL_COBS in the UART demo. A message never holds
+ *       a 0x00 so either end that loses or garbles a byte drops that
+ *       one message and is back in step at the next 0x00. Messages
+ *       with a bad CRC or the wrong length for their header are
+ *       dropped and counted. The host should start its decoder
+ *       after the CR that answers B
+ *
+ *       A worst case standard frame is 17 bytes on the wire so a
+ *       full 500k bus(~4500 frames/s) needs ~765kbps of UART, well
+ *       within the 2Mbps link
+ *
+ *       Any other header byte is a control code, sent as a message
+ *       of its own:
+ *         0x1B  (PC->gateway) return to ASCII mode
+ *         0x80  (gateway->PC) followed by one status byte(see F)
+ *               sent when a frame had to be refused
+ *
+ * Back pressure:
+ *       CAN->UART: frames that don't fit in the UART TX ring wait
+ *       in a frame backlog which is drained by the UART TX ISR.
+ *       If the backlog fills, frames are dropped and the overrun
+ *       flag is set
+ *
+ *       UART->CAN: frames wait in a TX queue for a free CAN
+ *       mailbox. If the queue is full the frame is refused
+ *       (BEL in ASCII mode, 0x80 status in binary mode)
+ *
+ * Hardware Notes:
+ *       UART1 PB0 - RX  PB1 - TX
+ *       CAN0 on the port given to SLCANInit
+ *
+ * Notes: CAN0, UART1 and Timer1A interrupts must stay at the same
+ *        priority, the rings below assume none of them preempt
+ *        each other
+ */
+
+#ifndef MIL_SLCAN_H_
+#define MIL_SLCAN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//MIL includes
+#include "MIL_CAN.h"
+
+/****************************CONFIG*************************************/
+
+//UART link rate, needs the 80MHz system clock
+#ifndef SLCAN_UART_BAUD
+#define SLCAN_UART_BAUD         2000000
+#endif
+
+//sizes must be powers of two
+#ifndef SLCAN_TX_RING_SIZE
+#define SLCAN_TX_RING_SIZE      2048
+#endif
+
+#ifndef SLCAN_BACKLOG_SIZE
+#define SLCAN_BACKLOG_SIZE      64
+#endif
+
+#ifndef SLCAN_CANTX_QUEUE_SIZE
+#define SLCAN_CANTX_QUEUE_SIZE  32
+#endif
+
+//message objects 1-24 form the RX FIFO, 25-32 are TX mailboxes
+#define SLCAN_RX_OBJ_FIRST      1
+#define SLCAN_RX_OBJ_LAST       24
+#define SLCAN_TX_OBJ_FIRST      25
+#define SLCAN_TX_OBJ_LAST       32
+
+/****************************STATUS FLAGS*******************************/
+
+/*
+ * Lawicel F command bits
+ */
+#define SLCAN_STS_RX_FULL       0x01
+#define SLCAN_STS_TX_FULL       0x02
+#define SLCAN_STS_EWARN         0x04
+#define SLCAN_STS_OVERRUN       0x08
+#define SLCAN_STS_EPASS         0x20
+#define SLCAN_STS_BUS_ERROR     0x80
+
+/****************************TYPES**************************************/
+
+/*
+ * Desc: one CAN frame as it moves through the gateway
+ */
+typedef struct {
+    uint32_t id;
+    uint16_t timestamp;
+    uint8_t  dlc;
+    uint8_t  flags;         //SLCAN_FRAME_EXT | SLCAN_FRAME_RTR
+    uint8_t  data[8];
+} tSLCANFrame;
+
+#define SLCAN_FRAME_EXT         0x20
+#define SLCAN_FRAME_RTR         0x10
+
+/*
+ * Desc: gateway counters
+ */
+typedef struct {
+    uint32_t can_rx;        //frames received from the bus
+    uint32_t can_tx;        //frames sent on the bus
+    uint32_t backlogged;    //frames that had to wait for UART space
+    uint32_t dropped;       //frames lost because the backlog was full
+    uint32_t refused;       //host frames refused because the queue was full
+    uint32_t bad_cmd;       //unparsable host commands
+    uint32_t bad_frame;     //binary messages dropped for a bad CRC or length
+} tSLCANStats;
+
+/****************************FUNCTIONS**********************************/
+
+/*
+ * Desc: sets up UART1, CAN0 message objects, the millisecond
+ *       timestamp timer and all gateway interrupts
+ *
+ * Notes: the channel starts closed, the host must send O
+ *
+ * Inputs: port CAN0 is wired to
+ * Assumes: 80MHz system clock, CAN0 port clock enabled
+ */
+void SLCANInit(mil_port port);
+
+/*
+ * Desc: copies the gateway counters
+ */
+void SLCANStatsGet(tSLCANStats *psStats);
+
+/*
+ * Desc: ISRs registered by SLCANInit
+ */
+void SLCANCAN0ISR(void);
+void SLCANUART1ISR(void);
+void SLCANTimer1ISR(void);
+
+#endif /* MIL_SLCAN_H_ */
@@ -0,0 +1,77 @@
+/*
+ * Name: SLCAN_GATEWAY_NODE
+ * Author: Marquez Jones
+ * Desc: Bridges CAN0 to UART1 using the SLCAN(Lawicel) protocol
+ *       so a PC can sniff and inject frames on the lab bus
+ *
+ * Notes:
+ *       this is fully interrupt driven, main only sets things up
+ *       protocol details are in MIL_SLCAN.h
+ *
+ *       Linux example:
+ *       slcand -o -s6 -S 2000000 /dev/ttyUSB0 can0
+ *       ip link set up can0
+ *       candump can0
+ *
+ * Hardware Notes:
+ *                 UART:
+ *                 UART1 on Port B at 2Mbps(needs a fast FTDI cable)
+ *                 PB0 - UART RX
+ *                 PB1 - UART TX
+ *
+ *                 CAN:
+ *                 Demo uses CAN0 on Port B
+ *                 PB4 - CANRX
+ *                 PB5 - CANTX
+ *                 CAN must have termination resistors(120 Ohms) on each node
+ */
+
+//includes
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_can.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/can.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/sysctl.h"
+
+//MIL Includes
+#include "MIL_CAN.h"
+#include "MIL_SLCAN.h"
+
+/*********************************************MAIN**********************************/
+
+int main(void){
+
+    //set system clock to 80MHZ, the UART needs it for 2Mbps
+    SysCtlClockSet(SYSCTL_SYSDIV_2_5 |
+                   SYSCTL_USE_PLL  |
+                   SYSCTL_OSC_MAIN |
+                   SYSCTL_XTAL_16MHZ);
+
+    /************GATEWAY INIT START***************/
+
+    //enable gpio clocks for CAN
+    /*
+     * Check MIL_CAN.h for when this function
+     * should be used
+     */
+    MIL_CANPortClkEnable(MIL_PORT_B);
+
+    SLCANInit(MIL_PORT_B);
+
+    /************GATEWAY INIT END***************/
+
+    IntMasterEnable();
+
+    while(1){
+
+        //nothing to do, the gateway runs from its ISRs
+
+    }
+
+}
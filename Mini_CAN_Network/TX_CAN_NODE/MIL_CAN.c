@@ -75,6 +75,11 @@ void MIL_InitCAN0(mil_port port){
     CANInit(CAN0_BASE);
 
     //Set can retry to true
+    /*
+     * Retry is controller wide, frames that should not
+     * keep retrying past a deadline use MIL_TX_DEADLINE
+     * slots instead
+     */
     CANRetrySet(CAN0_BASE,1);
 
     //Set bit rates
@@ -209,11 +214,163 @@ void MIL_CANPortClkEnable(mil_port port){
 
 }
 
+/*
+ * Desc: checks whether a slot's frame still has a
+ *       transmit request pending
+ *
+ * Notes: a pulled object keeps its request bit, but it is
+ *        invalid so it is never sent, loaded tells them apart
+ */
+static bool TxPending(const tMILCANTxSlot *slot){
+
+    return slot->loaded &&
+           ((CANStatusGet(slot->base, CAN_STS_TXREQUEST) &
+             (1u << (slot->obj - 1))) != 0);
+
+}
+
+/*
+ * Desc: counts a slot's frame as sent once the controller
+ *       has cleared its transmit request
+ *
+ * Notes: a frame stuck in arbitration or behind bus-off keeps
+ *        its request and isn't counted
+ */
+static void TxSentCheck(tMILCANTxSlot *slot){
+
+    if(slot->loaded && !TxPending(slot)){
+        slot->sent++;
+        slot->loaded = false;
+    }
+
+}
+
+/*
+ * Desc: pulls a slot's frame from its mailbox
+ *
+ * Returns: true if the frame was still waiting, i.e. it will
+ *          never be sent
+ *
+ * Notes: CANMessageClear invalidates the object which withdraws
+ *        its transmit request. Checking the request only after
+ *        that means a frame that finished just before is counted
+ *        as sent instead. A frame already on the wire when it is
+ *        pulled still finishes and can't be told from one that
+ *        was waiting, so it is counted as pulled
+ */
+static bool TxPull(tMILCANTxSlot *slot){
+
+    bool waiting;
+
+    CANMessageClear(slot->base, slot->obj);
+
+    waiting = TxPending(slot);
+
+    if(!waiting){
+        TxSentCheck(slot);
+    }
+
+    slot->loaded = false;
+
+    return waiting;
+
+}
+
+/*
+ * Desc: sets up a transmit slot
+ *
+ * Inputs: slot, controller base, message object(1-32),
+ *         policy, deadline in ticks(MIL_TX_DEADLINE only)
+ *
+ * Notes: ticks are whatever time base the application passes to
+ *        MIL_CANTxSend and MIL_CANTxService, 1ms is typical
+ */
+void MIL_CANTxSlotInit(tMILCANTxSlot *slot, uint32_t base, uint32_t obj,
+                       mil_tx_policy policy, uint32_t deadline){
+
+    slot->base = base;
+    slot->obj = obj;
+    slot->policy = policy;
+    slot->deadline = deadline;
+    slot->expires = 0;
+    slot->sent = 0;
+    slot->superseded = 0;
+    slot->stale_dropped = 0;
+    slot->busy = 0;
+    slot->loaded = false;
+
+}
+
+/*
+ * Desc: sends a frame through a slot according to its policy
+ *
+ * Notes: a pending frame is pulled before the new one is
+ *        loaded so superseded only counts frames that never
+ *        made it out(see TxPull), a previous frame that did
+ *        is counted as sent first
+ *
+ * Inputs: slot, frame to send(ID, flags, length and data),
+ *         current tick
+ */
+mil_tx_result MIL_CANTxSend(tMILCANTxSlot *slot, tCANMsgObject *msg,
+                            uint32_t now){
+
+    mil_tx_result result = MIL_TX_QUEUED;
+
+    TxSentCheck(slot);
+
+    if(TxPending(slot)){
+
+        if(slot->policy == MIL_TX_RELIABLE){
+            slot->busy++;
+            return MIL_TX_BUSY;
+        }
+
+        if(TxPull(slot)){
+            slot->superseded++;
+            result = MIL_TX_SUPERSEDED;
+        }
+
+    }
+
+    CANMessageSet(slot->base, slot->obj, msg, MSG_OBJ_TYPE_TX);
+
+    slot->loaded = true;
+    slot->expires = now + slot->deadline;
+
+    return result;
+
+}
+
+/*
+ * Desc: counts frames that have been sent and drops deadline
+ *       frames that are still pending past their deadline
+ *
+ * Notes: call periodically(timer ISR or main loop) at least as
+ *        often as the shortest deadline
+ *
+ *        the pulled object stays invalid until the next
+ *        MIL_CANTxSend sets it up again
+ *
+ * Inputs: array of slots, number of slots, current tick
+ */
+void MIL_CANTxService(tMILCANTxSlot *slots, uint32_t count, uint32_t now){
 
+    for(uint32_t idx = 0; idx < count; idx++){
 
+        tMILCANTxSlot *slot = &slots[idx];
 
+        TxSentCheck(slot);
 
+        //signed difference handles tick wrap around
+        if((slot->policy == MIL_TX_DEADLINE) &&
+           ((int32_t)(now - slot->expires) >= 0) &&
+           TxPending(slot) && TxPull(slot)){
 
+            slot->stale_dropped++;
 
+        }
 
+    }
 
+}
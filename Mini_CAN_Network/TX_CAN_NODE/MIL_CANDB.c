@@ -0,0 +1,196 @@
+/*
+ * Name: MIL_CANDB.c
+ * Author: Marquez Jones
+ * Desc: Generic signal routines and benchmark for the
+ *       generated CAN signal database(see MIL_CANDB.h)
+ *
+ * Notes: The generated functions are all inline in MIL_CANDB.h,
+ *        this file only holds the slow reference versions
+ */
+
+/* INCLUDES */
+//includes
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "driverlib/can.h"
+
+//MIL includes
+#include "MIL_CANDB.h"
+
+/*
+ * DWT cycle counter registers(Cortex-M4 core)
+ */
+#define DWT_CTRL        0xE0001000
+#define DWT_CYCCNT      0xE0001004
+#define DEMCR           0xE000EDFC
+#define DEMCR_TRCENA    0x01000000
+#define DWT_CYCCNTENA   0x00000001
+
+/*
+ * Desc: generic bit by bit signal extraction
+ *
+ * Notes: This is the slow reference used to check and benchmark
+ *        the generated code. Use the generated functions in
+ *        application code
+ *
+ * Inputs: payload, DBC start bit, length(1-32),
+ *         big endian(Motorola) flag and signed flag
+ */
+uint32_t MIL_CANDBExtract(const uint8_t *pui8Data, uint32_t start,
+                          uint32_t len, bool big_endian, bool is_signed){
+
+    uint32_t value = 0;
+    uint32_t pos = start;
+
+    for(uint32_t idx = 0; idx < len; idx++){
+
+        uint32_t bit = (pui8Data[pos / 8] >> (pos % 8)) & 0x01;
+
+        if(big_endian){
+
+            //Motorola walks from the MSB down, wrapping to bit 7
+            //of the next byte
+            value = (value << 1) | bit;
+
+            if((pos % 8) == 0){
+                pos += 15;
+            }
+            else{
+                pos--;
+            }
+
+        }
+        else{
+
+            //Intel walks from the LSB up
+            value |= bit << idx;
+            pos++;
+
+        }
+
+    }
+
+    //sign extend
+    if(is_signed && (len < 32) && (value & (1u << (len - 1)))){
+        value |= ~0u << len;
+    }
+
+    return value;
+}
+
+/*
+ * Desc: generic bit by bit signal insertion
+ *
+ * Notes: see MIL_CANDBExtract
+ */
+void MIL_CANDBInsert(uint8_t *pui8Data, uint32_t start, uint32_t len,
+                     bool big_endian, uint32_t value){
+
+    uint32_t pos = start;
+
+    for(uint32_t idx = 0; idx < len; idx++){
+
+        uint32_t bit;
+
+        if(big_endian){
+            bit = (value >> (len - 1 - idx)) & 0x01;
+        }
+        else{
+            bit = (value >> idx) & 0x01;
+        }
+
+        pui8Data[pos / 8] &= ~(1u << (pos % 8));
+        pui8Data[pos / 8] |= bit << (pos % 8);
+
+        if(big_endian){
+            if((pos % 8) == 0){
+                pos += 15;
+            }
+            else{
+                pos--;
+            }
+        }
+        else{
+            pos++;
+        }
+
+    }
+
+}
+
+/******************************BENCHMARK***************************************/
+
+/*
+ * Per message benchmark pieces generated from the database
+ */
+#define MIL_CANDB_IS_BE_LE  false
+#define MIL_CANDB_IS_BE_BE  true
+#define MIL_CANDB_IS_SIGNED_UNSIGNED    false
+#define MIL_CANDB_IS_SIGNED_SIGNED      true
+
+//generic extraction of one signal, folded into a checksum
+#define MIL_CANDB_BENCH_GENERIC(msg, sig, start, len, order, sign, factor,   \
+                                offset)                                      \
+    sum += MIL_CANDBExtract(pui8Data, start, len, MIL_CANDB_IS_BE_##order,   \
+                            MIL_CANDB_IS_SIGNED_##sign);
+
+//generated extraction of one signal, folded into a checksum
+#define MIL_CANDB_BENCH_GEN(msg, sig, start, len, order, sign, factor,       \
+                            offset)                                          \
+    sum += (uint32_t)sMsg.sig;
+
+#define MIL_CANDB_BENCH_MESSAGE(msg, id, dlc, flags, SIGS)                   \
+    {                                                                        \
+        tCANDB_##msg sMsg;                                                   \
+        start_cnt = HWREG(DWT_CYCCNT);                                       \
+        for(uint32_t idx = 0; idx < iterations; idx++){                     \
+            pui8Data[0] = (uint8_t)idx;                                      \
+            CANDB_##msg##_Unpack(&sMsg, pui8Data);                           \
+            SIGS(MIL_CANDB_BENCH_GEN, msg)                                   \
+        }                                                                    \
+        *gen_cycles += HWREG(DWT_CYCCNT) - start_cnt;                        \
+        gen_sum += sum;                                                      \
+        sum = 0;                                                             \
+        start_cnt = HWREG(DWT_CYCCNT);                                       \
+        for(uint32_t idx = 0; idx < iterations; idx++){                      \
+            pui8Data[0] = (uint8_t)idx;                                      \
+            SIGS(MIL_CANDB_BENCH_GENERIC, msg)                               \
+        }                                                                    \
+        *generic_cycles += HWREG(DWT_CYCCNT) - start_cnt;                    \
+        generic_sum += sum;                                                  \
+        sum = 0;                                                             \
+    }
+
+/*
+ * Desc: times the generated unpack of every message in the
+ *       database against MIL_CANDBExtract using the DWT cycle
+ *       counter
+ *
+ * Inputs: number of iterations, outputs for the cycle counts
+ *
+ * Returns: true if both methods decoded the same values
+ */
+bool MIL_CANDBBenchmark(uint32_t iterations, uint32_t *gen_cycles,
+                        uint32_t *generic_cycles){
+
+    //arbitrary payload, byte 0 changes every pass
+    uint8_t pui8Data[8] = {0x00, 0xA5, 0x5A, 0xC3, 0x3C, 0xF0, 0x0F, 0x96};
+
+    uint32_t start_cnt;
+    uint32_t sum = 0;
+    uint32_t gen_sum = 0;
+    uint32_t generic_sum = 0;
+
+    //enable the cycle counter
+    HWREG(DEMCR) |= DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CYCCNTENA;
+
+    *gen_cycles = 0;
+    *generic_cycles = 0;
+
+    CANDB_MESSAGES(MIL_CANDB_BENCH_MESSAGE)
+
+    return (gen_sum == generic_sum);
+}
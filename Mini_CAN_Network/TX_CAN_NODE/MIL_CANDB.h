@@ -0,0 +1,282 @@
+/*
+ * Name: MIL_CANDB.h
+ * Author: Marquez Jones
+ * Desc: Signal database code generator for packed CAN payloads
+ *
+ *       Instead of hand packing bytes into pui8MsgData, messages
+ *       and their signals are described once in CANDB_Signals.h
+ *       (ID, start bit, length, byte order, sign, scale/offset)
+ *       and this header expands that description into:
+ *
+ *         tCANDB_<Msg>              typed message struct(raw values)
+ *         CANDB_<Msg>_ID/_DLC       message constants
+ *         CANDB_<Msg>_Pack()        struct -> payload bytes
+ *         CANDB_<Msg>_Unpack()      payload bytes -> struct
+ *         CANDB_<Msg>_ObjInit()     fills in a tCANMsgObject
+ *         CANDB_<Msg>_<Sig>_Phys()  raw -> physical value
+ *         CANDB_<Msg>_<Sig>_Raw()   physical value -> raw
+ *
+ * Notes: The "generator" is the C preprocessor(X-macros) so no
+ *        extra tools are needed in the CCS project
+ *
+ *        Every start bit and length is a compile time constant so
+ *        each signal turns into one shift and one mask on a 64 bit
+ *        word. There are no loops over bits and no branches
+ *
+ *        Bit numbering follows DBC files:
+ *        LE(Intel) start bit is the signal LSB
+ *        BE(Motorola) start bit is the signal MSB, bit 7 of
+ *        byte 0 is bit 7, bit 0 of byte 1 is bit 8 and so on
+ *
+ *        Signals are limited to 32 bits, and every signal must lie
+ *        within the message's dlc bytes, both are checked at compile
+ *        time
+ *
+ *        _Raw() wraps a value that doesn't fit the signal to its
+ *        length, the same value Pack() would put on the bus
+ */
+
+#ifndef MIL_CANDB_H_
+#define MIL_CANDB_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driverlib/can.h"
+
+/******************************BIT HELPERS*************************************/
+
+/*
+ * Desc: mask with the low len bits set(len 1-32)
+ */
+#define MIL_CANDB_MASK(len)     ((uint32_t)(0xFFFFFFFFu >> (32 - (len))))
+
+/*
+ * Desc: position of the signal LSB within the 64 bit payload word
+ *
+ * Notes: LE signals are taken from the payload read as a little
+ *        endian word, BE signals from the payload read as a big
+ *        endian word(byte 0 is the most significant byte)
+ */
+#define MIL_CANDB_LSB_LE(start, len)    (start)
+#define MIL_CANDB_LSB_BE(start, len)    \
+    ((((7 - ((start) / 8)) * 8) + ((start) % 8)) - ((len) - 1))
+
+/*
+ * Desc: sign extension for a len bit two's complement value
+ *       (branch free)
+ */
+#define MIL_CANDB_EXTEND_UNSIGNED(raw, len)     (raw)
+#define MIL_CANDB_EXTEND_SIGNED(raw, len)                                 \
+    ((uint32_t)(((raw) ^ (1u << ((len) - 1))) - (1u << ((len) - 1))))
+
+/*
+ * Desc: physical -> raw conversion of a scaled value, wrapped to len
+ *       bits like the payload would wrap it
+ *
+ * Notes: a float that doesn't fit the target type converts with
+ *        undefined behavior, and a negative one never fits an
+ *        unsigned type, so it goes through a signed integer first.
+ *        Only a 32 bit signal can pass INT32_MAX and pay for the
+ *        64 bit conversion, len is a constant so the other side of
+ *        the ?: drops out
+ */
+#define MIL_CANDB_TO_RAW(value, len)                                      \
+    ((((len) < 32) ? (uint32_t)(int32_t)(value) :                         \
+                     (uint32_t)(int64_t)(value)) & MIL_CANDB_MASK(len))
+
+/*
+ * Desc: true if a signal lies within the first dlc bytes
+ *
+ * Notes: an LE signal runs up from start, a BE signal runs down from
+ *        start(its MSB) to an LSB that has to land in byte dlc - 1 or
+ *        before, which is bit (8 - dlc) * 8 of the BE word
+ */
+#define MIL_CANDB_FITS_LE(start, len, dlc)                                \
+    (((start) + (len)) <= ((dlc) * 8))
+#define MIL_CANDB_FITS_BE(start, len, dlc)                                \
+    ((((start) / 8) < (dlc)) &&                                           \
+     (MIL_CANDB_LSB_BE(start, len) >= ((8 - (dlc)) * 8)))
+
+/*
+ * Desc: C type used for a raw signal in the message struct
+ */
+#define MIL_CANDB_TYPE_UNSIGNED uint32_t
+#define MIL_CANDB_TYPE_SIGNED   int32_t
+
+/*
+ * Desc: reads the first dlc bytes of a payload as a little or
+ *       big endian 64 bit word
+ *
+ * Notes: dlc is a constant in all generated code so the loops
+ *        unroll. Bytes past dlc are never read so an exact
+ *        sized buffer is fine
+ */
+static inline uint64_t MIL_CANDBLoadLE(const uint8_t *pui8Data, uint32_t dlc){
+
+    uint64_t ui64Word = 0;
+
+    for(uint32_t idx = 0; idx < dlc; idx++){
+        ui64Word |= (uint64_t)pui8Data[idx] << (8 * idx);
+    }
+
+    return ui64Word;
+}
+
+static inline uint64_t MIL_CANDBLoadBE(const uint8_t *pui8Data, uint32_t dlc){
+
+    uint64_t ui64Word = 0;
+
+    for(uint32_t idx = 0; idx < dlc; idx++){
+        ui64Word |= (uint64_t)pui8Data[idx] << (56 - (8 * idx));
+    }
+
+    return ui64Word;
+}
+
+/*
+ * Desc: writes the LE and BE words back to the first dlc bytes
+ *
+ * Notes: a message only ever has its own signals set in either
+ *        word so the two can simply be OR'd together
+ */
+static inline void MIL_CANDBStore(uint8_t *pui8Data, uint32_t dlc,
+                                  uint64_t ui64LE, uint64_t ui64BE){
+
+    for(uint32_t idx = 0; idx < dlc; idx++){
+        pui8Data[idx] = (uint8_t)(ui64LE >> (8 * idx)) |
+                        (uint8_t)(ui64BE >> (56 - (8 * idx)));
+    }
+
+}
+
+/******************************GENERATORS**************************************/
+
+/*
+ * Each generator below is handed to the signal list of a message
+ * SIG(msg, sig, start, len, order, sign, factor, offset)
+ */
+
+//compile time layout check, a signal that doesn't fit the message
+//or isn't 1-32 bits long fails to build(negative array size)
+#define MIL_CANDB_GEN_CHECK(msg, sig, start, len, order, sign, factor, offset) \
+    typedef char tCANDB_##msg##_##sig##_Fits[                              \
+        (((len) >= 1) && ((len) <= 32) &&                                  \
+         MIL_CANDB_FITS_##order(start, len, CANDB_##msg##_DLC)) ? 1 : -1];
+
+//struct field
+#define MIL_CANDB_GEN_FIELD(msg, sig, start, len, order, sign, factor, offset) \
+    MIL_CANDB_TYPE_##sign sig;
+
+//extract from the LE or BE word
+#define MIL_CANDB_GEN_UNPACK(msg, sig, start, len, order, sign, factor, offset)\
+    psMsg->sig = (MIL_CANDB_TYPE_##sign)MIL_CANDB_EXTEND_##sign(           \
+        (uint32_t)(ui64##order >> MIL_CANDB_LSB_##order(start, len)) &     \
+        MIL_CANDB_MASK(len), len);
+
+//insert into the LE or BE word
+#define MIL_CANDB_GEN_PACK(msg, sig, start, len, order, sign, factor, offset)  \
+    ui64##order |= (uint64_t)((uint32_t)psMsg->sig & MIL_CANDB_MASK(len))  \
+                   << MIL_CANDB_LSB_##order(start, len);
+
+//scaling helpers
+#define MIL_CANDB_GEN_SCALE(msg, sig, start, len, order, sign, factor, offset) \
+    static inline float CANDB_##msg##_##sig##_Phys(MIL_CANDB_TYPE_##sign raw){\
+        return ((float)raw * (float)(factor)) + (float)(offset);           \
+    }                                                                      \
+    static inline MIL_CANDB_TYPE_##sign CANDB_##msg##_##sig##_Raw(float phys){\
+        return (MIL_CANDB_TYPE_##sign)MIL_CANDB_EXTEND_##sign(             \
+            MIL_CANDB_TO_RAW((phys - (float)(offset)) / (float)(factor),   \
+                             len), len);                                   \
+    }
+
+/*
+ * Desc: expands one message entry
+ *       MSG(msg, id, dlc, flags, SIGS)
+ *
+ * Notes: flags are the extra tCANMsgObject flags for the message
+ *        such as MSG_OBJ_EXTENDED_ID
+ */
+#define MIL_CANDB_GEN_MESSAGE(msg, id, dlc, flags, SIGS)                   \
+                                                                           \
+    enum {                                                                 \
+        CANDB_##msg##_ID  = (id),                                          \
+        CANDB_##msg##_DLC = (dlc)                                          \
+    };                                                                     \
+                                                                           \
+    SIGS(MIL_CANDB_GEN_CHECK, msg)                                         \
+                                                                           \
+    typedef struct {                                                       \
+        SIGS(MIL_CANDB_GEN_FIELD, msg)                                     \
+    } tCANDB_##msg;                                                        \
+                                                                           \
+    SIGS(MIL_CANDB_GEN_SCALE, msg)                                         \
+                                                                           \
+    static inline void CANDB_##msg##_Unpack(tCANDB_##msg *psMsg,           \
+                                            const uint8_t *pui8Data){      \
+        uint64_t ui64LE = MIL_CANDBLoadLE(pui8Data, (dlc));                \
+        uint64_t ui64BE = MIL_CANDBLoadBE(pui8Data, (dlc));                \
+        (void)ui64LE;                                                      \
+        (void)ui64BE;                                                      \
+        SIGS(MIL_CANDB_GEN_UNPACK, msg)                                    \
+    }                                                                      \
+                                                                           \
+    static inline void CANDB_##msg##_Pack(const tCANDB_##msg *psMsg,       \
+                                          uint8_t *pui8Data){              \
+        uint64_t ui64LE = 0;                                               \
+        uint64_t ui64BE = 0;                                               \
+        SIGS(MIL_CANDB_GEN_PACK, msg)                                      \
+        MIL_CANDBStore(pui8Data, (dlc), ui64LE, ui64BE);                   \
+    }                                                                      \
+                                                                           \
+    static inline void CANDB_##msg##_ObjInit(tCANMsgObject *psObj,         \
+                                             uint8_t *pui8Data){           \
+        psObj->ui32MsgID = (id);                                           \
+        psObj->ui32MsgIDMask = 0;                                          \
+        psObj->ui32Flags = (flags);                                        \
+        psObj->ui32MsgLen = (dlc);                                         \
+        psObj->pui8MsgData = pui8Data;                                     \
+    }
+
+/*
+ * Expand every message in the database
+ */
+#include "CANDB_Signals.h"
+
+CANDB_MESSAGES(MIL_CANDB_GEN_MESSAGE)
+
+/******************************GENERIC ROUTINES********************************/
+
+/*
+ * Desc: generic bit by bit signal extraction
+ *
+ * Notes: This is the slow reference used to check and benchmark
+ *        the generated code. Use the generated functions in
+ *        application code
+ *
+ * Inputs: payload, DBC start bit, length(1-32),
+ *         big endian(Motorola) flag and signed flag
+ */
+uint32_t MIL_CANDBExtract(const uint8_t *pui8Data, uint32_t start,
+                          uint32_t len, bool big_endian, bool is_signed);
+
+/*
+ * Desc: generic bit by bit signal insertion
+ *
+ * Notes: see MIL_CANDBExtract
+ */
+void MIL_CANDBInsert(uint8_t *pui8Data, uint32_t start, uint32_t len,
+                     bool big_endian, uint32_t value);
+
+/*
+ * Desc: times the generated unpack of every message in the
+ *       database against MIL_CANDBExtract using the DWT cycle
+ *       counter
+ *
+ * Inputs: number of iterations, outputs for the cycle counts
+ *
+ * Returns: true if both methods decoded the same values
+ */
+bool MIL_CANDBBenchmark(uint32_t iterations, uint32_t *gen_cycles,
+                        uint32_t *generic_cycles);
+
+#endif /* MIL_CANDB_H_ */
@@ -3,6 +3,12 @@
  * Author: Marquez Jones
  * Desc: Node transmits strings via CAN
  *
+ *       The strings go through a MIL_TX_DEADLINE slot, a string
+ *       nobody acknowledged within a second is pulled before the
+ *       next one goes out. The slot's counters follow every string
+ *       in a TxStats frame(ID 0x140, see CANDB_Signals.h) so they
+ *       can be watched with the SLCAN gateway and candump
+ *
  * Hardware Notes:
  *                 CAN:
  *                 Demo uses CAN0 on Port B
@@ -27,6 +33,14 @@
 
 //MIL Includes
 #include "MIL_CAN.h"
+#include "MIL_CANDB.h"
+
+/********************************************DEFINES******************************/
+
+//transmit slots
+#define STRING_SLOT     0
+#define STATS_SLOT      1
+#define NUM_SLOTS       2
 
 /********************************************FUNC PROTOTYPES******************************/
 
@@ -52,6 +66,9 @@ uint8_t timer0_txflag = 0x00;
 //selects message to be sent
 uint8_t timer0_msgsel = 0x00;
 
+//seconds since start, the tick for the transmit slots
+volatile uint32_t timer0_ticks = 0;
+
 /*********************************************MAIN**********************************/
 
 int main(void){
@@ -84,6 +101,25 @@ int main(void){
      */
     CANMsgObj.ui32MsgID = 1;
     CANMsgObj.ui32MsgIDMask = 0;
+    CANMsgObj.ui32Flags = MSG_OBJ_NO_FLAGS;
+
+    //slot counters report
+    tCANMsgObject StatsObj;
+    tCANDB_TxStats stats;
+    uint8_t stats_data[CANDB_TxStats_DLC];
+
+    CANDB_TxStats_ObjInit(&StatsObj, stats_data);
+
+    /*
+     * Strings use object 1 and are dropped once a second old,
+     * the report uses object 2 and is only replaced once sent
+     */
+    tMILCANTxSlot tx_slots[NUM_SLOTS];
+
+    MIL_CANTxSlotInit(&tx_slots[STRING_SLOT], CAN0_BASE, 1,
+                      MIL_TX_DEADLINE, 1);
+    MIL_CANTxSlotInit(&tx_slots[STATS_SLOT], CAN0_BASE, 2,
+                      MIL_TX_RELIABLE, 0);
 
     /************CAN INIT END***************/
 
@@ -95,6 +131,11 @@ int main(void){
 
         if(timer0_txflag){
 
+            uint32_t now = timer0_ticks;
+
+            //pull last second's string if it is still waiting
+            MIL_CANTxService(tx_slots, NUM_SLOTS, now);
+
             if(timer0_msgsel){
 
                 CANMsgObj.ui32MsgLen = 5;
@@ -110,7 +151,17 @@ int main(void){
             }
 
             //transmit using CAN object 1
-            CANMessageSet(CAN0_BASE, 1, &CANMsgObj, MSG_OBJ_TYPE_TX);
+            MIL_CANTxSend(&tx_slots[STRING_SLOT], &CANMsgObj, now);
+
+            //report the string slot
+            stats.Sent = tx_slots[STRING_SLOT].sent;
+            stats.Superseded = tx_slots[STRING_SLOT].superseded;
+            stats.StaleDropped = tx_slots[STRING_SLOT].stale_dropped;
+            stats.Busy = tx_slots[STRING_SLOT].busy;
+
+            CANDB_TxStats_Pack(&stats, stats_data);
+
+            MIL_CANTxSend(&tx_slots[STATS_SLOT], &StatsObj, now);
 
             timer0_txflag = 0;
 
@@ -192,6 +243,7 @@ void Timer0ISR(void){
 
     timer0_txflag = 0xFF;
     timer0_msgsel ^= 0xFF;
+    timer0_ticks++;
 
 }
 
@@ -0,0 +1,493 @@
+/*
+ * Name: fake_can.c
+ * Author: Marquez Jones
+ * Desc: Host model of the TM4C123 CAN message objects
+ *       see fake_can.h
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/can.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "driverlib/uart.h"
+#include "fake_can.h"
+
+//UART text kept
+#define UART_TEXT_SIZE      65536
+
+/*
+ * One message object
+ */
+typedef struct {
+    bool     valid;         //MSGVAL, cleared by CANMessageClear
+    bool     tx;            //configured for transmit
+    bool     newdat;        //received frame not read yet
+    bool     lost;          //a frame was overwritten
+    uint32_t id;
+    uint32_t flags;
+    uint32_t dlc;
+    uint8_t  data[8];
+} tFakeObj;
+
+/*
+ * One controller
+ */
+typedef struct {
+    tFakeObj obj[32];
+    uint32_t txrqst;        //bit obj - 1
+    uint32_t pending;       //bit obj - 1
+    uint32_t status;
+    bool     status_int;
+    tFakeCANTx log[FAKE_CAN_TX_LOG];
+    uint32_t logged;
+} tFakeCAN;
+
+static tFakeCAN g_psCAN[2];
+static char g_pcUART[UART_TEXT_SIZE];
+static uint32_t g_ui32UARTLen;
+static bool g_bMasked;
+
+/**************************************HELPERS********************************************/
+
+/*
+ * Desc: controller for a base address, aborts on anything else
+ */
+static tFakeCAN *Ctl(uint32_t base){
+
+    if(base == CAN0_BASE){
+        return &g_psCAN[0];
+    }
+
+    if(base == CAN1_BASE){
+        return &g_psCAN[1];
+    }
+
+    fprintf(stderr, "fake_can: bad CAN base 0x%08x\n", (unsigned)base);
+    abort();
+
+}
+
+/*
+ * Desc: message object, aborts outside 1-32
+ */
+static tFakeObj *Obj(tFakeCAN *psCAN, uint32_t obj){
+
+    if((obj < 1) || (obj > 32)){
+        fprintf(stderr, "fake_can: bad message object %u\n", (unsigned)obj);
+        abort();
+    }
+
+    return &psCAN->obj[obj - 1];
+
+}
+
+/**************************************TEST SIDE********************************************/
+
+void FakeCANReset(void){
+
+    memset(g_psCAN, 0, sizeof(g_psCAN));
+    g_ui32UARTLen = 0;
+    g_pcUART[0] = 0;
+    g_bMasked = false;
+
+}
+
+void FakeCANRx(uint32_t base, uint32_t obj, uint32_t id, uint32_t flags,
+               uint32_t dlc, const uint8_t *data){
+
+    tFakeCAN *psCAN = Ctl(base);
+    tFakeObj *psObj = Obj(psCAN, obj);
+
+    psObj->lost = psObj->newdat;
+    psObj->newdat = true;
+    psObj->id = id;
+    psObj->flags = flags & (MSG_OBJ_EXTENDED_ID | MSG_OBJ_REMOTE_FRAME);
+    psObj->dlc = dlc;
+    memset(psObj->data, 0, sizeof(psObj->data));
+
+    if(data){
+        memcpy(psObj->data, data, (dlc > 8) ? 8 : dlc);
+    }
+
+    psCAN->pending |= 1u << (obj - 1);
+
+}
+
+uint32_t FakeCANTxDone(uint32_t base){
+
+    tFakeCAN *psCAN = Ctl(base);
+    uint32_t done = 0;
+
+    //an invalid object keeps its request but never sends
+    for(uint32_t bit = 0; bit < 32; bit++){
+        if((psCAN->txrqst & (1u << bit)) && psCAN->obj[bit].valid){
+            psCAN->txrqst &= ~(1u << bit);
+            psCAN->pending |= 1u << bit;
+            done++;
+        }
+    }
+
+    return done;
+
+}
+
+void FakeCANError(uint32_t base, uint32_t status){
+
+    tFakeCAN *psCAN = Ctl(base);
+
+    psCAN->status = status;
+    psCAN->status_int = true;
+
+}
+
+uint32_t FakeCANTxCount(uint32_t base){
+
+    return Ctl(base)->logged;
+
+}
+
+const tFakeCANTx *FakeCANTxGet(uint32_t base, uint32_t idx){
+
+    tFakeCAN *psCAN = Ctl(base);
+
+    if((idx >= psCAN->logged) ||
+       ((psCAN->logged - idx) > FAKE_CAN_TX_LOG)){
+        fprintf(stderr, "fake_can: TX log index %u of %u\n", (unsigned)idx,
+                (unsigned)psCAN->logged);
+        abort();
+    }
+
+    return &psCAN->log[idx % FAKE_CAN_TX_LOG];
+
+}
+
+const char *FakeUARTText(void){
+
+    return g_pcUART;
+
+}
+
+/**************************************CAN********************************************/
+
+uint32_t CANIntStatus(uint32_t ui32Base, tCANIntStsReg eIntStsReg){
+
+    tFakeCAN *psCAN = Ctl(ui32Base);
+
+    if(eIntStsReg == CAN_INT_STS_OBJECT){
+        return psCAN->pending;
+    }
+
+    if(psCAN->status_int){
+        return CAN_INT_INTID_STATUS;
+    }
+
+    for(uint32_t bit = 0; bit < 32; bit++){
+        if(psCAN->pending & (1u << bit)){
+            return bit + 1;
+        }
+    }
+
+    return 0;
+
+}
+
+void CANIntClear(uint32_t ui32Base, uint32_t ui32IntClr){
+
+    tFakeCAN *psCAN = Ctl(ui32Base);
+
+    if(ui32IntClr == CAN_INT_INTID_STATUS){
+        psCAN->status_int = false;
+    }
+    else{
+        Obj(psCAN, ui32IntClr);
+        psCAN->pending &= ~(1u << (ui32IntClr - 1));
+    }
+
+}
+
+uint32_t CANStatusGet(uint32_t ui32Base, tCANStsReg eStatusReg){
+
+    tFakeCAN *psCAN = Ctl(ui32Base);
+    uint32_t value = 0;
+
+    switch(eStatusReg){
+
+    //the read clears the LEC and the status interrupt
+    case CAN_STS_CONTROL:
+        value = psCAN->status;
+        psCAN->status &= ~CAN_STATUS_LEC_MSK;
+        psCAN->status_int = false;
+        break;
+
+    case CAN_STS_TXREQUEST:
+        value = psCAN->txrqst;
+        break;
+
+    case CAN_STS_NEWDAT:
+        for(uint32_t bit = 0; bit < 32; bit++){
+            if(psCAN->obj[bit].newdat){
+                value |= 1u << bit;
+            }
+        }
+        break;
+
+    case CAN_STS_MSGVAL:
+        for(uint32_t bit = 0; bit < 32; bit++){
+            if(psCAN->obj[bit].valid){
+                value |= 1u << bit;
+            }
+        }
+        break;
+
+    }
+
+    return value;
+
+}
+
+void CANMessageSet(uint32_t ui32Base, uint32_t ui32ObjID,
+                   tCANMsgObject *psMsgObject, tMsgObjType eMsgType){
+
+    tFakeCAN *psCAN = Ctl(ui32Base);
+    tFakeObj *psObj = Obj(psCAN, ui32ObjID);
+    tFakeCANTx *psLog;
+
+    psObj->valid = true;
+    psObj->tx = (eMsgType == MSG_OBJ_TYPE_TX) ||
+                (eMsgType == MSG_OBJ_TYPE_TX_REMOTE);
+
+    if(!psObj->tx){
+        return;
+    }
+
+    psLog = &psCAN->log[psCAN->logged++ % FAKE_CAN_TX_LOG];
+    psLog->obj = ui32ObjID;
+    psLog->id = psMsgObject->ui32MsgID;
+    psLog->flags = psMsgObject->ui32Flags;
+    psLog->dlc = psMsgObject->ui32MsgLen;
+    psLog->remote = (eMsgType == MSG_OBJ_TYPE_TX_REMOTE);
+    memset(psLog->data, 0, sizeof(psLog->data));
+
+    if(!psLog->remote){
+        memcpy(psLog->data, psMsgObject->pui8MsgData,
+               (psLog->dlc > 8) ? 8 : psLog->dlc);
+    }
+
+    //a new request replaces one still waiting, like the hardware
+    psCAN->txrqst |= 1u << (ui32ObjID - 1);
+
+}
+
+void CANMessageGet(uint32_t ui32Base, uint32_t ui32ObjID,
+                   tCANMsgObject *psMsgObject, bool bClrPendingInt){
+
+    tFakeCAN *psCAN = Ctl(ui32Base);
+    tFakeObj *psObj = Obj(psCAN, ui32ObjID);
+
+    psMsgObject->ui32MsgID = psObj->id;
+    psMsgObject->ui32MsgIDMask = 0;
+    psMsgObject->ui32Flags = psObj->flags;
+    psMsgObject->ui32MsgLen = psObj->dlc;
+
+    if(psObj->newdat){
+        psMsgObject->ui32Flags |= MSG_OBJ_NEW_DATA;
+    }
+
+    if(psObj->lost){
+        psMsgObject->ui32Flags |= MSG_OBJ_DATA_LOST;
+    }
+
+    if(psMsgObject->pui8MsgData){
+        memcpy(psMsgObject->pui8MsgData, psObj->data,
+               (psObj->dlc > 8) ? 8 : psObj->dlc);
+    }
+
+    psObj->newdat = false;
+    psObj->lost = false;
+
+    if(bClrPendingInt){
+        psCAN->pending &= ~(1u << (ui32ObjID - 1));
+    }
+
+}
+
+void CANMessageClear(uint32_t ui32Base, uint32_t ui32ObjID){
+
+    Obj(Ctl(ui32Base), ui32ObjID)->valid = false;
+
+}
+
+void CANInit(uint32_t ui32Base){
+
+    Ctl(ui32Base);
+
+}
+
+void CANEnable(uint32_t ui32Base){
+
+    Ctl(ui32Base);
+
+}
+
+uint32_t CANBitRateSet(uint32_t ui32Base, uint32_t ui32SourceClock,
+                       uint32_t ui32BitRate){
+
+    (void)ui32SourceClock;
+
+    Ctl(ui32Base);
+
+    return ui32BitRate;
+
+}
+
+void CANRetrySet(uint32_t ui32Base, bool bAutoRetry){
+
+    (void)bAutoRetry;
+
+    Ctl(ui32Base);
+
+}
+
+void CANIntRegister(uint32_t ui32Base, void (*pfnHandler)(void)){
+
+    (void)pfnHandler;
+
+    Ctl(ui32Base);
+
+}
+
+void CANIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags){
+
+    (void)ui32IntFlags;
+
+    Ctl(ui32Base);
+
+}
+
+/**************************************EVERYTHING ELSE********************************************/
+
+bool IntMasterEnable(void){
+
+    bool masked = g_bMasked;
+
+    g_bMasked = false;
+
+    return masked;
+
+}
+
+bool IntMasterDisable(void){
+
+    bool masked = g_bMasked;
+
+    g_bMasked = true;
+
+    return masked;
+
+}
+
+void IntEnable(uint32_t ui32Interrupt){
+
+    (void)ui32Interrupt;
+
+}
+
+void GPIOPinConfigure(uint32_t ui32PinConfig){
+
+    (void)ui32PinConfig;
+
+}
+
+void GPIOPinTypeCAN(uint32_t ui32Port, uint8_t ui8Pins){
+
+    (void)ui32Port;
+    (void)ui8Pins;
+
+}
+
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral){
+
+    (void)ui32Peripheral;
+
+}
+
+bool SysCtlPeripheralReady(uint32_t ui32Peripheral){
+
+    (void)ui32Peripheral;
+
+    return true;
+
+}
+
+uint32_t SysCtlClockGet(void){
+
+    return 80000000;
+
+}
+
+void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config){
+
+    (void)ui32Base;
+    (void)ui32Config;
+
+}
+
+void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value){
+
+    (void)ui32Base;
+    (void)ui32Timer;
+    (void)ui32Value;
+
+}
+
+void TimerIntRegister(uint32_t ui32Base, uint32_t ui32Timer,
+                      void (*pfnHandler)(void)){
+
+    (void)ui32Base;
+    (void)ui32Timer;
+    (void)pfnHandler;
+
+}
+
+void TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags){
+
+    (void)ui32Base;
+    (void)ui32IntFlags;
+
+}
+
+void TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags){
+
+    (void)ui32Base;
+    (void)ui32IntFlags;
+
+}
+
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer){
+
+    (void)ui32Base;
+    (void)ui32Timer;
+
+}
+
+void UARTCharPut(uint32_t ui32Base, unsigned char ucData){
+
+    (void)ui32Base;
+
+    if(g_ui32UARTLen >= (UART_TEXT_SIZE - 1)){
+        fprintf(stderr, "fake_can: UART text full\n");
+        abort();
+    }
+
+    g_pcUART[g_ui32UARTLen++] = (char)ucData;
+    g_pcUART[g_ui32UARTLen] = 0;
+
+}
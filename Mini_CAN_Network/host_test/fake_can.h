@@ -0,0 +1,94 @@
+/*
+ * Name: fake_can.h
+ * Author: Marquez Jones
+ * Desc: Host model of the two TM4C123 CAN controllers' message
+ *       objects, plus the few timer, sysctl, interrupt and UART calls
+ *       the CAN nodes make, enough to run MIL_CAN.c's transmit slots
+ *       and the bridge and trace code on the host
+ *
+ * Model: each controller has 32 message objects, nothing happens on
+ *        its own, the test makes the bus events and then calls the
+ *        ISR the way the NVIC would
+ *        - CANMessageSet on a TX object logs the frame and sets the
+ *          object's TXRQST bit, on an RX object it only configures it
+ *        - FakeCANRx puts a received frame in an RX object and pends
+ *          its interrupt, a frame over one not read yet sets DATA_LOST
+ *        - FakeCANTxDone puts a requested frame on the wire, clears
+ *          TXRQST and pends the object's interrupt. Until then the
+ *          frame is pending, as if it kept losing arbitration
+ *        - CANMessageClear invalidates an object, its request bit
+ *          stays set but it is never sent
+ *        - FakeCANError sets the status register and pends the status
+ *          interrupt
+ *        - CANIntStatus(CAUSE) reports the status interrupt first,
+ *          then the lowest pending object, like the INTID register.
+ *          CANMessageGet(clear)/CANIntClear clear an object, reading
+ *          CAN_STS_CONTROL clears the status interrupt
+ *
+ * Notes: UARTCharPut appends to a text buffer(FakeUARTText)
+ */
+
+#ifndef FAKE_CAN_H_
+#define FAKE_CAN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//frames kept per controller, older ones are overwritten
+#define FAKE_CAN_TX_LOG     4096
+
+/*
+ * Desc: one frame loaded for transmission
+ */
+typedef struct {
+    uint32_t obj;
+    uint32_t id;
+    uint32_t flags;         //as passed to CANMessageSet
+    uint32_t dlc;
+    bool     remote;        //MSG_OBJ_TYPE_TX_REMOTE
+    uint8_t  data[8];
+} tFakeCANTx;
+
+/*
+ * Desc: clears both controllers, the TX logs and the UART text
+ */
+void FakeCANReset(void);
+
+/*
+ * Desc: receives one frame into an RX object
+ *
+ * Inputs: controller base, object(1-32), ID,
+ *         MSG_OBJ_EXTENDED_ID | MSG_OBJ_REMOTE_FRAME, length, payload
+ *         (may be 0 for a remote frame)
+ */
+void FakeCANRx(uint32_t base, uint32_t obj, uint32_t id, uint32_t flags,
+               uint32_t dlc, const uint8_t *data);
+
+/*
+ * Desc: completes every pending transmission of a valid object
+ *       on a controller
+ *
+ * Returns: frames completed
+ */
+uint32_t FakeCANTxDone(uint32_t base);
+
+/*
+ * Desc: raises a status interrupt
+ *
+ * Inputs: controller base, CAN_STATUS_xxx value
+ */
+void FakeCANError(uint32_t base, uint32_t status);
+
+/*
+ * Desc: TX log access, the count is every frame so far, only the
+ *       last FAKE_CAN_TX_LOG can be read back
+ */
+uint32_t FakeCANTxCount(uint32_t base);
+const tFakeCANTx *FakeCANTxGet(uint32_t base, uint32_t idx);
+
+/*
+ * Desc: everything written with UARTCharPut since the reset
+ */
+const char *FakeUARTText(void);
+
+#endif /* FAKE_CAN_H_ */
@@ -0,0 +1,18 @@
+/*
+ * Name: interrupt.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare driverlib/interrupt.h, backed by
+ *       fake_can.c
+ */
+
+#ifndef __DRIVERLIB_INTERRUPT_H__
+#define __DRIVERLIB_INTERRUPT_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+extern bool IntMasterEnable(void);
+extern bool IntMasterDisable(void);
+extern void IntEnable(uint32_t ui32Interrupt);
+
+#endif // __DRIVERLIB_INTERRUPT_H__
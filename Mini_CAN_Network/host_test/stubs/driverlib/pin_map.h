@@ -0,0 +1,20 @@
+/*
+ * Name: pin_map.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare driverlib/pin_map.h, the CAN pins
+ *       of the TM4C123
+ */
+
+#ifndef __DRIVERLIB_PIN_MAP_H__
+#define __DRIVERLIB_PIN_MAP_H__
+
+#define GPIO_PA0_CAN1RX         0x00000008
+#define GPIO_PA1_CAN1TX         0x00000408
+#define GPIO_PB4_CAN0RX         0x00011008
+#define GPIO_PB5_CAN0TX         0x00011408
+#define GPIO_PE4_CAN0RX         0x00041008
+#define GPIO_PE5_CAN0TX         0x00041408
+#define GPIO_PF0_CAN0RX         0x00050003
+#define GPIO_PF3_CAN0TX         0x00050C03
+
+#endif // __DRIVERLIB_PIN_MAP_H__
@@ -0,0 +1,26 @@
+/*
+ * Name: sysctl.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare driverlib/sysctl.h, backed by
+ *       fake_can.c
+ */
+
+#ifndef __DRIVERLIB_SYSCTL_H__
+#define __DRIVERLIB_SYSCTL_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SYSCTL_PERIPH_TIMER1    0xf0000401
+#define SYSCTL_PERIPH_GPIOA     0xf0000800
+#define SYSCTL_PERIPH_GPIOB     0xf0000801
+#define SYSCTL_PERIPH_GPIOE     0xf0000804
+#define SYSCTL_PERIPH_GPIOF     0xf0000805
+#define SYSCTL_PERIPH_CAN0      0xf0003400
+#define SYSCTL_PERIPH_CAN1      0xf0003401
+
+extern void SysCtlPeripheralEnable(uint32_t ui32Peripheral);
+extern bool SysCtlPeripheralReady(uint32_t ui32Peripheral);
+extern uint32_t SysCtlClockGet(void);
+
+#endif // __DRIVERLIB_SYSCTL_H__
@@ -0,0 +1,16 @@
+/*
+ * Name: uart.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare driverlib/uart.h, backed by
+ *       fake_can.c
+ */
+
+#ifndef __DRIVERLIB_UART_H__
+#define __DRIVERLIB_UART_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+extern void UARTCharPut(uint32_t ui32Base, unsigned char ucData);
+
+#endif // __DRIVERLIB_UART_H__
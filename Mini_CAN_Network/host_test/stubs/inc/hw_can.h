@@ -0,0 +1,11 @@
+/*
+ * Name: hw_can.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare inc/hw_can.h, nothing the CAN code
+ *       uses directly
+ */
+
+#ifndef __HW_CAN_H__
+#define __HW_CAN_H__
+
+#endif // __HW_CAN_H__
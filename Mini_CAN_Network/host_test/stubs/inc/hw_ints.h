@@ -0,0 +1,15 @@
+/*
+ * Name: hw_ints.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare inc/hw_ints.h(TM4C123 numbers)
+ */
+
+#ifndef __HW_INTS_H__
+#define __HW_INTS_H__
+
+#define INT_UART1               22
+#define INT_TIMER1A             37
+#define INT_CAN0                55
+#define INT_CAN1                56
+
+#endif // __HW_INTS_H__
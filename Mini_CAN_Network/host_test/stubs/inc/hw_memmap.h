@@ -0,0 +1,21 @@
+/*
+ * Name: hw_memmap.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare inc/hw_memmap.h, the peripherals
+ *       the CAN nodes use
+ */
+
+#ifndef __HW_MEMMAP_H__
+#define __HW_MEMMAP_H__
+
+#define GPIO_PORTA_BASE         0x40004000
+#define GPIO_PORTB_BASE         0x40005000
+#define UART0_BASE              0x4000C000
+#define UART1_BASE              0x4000D000
+#define TIMER1_BASE             0x40031000
+#define CAN0_BASE               0x40040000
+#define CAN1_BASE               0x40041000
+#define GPIO_PORTE_BASE         0x40024000
+#define GPIO_PORTF_BASE         0x40025000
+
+#endif // __HW_MEMMAP_H__
@@ -0,0 +1,16 @@
+/*
+ * Name: hw_types.h
+ * Author: Marquez Jones
+ * Desc: Host stand in for TivaWare inc/hw_types.h
+ *
+ * Notes: the CAN code only reaches the hardware through driverlib,
+ *        nothing here touches a register
+ */
+
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#endif // __HW_TYPES_H__
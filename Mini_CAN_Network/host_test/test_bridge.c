@@ -0,0 +1,287 @@
+/*
+ * Name: test_bridge.c
+ * Author: Marquez Jones
+ * Desc: Runs MIL_CANBridge.c and MIL_CANTrace.c as built for the
+ *       target against the fake controllers(fake_can.c), calling the
+ *       CAN and Timer1 ISRs the way the NVIC would
+ *
+ * Checks: routing and the ID rewrite(11 bits for a standard frame),
+ *         remote frames, the TX queue, and the token bucket for a rate
+ *         that doesn't divide the burst and for rates above
+ *         1000 x burst
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/can.h"
+#include "MIL_CANBridge.h"
+#include "fake_can.h"
+
+#define CHECK(cond)                                                    \
+    do{                                                                \
+        if(!(cond)){                                                   \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                   \
+        }                                                              \
+    }while(0)
+
+//route table, one route per check
+enum {
+    ROUTE_PLAIN,
+    ROUTE_STD_REWRITE,
+    ROUTE_EXT_REWRITE,
+    ROUTE_FAST,
+    ROUTE_FAST_BURST,
+    ROUTE_ODD_RATE,
+    ROUTE_BACK,
+    ROUTE_COUNT
+};
+
+static const tCANRoute g_psRoutes[ROUTE_COUNT] = {
+    //src              first    last     ext    keep                set         rate   burst
+    {MIL_BRIDGE_CAN0,  0x100,   0x17F,   false, MIL_BRIDGE_ID_KEEP, 0,          0,     1},
+    {MIL_BRIDGE_CAN0,  0x180,   0x1FF,   false, 0x0FF,              0x1F00,     0,     1},
+    {MIL_BRIDGE_CAN0,  0x10000, 0x1FFFF, true,  0xFFFF,             0x1F000000, 0,     1},
+    {MIL_BRIDGE_CAN0,  0x200,   0x20F,   false, MIL_BRIDGE_ID_KEEP, 0,          5000,  1},
+    {MIL_BRIDGE_CAN0,  0x210,   0x21F,   false, MIL_BRIDGE_ID_KEEP, 0,          20000, 4},
+    {MIL_BRIDGE_CAN0,  0x220,   0x22F,   false, MIL_BRIDGE_ID_KEEP, 0,          300,   1},
+    {MIL_BRIDGE_CAN1,  0x300,   0x3FF,   false, MIL_BRIDGE_ID_KEEP, 0,          0,     1},
+};
+
+static tCANRouteState g_psStates[ROUTE_COUNT];
+
+/******************************STAND INS FOR MIL_CAN.c******************************/
+
+void MIL_InitCAN0(mil_port port){
+
+    (void)port;
+
+}
+
+void MIL_InitCAN1(void){
+
+}
+
+void MIL_CAN0IntEnable(void (*func_ptr)(void)){
+
+    (void)func_ptr;
+
+}
+
+void MIL_CAN1IntEnable(void (*func_ptr)(void)){
+
+    (void)func_ptr;
+
+}
+
+/**************************************HELPERS********************************************/
+
+/*
+ * Desc: receives one data frame on CAN0 and runs its ISR
+ */
+static void RxCAN0(uint32_t id, bool ext){
+
+    static const uint8_t pui8Data[4] = {0xDE, 0xAD, 0xBE, 0xEF};
+
+    FakeCANRx(CAN0_BASE, 1, id, ext ? MSG_OBJ_EXTENDED_ID : 0, 4, pui8Data);
+    MIL_CANBridgeCAN0ISR();
+
+}
+
+/*
+ * Desc: puts everything queued for CAN1 on the wire
+ */
+static void DrainCAN1(void){
+
+    while(FakeCANTxDone(CAN1_BASE)){
+        MIL_CANBridgeCAN1ISR();
+    }
+
+}
+
+/*
+ * Desc: moves the millisecond tick on
+ */
+static void Tick(uint32_t ms){
+
+    while(ms--){
+        MIL_CANBridgeTimer1ISR();
+    }
+
+}
+
+/*
+ * Desc: offers count frames in the same millisecond
+ *
+ * Returns: frames forwarded
+ */
+static uint32_t Offer(uint32_t route, uint32_t id, uint32_t count){
+
+    uint32_t before = g_psStates[route].forwarded;
+
+    while(count--){
+        RxCAN0(id, false);
+        DrainCAN1();
+    }
+
+    return g_psStates[route].forwarded - before;
+
+}
+
+/**************************************CHECKS********************************************/
+
+static void CheckRouting(void){
+
+    const tFakeCANTx *psTx;
+    tCANBridgeStats sStats;
+    uint32_t first = FakeCANTxCount(CAN1_BASE);
+
+    RxCAN0(0x123, false);
+
+    CHECK(FakeCANTxCount(CAN1_BASE) == (first + 1));
+    psTx = FakeCANTxGet(CAN1_BASE, first);
+    CHECK(psTx->obj == MIL_BRIDGE_TX_OBJ_FIRST);
+    CHECK(psTx->id == 0x123);
+    CHECK(!(psTx->flags & MSG_OBJ_EXTENDED_ID));
+    CHECK(!psTx->remote);
+    CHECK((psTx->dlc == 4) && (psTx->data[0] == 0xDE) &&
+          (psTx->data[3] == 0xEF));
+    DrainCAN1();
+
+    //no route, stays on CAN0
+    RxCAN0(0x080, false);
+    CHECK(FakeCANTxCount(CAN1_BASE) == (first + 1));
+    MIL_CANBridgeStatsGet(MIL_BRIDGE_CAN0, &sStats);
+    CHECK(sStats.unrouted == 1);
+
+    //a standard frame with the route's ID is not an extended match
+    RxCAN0(0x10123, false);
+    CHECK(FakeCANTxCount(CAN1_BASE) == (first + 1));
+
+    //CAN1 -> CAN0, remote frame keeps its dlc
+    FakeCANRx(CAN1_BASE, 1, 0x345, MSG_OBJ_REMOTE_FRAME, 2, 0);
+    MIL_CANBridgeCAN1ISR();
+    CHECK(FakeCANTxCount(CAN0_BASE) == 1);
+    psTx = FakeCANTxGet(CAN0_BASE, 0);
+    CHECK((psTx->id == 0x345) && psTx->remote && (psTx->dlc == 2));
+    FakeCANTxDone(CAN0_BASE);
+    MIL_CANBridgeCAN0ISR();
+
+    MIL_CANBridgeStatsGet(MIL_BRIDGE_CAN0, &sStats);
+    CHECK(sStats.sent == 1);
+
+}
+
+static void CheckRewrite(void){
+
+    uint32_t first = FakeCANTxCount(CAN1_BASE);
+
+    //(0x1A5 & 0xFF) | 0x1F00 = 0x1FA5, the frame can only carry 0x7A5
+    RxCAN0(0x1A5, false);
+    CHECK(FakeCANTxGet(CAN1_BASE, first)->id == 0x7A5);
+
+    //an extended frame keeps all 29 bits
+    RxCAN0(0x1ABCD, true);
+    CHECK(FakeCANTxGet(CAN1_BASE, first + 1)->id == 0x1F00ABCD);
+    CHECK(FakeCANTxGet(CAN1_BASE, first + 1)->flags & MSG_OBJ_EXTENDED_ID);
+
+    DrainCAN1();
+
+}
+
+static void CheckQueue(void){
+
+    uint32_t first = FakeCANTxCount(CAN1_BASE);
+    uint32_t offered = (MIL_BRIDGE_TX_OBJ_LAST - MIL_BRIDGE_TX_OBJ_FIRST + 1) +
+                       MIL_BRIDGE_QUEUE_SIZE + 3;
+
+    //every mailbox and the queue fill up, the rest is dropped
+    for(uint32_t idx = 0; idx < offered; idx++){
+        RxCAN0(0x100 + (idx & 0x7F), false);
+    }
+
+    CHECK(g_psStates[ROUTE_PLAIN].queue_dropped == 3);
+    CHECK(FakeCANTxCount(CAN1_BASE) == (first + 8));
+
+    DrainCAN1();
+    CHECK(FakeCANTxCount(CAN1_BASE) == (first + offered - 3));
+
+}
+
+static void CheckRateAboveBurst(void){
+
+    //5000/s with a burst of 1, the bucket holds one frame however
+    //fast it refills
+    Tick(10);
+    CHECK(Offer(ROUTE_FAST, 0x200, 10) == 1);
+    Tick(1);
+    CHECK(Offer(ROUTE_FAST, 0x200, 10) == 1);
+    CHECK(Offer(ROUTE_FAST, 0x200, 1) == 0);
+
+    //20000/s with a burst of 4, 20 frames per ms refill but only 4 fit
+    Tick(10);
+    CHECK(Offer(ROUTE_FAST_BURST, 0x210, 10) == 4);
+    Tick(1);
+    CHECK(Offer(ROUTE_FAST_BURST, 0x210, 10) == 4);
+
+    CHECK(g_psStates[ROUTE_FAST].rate_dropped == 19);
+    CHECK(g_psStates[ROUTE_FAST_BURST].rate_dropped == 12);
+
+}
+
+static void CheckRateLongRun(void){
+
+    uint32_t forwarded = 0;
+
+    //300/s doesn't divide 1000. A frame offered every ms finds 900
+    //milli-frames after 3ms and 1200 after 4, which a 1 frame bucket
+    //keeps as 1000, so one frame gets through every 4ms. Never more
+    //than the burst plus 3000 in 10s, refilling to full after
+    //1000 / 300 = 3ms would give one every 3ms
+    Tick(10);
+    for(uint32_t ms = 0; ms < 10000; ms++){
+        forwarded += Offer(ROUTE_ODD_RATE, 0x220, 1);
+        Tick(1);
+    }
+
+    CHECK(forwarded == 2500);
+
+    //offered every 3ms the bucket is at 900 or full, never past the
+    //rate even though a whole 1000 / 300 ms has gone by each time
+    forwarded = 0;
+    Tick(10);
+    for(uint32_t ms = 0; ms < 10000; ms += 3){
+        forwarded += Offer(ROUTE_ODD_RATE, 0x220, 1);
+        Tick(3);
+    }
+
+    CHECK(forwarded <= 3001);
+
+    //a long idle gap only fills the bucket
+    Tick(5000000);
+    CHECK(Offer(ROUTE_ODD_RATE, 0x220, 5) == 1);
+
+}
+
+int main(int argc, char **argv){
+
+    (void)argc;
+
+    FakeCANReset();
+    MIL_CANBridgeInit(g_psRoutes, g_psStates, ROUTE_COUNT, MIL_PORT_B);
+
+    CheckRouting();
+    CheckRewrite();
+    CheckQueue();
+    CheckRateAboveBurst();
+    CheckRateLongRun();
+
+    fprintf(stderr, "%s: ok\n", argv[0]);
+
+    return 0;
+
+}
@@ -0,0 +1,142 @@
+/*
+ * Name: test_trace.c
+ * Author: Marquez Jones
+ * Desc: Runs MIL_CANTrace.c against the fake UART(fake_can.c)
+ *
+ * Checks: the trigger on an error and on an ID, post trigger records,
+ *         the candump -L export, and that a capture nobody has read
+ *         can't be thrown away by re-arming the trigger
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/can.h"
+#include "MIL_CANTrace.h"
+#include "fake_can.h"
+
+#define CHECK(cond)                                                    \
+    do{                                                                \
+        if(!(cond)){                                                   \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                   \
+        }                                                              \
+    }while(0)
+
+/*
+ * Desc: records one 4 byte standard frame on can0
+ */
+static void Frame(uint32_t ts, uint32_t id){
+
+    uint8_t pui8Data[8] = {0xDE, 0xAD, 0xBE, 0xEF};
+    tCANMsgObject sMsg = {id, 0, MSG_OBJ_NO_FLAGS, 4, pui8Data};
+
+    MIL_CANTraceRecord(ts, 0, &sMsg);
+
+}
+
+/*
+ * Desc: exports the ring
+ *
+ * Returns: records written, the text is in FakeUARTText
+ */
+static uint32_t Export(void){
+
+    FakeCANReset();
+
+    return MIL_CANTraceExport(UART1_BASE);
+
+}
+
+/**************************************CHECKS********************************************/
+
+static void CheckErrorTrigger(void){
+
+    MIL_CANTraceInit(1000);
+    CHECK(MIL_CANTraceTriggerSet(0, 0, true, 2));
+
+    Frame(1, 0x123);
+    Frame(2, 0x124);
+
+    //no error in the status, nothing recorded
+    MIL_CANTraceRecordError(3, 0, CAN_STATUS_TXOK);
+    CHECK(MIL_CANTraceStateGet() == MIL_TRACE_RUNNING);
+
+    MIL_CANTraceRecordError(3, 0, CAN_STATUS_LEC_STUFF);
+    CHECK(MIL_CANTraceStateGet() == MIL_TRACE_TRIGGERED);
+
+    //re-arming now would throw the capture away
+    CHECK(!MIL_CANTraceTriggerSet(0x7FF, 0x7FF, false, 0));
+    CHECK(MIL_CANTraceStateGet() == MIL_TRACE_TRIGGERED);
+
+    Frame(4, 0x125);
+    Frame(5, 0x126);
+    CHECK(MIL_CANTraceStateGet() == MIL_TRACE_FROZEN);
+    Frame(6, 0x127);
+
+    CHECK(!MIL_CANTraceTriggerSet(0x7FF, 0x7FF, false, 0));
+
+    //the 0x7FF trigger above never took, an ID match doesn't re-fire
+    CHECK(Export() == 5);
+    CHECK(strstr(FakeUARTText(), "(0000000000.001000) can0 123#DEADBEEF\r\n"));
+    CHECK(strstr(FakeUARTText(),
+                 "(0000000000.003000) can0 20000008#0000040000000000\r\n"));
+    CHECK(strstr(FakeUARTText(), "(0000000000.005000) can0 126#DEADBEEF\r\n"));
+    CHECK(!strstr(FakeUARTText(), "127#"));
+
+    //read, so it can be armed again and records from scratch
+    CHECK(MIL_CANTraceTriggerSet(0x300, 0x7F0, false, 0));
+    CHECK(MIL_CANTraceStateGet() == MIL_TRACE_RUNNING);
+    CHECK(Export() == 0);
+
+}
+
+static void CheckIdTrigger(void){
+
+    MIL_CANTraceRestart();
+    CHECK(MIL_CANTraceTriggerSet(0x300, 0x7F0, false, 0));
+
+    Frame(10, 0x123);
+    CHECK(MIL_CANTraceStateGet() == MIL_TRACE_RUNNING);
+
+    //post 0 freezes on the matching frame itself
+    Frame(11, 0x305);
+    CHECK(MIL_CANTraceStateGet() == MIL_TRACE_FROZEN);
+    CHECK(!MIL_CANTraceTriggerSet(0, 0, true, 8));
+
+    //throwing it away on purpose is still possible
+    MIL_CANTraceRestart();
+    CHECK(MIL_CANTraceTriggerSet(0, 0, true, 8));
+    CHECK(MIL_CANTraceStateGet() == MIL_TRACE_RUNNING);
+
+}
+
+static void CheckManualTrigger(void){
+
+    Frame(20, 0x123);
+    MIL_CANTraceTrigger(0);
+    CHECK(MIL_CANTraceStateGet() == MIL_TRACE_FROZEN);
+    CHECK(!MIL_CANTraceTriggerSet(0, 0, true, 8));
+
+    CHECK(Export() == 1);
+    CHECK(MIL_CANTraceTriggerSet(0, 0, true, 8));
+
+}
+
+int main(int argc, char **argv){
+
+    (void)argc;
+
+    CheckErrorTrigger();
+    CheckIdTrigger();
+    CheckManualTrigger();
+
+    fprintf(stderr, "%s: ok\n", argv[0]);
+
+    return 0;
+
+}
@@ -0,0 +1,135 @@
+/*
+ * Name: test_txslot.c
+ * Author: Marquez Jones
+ * Desc: Runs the transmit slots of MIL_CAN.c(TX_CAN_NODE copy, the
+ *       others are identical) against the fake controllers
+ *
+ * Checks: each policy's result and counters, sent only counting
+ *         frames the controller finished, never a frame that is
+ *         still pending(arbitration, bus-off) or was pulled
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/can.h"
+#include "MIL_CAN.h"
+#include "fake_can.h"
+
+#define CHECK(cond)                                                    \
+    do{                                                                \
+        if(!(cond)){                                                   \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                   \
+        }                                                              \
+    }while(0)
+
+static uint8_t g_pui8Data[2] = {0x12, 0x34};
+
+static tCANMsgObject g_sMsg = {
+    0x321, 0, MSG_OBJ_NO_FLAGS, sizeof(g_pui8Data), g_pui8Data
+};
+
+/**************************************CHECKS********************************************/
+
+static void CheckReliable(void){
+
+    tMILCANTxSlot sSlot;
+
+    FakeCANReset();
+    MIL_CANTxSlotInit(&sSlot, CAN0_BASE, 1, MIL_TX_RELIABLE, 0);
+
+    //loaded but stuck, as on a busy bus or in bus-off
+    CHECK(MIL_CANTxSend(&sSlot, &g_sMsg, 0) == MIL_TX_QUEUED);
+    MIL_CANTxService(&sSlot, 1, 1);
+    CHECK(sSlot.sent == 0);
+
+    CHECK(MIL_CANTxSend(&sSlot, &g_sMsg, 2) == MIL_TX_BUSY);
+    CHECK(sSlot.busy == 1);
+    CHECK(FakeCANTxCount(CAN0_BASE) == 1);
+
+    CHECK(FakeCANTxDone(CAN0_BASE) == 1);
+    MIL_CANTxService(&sSlot, 1, 3);
+    CHECK(sSlot.sent == 1);
+
+    //counted once however often it is serviced
+    MIL_CANTxService(&sSlot, 1, 4);
+    CHECK(sSlot.sent == 1);
+
+    //a send finds the last frame gone and counts it itself
+    CHECK(MIL_CANTxSend(&sSlot, &g_sMsg, 5) == MIL_TX_QUEUED);
+    CHECK(FakeCANTxDone(CAN0_BASE) == 1);
+    CHECK(MIL_CANTxSend(&sSlot, &g_sMsg, 6) == MIL_TX_QUEUED);
+    CHECK(sSlot.sent == 2);
+    CHECK(sSlot.busy == 1);
+
+}
+
+static void CheckReplace(void){
+
+    tMILCANTxSlot sSlot;
+
+    FakeCANReset();
+    MIL_CANTxSlotInit(&sSlot, CAN0_BASE, 3, MIL_TX_REPLACE, 0);
+
+    CHECK(MIL_CANTxSend(&sSlot, &g_sMsg, 0) == MIL_TX_QUEUED);
+    CHECK(MIL_CANTxSend(&sSlot, &g_sMsg, 1) == MIL_TX_SUPERSEDED);
+    CHECK(MIL_CANTxSend(&sSlot, &g_sMsg, 2) == MIL_TX_SUPERSEDED);
+    CHECK(sSlot.superseded == 2);
+    CHECK(FakeCANTxCount(CAN0_BASE) == 3);
+
+    //only the last value reaches the bus
+    CHECK(FakeCANTxDone(CAN0_BASE) == 1);
+    MIL_CANTxService(&sSlot, 1, 3);
+    CHECK(sSlot.sent == 1);
+
+    //a finished frame isn't superseded
+    CHECK(MIL_CANTxSend(&sSlot, &g_sMsg, 4) == MIL_TX_QUEUED);
+    CHECK(sSlot.superseded == 2);
+
+}
+
+static void CheckDeadline(void){
+
+    tMILCANTxSlot sSlot;
+
+    FakeCANReset();
+    MIL_CANTxSlotInit(&sSlot, CAN1_BASE, 32, MIL_TX_DEADLINE, 5);
+
+    CHECK(MIL_CANTxSend(&sSlot, &g_sMsg, 100) == MIL_TX_QUEUED);
+    MIL_CANTxService(&sSlot, 1, 104);
+    CHECK(sSlot.stale_dropped == 0);
+    MIL_CANTxService(&sSlot, 1, 105);
+    CHECK(sSlot.stale_dropped == 1);
+
+    //the pulled frame never goes out and isn't sent
+    CHECK(FakeCANTxDone(CAN1_BASE) == 0);
+    MIL_CANTxService(&sSlot, 1, 106);
+    CHECK(sSlot.sent == 0);
+
+    //a frame that finished before its deadline is sent, not stale,
+    //across the tick wrap too
+    CHECK(MIL_CANTxSend(&sSlot, &g_sMsg, 0xFFFFFFFE) == MIL_TX_QUEUED);
+    CHECK(FakeCANTxDone(CAN1_BASE) == 1);
+    MIL_CANTxService(&sSlot, 1, 3);
+    CHECK(sSlot.sent == 1);
+    CHECK(sSlot.stale_dropped == 1);
+
+}
+
+int main(int argc, char **argv){
+
+    (void)argc;
+
+    CheckReliable();
+    CheckReplace();
+    CheckDeadline();
+
+    fprintf(stderr, "%s: ok\n", argv[0]);
+
+    return 0;
+
+}